@@ -510,7 +510,9 @@ ndk::ScopedAStatus Artd::copyAndRewriteProfile(const ProfilePath& in_src,
   art_exec_args.Add(OR_RETURN_FATAL(GetArtExec())).Add("--drop-capabilities");
 
   CmdlineBuilder args;
-  args.Add(OR_RETURN_FATAL(GetProfman())).Add("--copy-and-update-profile-key");
+  args.Add(OR_RETURN_FATAL(GetProfman()))
+      .Add("--copy-and-update-profile-key")
+      .Add("--write-mappable-profile");
 
   Result<std::unique_ptr<File>> src = OpenFileForReading(src_path);
   if (!src.ok()) {
@@ -708,7 +710,9 @@ ndk::ScopedAStatus Artd::mergeProfiles(const std::vector<ProfilePath>& in_profil
         .AddIfNonEmpty("--min-new-methods-percent-change=%s",
                        props_->GetOrEmpty("dalvik.vm.bgdexopt.new-methods-percent"))
         .AddIf(in_options.forceMerge, "--force-merge")
-        .AddIf(in_options.forBootImage, "--boot-image-merge");
+        .AddIf(in_options.forBootImage, "--boot-image-merge")
+        // Lets `isProfileUsable` query the reference profile without loading it.
+        .Add("--write-mappable-profile");
   }
 
   art_exec_args.Add("--keep-fds=%s", fd_logger.GetFds()).Add("--").Concat(std::move(args));
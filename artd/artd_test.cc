@@ -1328,6 +1328,7 @@ TEST_F(ArtdTest, copyAndRewriteProfile) {
                     AllOf(Contains(art_root_ + "/bin/art_exec"), Contains("--drop-capabilities")),
                     AllOf(Contains(art_root_ + "/bin/profman"),
                           Contains("--copy-and-update-profile-key"),
+                          Contains("--write-mappable-profile"),
                           Contains(Flag("--profile-file-fd=", FdOf(src_file))),
                           Contains(Flag("--apk-fd=", FdOf(dex_file_))))),
                 HasKeepFdsFor("--profile-file-fd=", "--reference-profile-file-fd=", "--apk-fd=")),
@@ -1627,7 +1628,8 @@ TEST_F(ArtdTest, mergeProfiles) {
                           Contains(Flag("--apk-fd=", FdOf(dex_file_1))),
                           Contains(Flag("--apk-fd=", FdOf(dex_file_2))),
                           Not(Contains("--force-merge")),
-                          Not(Contains("--boot-image-merge")))),
+                          Not(Contains("--boot-image-merge")),
+                          Contains("--write-mappable-profile"))),
                 HasKeepFdsFor("--profile-file-fd=", "--reference-profile-file-fd=", "--apk-fd=")),
           _,
           _))
@@ -1782,7 +1784,8 @@ TEST_F(ArtdTest, mergeProfilesWithOptionsDumpOnly) {
                   AllOf(WhenSplitBy("--",
                                     _,
                                     AllOf(Contains("--dump-only"),
-                                          Not(Contains(Flag("--reference-profile-file-fd=", _))))),
+                                          Not(Contains(Flag("--reference-profile-file-fd=", _))),
+                                          Not(Contains("--write-mappable-profile")))),
                         HasKeepFdsFor("--profile-file-fd=", "--apk-fd=", "--dump-output-to-fd=")),
                   _,
                   _))
@@ -34,6 +34,22 @@ extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfSOAUncheckedCall(JNI
   ScopedObjectAccessUnchecked soa(Thread::Current());
 }
 
+extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfNewDeleteGlobalRef(
+    JNIEnv* env, jobject jobj, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    jobject ref = env->NewGlobalRef(jobj);
+    env->DeleteGlobalRef(ref);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfNewDeleteWeakGlobalRef(
+    JNIEnv* env, jobject jobj, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    jweak ref = env->NewWeakGlobalRef(jobj);
+    env->DeleteWeakGlobalRef(ref);
+  }
+}
+
 }  // namespace
 
 }  // namespace art
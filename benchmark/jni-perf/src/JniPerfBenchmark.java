@@ -20,6 +20,8 @@ public class JniPerfBenchmark {
   native void perfJniEmptyCall();
   native void perfSOACall();
   native void perfSOAUncheckedCall();
+  native void perfNewDeleteGlobalRef(int reps);
+  native void perfNewDeleteWeakGlobalRef(int reps);
 
   public void timeFastJNI(int N) {
     // TODO: This might be an intrinsic.
@@ -46,6 +48,35 @@ public class JniPerfBenchmark {
     }
   }
 
+  public void timeNewDeleteGlobalRef(int N) {
+    perfNewDeleteGlobalRef(N);
+  }
+
+  public void timeNewDeleteWeakGlobalRef(int N) {
+    perfNewDeleteWeakGlobalRef(N);
+  }
+
+  // Each thread does N iterations, so the time per iteration stays the same
+  // as long as the threads do not contend with each other.
+  public void timeNewDeleteGlobalRefMultiThreaded(int N) throws InterruptedException {
+    runOnAllProcessors(() -> perfNewDeleteGlobalRef(N));
+  }
+
+  public void timeNewDeleteWeakGlobalRefMultiThreaded(int N) throws InterruptedException {
+    runOnAllProcessors(() -> perfNewDeleteWeakGlobalRef(N));
+  }
+
+  private static void runOnAllProcessors(Runnable runnable) throws InterruptedException {
+    Thread[] threads = new Thread[Runtime.getRuntime().availableProcessors()];
+    for (int i = 0; i < threads.length; i++) {
+      threads[i] = new Thread(runnable);
+      threads[i].start();
+    }
+    for (Thread thread : threads) {
+      thread.join();
+    }
+  }
+
   {
     System.loadLibrary("artbenchmark");
   }
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Each benchmark creates Throwables at the bottom of a stack of 64 frames, which walks
+// the stack to fill in the trace. The frames cycle through 1, 2, 4, 8 or 16 distinct
+// methods, plus the method dispatching between them, so cache sizes can be compared by
+// the point where the time per walk jumps.
+public class StackWalkBenchmark {
+    private static final int DEPTH = 64;
+    private static final int WALKS = 16;
+
+    public void timeDistinctMethods1(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$walk(DEPTH, 1);
+        }
+    }
+
+    public void timeDistinctMethods2(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$walk(DEPTH, 2);
+        }
+    }
+
+    public void timeDistinctMethods4(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$walk(DEPTH, 4);
+        }
+    }
+
+    public void timeDistinctMethods8(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$walk(DEPTH, 8);
+        }
+    }
+
+    public void timeDistinctMethods16(int count) {
+        for (int i = 0; i < count; ++i) {
+            $noinline$walk(DEPTH, 16);
+        }
+    }
+
+    // Recurse through methods m0 to m15, choosing the next one modulo `distinct`.
+    private static int $noinline$walk(int depth, int distinct) {
+        return $noinline$m0(depth, distinct);
+    }
+
+    private static int $noinline$next(int depth, int distinct) {
+        if (depth == 0) {
+            int sum = 0;
+            for (int i = 0; i < WALKS; ++i) {
+                sum += System.identityHashCode(new Throwable());
+            }
+            return sum;
+        }
+        switch (depth % distinct) {
+            case 0: return $noinline$m0(depth - 1, distinct);
+            case 1: return $noinline$m1(depth - 1, distinct);
+            case 2: return $noinline$m2(depth - 1, distinct);
+            case 3: return $noinline$m3(depth - 1, distinct);
+            case 4: return $noinline$m4(depth - 1, distinct);
+            case 5: return $noinline$m5(depth - 1, distinct);
+            case 6: return $noinline$m6(depth - 1, distinct);
+            case 7: return $noinline$m7(depth - 1, distinct);
+            case 8: return $noinline$m8(depth - 1, distinct);
+            case 9: return $noinline$m9(depth - 1, distinct);
+            case 10: return $noinline$m10(depth - 1, distinct);
+            case 11: return $noinline$m11(depth - 1, distinct);
+            case 12: return $noinline$m12(depth - 1, distinct);
+            case 13: return $noinline$m13(depth - 1, distinct);
+            case 14: return $noinline$m14(depth - 1, distinct);
+            default: return $noinline$m15(depth - 1, distinct);
+        }
+    }
+
+    private static int $noinline$m0(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m1(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m2(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m3(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m4(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m5(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m6(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m7(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m8(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m9(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m10(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m11(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m12(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m13(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m14(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+
+    private static int $noinline$m15(int depth, int distinct) {
+        return $noinline$next(depth, distinct) + 1;
+    }
+}
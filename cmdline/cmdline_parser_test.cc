@@ -477,6 +477,9 @@ TEST_F(CmdlineParserTest, TestJitOptions) {
         MemoryKiB(16 * KB), "-Xjitinitialsize:16K", M::JITCodeCacheInitialCapacity);
     EXPECT_SINGLE_PARSE_VALUE(
         MemoryKiB(16 * MB), "-Xjitmaxsize:16M", M::JITCodeCacheMaxCapacity);
+    EXPECT_SINGLE_PARSE_VALUE(
+        MemoryKiB(2 * MB), "-Xjitarenaretainedsize:2M", M::JITArenaRetainedCapacity);
+    EXPECT_SINGLE_PARSE_VALUE(true, "-Xjitarenahugepages:true", M::JITArenaHugePages);
   }
   {
     EXPECT_SINGLE_PARSE_VALUE(12345u, "-Xjitthreshold:12345", M::JITOptimizeThreshold);
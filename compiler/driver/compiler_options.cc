@@ -19,11 +19,14 @@
 #include <fstream>
 #include <string_view>
 
+#include <unistd.h>
+
 #include "android-base/stringprintf.h"
 
 #include "arch/instruction_set.h"
 #include "arch/instruction_set_features.h"
 #include "art_method-inl.h"
+#include "base/os.h"
 #include "base/runtime_debug.h"
 #include "base/string_view_cpp20.h"
 #include "base/variant_map.h"
@@ -72,6 +75,7 @@ CompilerOptions::CompilerOptions()
       init_failure_output_(nullptr),
       dump_cfg_file_name_(""),
       dump_cfg_append_(false),
+      pass_profile_output_(nullptr),
       force_determinism_(false),
       check_linkage_conditions_(false),
       crash_on_linkage_violation_(false),
@@ -116,6 +120,46 @@ bool CompilerOptions::ParseDumpInitFailures(const std::string& option, std::stri
   return true;
 }
 
+bool CompilerOptions::ParsePassProfile(const std::string& option, std::string* error_msg) {
+  // Several compilers, e.g. the JIT's and dex2oat's, may append to the same file. Create the
+  // file with its header under a temporary name and link it in place, so that exactly one
+  // compiler writes the header and nothing can be appended before it.
+  if (!OS::FileExists(option.c_str())) {
+    std::string temp_name = android::base::StringPrintf("%s.%d.tmp", option.c_str(), getpid());
+    {
+      std::ofstream temp_output(temp_name, std::ofstream::trunc);
+      temp_output << "# method\tpass\twall_ns\tgraph_arena_delta_bytes"
+                  << "\tstack_arena_peak_delta_bytes\tblocks\tinstructions\n";
+      temp_output.close();
+      if (temp_output.fail()) {
+        *error_msg = android::base::StringPrintf(
+            "Failed to write %s for the compile pass profile.", temp_name.c_str());
+        unlink(temp_name.c_str());
+        return false;
+      }
+    }
+    // If another compiler created the file in the meantime, use that one.
+    int link_result = link(temp_name.c_str(), option.c_str());
+    int link_errno = errno;
+    unlink(temp_name.c_str());
+    if (link_result != 0 && link_errno != EEXIST) {
+      *error_msg = android::base::StringPrintf(
+          "Failed to create %s for the compile pass profile: %s",
+          option.c_str(),
+          strerror(link_errno));
+      return false;
+    }
+  }
+  pass_profile_output_.reset(new std::ofstream(option, std::ofstream::app));
+  if (pass_profile_output_->fail()) {
+    *error_msg = android::base::StringPrintf(
+        "Failed to open %s for writing the compile pass profile.", option.c_str());
+    pass_profile_output_.reset();
+    return false;
+  }
+  return true;
+}
+
 bool CompilerOptions::ParseRegisterAllocationStrategy(const std::string& option,
                                                       std::string* error_msg) {
   if (option == "linear-scan") {
@@ -316,6 +316,11 @@ class CompilerOptions final {
     return dump_cfg_append_;
   }
 
+  // Append per-method, per-pass compilation data to this stream if not null.
+  std::ostream* GetPassProfileOutput() const {
+    return pass_profile_output_.get();
+  }
+
   bool IsForceDeterminism() const {
     return force_determinism_;
   }
@@ -389,6 +394,7 @@ class CompilerOptions final {
 
  private:
   EXPORT bool ParseDumpInitFailures(const std::string& option, std::string* error_msg);
+  EXPORT bool ParsePassProfile(const std::string& option, std::string* error_msg);
   EXPORT bool ParseRegisterAllocationStrategy(const std::string& option, std::string* error_msg);
 
   CompilerFilter::Filter compiler_filter_;
@@ -454,6 +460,9 @@ class CompilerOptions final {
   std::string dump_cfg_file_name_;
   bool dump_cfg_append_;
 
+  // If not null, per-method, per-pass compile time and arena usage is appended to this stream.
+  std::unique_ptr<std::ostream> pass_profile_output_;
+
   // Whether the compiler should trade performance for determinism to guarantee exactly reproducible
   // outcomes.
   bool force_determinism_;
@@ -81,6 +81,11 @@ inline bool ReadCompilerOptions(Base& map, CompilerOptions* options, std::string
   if (map.Exists(Base::DumpCFGAppend)) {
     options->dump_cfg_append_ = true;
   }
+  if (map.Exists(Base::PassProfile)) {
+    if (!options->ParsePassProfile(*map.Get(Base::PassProfile), error_msg)) {
+      return false;
+    }
+  }
   if (map.Exists(Base::RegisterAllocationStrategy)) {
     if (!options->ParseRegisterAllocationStrategy(*map.Get(Base::DumpInitFailures), error_msg)) {
       return false;
@@ -230,6 +235,12 @@ inline void AddCompilerOptionsArgumentParserOptions(Builder& b) {
                     "(instead of overwriting existing data with new data, which is the default\n"
                     "behavior). This option is only meaningful when used with --dump-cfg.")
           .IntoKey(Map::DumpCFGAppend)
+      .Define("--compile-pass-profile=_")
+          .template WithType<std::string>()
+          .WithHelp("Append per-method, per-pass compile time, arena usage and graph size to the\n"
+                    "specified file as tab-separated values. The JIT honors this option when it\n"
+                    "is passed with -Xcompiler-option.")
+          .IntoKey(Map::PassProfile)
 
       .Define("--register-allocation-strategy=_")
           .template WithType<std::string>()
@@ -119,7 +119,7 @@ void JitCompiler::ParseCompilerOptions() {
   }
   compiler_options_->instruction_set_features_ = std::move(instruction_set_features);
 
-  if (compiler_options_->GetGenerateDebugInfo()) {
+  if (compiler_options_->GetGenerateDebugInfo() || runtime->GetJITOptions()->WritePerfMap()) {
     jit_logger_.reset(new JitLogger());
     jit_logger_->OpenLog();
   }
@@ -16,13 +16,19 @@
 
 #include "jit_logger.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "arch/instruction_set.h"
 #include "art_method-inl.h"
 #include "base/time_utils.h"
 #include "base/unix_file/fd_file.h"
+#include "dex/dex_file_types.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
 #include "oat_file-inl.h"
+#include "oat_quick_method_header.h"
+#include "stack_map.h"
 
 namespace art HIDDEN {
 namespace jit {
@@ -83,7 +89,14 @@ void JitLogger::ClosePerfMapLog() {
 //  +--------------------------------+
 //  |  PerfJitHeader                 |
 //  +--------------------------------+
-//  |  PerfJitCodeLoad {             | .
+//  |  PerfJitCodeDebugInfo     {    | .
+//  |    struct PerfJitBase;         |  .
+//  |    uint64_t address_;          |   .
+//  |    uint64_t entry_count_;      |   .
+//  |    struct PerfJitDebugEntry;   |   .
+//  |  }                             |   .
+//  +--------------------------------+   .
+//  |  PerfJitCodeLoad {             |   .
 //  |    struct PerfJitBase;         |  .
 //  |    uint32_t process_id_;       |   .
 //  |    uint32_t thread_id_;        |   .
@@ -95,19 +108,14 @@ void JitLogger::ClosePerfMapLog() {
 //  +-                              -+   .
 //  |  method_name'\0'               |   +--> one jitted method
 //  +-                              -+   .
-//  |  jitted code binary            |   .
-//  |  ...                           |   .
-//  +--------------------------------+   .
-//  |  PerfJitCodeDebugInfo     {    |   .
-//  |    struct PerfJitBase;         |   .
-//  |    uint64_t address_;          |   .
-//  |    uint64_t entry_count_;      |   .
-//  |    struct PerfJitDebugEntry;   |  .
-//  |  }                             | .
+//  |  jitted code binary            |  .
+//  |  ...                           | .
 //  +--------------------------------+
-//  |  PerfJitCodeLoad               |
+//  |  PerfJitCodeDebugInfo          |
 //     ...
 //
+// The debug info of a method, if any, must precede its code load record.
+//
 struct PerfJitHeader {
   uint32_t magic_;            // Characters "JiTD"
   uint32_t version_;          // Header version
@@ -171,7 +179,6 @@ struct PerfJitCodeLoad : PerfJitBase {
 };
 
 // This structure is for source line/column mapping.
-// Currently this feature is not implemented in ART JIT yet.
 struct PerfJitDebugEntry {
   uint64_t address_;      // Code address which maps to the line/column in source.
   uint32_t line_number_;  // Source line number starting at 1.
@@ -181,7 +188,7 @@ struct PerfJitDebugEntry {
 
 // Logs debug line information (kDebugInfo).
 // This structure is for source line/column mapping.
-// Currently this feature is not implemented in ART JIT yet.
+// In ART JIT, the entries are derived from the dex pcs of the stack maps of the method.
 struct PerfJitCodeDebugInfo : PerfJitBase {
   uint64_t address_;              // Starting code address which the debug info describes.
   uint64_t entry_count_;          // How many instances of PerfJitDebugEntry.
@@ -224,8 +231,72 @@ void JitLogger::CloseMarkerFile() {
   }
 }
 
-void JitLogger::WriteJitDumpDebugInfo() {
-  // In the future, we can add java source file line/column mapping here.
+void JitLogger::WriteJitDumpDebugInfo(const void* ptr, ArtMethod* method) {
+  if (method->IsNative()) {
+    return;
+  }
+  const char* source_file = method->GetDeclaringClassSourceFile();
+  const OatQuickMethodHeader* header = OatQuickMethodHeader::FromCodePointer(ptr);
+  if (source_file == nullptr || !header->IsOptimized()) {
+    return;
+  }
+
+  // Map the native pc of each stack map to the line of its dex pc. Inlined frames are attributed
+  // to the line of the call in the outer method.
+  std::vector<std::pair<uint64_t, int32_t>> lines;
+  CodeInfo code_info(header);
+  for (StackMap stack_map : code_info.GetStackMaps()) {
+    uint32_t dex_pc = stack_map.GetDexPc();
+    if (dex_pc == dex::kDexNoIndex) {
+      continue;
+    }
+    int32_t line = method->GetLineNumFromDexPC(dex_pc);
+    if (line > 0) {
+      uint64_t address =
+          reinterpret_cast<uint64_t>(ptr) + stack_map.GetNativePcOffset(kRuntimeISA);
+      lines.emplace_back(address, line);
+    }
+  }
+  std::sort(lines.begin(), lines.end());
+  lines.erase(std::unique(lines.begin(),
+                          lines.end(),
+                          [](const auto& lhs, const auto& rhs) { return lhs.second == rhs.second; }),
+              lines.end());
+  if (lines.empty()) {
+    return;
+  }
+
+  // The first entry has the name of the source file, the following ones use the special
+  // name "\xff" which means the same name as the previous entry.
+  static constexpr char kSameName[] = "\xff";
+  std::vector<uint8_t> record(sizeof(PerfJitCodeDebugInfo), 0u);
+  auto append = [&record](const void* data, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    record.insert(record.end(), bytes, bytes + size);
+  };
+  for (size_t i = 0; i != lines.size(); ++i) {
+    uint64_t address = lines[i].first;
+    uint32_t line_number = static_cast<uint32_t>(lines[i].second);
+    uint32_t column = 0u;
+    append(&address, sizeof(address));
+    append(&line_number, sizeof(line_number));
+    append(&column, sizeof(column));
+    if (i == 0u) {
+      append(source_file, strlen(source_file) + 1u);
+    } else {
+      append(kSameName, sizeof(kSameName));
+    }
+  }
+
+  PerfJitCodeDebugInfo debug_info;
+  std::memset(&debug_info, 0, sizeof(debug_info));
+  debug_info.event_ = PerfJitCodeDebugInfo::kDebugInfo;
+  debug_info.size_ = record.size();
+  debug_info.time_stamp_ = art::NanoTime();  // CLOCK_MONOTONIC clock is required.
+  debug_info.address_ = reinterpret_cast<uint64_t>(ptr);
+  debug_info.entry_count_ = lines.size();
+  std::memcpy(record.data(), &debug_info, sizeof(debug_info));
+  UNUSED(jit_dump_file_->WriteFully(record.data(), record.size()));
 }
 
 void JitLogger::WriteJitDumpHeader() {
@@ -270,6 +341,9 @@ void JitLogger::WriteJitDumpLog(const void* ptr, size_t code_size, ArtMethod* me
   if (jit_dump_file_ != nullptr) {
     std::string method_name = method->PrettyMethod();
 
+    // 'perf inject' expects the debug info of a method before its code load record.
+    WriteJitDumpDebugInfo(ptr, method);
+
     PerfJitCodeLoad jit_code;
     std::memset(&jit_code, 0, sizeof(jit_code));
     jit_code.event_ = PerfJitCodeLoad::kLoad;
@@ -291,8 +365,6 @@ void JitLogger::WriteJitDumpLog(const void* ptr, size_t code_size, ArtMethod* me
     UNUSED(jit_dump_file_->WriteFully(reinterpret_cast<const char*>(&jit_code), sizeof(jit_code)));
     UNUSED(jit_dump_file_->WriteFully(method_name.c_str(), method_name.size() + 1));
     UNUSED(jit_dump_file_->WriteFully(ptr, code_size));
-
-    WriteJitDumpDebugInfo();
   }
 }
 
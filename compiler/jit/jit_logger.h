@@ -40,6 +40,8 @@ namespace jit {
 //     Command line Example:
 //       $ perf record dalvikvm -Xcompiler-option --generate-debug-info -cp <classpath> Test
 //       $ perf report
+//     The -XX:JITPerfMap runtime option writes the same files without generating native
+//     debug info for the jitted code.
 //     NOTE:
 //       - Make sure that the perf-PID.map file is available for 'perf report' tool to access,
 //         so that jitted method can be displayed.
@@ -122,7 +124,8 @@ class JitLogger {
     void OpenMarkerFile();
     void CloseMarkerFile();
     void WriteJitDumpHeader();
-    void WriteJitDumpDebugInfo();
+    void WriteJitDumpDebugInfo(const void* ptr, ArtMethod* method)
+        REQUIRES_SHARED(Locks::mutator_lock_);
 
     std::unique_ptr<File> perf_file_;
     std::unique_ptr<File> jit_dump_file_;
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "argument_type_speculation.h"
+
+#include "art_field-inl.h"
+#include "class_linker.h"
+#include "class_root-inl.h"
+#include "code_generator.h"
+#include "deoptimization_kind.h"
+#include "driver/compiler_options.h"
+#include "driver/dex_compilation_unit.h"
+#include "handle_scope-inl.h"
+#include "inliner.h"
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
+#include "jit/profiling_info.h"
+#include "mirror/class-inl.h"
+#include "nodes.h"
+#include "optimizing_compiler_stats.h"
+#include "reference_type_propagation.h"
+#include "scoped_thread_state_change-inl.h"
+#include "sharpening.h"
+
+namespace art HIDDEN {
+
+bool ArgumentTypeSpeculation::GetArgumentProfile(ProfilingInfo* info,
+                                                 size_t ordinal,
+                                                 /*out*/ ArgumentProfile* profile) {
+  InlineCache* cache = info->GetArgumentCache(ordinal);
+  if (cache == nullptr || info->HasSeenNullArgument(ordinal)) {
+    return false;
+  }
+
+  StackHandleScope<InlineCache::kIndividualCacheSize> classes(Thread::Current());
+  Runtime::Current()->GetJit()->GetCodeCache()->CopyInlineCacheInto(*cache, &classes);
+  size_t number_of_types = InlineCache::kIndividualCacheSize - classes.RemainingSlots();
+  if (number_of_types == 0u) {
+    // Baseline code has not seen a non-null value yet.
+    return false;
+  }
+  profile->non_null = true;
+  if (number_of_types == 1u) {
+    profile->monomorphic_class =
+        graph_->GetHandleCache()->NewHandle(classes.GetReference(0)->AsClass());
+  }
+  return true;
+}
+
+HInstruction* ArgumentTypeSpeculation::SpeculateOnArgument(HParameterValue* parameter,
+                                                           const ArgumentProfile& profile,
+                                                           HInstruction* cursor,
+                                                           HEnvironment* environment) {
+  DCHECK(profile.non_null);
+  ArenaAllocator* allocator = graph_->GetAllocator();
+  HBasicBlock* block = graph_->GetEntryBlock()->GetSingleSuccessor();
+  auto insert = [&](HInstruction* instruction) {
+    if (cursor == nullptr) {
+      block->InsertInstructionBefore(instruction, block->GetFirstInstruction());
+    } else {
+      block->InsertInstructionAfter(instruction, cursor);
+    }
+    cursor = instruction;
+  };
+  DeoptimizationKind kind = DeoptimizationKind::kJitArgumentType;
+  ReferenceTypeInfo rti = parameter->GetReferenceTypeInfo();
+
+  // Deoptimize if the argument is null. The environment is the one of the method entry,
+  // so the interpreter re-executes the method from its first instruction.
+  HEqual* is_null = new (allocator) HEqual(parameter, graph_->GetNullConstant());
+  insert(is_null);
+  HDeoptimize* guard = new (allocator) HDeoptimize(allocator, is_null, parameter, kind, 0u);
+  insert(guard);
+  guard->CopyEnvironmentFrom(environment);
+  guard->SetReferenceTypeInfo(rti);
+  MaybeRecordStat(stats_, MethodCompilationStat::kSpeculatedArgumentNonNull);
+
+  // Deoptimize if the class of the argument is not the profiled one.
+  Handle<mirror::Class> klass = profile.monomorphic_class;
+  if (!klass.IsNull() &&
+      klass->IsInstantiable() &&
+      rti.GetTypeHandle()->IsAssignableFrom(klass.Get())) {
+    dex::TypeIndex class_index = FindClassIndexIn(klass.Get(), compilation_unit_);
+    ArtMethod* method = graph_->GetArtMethod();
+    bool is_referrer = (method != nullptr) && (klass.Get() == method->GetDeclaringClass());
+    HLoadClass* load_class = class_index.IsValid()
+        ? new (allocator) HLoadClass(graph_->GetCurrentMethod(),
+                                     class_index,
+                                     *compilation_unit_.GetDexFile(),
+                                     klass,
+                                     is_referrer,
+                                     0u,
+                                     /* needs_access_check= */ false)
+        : nullptr;
+    HLoadClass::LoadKind load_kind = (load_class != nullptr)
+        ? HSharpening::ComputeLoadClassKind(load_class, codegen_, compilation_unit_)
+        : HLoadClass::LoadKind::kInvalid;
+    if (load_kind != HLoadClass::LoadKind::kInvalid) {
+      ArtField* field =
+          GetClassRoot<mirror::Object>(compilation_unit_.GetClassLinker())->GetInstanceField(0);
+      DCHECK_EQ(std::string(field->GetName()), "shadow$_klass_");
+      HInstanceFieldGet* argument_class = new (allocator) HInstanceFieldGet(
+          guard,
+          field,
+          DataType::Type::kReference,
+          field->GetOffset(),
+          field->IsVolatile(),
+          field->GetDexFieldIndex(),
+          field->GetDeclaringClass()->GetDexClassDefIndex(),
+          *field->GetDexFile(),
+          0u);
+      // The class of a field is effectively final, and does not have any memory dependencies.
+      argument_class->SetSideEffects(SideEffects::None());
+      insert(argument_class);
+      // Load kind must be set before inserting the instruction into the graph.
+      load_class->SetLoadKind(load_kind);
+      insert(load_class);
+      if (load_class->NeedsEnvironment()) {
+        load_class->CopyEnvironmentFrom(environment);
+      }
+      HNotEqual* compare = new (allocator) HNotEqual(load_class, argument_class);
+      insert(compare);
+      HDeoptimize* type_guard = new (allocator) HDeoptimize(allocator, compare, guard, kind, 0u);
+      insert(type_guard);
+      type_guard->CopyEnvironmentFrom(environment);
+      type_guard->SetReferenceTypeInfo(rti);
+      guard = type_guard;
+      rti = ReferenceTypeInfo::Create(klass, /* is_exact= */ true);
+      MaybeRecordStat(stats_, MethodCompilationStat::kSpeculatedArgumentType);
+    }
+  }
+
+  // Retype the uses of the argument following the guards.
+  HBoundType* bound_type = new (allocator) HBoundType(guard);
+  bound_type->SetUpperBound(rti, /* can_be_null= */ false);
+  insert(bound_type);
+  parameter->ReplaceUsesDominatedBy(bound_type, bound_type);
+  return cursor;
+}
+
+bool ArgumentTypeSpeculation::Run() {
+  if (!codegen_->GetCompilerOptions().IsJitCompiler()) {
+    // AOT code cannot be recompiled when a guard fails, so a wrong speculation would
+    // leave the method in the interpreter until the next dexopt.
+    return false;
+  }
+  if (graph_->IsDebuggable() || graph_->IsCompilingOsr() || graph_->IsCompilingBaseline()) {
+    // Debuggable and OSR code must not deoptimize at method entry, and baseline code
+    // collects the profile this pass reads.
+    return false;
+  }
+  ProfilingInfo* info = graph_->GetProfilingInfo();
+  if (info == nullptr || info->HasArgumentSpeculationFailed()) {
+    // Do not speculate again on the arguments of a method whose guards have failed.
+    return false;
+  }
+
+  HBasicBlock* entry_block = graph_->GetEntryBlock();
+  HBasicBlock* first_block = entry_block->GetSingleSuccessor();
+  if (first_block->GetPredecessors().size() != 1u ||
+      first_block->IsLoopHeader() ||
+      first_block->IsTryBlock()) {
+    return false;
+  }
+  HEnvironment* environment = nullptr;
+  for (HInstructionIterator it(entry_block->GetInstructions()); !it.Done(); it.Advance()) {
+    if (it.Current()->IsSuspendCheck()) {
+      environment = it.Current()->GetEnvironment();
+      break;
+    }
+  }
+  if (environment == nullptr) {
+    return false;
+  }
+
+  bool changed = false;
+  HInstruction* cursor = nullptr;
+  size_t ordinal = 0u;
+  ScopedObjectAccess soa(Thread::Current());
+  for (HInstructionIterator it(entry_block->GetInstructions()); !it.Done(); it.Advance()) {
+    HParameterValue* parameter = it.Current()->AsParameterValueOrNull();
+    if (parameter == nullptr ||
+        parameter->IsThis() ||
+        parameter->GetType() != DataType::Type::kReference) {
+      continue;
+    }
+    if (ordinal == ProfilingInfo::kMaxProfiledArguments) {
+      break;
+    }
+    ArgumentProfile profile;
+    bool has_profile = GetArgumentProfile(info, ordinal, &profile);
+    ++ordinal;
+    if (!has_profile ||
+        !profile.non_null ||
+        !parameter->CanBeNull() ||
+        !parameter->GetReferenceTypeInfo().IsValid()) {
+      continue;
+    }
+    cursor = SpeculateOnArgument(parameter, profile, cursor, environment);
+    changed = true;
+  }
+
+  if (changed) {
+    // Run type propagation to get the guards typed, and propagate the types of the
+    // guarded arguments.
+    ReferenceTypePropagation rtp_fixup(graph_,
+                                       compilation_unit_.GetDexCache(),
+                                       /* is_first_run= */ false);
+    rtp_fixup.Run();
+  }
+  return changed;
+}
+
+}  // namespace art
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_ARGUMENT_TYPE_SPECULATION_H_
+#define ART_COMPILER_OPTIMIZING_ARGUMENT_TYPE_SPECULATION_H_
+
+#include "base/macros.h"
+#include "handle.h"
+#include "optimization.h"
+
+namespace art HIDDEN {
+
+class CodeGenerator;
+class DexCompilationUnit;
+class ProfilingInfo;
+
+namespace mirror {
+class Class;
+}  // namespace mirror
+
+/**
+ * Speculate on the profiled types of reference arguments.
+ *
+ * Baseline compiled code records the classes of the reference arguments a method is
+ * called with, and whether they were ever null (see ProfilingInfo::GetArgumentCache).
+ * When the profile says an argument was never null, or only ever of one class, this
+ * pass guards the argument with a deoptimization at method entry and types the
+ * argument accordingly for the rest of the method. This lets the inliner devirtualize
+ * calls on the argument and removes its null checks.
+ *
+ * The pass only runs in the JIT. When a guard fails, the deoptimization is recorded in
+ * the ProfilingInfo of the method and the recompiled code no longer speculates.
+ */
+class ArgumentTypeSpeculation : public HOptimization {
+ public:
+  ArgumentTypeSpeculation(HGraph* graph,
+                          CodeGenerator* codegen,
+                          const DexCompilationUnit& compilation_unit,
+                          OptimizingCompilerStats* stats,
+                          const char* name = kArgumentTypeSpeculationPassName)
+      : HOptimization(graph, name, stats),
+        codegen_(codegen),
+        compilation_unit_(compilation_unit) {}
+
+  bool Run() override;
+
+  static constexpr const char* kArgumentTypeSpeculationPassName = "argument_type_speculation";
+
+ private:
+  // What the profile says about one reference argument.
+  struct ArgumentProfile {
+    bool non_null = false;
+    // Valid only if the argument was only ever seen with this class.
+    Handle<mirror::Class> monomorphic_class;
+  };
+
+  bool GetArgumentProfile(ProfilingInfo* info, size_t ordinal, /*out*/ ArgumentProfile* profile)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Guard `parameter` at `cursor` and retype its uses dominated by the guards.
+  // Returns the last instruction inserted.
+  HInstruction* SpeculateOnArgument(HParameterValue* parameter,
+                                    const ArgumentProfile& profile,
+                                    HInstruction* cursor,
+                                    HEnvironment* environment)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  CodeGenerator* const codegen_;
+  const DexCompilationUnit& compilation_unit_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArgumentTypeSpeculation);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_ARGUMENT_TYPE_SPECULATION_H_
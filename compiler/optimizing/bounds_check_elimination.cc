@@ -23,6 +23,7 @@
 #include "induction_var_range.h"
 #include "nodes.h"
 #include "side_effects_analysis.h"
+#include "superblock_cloner.h"
 
 namespace art HIDDEN {
 
@@ -502,6 +503,14 @@ class BCEVisitor final : public HGraphVisitor {
   static constexpr uint32_t kMaxLengthForAddingDeoptimize =
       std::numeric_limits<int32_t>::max() - 1024 * 1024;
 
+  // The largest loop, in number of instructions, that is versioned to eliminate bounds checks
+  // where the deoptimization technique does not apply. Versioning duplicates the loop.
+  static constexpr size_t kMaxInstructionsForLoopVersioning = 64;
+
+  // The most bounds checks in one loop that are eliminated by versioning the loop. Each
+  // one adds up to two tests before the loop.
+  static constexpr size_t kMaxBoundsChecksForLoopVersioning = 4;
+
   // Added blocks for loop body entry test.
   bool IsAddedBlock(HBasicBlock* block) const {
     return block->GetBlockId() >= initial_block_size_;
@@ -524,6 +533,7 @@ class BCEVisitor final : public HGraphVisitor {
         taken_test_loop_(std::less<uint32_t>(),
                          allocator_.Adapter(kArenaAllocBoundsCheckElimination)),
         finite_loop_(allocator_.Adapter(kArenaAllocBoundsCheckElimination)),
+        versioning_candidates_(allocator_.Adapter(kArenaAllocBoundsCheckElimination)),
         has_dom_based_dynamic_bce_(false),
         initial_block_size_(graph->GetBlocks().size()),
         side_effects_(side_effects),
@@ -560,10 +570,14 @@ class BCEVisitor final : public HGraphVisitor {
     // new taken-test structures (see TransformLoopForDeoptimizationIfNeeded()).
     InsertPhiNodes();
 
+    // Eliminate the remaining bounds checks of early-exit loops by loop versioning.
+    VersionLoopsForDynamicBCE();
+
     // Clear the loop data structures.
     early_exit_loop_.clear();
     taken_test_loop_.clear();
     finite_loop_.clear();
+    versioning_candidates_.clear();
 
     // We may have eliminated all bounds checks so we should update the flag.
     // TODO(solanes): Do this without a linear pass of the graph?
@@ -932,6 +946,10 @@ class BCEVisitor final : public HGraphVisitor {
         TransformLoopForDynamicBCE(loop, bounds_check);
         return;
       }
+      // Otherwise, remember bounds checks that loop versioning may eliminate later.
+      if (IsLoopVersioningCandidate(loop, bounds_check)) {
+        versioning_candidates_.push_back(bounds_check);
+      }
       // Otherwise, prepare dominator-based dynamic elimination.
       if (first_index_bounds_check_map_.find(array_length->GetId()) ==
           first_index_bounds_check_map_.end()) {
@@ -1692,6 +1710,7 @@ class BCEVisitor final : public HGraphVisitor {
       }
       // Does loop have early-exits? If so, the full range may not be covered by the loop
       // at runtime and testing the range may apply deoptimization unnecessarily.
+      // Such loops may be versioned instead (see VersionLoopsForDynamicBCE()).
       if (IsEarlyExitLoop(loop)) {
         return false;
       }
@@ -1728,6 +1747,45 @@ class BCEVisitor final : public HGraphVisitor {
     return false;
   }
 
+  /**
+   * Returns true if the bounds check may be eliminated by loop versioning. This applies to
+   * early-exit loops, where testing the range could apply deoptimization unnecessarily, but
+   * can select between a version of the loop without the bounds check and the original loop.
+   */
+  bool IsLoopVersioningCandidate(HLoopInformation* loop, HBoundsCheck* bounds_check) {
+    if (loop == nullptr ||
+        loop->IsIrreducible() ||
+        !IsEarlyExitLoop(loop) ||
+        !loop->DominatesAllBackEdges(bounds_check->GetBlock()) ||
+        !loop->IsDefinedOutOfTheLoop(bounds_check->InputAt(1))) {
+      return false;
+    }
+    // The range is only valid for a finite loop. A taken-test is not needed, since a loop
+    // that is not taken does not reach the bounds check in either version.
+    bool needs_finite_test = false;
+    bool needs_taken_test = false;
+    return induction_range_.CanGenerateRange(bounds_check->GetBlock(),
+                                             bounds_check->InputAt(0),
+                                             &needs_finite_test,
+                                             &needs_taken_test) &&
+           !needs_finite_test;
+  }
+
+  /**
+   * Returns true if the loop is an innermost loop that is small enough to be duplicated.
+   */
+  bool IsLoopVersioningProfitable(HLoopInformation* loop) {
+    size_t num_instructions = 0;
+    for (HBlocksInLoopIterator it(*loop); !it.Done(); it.Advance()) {
+      HBasicBlock* block = it.Current();
+      if (block->GetLoopInformation() != loop) {
+        return false;  // inner loop
+      }
+      num_instructions += block->GetInstructions().CountSize();
+    }
+    return num_instructions <= kMaxInstructionsForLoopVersioning;
+  }
+
   /**
    * Returns true if the array length is already loop invariant, or can be made so
    * by handling the null check under the hood of the array length operation.
@@ -1931,6 +1989,118 @@ class BCEVisitor final : public HGraphVisitor {
     taken_test_loop_.Put(loop_id, true_block);
   }
 
+  /**
+   * Versions the loops of the remaining candidate bounds checks. The preheader tests the
+   * ranges of the bounds checks and selects between the original loop, where they are
+   * eliminated, and a copy of the loop that keeps them.
+   *
+   * For example, this loop:
+   *
+   *   for (int i = lower; i < upper; i++) {
+   *     if (array[i] == 0) break;
+   *   }
+   *
+   * will be transformed to:
+   *
+   *   if (lower <= upper - 1 && upper - 1 < array.length) {  // unsigned
+   *     for (int i = lower; i < upper; i++) {
+   *       // Loop without bounds check.
+   *       if (array[i] == 0) break;
+   *     }
+   *   } else {
+   *     for (int i = lower; i < upper; i++) {
+   *       // Loop with bounds check.
+   *       if (array[i] == 0) break;
+   *     }
+   *   }
+   */
+  void VersionLoopsForDynamicBCE() {
+    ScopedArenaVector<HBoundsCheck*> bounds_checks(
+        allocator_.Adapter(kArenaAllocBoundsCheckElimination));
+    for (size_t i = 0, size = versioning_candidates_.size(); i < size; ++i) {
+      HBoundsCheck* bounds_check = versioning_candidates_[i];
+      // Skip bounds checks eliminated otherwise, or already handled with their loop.
+      if (bounds_check == nullptr || !bounds_check->IsInBlock()) {
+        continue;
+      }
+      HLoopInformation* loop = bounds_check->GetBlock()->GetLoopInformation();
+      bounds_checks.clear();
+      for (size_t j = i; j < size; ++j) {
+        HBoundsCheck* other_bounds_check = versioning_candidates_[j];
+        if (other_bounds_check != nullptr &&
+            other_bounds_check->IsInBlock() &&
+            other_bounds_check->GetBlock()->GetLoopInformation() == loop) {
+          if (bounds_checks.size() < kMaxBoundsChecksForLoopVersioning &&
+              IsLoopVersioningCandidate(loop, other_bounds_check)) {
+            bounds_checks.push_back(other_bounds_check);
+          }
+          versioning_candidates_[j] = nullptr;
+        }
+      }
+      if (!bounds_checks.empty() &&
+          IsLoopVersioningProfitable(loop) &&
+          LoopClonerHelper::IsLoopClonable(loop)) {
+        VersionLoopForDynamicBCE(loop, bounds_checks);
+      }
+    }
+  }
+
+  /** Versions the loop and eliminates the bounds checks in its original version. */
+  void VersionLoopForDynamicBCE(HLoopInformation* loop,
+                                const ScopedArenaVector<HBoundsCheck*>& bounds_checks) {
+    HBasicBlock* preheader = loop->GetPreHeader();
+    DCHECK(preheader->GetLastInstruction()->IsGoto());
+    // In code, using unsigned comparisons, for each bounds check:
+    //   fast_path = fast_path && lower <= upper;   unless lower is not set
+    //   fast_path = fast_path && upper <  a.length;
+    HInstruction* fast_path = nullptr;
+    for (HBoundsCheck* bounds_check : bounds_checks) {
+      HInstruction* lower = nullptr;
+      HInstruction* upper = nullptr;
+      induction_range_.GenerateRange(bounds_check->GetBlock(),
+                                     bounds_check->InputAt(0),
+                                     GetGraph(),
+                                     preheader,
+                                     &lower,
+                                     &upper);
+      if (lower != nullptr) {
+        fast_path = InsertVersioningTest(
+            preheader, new (GetGraph()->GetAllocator()) HBelowOrEqual(lower, upper), fast_path);
+      }
+      fast_path = InsertVersioningTest(
+          preheader,
+          new (GetGraph()->GetAllocator()) HBelow(upper, bounds_check->InputAt(1)),
+          fast_path);
+    }
+
+    // Duplicate the loop. The original loop becomes the first successor of the preheader,
+    // which is taken when all tests pass.
+    LoopClonerSimpleHelper helper(loop, &induction_range_);
+    helper.DoVersioning();
+    DCHECK_EQ(preheader->GetSuccessors().size(), 2u);
+    DCHECK(preheader->GetSuccessors()[0]->Dominates(loop->GetHeader()));
+    preheader->RemoveInstruction(preheader->GetLastInstruction());
+    preheader->AddInstruction(new (GetGraph()->GetAllocator()) HIf(fast_path));
+
+    for (HBoundsCheck* bounds_check : bounds_checks) {
+      ReplaceInstruction(bounds_check, bounds_check->InputAt(0));
+    }
+  }
+
+  /** Inserts a test in the preheader and returns its conjunction with the earlier tests. */
+  HInstruction* InsertVersioningTest(HBasicBlock* preheader,
+                                     HInstruction* test,
+                                     HInstruction* fast_path) {
+    preheader->InsertInstructionBefore(test, preheader->GetLastInstruction());
+    if (fast_path == nullptr) {
+      return test;
+    }
+    HInstruction* select = new (GetGraph()->GetAllocator())
+        HSelect(test, fast_path, GetGraph()->GetIntConstant(0), kNoDexPc);
+    preheader->InsertInstructionBefore(select, preheader->GetLastInstruction());
+    return select;
+  }
+
   /**
    * Inserts phi nodes that preserve SSA structure in generated top test structures.
    * All uses of instructions in the deoptimization block that reach the loop need
@@ -2046,6 +2216,9 @@ class BCEVisitor final : public HGraphVisitor {
   // Finite loop bookkeeping.
   ScopedArenaSet<uint32_t> finite_loop_;
 
+  // Bounds checks in early-exit loops that loop versioning may eliminate.
+  ScopedArenaVector<HBoundsCheck*> versioning_candidates_;
+
   // Flag that denotes whether dominator-based dynamic elimination has occurred.
   bool has_dom_based_dynamic_bce_;
 
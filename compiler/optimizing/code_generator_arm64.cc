@@ -1306,6 +1306,64 @@ void CodeGeneratorARM64::MaybeIncrementHotness(bool is_frame_entry) {
   }
 }
 
+void CodeGeneratorARM64::MaybeGenerateArgumentProfiling() {
+  if (!GetGraph()->IsCompilingBaseline() || Runtime::Current()->IsAotCompiler()) {
+    return;
+  }
+  MacroAssembler* masm = GetVIXLAssembler();
+  ProfilingInfo* info = GetGraph()->GetProfilingInfo();
+  DCHECK(info != nullptr);
+  DCHECK(!HasEmptyFrame());
+  // Record the classes of the reference arguments still in their argument registers.
+  // The inline cache stub takes the class in w0, which holds the current method, and the
+  // cache in x8, and clobbers x9, x10 and lr. None of these are argument registers, and lr
+  // has been spilled by the frame entry.
+  uint32_t class_offset = mirror::Object::ClassOffset().Uint32Value();
+  size_t ordinal = 0u;
+  bool saved_method = false;
+  for (HInstructionIterator it(GetGraph()->GetEntryBlock()->GetInstructions());
+       !it.Done() && ordinal != ProfilingInfo::kMaxProfiledArguments;
+       it.Advance()) {
+    HParameterValue* parameter = it.Current()->AsParameterValueOrNull();
+    if (parameter == nullptr ||
+        parameter->IsThis() ||
+        parameter->GetType() != DataType::Type::kReference) {
+      continue;
+    }
+    InlineCache* cache = info->GetArgumentCache(ordinal);
+    Location location = parameter->GetLocations()->Out();
+    if (cache != nullptr && location.IsRegister()) {
+      Register argument = WRegisterFrom(location);
+      if (!saved_method) {
+        __ Mov(x11, kArtMethodRegister);
+        saved_method = true;
+      }
+      vixl::aarch64::Label is_null, done;
+      __ Cbz(argument, &is_null);
+      __ Ldr(w0, HeapOperand(argument, class_offset));
+      GetAssembler()->MaybeUnpoisonHeapReference(w0);
+      __ Mov(x8, reinterpret_cast64<uint64_t>(cache));
+      __ Ldr(w9, MemOperand(x8, InlineCache::ClassesOffset().Int32Value()));
+      // Fast path for a monomorphic cache.
+      __ Cmp(w0, w9);
+      __ B(eq, &done);
+      __ Ldr(lr, MemOperand(tr, GetThreadOffset<kArm64PointerSize>(
+          kQuickUpdateInlineCache).Int32Value()));
+      __ Blr(lr);
+      __ B(&done);
+      __ Bind(&is_null);
+      __ Mov(x8, reinterpret_cast64<uint64_t>(info));
+      __ Mov(w9, 1);
+      __ Strb(w9, MemOperand(x8, ProfilingInfo::NullArgumentOffset(ordinal).Int32Value()));
+      __ Bind(&done);
+    }
+    ++ordinal;
+  }
+  if (saved_method) {
+    __ Mov(kArtMethodRegister, x11);
+  }
+}
+
 void CodeGeneratorARM64::GenerateFrameEntry() {
   MacroAssembler* masm = GetVIXLAssembler();
 
@@ -1420,6 +1478,7 @@ void CodeGeneratorARM64::GenerateFrameEntry() {
     }
   }
   MaybeIncrementHotness(/* is_frame_entry= */ true);
+  MaybeGenerateArgumentProfiling();
   MaybeGenerateMarkingRegisterCheck(/* code= */ __LINE__);
 }
 
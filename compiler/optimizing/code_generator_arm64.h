@@ -559,6 +559,13 @@ class InstructionCodeGeneratorARM64Sve : public InstructionCodeGeneratorARM64 {
   static vixl::aarch64::PRegister LoopPReg() {
     return vixl::aarch64::p0;
   }
+
+  // Returns a predicate register for values that do not live past a single vector instruction,
+  // e.g. the result of a comparison turned into a vector mask. Like LoopPReg(), it is not
+  // exposed to the register allocator; no other code uses it.
+  static vixl::aarch64::PRegister ScratchPReg() {
+    return vixl::aarch64::p1;
+  }
 };
 
 class LocationsBuilderARM64Sve : public LocationsBuilderARM64 {
@@ -1011,6 +1018,7 @@ class CodeGeneratorARM64 : public CodeGenerator {
 
   void MaybeGenerateInlineCacheCheck(HInstruction* instruction, vixl::aarch64::Register klass);
   void MaybeIncrementHotness(bool is_frame_entry);
+  void MaybeGenerateArgumentProfiling();
 
   bool CanUseImplicitSuspendCheck() const;
 
@@ -1589,6 +1589,26 @@ void InstructionCodeGeneratorRISCV64::VisitVecUShr(HVecUShr* instruction) {
   LOG(FATAL) << "Unimplemented";
 }
 
+void LocationsBuilderRISCV64::VisitVecCondition(HVecCondition* instruction) {
+  UNUSED(instruction);
+  LOG(FATAL) << "Unimplemented";
+}
+
+void InstructionCodeGeneratorRISCV64::VisitVecCondition(HVecCondition* instruction) {
+  UNUSED(instruction);
+  LOG(FATAL) << "Unimplemented";
+}
+
+void LocationsBuilderRISCV64::VisitVecSelect(HVecSelect* instruction) {
+  UNUSED(instruction);
+  LOG(FATAL) << "Unimplemented";
+}
+
+void InstructionCodeGeneratorRISCV64::VisitVecSelect(HVecSelect* instruction) {
+  UNUSED(instruction);
+  LOG(FATAL) << "Unimplemented";
+}
+
 void LocationsBuilderRISCV64::VisitVecSetScalars(HVecSetScalars* instruction) {
   UNUSED(instruction);
   LOG(FATAL) << "Unimplemented";
@@ -990,6 +990,60 @@ void InstructionCodeGeneratorARM64Neon::VisitVecUShr(HVecUShr* instruction) {
   }
 }
 
+void LocationsBuilderARM64Neon::VisitVecCondition(HVecCondition* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+}
+
+void InstructionCodeGeneratorARM64Neon::VisitVecCondition(HVecCondition* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  VRegister lhs = VRegisterFrom(locations->InAt(0));
+  VRegister rhs = VRegisterFrom(locations->InAt(1));
+  VRegister dst = VRegisterFrom(locations->Out());
+  bool is_equal = instruction->GetCondition() == kCondEQ;
+  switch (instruction->GetPackedType()) {
+    case DataType::Type::kInt8:
+      DCHECK_EQ(16u, instruction->GetVectorLength());
+      is_equal ? __ Cmeq(dst.V16B(), lhs.V16B(), rhs.V16B())
+               : __ Cmgt(dst.V16B(), lhs.V16B(), rhs.V16B());
+      break;
+    case DataType::Type::kInt16:
+      DCHECK_EQ(8u, instruction->GetVectorLength());
+      is_equal ? __ Cmeq(dst.V8H(), lhs.V8H(), rhs.V8H())
+               : __ Cmgt(dst.V8H(), lhs.V8H(), rhs.V8H());
+      break;
+    case DataType::Type::kInt32:
+      DCHECK_EQ(4u, instruction->GetVectorLength());
+      is_equal ? __ Cmeq(dst.V4S(), lhs.V4S(), rhs.V4S())
+               : __ Cmgt(dst.V4S(), lhs.V4S(), rhs.V4S());
+      break;
+    case DataType::Type::kInt64:
+      DCHECK_EQ(2u, instruction->GetVectorLength());
+      is_equal ? __ Cmeq(dst.V2D(), lhs.V2D(), rhs.V2D())
+               : __ Cmgt(dst.V2D(), lhs.V2D(), rhs.V2D());
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderARM64Neon::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresFpuRegister());
+  locations->SetInAt(2, Location::RequiresFpuRegister());
+  locations->SetOut(Location::SameAsFirstInput());
+}
+
+void InstructionCodeGeneratorARM64Neon::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  VRegister true_value = VRegisterFrom(locations->InAt(1));
+  VRegister false_value = VRegisterFrom(locations->InAt(2));
+  VRegister dst = VRegisterFrom(locations->Out());
+  __ Bsl(dst.V16B(), true_value.V16B(), false_value.V16B());  // lanes do not matter
+}
+
 void LocationsBuilderARM64Neon::VisitVecSetScalars(HVecSetScalars* instruction) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
 
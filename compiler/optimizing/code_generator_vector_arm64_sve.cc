@@ -858,6 +858,94 @@ void InstructionCodeGeneratorARM64Sve::VisitVecUShr(HVecUShr* instruction) {
   }
 }
 
+void LocationsBuilderARM64Sve::VisitVecCondition(HVecCondition* instruction) {
+  CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+}
+
+void InstructionCodeGeneratorARM64Sve::VisitVecCondition(HVecCondition* instruction) {
+  DCHECK(instruction->IsPredicated());
+  LocationSummary* locations = instruction->GetLocations();
+  const ZRegister lhs = ZRegisterFrom(locations->InAt(0));
+  const ZRegister rhs = ZRegisterFrom(locations->InAt(1));
+  const ZRegister dst = ZRegisterFrom(locations->Out());
+  const PRegisterZ p_reg = LoopPReg().Zeroing();
+  const PRegister p_tmp = ScratchPReg();
+  ValidateVectorLength(instruction);
+
+  // Compare into a predicate, then turn it into a mask of all ones or all zeros per lane.
+  // Inactive lanes compare false.
+  bool is_equal = instruction->GetCondition() == kCondEQ;
+  switch (instruction->GetPackedType()) {
+    case DataType::Type::kInt8:
+      is_equal ? __ Cmpeq(p_tmp.VnB(), p_reg, lhs.VnB(), rhs.VnB())
+               : __ Cmpgt(p_tmp.VnB(), p_reg, lhs.VnB(), rhs.VnB());
+      __ Cpy(dst.VnB(), p_tmp.Zeroing(), -1);
+      break;
+    case DataType::Type::kInt16:
+      is_equal ? __ Cmpeq(p_tmp.VnH(), p_reg, lhs.VnH(), rhs.VnH())
+               : __ Cmpgt(p_tmp.VnH(), p_reg, lhs.VnH(), rhs.VnH());
+      __ Cpy(dst.VnH(), p_tmp.Zeroing(), -1);
+      break;
+    case DataType::Type::kInt32:
+      is_equal ? __ Cmpeq(p_tmp.VnS(), p_reg, lhs.VnS(), rhs.VnS())
+               : __ Cmpgt(p_tmp.VnS(), p_reg, lhs.VnS(), rhs.VnS());
+      __ Cpy(dst.VnS(), p_tmp.Zeroing(), -1);
+      break;
+    case DataType::Type::kInt64:
+      is_equal ? __ Cmpeq(p_tmp.VnD(), p_reg, lhs.VnD(), rhs.VnD())
+               : __ Cmpgt(p_tmp.VnD(), p_reg, lhs.VnD(), rhs.VnD());
+      __ Cpy(dst.VnD(), p_tmp.Zeroing(), -1);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderARM64Sve::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresFpuRegister());
+  locations->SetInAt(2, Location::RequiresFpuRegister());
+  locations->SetOut(Location::SameAsFirstInput());
+}
+
+void InstructionCodeGeneratorARM64Sve::VisitVecSelect(HVecSelect* instruction) {
+  DCHECK(instruction->IsPredicated());
+  LocationSummary* locations = instruction->GetLocations();
+  DCHECK(locations->InAt(0).Equals(locations->Out()));
+  const ZRegister mask = ZRegisterFrom(locations->InAt(0));
+  const ZRegister true_value = ZRegisterFrom(locations->InAt(1));
+  const ZRegister false_value = ZRegisterFrom(locations->InAt(2));
+  const ZRegister dst = ZRegisterFrom(locations->Out());
+  const PRegisterZ p_reg = LoopPReg().Zeroing();
+  const PRegister p_tmp = ScratchPReg();
+  ValidateVectorLength(instruction);
+
+  // Turn the mask back into a predicate to select with. Inactive lanes select the false value.
+  switch (instruction->GetPackedType()) {
+    case DataType::Type::kInt8:
+      __ Cmpne(p_tmp.VnB(), p_reg, mask.VnB(), 0);
+      __ Sel(dst.VnB(), p_tmp, true_value.VnB(), false_value.VnB());
+      break;
+    case DataType::Type::kInt16:
+      __ Cmpne(p_tmp.VnH(), p_reg, mask.VnH(), 0);
+      __ Sel(dst.VnH(), p_tmp, true_value.VnH(), false_value.VnH());
+      break;
+    case DataType::Type::kInt32:
+      __ Cmpne(p_tmp.VnS(), p_reg, mask.VnS(), 0);
+      __ Sel(dst.VnS(), p_tmp, true_value.VnS(), false_value.VnS());
+      break;
+    case DataType::Type::kInt64:
+      __ Cmpne(p_tmp.VnD(), p_reg, mask.VnD(), 0);
+      __ Sel(dst.VnD(), p_tmp, true_value.VnD(), false_value.VnD());
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
 void LocationsBuilderARM64Sve::VisitVecSetScalars(HVecSetScalars* instruction) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
 
@@ -25,6 +25,11 @@ namespace x86_64 {
 // NOLINT on __ macro to suppress wrong warning/fix (misc-macro-parentheses) from clang-tidy.
 #define __ down_cast<X86_64Assembler*>(GetAssembler())->  // NOLINT
 
+// Whether `instruction` operates on all 256 bits of the YMM registers, which requires AVX2.
+static bool IsYmmOperation(HVecOperation* instruction) {
+  return instruction->GetVectorNumberOfBytes() == 32u;
+}
+
 void LocationsBuilderX86_64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
   HInstruction* input = instruction->InputAt(0);
@@ -59,12 +64,55 @@ void InstructionCodeGeneratorX86_64::VisitVecReplicateScalar(HVecReplicateScalar
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
 
   bool cpu_has_avx = CpuHasAvxFeatureFlag();
-  // Shorthand for any type of zero.
+  // Shorthand for any type of zero. VEX.128 also clears the upper YMM bits.
   if (IsZeroBitPattern(instruction->InputAt(0))) {
     cpu_has_avx ? __ vxorps(dst, dst, dst) : __ xorps(dst, dst);
     return;
   }
 
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kBool:
+      case DataType::Type::kUint8:
+      case DataType::Type::kInt8:
+        DCHECK_EQ(32u, instruction->GetVectorLength());
+        __ movd(dst, locations->InAt(0).AsRegister<CpuRegister>(), /*64-bit*/ false);
+        __ vpbroadcastb(ymm_dst, dst);
+        break;
+      case DataType::Type::kUint16:
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ movd(dst, locations->InAt(0).AsRegister<CpuRegister>(), /*64-bit*/ false);
+        __ vpbroadcastw(ymm_dst, dst);
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ movd(dst, locations->InAt(0).AsRegister<CpuRegister>(), /*64-bit*/ false);
+        __ vpbroadcastd(ymm_dst, dst);
+        break;
+      case DataType::Type::kInt64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ movd(dst, locations->InAt(0).AsRegister<CpuRegister>(), /*64-bit*/ true);
+        __ vpbroadcastq(ymm_dst, dst);
+        break;
+      case DataType::Type::kFloat32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        DCHECK(locations->InAt(0).Equals(locations->Out()));
+        __ vbroadcastss(ymm_dst, dst);
+        break;
+      case DataType::Type::kFloat64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        DCHECK(locations->InAt(0).Equals(locations->Out()));
+        __ vbroadcastsd(ymm_dst, dst);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
+
   switch (instruction->GetPackedType()) {
     case DataType::Type::kBool:
     case DataType::Type::kUint8:
@@ -144,17 +192,17 @@ void InstructionCodeGeneratorX86_64::VisitVecExtractScalar(HVecExtractScalar* in
       LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
       UNREACHABLE();
     case DataType::Type::kInt32:
-      DCHECK_EQ(4u, instruction->GetVectorLength());
+      DCHECK_EQ(IsYmmOperation(instruction) ? 8u : 4u, instruction->GetVectorLength());
       __ movd(locations->Out().AsRegister<CpuRegister>(), src, /*64-bit*/ false);
       break;
     case DataType::Type::kInt64:
-      DCHECK_EQ(2u, instruction->GetVectorLength());
+      DCHECK_EQ(IsYmmOperation(instruction) ? 4u : 2u, instruction->GetVectorLength());
       __ movd(locations->Out().AsRegister<CpuRegister>(), src, /*64-bit*/ true);
       break;
     case DataType::Type::kFloat32:
     case DataType::Type::kFloat64:
       DCHECK_LE(2u, instruction->GetVectorLength());
-      DCHECK_LE(instruction->GetVectorLength(), 4u);
+      DCHECK_LE(instruction->GetVectorLength(), 8u);
       DCHECK(locations->InAt(0).Equals(locations->Out()));  // no code required
       break;
     default:
@@ -187,8 +235,9 @@ static void CreateVecUnOpLocations(ArenaAllocator* allocator, HVecUnaryOperation
 
 void LocationsBuilderX86_64::VisitVecReduce(HVecReduce* instruction) {
   CreateVecUnOpLocations(GetGraph()->GetAllocator(), instruction);
-  // Long reduction or min/max require a temporary.
+  // Long or YMM reduction or min/max require a temporary.
   if (instruction->GetPackedType() == DataType::Type::kInt64 ||
+      IsYmmOperation(instruction) ||
       instruction->GetReductionKind() == HVecReduce::kMin ||
       instruction->GetReductionKind() == HVecReduce::kMax) {
     instruction->GetLocations()->AddTemp(Location::RequiresFpuRegister());
@@ -199,6 +248,31 @@ void InstructionCodeGeneratorX86_64::VisitVecReduce(HVecReduce* instruction) {
   LocationSummary* locations = instruction->GetLocations();
   XmmRegister src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    // Add the upper half to the lower half, then reduce the lower half as for XMM.
+    DCHECK_EQ(instruction->GetReductionKind(), HVecReduce::kSum);
+    XmmRegister tmp = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+    __ vextracti128(tmp, YmmRegister(src), Immediate(1));
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpaddd(dst, src, tmp);
+        __ phaddd(dst, dst);
+        __ phaddd(dst, dst);
+        break;
+      case DataType::Type::kInt64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vpaddq(dst, src, tmp);
+        __ movaps(tmp, dst);
+        __ punpckhqdq(tmp, tmp);
+        __ paddq(dst, tmp);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kInt32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
@@ -247,7 +321,11 @@ void InstructionCodeGeneratorX86_64::VisitVecCnv(HVecCnv* instruction) {
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
   DataType::Type from = instruction->GetInputType();
   DataType::Type to = instruction->GetResultType();
-  if (from == DataType::Type::kInt32 && to == DataType::Type::kFloat32) {
+  if (from == DataType::Type::kInt32 && to == DataType::Type::kFloat32 &&
+      IsYmmOperation(instruction)) {
+    DCHECK_EQ(8u, instruction->GetVectorLength());
+    __ vcvtdq2ps(YmmRegister(dst), YmmRegister(src));
+  } else if (from == DataType::Type::kInt32 && to == DataType::Type::kFloat32) {
     DCHECK_EQ(4u, instruction->GetVectorLength());
     __ cvtdq2ps(dst, src);
   } else {
@@ -263,6 +341,43 @@ void InstructionCodeGeneratorX86_64::VisitVecNeg(HVecNeg* instruction) {
   LocationSummary* locations = instruction->GetLocations();
   XmmRegister src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_dst(dst);
+    __ vpxor(ymm_dst, ymm_dst, ymm_dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kUint8:
+      case DataType::Type::kInt8:
+        DCHECK_EQ(32u, instruction->GetVectorLength());
+        __ vpsubb(ymm_dst, ymm_dst, ymm_src);
+        break;
+      case DataType::Type::kUint16:
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ vpsubw(ymm_dst, ymm_dst, ymm_src);
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpsubd(ymm_dst, ymm_dst, ymm_src);
+        break;
+      case DataType::Type::kInt64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vpsubq(ymm_dst, ymm_dst, ymm_src);
+        break;
+      case DataType::Type::kFloat32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vsubps(ymm_dst, ymm_dst, ymm_src);
+        break;
+      case DataType::Type::kFloat64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vsubpd(ymm_dst, ymm_dst, ymm_src);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint8:
     case DataType::Type::kInt8:
@@ -314,6 +429,32 @@ void InstructionCodeGeneratorX86_64::VisitVecAbs(HVecAbs* instruction) {
   LocationSummary* locations = instruction->GetLocations();
   XmmRegister src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpabsd(ymm_dst, ymm_src);
+        break;
+      case DataType::Type::kFloat32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpcmpeqb(ymm_dst, ymm_dst, ymm_dst);  // all ones
+        __ vpsrld(ymm_dst, ymm_dst, Immediate(1));
+        __ vpand(ymm_dst, ymm_dst, ymm_src);
+        break;
+      case DataType::Type::kFloat64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vpcmpeqb(ymm_dst, ymm_dst, ymm_dst);  // all ones
+        __ vpsrlq(ymm_dst, ymm_dst, Immediate(1));
+        __ vpand(ymm_dst, ymm_dst, ymm_src);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kInt32: {
       DCHECK_EQ(4u, instruction->GetVectorLength());
@@ -355,6 +496,21 @@ void InstructionCodeGeneratorX86_64::VisitVecNot(HVecNot* instruction) {
   LocationSummary* locations = instruction->GetLocations();
   XmmRegister src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_dst(dst);
+    if (instruction->GetPackedType() == DataType::Type::kBool) {  // special case boolean-not
+      DCHECK_EQ(32u, instruction->GetVectorLength());
+      YmmRegister ymm_tmp(locations->GetTemp(0).AsFpuRegister<XmmRegister>());
+      __ vpxor(ymm_dst, ymm_dst, ymm_dst);
+      __ vpcmpeqb(ymm_tmp, ymm_tmp, ymm_tmp);  // all ones
+      __ vpsubb(ymm_dst, ymm_dst, ymm_tmp);  // 32 x one
+    } else {
+      __ vpcmpeqb(ymm_dst, ymm_dst, ymm_dst);  // all ones
+    }
+    __ vpxor(ymm_dst, ymm_dst, ymm_src);
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kBool: {  // special case boolean-not
       DCHECK_EQ(16u, instruction->GetVectorLength());
@@ -452,6 +608,43 @@ void InstructionCodeGeneratorX86_64::VisitVecAdd(HVecAdd* instruction) {
   XmmRegister other_src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
   DCHECK(cpu_has_avx || other_src == dst);
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_other_src(other_src);
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kUint8:
+      case DataType::Type::kInt8:
+        DCHECK_EQ(32u, instruction->GetVectorLength());
+        __ vpaddb(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kUint16:
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ vpaddw(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpaddd(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kInt64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vpaddq(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kFloat32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vaddps(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kFloat64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vaddpd(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint8:
     case DataType::Type::kInt8:
@@ -529,6 +722,25 @@ void InstructionCodeGeneratorX86_64::VisitVecHalvingAdd(HVecHalvingAdd* instruct
 
   DCHECK(instruction->IsRounded());
 
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kUint8:
+        DCHECK_EQ(32u, instruction->GetVectorLength());
+        __ vpavgb(ymm_dst, ymm_dst, ymm_src);
+        break;
+      case DataType::Type::kUint16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ vpavgw(ymm_dst, ymm_dst, ymm_src);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
+
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint8:
       DCHECK_EQ(16u, instruction->GetVectorLength());
@@ -559,6 +771,43 @@ void InstructionCodeGeneratorX86_64::VisitVecSub(HVecSub* instruction) {
   XmmRegister other_src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
   DCHECK(cpu_has_avx || other_src == dst);
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_other_src(other_src);
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kUint8:
+      case DataType::Type::kInt8:
+        DCHECK_EQ(32u, instruction->GetVectorLength());
+        __ vpsubb(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kUint16:
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ vpsubw(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpsubd(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kInt64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vpsubq(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kFloat32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vsubps(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kFloat64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vsubpd(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint8:
     case DataType::Type::kInt8:
@@ -639,6 +888,34 @@ void InstructionCodeGeneratorX86_64::VisitVecMul(HVecMul* instruction) {
   XmmRegister other_src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
   DCHECK(cpu_has_avx || other_src == dst);
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_other_src(other_src);
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kUint16:
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ vpmullw(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpmulld(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kFloat32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vmulps(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kFloat64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vmulpd(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint16:
     case DataType::Type::kInt16:
@@ -678,6 +955,25 @@ void InstructionCodeGeneratorX86_64::VisitVecDiv(HVecDiv* instruction) {
   XmmRegister other_src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
   DCHECK(cpu_has_avx || other_src == dst);
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_other_src(other_src);
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kFloat32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vdivps(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kFloat64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vdivpd(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kFloat32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
@@ -694,47 +990,53 @@ void InstructionCodeGeneratorX86_64::VisitVecDiv(HVecDiv* instruction) {
 }
 
 void LocationsBuilderX86_64::VisitVecMin(HVecMin* instruction) {
-  CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+  if (CpuHasAvxFeatureFlag()) {
+    CreateVecTerOpLocations(GetGraph()->GetAllocator(), instruction);
+  } else {
+    CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+  }
 }
 
 void InstructionCodeGeneratorX86_64::VisitVecMin(HVecMin* instruction) {
+  bool cpu_has_avx = CpuHasAvxFeatureFlag();
   LocationSummary* locations = instruction->GetLocations();
-  DCHECK(locations->InAt(0).Equals(locations->Out()));
   XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  XmmRegister other_src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  DCHECK(cpu_has_avx || other_src == dst);
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint8:
       DCHECK_EQ(16u, instruction->GetVectorLength());
-      __ pminub(dst, src);
+      cpu_has_avx ? __ vpminub(dst, other_src, src) : __ pminub(dst, src);
       break;
     case DataType::Type::kInt8:
       DCHECK_EQ(16u, instruction->GetVectorLength());
-      __ pminsb(dst, src);
+      cpu_has_avx ? __ vpminsb(dst, other_src, src) : __ pminsb(dst, src);
       break;
     case DataType::Type::kUint16:
       DCHECK_EQ(8u, instruction->GetVectorLength());
-      __ pminuw(dst, src);
+      cpu_has_avx ? __ vpminuw(dst, other_src, src) : __ pminuw(dst, src);
       break;
     case DataType::Type::kInt16:
       DCHECK_EQ(8u, instruction->GetVectorLength());
-      __ pminsw(dst, src);
+      cpu_has_avx ? __ vpminsw(dst, other_src, src) : __ pminsw(dst, src);
       break;
     case DataType::Type::kUint32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
-      __ pminud(dst, src);
+      cpu_has_avx ? __ vpminud(dst, other_src, src) : __ pminud(dst, src);
       break;
     case DataType::Type::kInt32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
-      __ pminsd(dst, src);
+      cpu_has_avx ? __ vpminsd(dst, other_src, src) : __ pminsd(dst, src);
       break;
     // Next cases are sloppy wrt 0.0 vs -0.0.
     case DataType::Type::kFloat32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
-      __ minps(dst, src);
+      cpu_has_avx ? __ vminps(dst, other_src, src) : __ minps(dst, src);
       break;
     case DataType::Type::kFloat64:
       DCHECK_EQ(2u, instruction->GetVectorLength());
-      __ minpd(dst, src);
+      cpu_has_avx ? __ vminpd(dst, other_src, src) : __ minpd(dst, src);
       break;
     default:
       LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
@@ -743,47 +1045,53 @@ void InstructionCodeGeneratorX86_64::VisitVecMin(HVecMin* instruction) {
 }
 
 void LocationsBuilderX86_64::VisitVecMax(HVecMax* instruction) {
-  CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+  if (CpuHasAvxFeatureFlag()) {
+    CreateVecTerOpLocations(GetGraph()->GetAllocator(), instruction);
+  } else {
+    CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+  }
 }
 
 void InstructionCodeGeneratorX86_64::VisitVecMax(HVecMax* instruction) {
+  bool cpu_has_avx = CpuHasAvxFeatureFlag();
   LocationSummary* locations = instruction->GetLocations();
-  DCHECK(locations->InAt(0).Equals(locations->Out()));
   XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  XmmRegister other_src = locations->InAt(0).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  DCHECK(cpu_has_avx || other_src == dst);
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint8:
       DCHECK_EQ(16u, instruction->GetVectorLength());
-      __ pmaxub(dst, src);
+      cpu_has_avx ? __ vpmaxub(dst, other_src, src) : __ pmaxub(dst, src);
       break;
     case DataType::Type::kInt8:
       DCHECK_EQ(16u, instruction->GetVectorLength());
-      __ pmaxsb(dst, src);
+      cpu_has_avx ? __ vpmaxsb(dst, other_src, src) : __ pmaxsb(dst, src);
       break;
     case DataType::Type::kUint16:
       DCHECK_EQ(8u, instruction->GetVectorLength());
-      __ pmaxuw(dst, src);
+      cpu_has_avx ? __ vpmaxuw(dst, other_src, src) : __ pmaxuw(dst, src);
       break;
     case DataType::Type::kInt16:
       DCHECK_EQ(8u, instruction->GetVectorLength());
-      __ pmaxsw(dst, src);
+      cpu_has_avx ? __ vpmaxsw(dst, other_src, src) : __ pmaxsw(dst, src);
       break;
     case DataType::Type::kUint32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
-      __ pmaxud(dst, src);
+      cpu_has_avx ? __ vpmaxud(dst, other_src, src) : __ pmaxud(dst, src);
       break;
     case DataType::Type::kInt32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
-      __ pmaxsd(dst, src);
+      cpu_has_avx ? __ vpmaxsd(dst, other_src, src) : __ pmaxsd(dst, src);
       break;
     // Next cases are sloppy wrt 0.0 vs -0.0.
     case DataType::Type::kFloat32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
-      __ maxps(dst, src);
+      cpu_has_avx ? __ vmaxps(dst, other_src, src) : __ maxps(dst, src);
       break;
     case DataType::Type::kFloat64:
       DCHECK_EQ(2u, instruction->GetVectorLength());
-      __ maxpd(dst, src);
+      cpu_has_avx ? __ vmaxpd(dst, other_src, src) : __ maxpd(dst, src);
       break;
     default:
       LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
@@ -806,6 +1114,11 @@ void InstructionCodeGeneratorX86_64::VisitVecAnd(HVecAnd* instruction) {
   XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
   DCHECK(cpu_has_avx || other_src == dst);
+  if (IsYmmOperation(instruction)) {
+    // The bitwise operation does not depend on the packed type.
+    __ vpand(YmmRegister(dst), YmmRegister(other_src), YmmRegister(src));
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kBool:
     case DataType::Type::kUint8:
@@ -888,6 +1201,11 @@ void InstructionCodeGeneratorX86_64::VisitVecOr(HVecOr* instruction) {
   XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
   DCHECK(cpu_has_avx || other_src == dst);
+  if (IsYmmOperation(instruction)) {
+    // The bitwise operation does not depend on the packed type.
+    __ vpor(YmmRegister(dst), YmmRegister(other_src), YmmRegister(src));
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kBool:
     case DataType::Type::kUint8:
@@ -929,6 +1247,11 @@ void InstructionCodeGeneratorX86_64::VisitVecXor(HVecXor* instruction) {
   XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
   DCHECK(cpu_has_avx || other_src == dst);
+  if (IsYmmOperation(instruction)) {
+    // The bitwise operation does not depend on the packed type.
+    __ vpxor(YmmRegister(dst), YmmRegister(other_src), YmmRegister(src));
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kBool:
     case DataType::Type::kUint8:
@@ -982,6 +1305,28 @@ void InstructionCodeGeneratorX86_64::VisitVecShl(HVecShl* instruction) {
   DCHECK(locations->InAt(0).Equals(locations->Out()));
   int32_t value = locations->InAt(1).GetConstant()->AsIntConstant()->GetValue();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kUint16:
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ vpsllw(ymm_dst, ymm_dst, Immediate(static_cast<int8_t>(value)));
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpslld(ymm_dst, ymm_dst, Immediate(static_cast<int8_t>(value)));
+        break;
+      case DataType::Type::kInt64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vpsllq(ymm_dst, ymm_dst, Immediate(static_cast<int8_t>(value)));
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint16:
     case DataType::Type::kInt16:
@@ -1011,6 +1356,24 @@ void InstructionCodeGeneratorX86_64::VisitVecShr(HVecShr* instruction) {
   DCHECK(locations->InAt(0).Equals(locations->Out()));
   int32_t value = locations->InAt(1).GetConstant()->AsIntConstant()->GetValue();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kUint16:
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ vpsraw(ymm_dst, ymm_dst, Immediate(static_cast<int8_t>(value)));
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpsrad(ymm_dst, ymm_dst, Immediate(static_cast<int8_t>(value)));
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint16:
     case DataType::Type::kInt16:
@@ -1036,6 +1399,28 @@ void InstructionCodeGeneratorX86_64::VisitVecUShr(HVecUShr* instruction) {
   DCHECK(locations->InAt(0).Equals(locations->Out()));
   int32_t value = locations->InAt(1).GetConstant()->AsIntConstant()->GetValue();
   XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kUint16:
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        __ vpsrlw(ymm_dst, ymm_dst, Immediate(static_cast<int8_t>(value)));
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpsrld(ymm_dst, ymm_dst, Immediate(static_cast<int8_t>(value)));
+        break;
+      case DataType::Type::kInt64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        __ vpsrlq(ymm_dst, ymm_dst, Immediate(static_cast<int8_t>(value)));
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
   switch (instruction->GetPackedType()) {
     case DataType::Type::kUint16:
     case DataType::Type::kInt16:
@@ -1056,6 +1441,131 @@ void InstructionCodeGeneratorX86_64::VisitVecUShr(HVecUShr* instruction) {
   }
 }
 
+void LocationsBuilderX86_64::VisitVecCondition(HVecCondition* instruction) {
+  if (CpuHasAvxFeatureFlag()) {
+    CreateVecTerOpLocations(GetGraph()->GetAllocator(), instruction);
+  } else {
+    CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+  }
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecCondition(HVecCondition* instruction) {
+  bool cpu_has_avx = CpuHasAvxFeatureFlag();
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister src = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  XmmRegister other_src = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  DCHECK(cpu_has_avx || other_src == dst);
+  bool is_equal = instruction->GetCondition() == kCondEQ;
+  if (IsYmmOperation(instruction)) {
+    YmmRegister ymm_src(src);
+    YmmRegister ymm_other_src(other_src);
+    YmmRegister ymm_dst(dst);
+    switch (instruction->GetPackedType()) {
+      case DataType::Type::kInt8:
+        DCHECK_EQ(32u, instruction->GetVectorLength());
+        is_equal ? __ vpcmpeqb(ymm_dst, ymm_other_src, ymm_src)
+                 : __ vpcmpgtb(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kInt16:
+        DCHECK_EQ(16u, instruction->GetVectorLength());
+        is_equal ? __ vpcmpeqw(ymm_dst, ymm_other_src, ymm_src)
+                 : __ vpcmpgtw(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kInt32:
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        is_equal ? __ vpcmpeqd(ymm_dst, ymm_other_src, ymm_src)
+                 : __ vpcmpgtd(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      case DataType::Type::kInt64:
+        DCHECK_EQ(4u, instruction->GetVectorLength());
+        is_equal ? __ vpcmpeqq(ymm_dst, ymm_other_src, ymm_src)
+                 : __ vpcmpgtq(ymm_dst, ymm_other_src, ymm_src);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+        UNREACHABLE();
+    }
+    return;
+  }
+  switch (instruction->GetPackedType()) {
+    case DataType::Type::kInt8:
+      DCHECK_EQ(16u, instruction->GetVectorLength());
+      if (cpu_has_avx) {
+        is_equal ? __ vpcmpeqb(dst, other_src, src) : __ vpcmpgtb(dst, other_src, src);
+      } else {
+        is_equal ? __ pcmpeqb(dst, src) : __ pcmpgtb(dst, src);
+      }
+      break;
+    case DataType::Type::kInt16:
+      DCHECK_EQ(8u, instruction->GetVectorLength());
+      if (cpu_has_avx) {
+        is_equal ? __ vpcmpeqw(dst, other_src, src) : __ vpcmpgtw(dst, other_src, src);
+      } else {
+        is_equal ? __ pcmpeqw(dst, src) : __ pcmpgtw(dst, src);
+      }
+      break;
+    case DataType::Type::kInt32:
+      DCHECK_EQ(4u, instruction->GetVectorLength());
+      if (cpu_has_avx) {
+        is_equal ? __ vpcmpeqd(dst, other_src, src) : __ vpcmpgtd(dst, other_src, src);
+      } else {
+        is_equal ? __ pcmpeqd(dst, src) : __ pcmpgtd(dst, src);
+      }
+      break;
+    case DataType::Type::kInt64:
+      // Only vectorized with AVX, which implies SSE4.2 for the signed 64-bit comparison.
+      DCHECK(cpu_has_avx);
+      DCHECK_EQ(2u, instruction->GetVectorLength());
+      is_equal ? __ vpcmpeqq(dst, other_src, src) : __ vpcmpgtq(dst, other_src, src);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
+      UNREACHABLE();
+  }
+}
+
+void LocationsBuilderX86_64::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresFpuRegister());
+  locations->SetInAt(2, Location::RequiresFpuRegister());
+  if (CpuHasAvxFeatureFlag()) {
+    locations->SetOut(Location::RequiresFpuRegister());
+  } else {
+    locations->AddTemp(Location::RequiresFpuRegister());
+    locations->SetOut(Location::SameAsFirstInput());
+  }
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecSelect(HVecSelect* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister mask = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  XmmRegister true_value = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  XmmRegister false_value = locations->InAt(2).AsFpuRegister<XmmRegister>();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    // Mask components are all ones or all zeros, so blending bytes is exact for any lanes.
+    __ vpblendvb(YmmRegister(dst),
+                 YmmRegister(false_value),
+                 YmmRegister(true_value),
+                 YmmRegister(mask));
+    return;
+  }
+  if (CpuHasAvxFeatureFlag()) {
+    // Mask components are all ones or all zeros, so blending bytes is exact for any lanes.
+    __ vpblendvb(dst, false_value, true_value, mask);
+    return;
+  }
+  DCHECK(mask == dst);
+  XmmRegister tmp = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+  // dst = (mask & true_value) | (~mask & false_value), lanes do not matter.
+  __ movaps(tmp, dst);
+  __ pand(dst, true_value);
+  __ pandn(tmp, false_value);
+  __ por(dst, tmp);
+}
+
 void LocationsBuilderX86_64::VisitVecSetScalars(HVecSetScalars* instruction) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
 
@@ -1094,7 +1604,7 @@ void InstructionCodeGeneratorX86_64::VisitVecSetScalars(HVecSetScalars* instruct
 
   DCHECK_EQ(1u, instruction->InputCount());  // only one input currently implemented
 
-  // Zero out all other elements first.
+  // Zero out all other elements first. VEX.128 also clears the upper YMM bits.
   bool cpu_has_avx = CpuHasAvxFeatureFlag();
   cpu_has_avx ? __ vxorps(dst, dst, dst) : __ xorps(dst, dst);
 
@@ -1113,19 +1623,19 @@ void InstructionCodeGeneratorX86_64::VisitVecSetScalars(HVecSetScalars* instruct
       LOG(FATAL) << "Unsupported SIMD type: " << instruction->GetPackedType();
       UNREACHABLE();
     case DataType::Type::kInt32:
-      DCHECK_EQ(4u, instruction->GetVectorLength());
+      DCHECK_EQ(IsYmmOperation(instruction) ? 8u : 4u, instruction->GetVectorLength());
       __ movd(dst, locations->InAt(0).AsRegister<CpuRegister>());
       break;
     case DataType::Type::kInt64:
-      DCHECK_EQ(2u, instruction->GetVectorLength());
+      DCHECK_EQ(IsYmmOperation(instruction) ? 4u : 2u, instruction->GetVectorLength());
       __ movd(dst, locations->InAt(0).AsRegister<CpuRegister>());  // is 64-bit
       break;
     case DataType::Type::kFloat32:
-      DCHECK_EQ(4u, instruction->GetVectorLength());
+      DCHECK_EQ(IsYmmOperation(instruction) ? 8u : 4u, instruction->GetVectorLength());
       __ movss(dst, locations->InAt(0).AsFpuRegister<XmmRegister>());
       break;
     case DataType::Type::kFloat64:
-      DCHECK_EQ(2u, instruction->GetVectorLength());
+      DCHECK_EQ(IsYmmOperation(instruction) ? 4u : 2u, instruction->GetVectorLength());
       __ movsd(dst, locations->InAt(0).AsFpuRegister<XmmRegister>());
       break;
     default:
@@ -1190,8 +1700,14 @@ void InstructionCodeGeneratorX86_64::VisitVecDotProd(HVecDotProd* instruction) {
   XmmRegister right = locations->InAt(2).AsFpuRegister<XmmRegister>();
   switch (instruction->GetPackedType()) {
     case DataType::Type::kInt32: {
-      DCHECK_EQ(4u, instruction->GetVectorLength());
       XmmRegister tmp = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+      if (IsYmmOperation(instruction)) {
+        DCHECK_EQ(8u, instruction->GetVectorLength());
+        __ vpmaddwd(YmmRegister(tmp), YmmRegister(left), YmmRegister(right));
+        __ vpaddd(YmmRegister(acc), YmmRegister(acc), YmmRegister(tmp));
+        break;
+      }
+      DCHECK_EQ(4u, instruction->GetVectorLength());
       if (!cpu_has_avx) {
         __ movaps(tmp, right);
         __ pmaddwd(tmp, left);
@@ -1268,6 +1784,14 @@ void InstructionCodeGeneratorX86_64::VisitVecLoad(HVecLoad* instruction) {
   size_t size = DataType::Size(instruction->GetPackedType());
   Address address = VecAddress(locations, size, instruction->IsStringCharAt());
   XmmRegister reg = locations->Out().AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    // Compressed string loads are not vectorized with YMM registers.
+    DCHECK(!instruction->IsStringCharAt());
+    DataType::IsFloatingPointType(instruction->GetPackedType())
+        ? __ vmovups(YmmRegister(reg), address)
+        : __ vmovdqu(YmmRegister(reg), address);
+    return;
+  }
   bool is_aligned16 = instruction->GetAlignment().IsAlignedAt(16);
   switch (instruction->GetPackedType()) {
     case DataType::Type::kInt16:  // (short) s.charAt(.) can yield HVecLoad/Int16/StringCharAt.
@@ -1327,6 +1851,12 @@ void InstructionCodeGeneratorX86_64::VisitVecStore(HVecStore* instruction) {
   size_t size = DataType::Size(instruction->GetPackedType());
   Address address = VecAddress(locations, size, /*is_string_char_at*/ false);
   XmmRegister reg = locations->InAt(2).AsFpuRegister<XmmRegister>();
+  if (IsYmmOperation(instruction)) {
+    DataType::IsFloatingPointType(instruction->GetPackedType())
+        ? __ vmovups(address, YmmRegister(reg))
+        : __ vmovdqu(address, YmmRegister(reg));
+    return;
+  }
   bool is_aligned16 = instruction->GetAlignment().IsAlignedAt(16);
   switch (instruction->GetPackedType()) {
     case DataType::Type::kBool:
@@ -1456,8 +1456,15 @@ size_t CodeGeneratorX86_64::RestoreCoreRegister(size_t stack_index, uint32_t reg
   return kX86_64WordSize;
 }
 
+size_t CodeGeneratorX86_64::GetSIMDRegisterWidth() const {
+  // AVX2 provides the integer operations on the 256-bit YMM registers.
+  return GetInstructionSetFeatures().HasAVX2() ? 4 * kX86_64WordSize : 2 * kX86_64WordSize;
+}
+
 size_t CodeGeneratorX86_64::SaveFloatingPointRegister(size_t stack_index, uint32_t reg_id) {
-  if (GetGraph()->HasSIMD()) {
+  if (HasYmmVectors()) {
+    __ vmovups(Address(CpuRegister(RSP), stack_index), YmmRegister(reg_id));
+  } else if (GetGraph()->HasSIMD()) {
     __ movups(Address(CpuRegister(RSP), stack_index), XmmRegister(reg_id));
   } else {
     __ movsd(Address(CpuRegister(RSP), stack_index), XmmRegister(reg_id));
@@ -1466,7 +1473,9 @@ size_t CodeGeneratorX86_64::SaveFloatingPointRegister(size_t stack_index, uint32
 }
 
 size_t CodeGeneratorX86_64::RestoreFloatingPointRegister(size_t stack_index, uint32_t reg_id) {
-  if (GetGraph()->HasSIMD()) {
+  if (HasYmmVectors()) {
+    __ vmovups(YmmRegister(reg_id), Address(CpuRegister(RSP), stack_index));
+  } else if (GetGraph()->HasSIMD()) {
     __ movups(XmmRegister(reg_id), Address(CpuRegister(RSP), stack_index));
   } else {
     __ movsd(XmmRegister(reg_id), Address(CpuRegister(RSP), stack_index));
@@ -1493,6 +1502,11 @@ void CodeGeneratorX86_64::InvokeRuntimeWithoutRecordingPcInfo(int32_t entry_poin
 }
 
 void CodeGeneratorX86_64::GenerateInvokeRuntime(int32_t entry_point_offset) {
+  if (HasYmmVectors()) {
+    // The runtime uses legacy SSE code, which is slow while the upper YMM halves are dirty.
+    // Live vector values have been saved by the slow path, if any.
+    __ vzeroupper();
+  }
   __ gs()->call(Address::Absolute(entry_point_offset, /* no_rip= */ true));
 }
 
@@ -1747,6 +1761,64 @@ void CodeGeneratorX86_64::MaybeIncrementHotness(bool is_frame_entry) {
   }
 }
 
+void CodeGeneratorX86_64::MaybeGenerateArgumentProfiling() {
+  if (!GetGraph()->IsCompilingBaseline() || Runtime::Current()->IsAotCompiler()) {
+    return;
+  }
+  ProfilingInfo* info = GetGraph()->GetProfilingInfo();
+  DCHECK(info != nullptr);
+  CHECK(!HasEmptyFrame());
+  // Record the classes of the reference arguments still in their argument registers.
+  // The inline cache stub takes the class in RDI, which holds the current method, and the
+  // cache in TMP, and clobbers RAX, which is not an argument register.
+  uint32_t class_offset = mirror::Object::ClassOffset().Uint32Value();
+  CpuRegister klass(kMethodRegisterArgument);
+  size_t ordinal = 0u;
+  bool saved_method = false;
+  for (HInstructionIterator it(GetGraph()->GetEntryBlock()->GetInstructions());
+       !it.Done() && ordinal != ProfilingInfo::kMaxProfiledArguments;
+       it.Advance()) {
+    HParameterValue* parameter = it.Current()->AsParameterValueOrNull();
+    if (parameter == nullptr ||
+        parameter->IsThis() ||
+        parameter->GetType() != DataType::Type::kReference) {
+      continue;
+    }
+    InlineCache* cache = info->GetArgumentCache(ordinal);
+    Location location = parameter->GetLocations()->Out();
+    if (cache != nullptr && location.IsRegister()) {
+      CpuRegister argument = location.AsRegister<CpuRegister>();
+      if (!saved_method) {
+        __ pushq(klass);
+        __ cfi().AdjustCFAOffset(kX86_64WordSize);
+        saved_method = true;
+      }
+      NearLabel is_null, done;
+      __ testl(argument, argument);
+      __ j(kEqual, &is_null);
+      __ movl(klass, Address(argument, class_offset));
+      __ MaybeUnpoisonHeapReference(klass);
+      __ movq(CpuRegister(TMP), Immediate(reinterpret_cast64<uint64_t>(cache)));
+      // Fast path for a monomorphic cache.
+      __ cmpl(Address(CpuRegister(TMP), InlineCache::ClassesOffset().Int32Value()), klass);
+      __ j(kEqual, &done);
+      GenerateInvokeRuntime(
+          GetThreadOffset<kX86_64PointerSize>(kQuickUpdateInlineCache).Int32Value());
+      __ jmp(&done);
+      __ Bind(&is_null);
+      __ movq(CpuRegister(TMP), Immediate(reinterpret_cast64<uint64_t>(info)));
+      __ movb(Address(CpuRegister(TMP), ProfilingInfo::NullArgumentOffset(ordinal).Int32Value()),
+              Immediate(1));
+      __ Bind(&done);
+    }
+    ++ordinal;
+  }
+  if (saved_method) {
+    __ popq(klass);
+    __ cfi().AdjustCFAOffset(-static_cast<int>(kX86_64WordSize));
+  }
+}
+
 void CodeGeneratorX86_64::GenerateFrameEntry() {
   __ cfi().SetCurrentCFAOffset(kX86_64WordSize);  // return address
 
@@ -1839,10 +1911,15 @@ void CodeGeneratorX86_64::GenerateFrameEntry() {
   }
 
   MaybeIncrementHotness(/* is_frame_entry= */ true);
+  MaybeGenerateArgumentProfiling();
 }
 
 void CodeGeneratorX86_64::GenerateFrameExit() {
   __ cfi().RememberState();
+  if (HasYmmVectors()) {
+    // Do not return to the caller with dirty upper YMM halves.
+    __ vzeroupper();
+  }
   if (!HasEmptyFrame()) {
     uint32_t xmm_spill_location = GetFpuSpillStart();
     size_t xmm_spill_slot_size = GetCalleePreservedFPWidth();
@@ -6247,15 +6324,22 @@ void ParallelMoveResolverX86_64::EmitMove(size_t index) {
     }
   } else if (source.IsSIMDStackSlot()) {
     if (destination.IsFpuRegister()) {
-      __ movups(destination.AsFpuRegister<XmmRegister>(),
-                Address(CpuRegister(RSP), source.GetStackIndex()));
+      if (codegen_->HasYmmVectors()) {
+        __ vmovups(YmmRegister(destination.AsFpuRegister<XmmRegister>()),
+                   Address(CpuRegister(RSP), source.GetStackIndex()));
+      } else {
+        __ movups(destination.AsFpuRegister<XmmRegister>(),
+                  Address(CpuRegister(RSP), source.GetStackIndex()));
+      }
     } else {
       DCHECK(destination.IsSIMDStackSlot());
-      size_t high = kX86_64WordSize;
-      __ movq(CpuRegister(TMP), Address(CpuRegister(RSP), source.GetStackIndex()));
-      __ movq(Address(CpuRegister(RSP), destination.GetStackIndex()), CpuRegister(TMP));
-      __ movq(CpuRegister(TMP), Address(CpuRegister(RSP), source.GetStackIndex() + high));
-      __ movq(Address(CpuRegister(RSP), destination.GetStackIndex() + high), CpuRegister(TMP));
+      for (size_t offset = 0;
+           offset != codegen_->GetSIMDRegisterWidth();
+           offset += kX86_64WordSize) {
+        __ movq(CpuRegister(TMP), Address(CpuRegister(RSP), source.GetStackIndex() + offset));
+        __ movq(Address(CpuRegister(RSP), destination.GetStackIndex() + offset),
+                CpuRegister(TMP));
+      }
     }
   } else if (source.IsConstant()) {
     HConstant* constant = source.GetConstant();
@@ -6303,7 +6387,12 @@ void ParallelMoveResolverX86_64::EmitMove(size_t index) {
     }
   } else if (source.IsFpuRegister()) {
     if (destination.IsFpuRegister()) {
-      __ movaps(destination.AsFpuRegister<XmmRegister>(), source.AsFpuRegister<XmmRegister>());
+      if (codegen_->HasYmmVectors()) {
+        __ vmovaps(YmmRegister(destination.AsFpuRegister<XmmRegister>()),
+                   YmmRegister(source.AsFpuRegister<XmmRegister>()));
+      } else {
+        __ movaps(destination.AsFpuRegister<XmmRegister>(), source.AsFpuRegister<XmmRegister>());
+      }
     } else if (destination.IsStackSlot()) {
       __ movss(Address(CpuRegister(RSP), destination.GetStackIndex()),
                source.AsFpuRegister<XmmRegister>());
@@ -6312,8 +6401,13 @@ void ParallelMoveResolverX86_64::EmitMove(size_t index) {
                source.AsFpuRegister<XmmRegister>());
     } else {
        DCHECK(destination.IsSIMDStackSlot());
-      __ movups(Address(CpuRegister(RSP), destination.GetStackIndex()),
-                source.AsFpuRegister<XmmRegister>());
+      if (codegen_->HasYmmVectors()) {
+        __ vmovups(Address(CpuRegister(RSP), destination.GetStackIndex()),
+                   YmmRegister(source.AsFpuRegister<XmmRegister>()));
+      } else {
+        __ movups(Address(CpuRegister(RSP), destination.GetStackIndex()),
+                  source.AsFpuRegister<XmmRegister>());
+      }
     }
   }
 }
@@ -6348,12 +6442,20 @@ void ParallelMoveResolverX86_64::Exchange64(XmmRegister reg, int mem) {
   __ movd(reg, CpuRegister(TMP));
 }
 
-void ParallelMoveResolverX86_64::Exchange128(XmmRegister reg, int mem) {
-  size_t extra_slot = 2 * kX86_64WordSize;
+void ParallelMoveResolverX86_64::ExchangeSIMD(XmmRegister reg, int mem) {
+  size_t extra_slot = codegen_->GetSIMDRegisterWidth();
   __ subq(CpuRegister(RSP), Immediate(extra_slot));
-  __ movups(Address(CpuRegister(RSP), 0), XmmRegister(reg));
-  ExchangeMemory64(0, mem + extra_slot, 2);
-  __ movups(XmmRegister(reg), Address(CpuRegister(RSP), 0));
+  if (codegen_->HasYmmVectors()) {
+    __ vmovups(Address(CpuRegister(RSP), 0), YmmRegister(reg));
+  } else {
+    __ movups(Address(CpuRegister(RSP), 0), XmmRegister(reg));
+  }
+  ExchangeMemory64(0, mem + extra_slot, static_cast<int>(extra_slot / kX86_64WordSize));
+  if (codegen_->HasYmmVectors()) {
+    __ vmovups(YmmRegister(reg), Address(CpuRegister(RSP), 0));
+  } else {
+    __ movups(XmmRegister(reg), Address(CpuRegister(RSP), 0));
+  }
   __ addq(CpuRegister(RSP), Immediate(extra_slot));
 }
 
@@ -6410,9 +6512,18 @@ void ParallelMoveResolverX86_64::EmitSwap(size_t index) {
   } else if (source.IsDoubleStackSlot() && destination.IsDoubleStackSlot()) {
     ExchangeMemory64(destination.GetStackIndex(), source.GetStackIndex(), 1);
   } else if (source.IsFpuRegister() && destination.IsFpuRegister()) {
-    __ movd(CpuRegister(TMP), source.AsFpuRegister<XmmRegister>());
-    __ movaps(source.AsFpuRegister<XmmRegister>(), destination.AsFpuRegister<XmmRegister>());
-    __ movd(destination.AsFpuRegister<XmmRegister>(), CpuRegister(TMP));
+    if (codegen_->HasYmmVectors()) {
+      // Swap all 256 bits without a temporary.
+      YmmRegister lhs(source.AsFpuRegister<XmmRegister>());
+      YmmRegister rhs(destination.AsFpuRegister<XmmRegister>());
+      __ vpxor(lhs, lhs, rhs);
+      __ vpxor(rhs, rhs, lhs);
+      __ vpxor(lhs, lhs, rhs);
+    } else {
+      __ movd(CpuRegister(TMP), source.AsFpuRegister<XmmRegister>());
+      __ movaps(source.AsFpuRegister<XmmRegister>(), destination.AsFpuRegister<XmmRegister>());
+      __ movd(destination.AsFpuRegister<XmmRegister>(), CpuRegister(TMP));
+    }
   } else if (source.IsFpuRegister() && destination.IsStackSlot()) {
     Exchange32(source.AsFpuRegister<XmmRegister>(), destination.GetStackIndex());
   } else if (source.IsStackSlot() && destination.IsFpuRegister()) {
@@ -6422,11 +6533,13 @@ void ParallelMoveResolverX86_64::EmitSwap(size_t index) {
   } else if (source.IsDoubleStackSlot() && destination.IsFpuRegister()) {
     Exchange64(destination.AsFpuRegister<XmmRegister>(), source.GetStackIndex());
   } else if (source.IsSIMDStackSlot() && destination.IsSIMDStackSlot()) {
-    ExchangeMemory64(destination.GetStackIndex(), source.GetStackIndex(), 2);
+    ExchangeMemory64(destination.GetStackIndex(),
+                     source.GetStackIndex(),
+                     static_cast<int>(codegen_->GetSIMDRegisterWidth() / kX86_64WordSize));
   } else if (source.IsFpuRegister() && destination.IsSIMDStackSlot()) {
-    Exchange128(source.AsFpuRegister<XmmRegister>(), destination.GetStackIndex());
+    ExchangeSIMD(source.AsFpuRegister<XmmRegister>(), destination.GetStackIndex());
   } else if (destination.IsFpuRegister() && source.IsSIMDStackSlot()) {
-    Exchange128(destination.AsFpuRegister<XmmRegister>(), source.GetStackIndex());
+    ExchangeSIMD(destination.AsFpuRegister<XmmRegister>(), source.GetStackIndex());
   } else {
     LOG(FATAL) << "Unimplemented swap between " << source << " and " << destination;
   }
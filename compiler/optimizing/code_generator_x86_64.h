@@ -215,7 +215,7 @@ class ParallelMoveResolverX86_64 : public ParallelMoveResolverWithSwap {
   void Exchange64(CpuRegister reg1, CpuRegister reg2);
   void Exchange64(CpuRegister reg, int mem);
   void Exchange64(XmmRegister reg, int mem);
-  void Exchange128(XmmRegister reg, int mem);
+  void ExchangeSIMD(XmmRegister reg, int mem);
   void ExchangeMemory32(int mem1, int mem2);
   void ExchangeMemory64(int mem1, int mem2, int num_of_qwords);
 
@@ -437,8 +437,11 @@ class CodeGeneratorX86_64 : public CodeGenerator {
     return 1 * kX86_64WordSize;
   }
 
-  size_t GetSIMDRegisterWidth() const override {
-    return 2 * kX86_64WordSize;
+  size_t GetSIMDRegisterWidth() const override;
+
+  // Whether the vector values of the graph use all 256 bits of the YMM registers.
+  bool HasYmmVectors() const {
+    return GetGraph()->HasSIMD() && GetSIMDRegisterWidth() == 4 * kX86_64WordSize;
   }
 
   HGraphVisitor* GetLocationBuilder() override {
@@ -706,6 +709,7 @@ class CodeGeneratorX86_64 : public CodeGenerator {
   void MaybeGenerateInlineCacheCheck(HInstruction* instruction, CpuRegister cls);
 
   void MaybeIncrementHotness(bool is_frame_entry);
+  void MaybeGenerateArgumentProfiling();
 
   static void BlockNonVolatileXmmRegisters(LocationSummary* locations);
 
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "code_info_cache.h"
+
+#include <vector>
+
+#include "art_method.h"
+#include "base/arena_bit_vector.h"
+#include "base/casts.h"
+#include "base/macros.h"
+#include "base/malloc_arena_pool.h"
+#include "oat_quick_method_header.h"
+#include "stack_map_stream.h"
+
+#include "gtest/gtest.h"
+
+namespace art HIDDEN {
+
+using Kind = DexRegisterLocation::Kind;
+using DecodeKind = CodeInfoCache::DecodeKind;
+
+constexpr static uint32_t kPcAlign = GetInstructionSetInstructionAlignment(kRuntimeISA);
+
+// Memory laid out like compiled code: the CodeInfo immediately precedes the method header.
+// The header stays at the same address when the method is replaced, like JIT code reusing
+// freed memory.
+class FakeCompiledMethod {
+ public:
+  static constexpr size_t kHeaderOffset = 1024;
+
+  FakeCompiledMethod() : memory_(kHeaderOffset + sizeof(OatQuickMethodHeader) + kPcAlign) {}
+
+  void SetCodeInfo(const ScopedArenaVector<uint8_t>& code_info) {
+    CHECK_LE(code_info.size(), kHeaderOffset);
+    std::copy(code_info.begin(), code_info.end(), &memory_[kHeaderOffset - code_info.size()]);
+    new (&memory_[kHeaderOffset]) OatQuickMethodHeader(
+        dchecked_integral_cast<uint32_t>(code_info.size() + sizeof(OatQuickMethodHeader)));
+    DCHECK_EQ(GetHeader()->GetOptimizedCodeInfoPtr(),
+              &memory_[kHeaderOffset - code_info.size()]);
+  }
+
+  const OatQuickMethodHeader* GetHeader() const {
+    return reinterpret_cast<const OatQuickMethodHeader*>(&memory_[kHeaderOffset]);
+  }
+
+ private:
+  std::vector<uint8_t> memory_;
+};
+
+class CodeInfoCacheTest : public testing::Test {
+ protected:
+  CodeInfoCacheTest() : arena_stack_(&pool_), allocator_(&arena_stack_) {}
+
+  // Encode a method with `num_stack_maps` stack maps at native pcs 64, 128, ... (times
+  // the instruction alignment). The first stack map has an inline info.
+  ScopedArenaVector<uint8_t> EncodeMethod(size_t num_stack_maps) {
+    StackMapStream stream(&allocator_, kRuntimeISA);
+    stream.BeginMethod(/* frame_size_in_bytes= */ 32,
+                       /* core_spill_mask= */ 0,
+                       /* fp_spill_mask= */ 0,
+                       /* num_dex_registers= */ 2,
+                       /* baseline= */ false,
+                       /* debuggable= */ false);
+    for (size_t i = 0; i != num_stack_maps; ++i) {
+      ArenaBitVector sp_mask(&allocator_, 0, true);
+      sp_mask.SetBit(i);
+      stream.BeginStackMapEntry(i, (i + 1u) * 64u * kPcAlign, 0x3, &sp_mask);
+      stream.AddDexRegisterEntry(Kind::kInStack, 0);
+      stream.AddDexRegisterEntry(Kind::kConstant, -2);
+      if (i == 0u) {
+        stream.BeginInlineInfoEntry(&art_method_, 3, /* num_dex_registers= */ 0);
+        stream.EndInlineInfoEntry();
+      }
+      stream.EndStackMapEntry();
+    }
+    stream.EndMethod(num_stack_maps * 64u * kPcAlign);
+    return stream.Encode();
+  }
+
+  MallocArenaPool pool_;
+  ArenaStack arena_stack_;
+  ScopedArenaAllocator allocator_;
+  ArtMethod art_method_;
+  CodeInfoCache cache_;
+};
+
+TEST_F(CodeInfoCacheTest, PartialDecodes) {
+  FakeCompiledMethod method;
+  method.SetCodeInfo(EncodeMethod(/* num_stack_maps= */ 2));
+  const OatQuickMethodHeader* header = method.GetHeader();
+
+  // A miss only decodes the requested tables.
+  CodeInfo code_info;
+  cache_.GetCodeInfo(header, DecodeKind::kInlineInfoOnly, &code_info);
+  EXPECT_EQ(2u, code_info.GetNumberOfStackMaps());
+  EXPECT_TRUE(code_info.HasInlineInfo());
+  EXPECT_EQ(0u, code_info.GetNumberOfLocationCatalogEntries());
+
+  CodeInfoCache other_cache;
+  other_cache.GetCodeInfo(header, DecodeKind::kGcMasksOnly, &code_info);
+  EXPECT_EQ(2u, code_info.GetNumberOfStackMaps());
+  EXPECT_FALSE(code_info.HasInlineInfo());
+  EXPECT_EQ(0u, code_info.GetNumberOfLocationCatalogEntries());
+  EXPECT_EQ(0x3u, code_info.GetRegisterMaskOf(code_info.GetStackMapAt(1)));
+  EXPECT_TRUE(code_info.GetStackMaskOf(code_info.GetStackMapAt(1)).LoadBit(1));
+
+  // Asking for the other partial decoding of a cached method decodes it fully.
+  cache_.GetCodeInfo(header, DecodeKind::kGcMasksOnly, &code_info);
+  EXPECT_TRUE(code_info.HasInlineInfo());
+  EXPECT_EQ(0x3u, code_info.GetRegisterMaskOf(code_info.GetStackMapAt(1)));
+  EXPECT_EQ(2u, code_info.GetNumberOfLocationCatalogEntries());
+
+  // And the full decoding serves all requests.
+  for (DecodeKind kind :
+       {DecodeKind::kInlineInfoOnly, DecodeKind::kGcMasksOnly, DecodeKind::kFull}) {
+    CodeInfo cached;
+    cache_.GetCodeInfo(header, kind, &cached);
+    EXPECT_EQ(2u, cached.GetNumberOfLocationCatalogEntries());
+    DexRegisterMap dex_register_map = cached.GetDexRegisterMapOf(cached.GetStackMapAt(0));
+    ASSERT_EQ(2u, dex_register_map.size());
+    EXPECT_EQ(-2, dex_register_map[1].GetConstant());
+  }
+}
+
+TEST_F(CodeInfoCacheTest, Eviction) {
+  // More methods than cache entries, each identified by its number of stack maps.
+  std::vector<FakeCompiledMethod> methods(CodeInfoCache::kCodeInfoSize + 1u);
+  for (size_t i = 0; i != methods.size(); ++i) {
+    methods[i].SetCodeInfo(EncodeMethod(/* num_stack_maps= */ i + 1u));
+  }
+  for (size_t round = 0; round != 3u; ++round) {
+    for (size_t i = 0; i != methods.size(); ++i) {
+      CodeInfo code_info;
+      cache_.GetCodeInfo(methods[i].GetHeader(), DecodeKind::kInlineInfoOnly, &code_info);
+      EXPECT_EQ(i + 1u, code_info.GetNumberOfStackMaps());
+    }
+  }
+}
+
+TEST_F(CodeInfoCacheTest, StackMapLookup) {
+  FakeCompiledMethod method;
+  method.SetCodeInfo(EncodeMethod(/* num_stack_maps= */ 3));
+  const OatQuickMethodHeader* header = method.GetHeader();
+  CodeInfo code_info;
+  cache_.GetCodeInfo(header, DecodeKind::kInlineInfoOnly, &code_info);
+
+  // Look up each pc twice, to miss and then hit.
+  for (size_t round = 0; round != 2u; ++round) {
+    for (uint32_t i = 0; i != 3u; ++i) {
+      uint32_t native_pc_offset = (i + 1u) * 64u * kPcAlign;
+      StackMap stack_map = cache_.GetStackMapForNativePcOffset(header, code_info, native_pc_offset);
+      ASSERT_TRUE(stack_map.IsValid());
+      EXPECT_EQ(i, stack_map.Row());
+      EXPECT_EQ(i, stack_map.GetDexPc());
+    }
+    // Pcs without a stack map are not cached.
+    EXPECT_FALSE(cache_.GetStackMapForNativePcOffset(header, code_info, 32u * kPcAlign).IsValid());
+  }
+}
+
+TEST_F(CodeInfoCacheTest, InvalidateAll) {
+  FakeCompiledMethod method;
+  method.SetCodeInfo(EncodeMethod(/* num_stack_maps= */ 1));
+  const OatQuickMethodHeader* header = method.GetHeader();
+  CodeInfo code_info;
+  cache_.GetCodeInfo(header, DecodeKind::kFull, &code_info);
+  ASSERT_EQ(1u, code_info.GetNumberOfStackMaps());
+  uint32_t native_pc_offset = 64u * kPcAlign;
+  ASSERT_EQ(0u, cache_.GetStackMapForNativePcOffset(header, code_info, native_pc_offset).Row());
+
+  // Free the code and reuse its memory for a method with a different layout.
+  CodeInfoCache::InvalidateAll();
+  method.SetCodeInfo(EncodeMethod(/* num_stack_maps= */ 2));
+  ASSERT_EQ(header, method.GetHeader());
+
+  cache_.GetCodeInfo(header, DecodeKind::kFull, &code_info);
+  EXPECT_EQ(2u, code_info.GetNumberOfStackMaps());
+  StackMap stack_map = cache_.GetStackMapForNativePcOffset(header, code_info, native_pc_offset);
+  ASSERT_TRUE(stack_map.IsValid());
+  EXPECT_EQ(0u, stack_map.Row());
+  stack_map = cache_.GetStackMapForNativePcOffset(header, code_info, 2u * native_pc_offset);
+  ASSERT_TRUE(stack_map.IsValid());
+  EXPECT_EQ(1u, stack_map.Row());
+}
+
+}  // namespace art
@@ -16,6 +16,7 @@
 
 #include "inliner.h"
 
+#include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "base/enums.h"
 #include "base/logging.h"
@@ -34,6 +35,7 @@
 #include "jit/jit_code_cache.h"
 #include "mirror/class_loader.h"
 #include "mirror/dex_cache.h"
+#include "mirror/method_handle_impl-inl.h"
 #include "mirror/object_array-alloc-inl.h"
 #include "mirror/object_array-inl.h"
 #include "nodes.h"
@@ -303,9 +305,8 @@ static uint32_t FindMethodIndexIn(ArtMethod* method,
   }
 }
 
-static dex::TypeIndex FindClassIndexIn(ObjPtr<mirror::Class> cls,
-                                       const DexCompilationUnit& compilation_unit)
-    REQUIRES_SHARED(Locks::mutator_lock_) {
+dex::TypeIndex FindClassIndexIn(ObjPtr<mirror::Class> cls,
+                                const DexCompilationUnit& compilation_unit) {
   const DexFile& dex_file = *compilation_unit.GetDexFile();
   dex::TypeIndex index;
   if (cls->GetDexCache() == nullptr) {
@@ -454,6 +455,9 @@ bool HInliner::TryInline(HInvoke* invoke_instruction) {
     MaybeRecordStat(stats_, MethodCompilationStat::kNotInlinedUnresolved);
     return false;
   } else if (invoke_instruction->IsInvokePolymorphic()) {
+    if (TryInlineMethodHandleTarget(invoke_instruction->AsInvokePolymorphic())) {
+      return true;
+    }
     MaybeRecordStat(stats_, MethodCompilationStat::kNotInlinedPolymorphic);
     return false;
   } else if (invoke_instruction->IsInvokeCustom()) {
@@ -1266,6 +1270,165 @@ void HInliner::MaybeRunReferenceTypePropagation(HInstruction* replacement,
   }
 }
 
+ArtMethod* HInliner::FindMethodHandleTarget(HInstruction* method_handle) {
+  if (method_handle->IsNullCheck()) {
+    method_handle = method_handle->InputAt(0);
+  }
+  ClassLinker* class_linker = caller_compilation_unit_.GetClassLinker();
+  if (method_handle->IsLoadMethodHandle()) {
+    // A const-method-handle. Only consider methods that are already resolved.
+    HLoadMethodHandle* load = method_handle->AsLoadMethodHandle();
+    if (!IsSameDexFile(load->GetDexFile(), *caller_compilation_unit_.GetDexFile())) {
+      return nullptr;
+    }
+    const dex::MethodHandleItem& item = load->GetDexFile().GetMethodHandle(
+        load->GetMethodHandleIndex());
+    if (static_cast<DexFile::MethodHandleType>(item.method_handle_type_) !=
+            DexFile::MethodHandleType::kInvokeStatic) {
+      return nullptr;
+    }
+    ArtMethod* method =
+        class_linker->LookupResolvedMethod(item.field_or_method_idx_,
+                                           caller_compilation_unit_.GetDexCache().Get(),
+                                           caller_compilation_unit_.GetClassLoader().Get());
+    return (method != nullptr && method->IsStatic()) ? method : nullptr;
+  } else if (method_handle->IsStaticFieldGet()) {
+    // Typically a `static final MethodHandle` field. The guard below makes this safe
+    // even if the field is later changed, but only final fields are worth speculating on.
+    ArtField* field = method_handle->AsStaticFieldGet()->GetFieldInfo().GetField();
+    if (field == nullptr || !field->IsFinal()) {
+      return nullptr;
+    }
+    ObjPtr<mirror::Class> klass = field->GetDeclaringClass();
+    if (!klass->IsVisiblyInitialized()) {
+      // The field may not be set yet.
+      return nullptr;
+    }
+    ObjPtr<mirror::Object> value = field->GetObject(klass);
+    if (value == nullptr ||
+        !value->InstanceOf(GetClassRoot<mirror::MethodHandle>(class_linker))) {
+      return nullptr;
+    }
+    ObjPtr<mirror::MethodHandle> handle = ObjPtr<mirror::MethodHandle>::DownCast(value);
+    return (handle->GetHandleKind() == mirror::MethodHandle::kInvokeStatic)
+        ? handle->GetTargetMethod()
+        : nullptr;
+  }
+  return nullptr;
+}
+
+bool HInliner::TryInlineMethodHandleTarget(HInvokePolymorphic* invoke_instruction) {
+  // Like TryInlinePolymorphicCallToSameTarget, the guard compares against an ArtMethod
+  // pointer, so this only works under JIT.
+  if (!codegen_->GetCompilerOptions().IsJitCompiler()) {
+    return false;
+  }
+  if (invoke_instruction->GetIntrinsic() != Intrinsics::kMethodHandleInvokeExact &&
+      invoke_instruction->GetIntrinsic() != Intrinsics::kMethodHandleInvoke) {
+    return false;
+  }
+
+  ScopedObjectAccess soa(Thread::Current());
+  ArtMethod* method = FindMethodHandleTarget(invoke_instruction->InputAt(0));
+  if (method == nullptr) {
+    return false;
+  }
+  DCHECK(method->IsStatic());
+  const DexFile& caller_dex_file = *invoke_instruction->GetMethodReference().dex_file;
+  // Requiring the caller's dex file gives the method the caller's lifetime, and lets us
+  // compare prototypes by index. With identical types, `invoke` behaves like `invokeExact`.
+  if (!IsSameDexFile(*method->GetDexFile(), caller_dex_file) ||
+      method->GetDexFile()->GetMethodId(method->GetDexMethodIndex()).proto_idx_ !=
+          invoke_instruction->GetProtoIndex()) {
+    return false;
+  }
+  if (!method->GetDeclaringClass()->IsVisiblyInitialized()) {
+    // Invoking the handle initializes the class, the direct call would not.
+    return false;
+  }
+  HInvokeStaticOrDirect::DispatchInfo dispatch_info =
+      HSharpening::SharpenLoadMethod(method,
+                                     /* has_method_id= */ true,
+                                     /* for_interface_call= */ false,
+                                     codegen_);
+  if (dispatch_info.method_load_kind == MethodLoadKind::kRuntimeCall ||
+      dispatch_info.code_ptr_location == CodePtrLocation::kCallCriticalNative) {
+    return false;
+  }
+
+  uint32_t dex_pc = invoke_instruction->GetDexPc();
+  ArenaAllocator* allocator = graph_->GetAllocator();
+  MethodReference method_reference(method->GetDexFile(), method->GetDexMethodIndex());
+  HInvokeStaticOrDirect* direct_invoke = new (allocator) HInvokeStaticOrDirect(
+      allocator,
+      invoke_instruction->GetNumberOfArguments() - 1u,
+      invoke_instruction->GetType(),
+      dex_pc,
+      method_reference,
+      method,
+      dispatch_info,
+      kStatic,
+      method_reference,
+      HInvokeStaticOrDirect::ClinitCheckRequirement::kNone,
+      !graph_->IsDebuggable());
+  // The first input of the polymorphic invoke is the method handle.
+  for (size_t index = 1; index != invoke_instruction->GetNumberOfArguments(); ++index) {
+    direct_invoke->SetArgumentAt(index - 1u, invoke_instruction->InputAt(index));
+  }
+  if (HInvokeStaticOrDirect::NeedsCurrentMethodInput(dispatch_info)) {
+    direct_invoke->SetRawInputAt(direct_invoke->GetCurrentMethodIndexUnchecked(),
+                                 graph_->GetCurrentMethod());
+  }
+
+  // Guard on the target of the handle.
+  ArtField* target_field = GetClassRoot<mirror::MethodHandle>(
+      caller_compilation_unit_.GetClassLinker())->FindDeclaredInstanceField("artFieldOrMethod",
+                                                                             "J");
+  DCHECK(target_field != nullptr);
+  HInstanceFieldGet* handle_target = new (allocator) HInstanceFieldGet(
+      invoke_instruction->InputAt(0),
+      target_field,
+      DataType::Type::kInt64,
+      target_field->GetOffset(),
+      target_field->IsVolatile(),
+      target_field->GetDexFieldIndex(),
+      target_field->GetDeclaringClass()->GetDexClassDefIndex(),
+      *target_field->GetDexFile(),
+      dex_pc);
+  HConstant* constant = graph_->GetLongConstant(
+      static_cast<int64_t>(reinterpret_cast<uintptr_t>(method)), dex_pc);
+  HNotEqual* compare = new (allocator) HNotEqual(handle_target, constant);
+  HBasicBlock* block = invoke_instruction->GetBlock();
+  block->InsertInstructionBefore(handle_target, invoke_instruction);
+  block->InsertInstructionBefore(compare, invoke_instruction);
+  block->InsertInstructionBefore(direct_invoke, invoke_instruction);
+  direct_invoke->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  if (invoke_instruction->GetType() == DataType::Type::kReference) {
+    direct_invoke->SetReferenceTypeInfoIfValid(invoke_instruction->GetReferenceTypeInfo());
+  }
+  CreateDiamondPatternForPolymorphicInline(
+      compare,
+      (invoke_instruction->GetType() == DataType::Type::kVoid) ? nullptr : direct_invoke,
+      invoke_instruction);
+  MaybeRecordStat(stats_, MethodCompilationStat::kDevirtualizedMethodHandle);
+
+  if (TryInlineAndReplace(direct_invoke,
+                          method,
+                          ReferenceTypeInfo::CreateInvalid(),
+                          /* do_rtp= */ false,
+                          /* is_speculative= */ false)) {
+    MaybeRecordStat(stats_, MethodCompilationStat::kInlinedMethodHandle);
+    LOG_SUCCESS() << "Inlined method handle target " << method->PrettyMethod();
+  }
+
+  // Run type propagation to get the merge of the two calls typed.
+  ReferenceTypePropagation rtp_fixup(graph_,
+                                     outer_compilation_unit_.GetDexCache(),
+                                     /* is_first_run= */ false);
+  rtp_fixup.Run();
+  return true;
+}
+
 bool HInliner::TryDevirtualize(HInvoke* invoke_instruction,
                                ArtMethod* method,
                                HInvoke** replacement) {
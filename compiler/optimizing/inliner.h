@@ -21,6 +21,7 @@
 #include "dex/dex_file_types.h"
 #include "dex/invoke_type.h"
 #include "jit/profiling_info.h"
+#include "obj_ptr.h"
 #include "optimization.h"
 #include "profile/profile_compilation_info.h"
 
@@ -219,6 +220,21 @@ class HInliner : public HOptimization {
       const StackHandleScope<InlineCache::kIndividualCacheSize>& classes)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Try to call the target of a MethodHandle.invoke or invokeExact directly, when the
+  // handle is known at compile time to invoke a static method. If successful, the code
+  // in the graph will look like:
+  // if (handle.artFieldOrMethod != target) {
+  //   handle.invokeExact(...)
+  // } else {
+  //   ... // inlined code, or direct call to target
+  // }
+  bool TryInlineMethodHandleTarget(HInvokePolymorphic* invoke_instruction);
+
+  // Returns the static method that `method_handle` invokes, if it can be found at
+  // compile time, or null.
+  ArtMethod* FindMethodHandleTarget(HInstruction* method_handle)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Returns whether or not we should use only polymorphic inlining with no deoptimizations.
   bool UseOnlyPolymorphicInliningWithNoDeopt();
 
@@ -338,6 +354,12 @@ class HInliner : public HOptimization {
   DISALLOW_COPY_AND_ASSIGN(HInliner);
 };
 
+// Find the index of `cls` in the dex file of `compilation_unit`. Returns an invalid index
+// if the class cannot be referenced from there, or would not resolve to the same class.
+dex::TypeIndex FindClassIndexIn(ObjPtr<mirror::Class> cls,
+                                const DexCompilationUnit& compilation_unit)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
 }  // namespace art
 
 #endif  // ART_COMPILER_OPTIMIZING_INLINER_H_
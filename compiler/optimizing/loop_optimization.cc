@@ -215,6 +215,17 @@ static bool IsZeroExtensionAndGet(HInstruction* instruction,
   return false;
 }
 
+// Detect an operand of a comparison that is represented exactly in the
+// components of the given narrow vector type.
+static bool IsExactNarrowOperand(HInstruction* a, DataType::Type type) {
+  int64_t value = 0;
+  if (IsInt64AndGet(a, /*out*/ &value)) {
+    return DataType::MinValueOfIntegralType(type) <= value &&
+           value <= DataType::MaxValueOfIntegralType(type);
+  }
+  return a->GetType() == type;
+}
+
 // Detect situations with same-extension narrower operands.
 // Returns true on success and sets is_unsigned accordingly.
 static bool IsNarrowerOperands(HInstruction* a,
@@ -478,8 +489,7 @@ HLoopOptimization::HLoopOptimization(HGraph* graph,
       vector_refs_(nullptr),
       vector_static_peeling_factor_(0),
       vector_dynamic_peeling_candidate_(nullptr),
-      vector_runtime_test_a_(nullptr),
-      vector_runtime_test_b_(nullptr),
+      vector_runtime_tests_(nullptr),
       vector_map_(nullptr),
       vector_permanent_map_(nullptr),
       vector_external_set_(nullptr),
@@ -544,6 +554,8 @@ bool HLoopOptimization::LocalRun() {
   ScopedArenaSafeMap<HInstruction*, HInstruction*> perm(
       std::less<HInstruction*>(), loop_allocator_->Adapter(kArenaAllocLoopOptimization));
   ScopedArenaSet<HInstruction*> ext_set(loop_allocator_->Adapter(kArenaAllocLoopOptimization));
+  ScopedArenaVector<std::pair<HInstruction*, HInstruction*>> rt_tests(
+      loop_allocator_->Adapter(kArenaAllocLoopOptimization));
   // Attach.
   iset_ = &iset;
   reductions_ = &reds;
@@ -551,6 +563,7 @@ bool HLoopOptimization::LocalRun() {
   vector_map_ = &map;
   vector_permanent_map_ = &perm;
   vector_external_set_ = &ext_set;
+  vector_runtime_tests_ = &rt_tests;
   // Traverse.
   const bool did_loop_opt = TraverseLoopsInnerToOuter(top_loop_);
   // Detach.
@@ -560,6 +573,7 @@ bool HLoopOptimization::LocalRun() {
   vector_map_ = nullptr;
   vector_permanent_map_ = nullptr;
   vector_external_set_ = nullptr;
+  vector_runtime_tests_ = nullptr;
 
   return did_loop_opt;
 }
@@ -1017,8 +1031,7 @@ bool HLoopOptimization::ShouldVectorize(LoopNode* node, HBasicBlock* block, int6
   vector_refs_->clear();
   vector_static_peeling_factor_ = 0;
   vector_dynamic_peeling_candidate_ = nullptr;
-  vector_runtime_test_a_ =
-  vector_runtime_test_b_ = nullptr;
+  vector_runtime_tests_->clear();
 
   // Phis in the loop-body prevent vectorization.
   if (!block->GetPhis().IsEmpty()) {
@@ -1077,16 +1090,8 @@ bool HLoopOptimization::ShouldVectorize(LoopNode* node, HBasicBlock* block, int6
           // Found a[i+x] vs. b[i+y]. Accept if x == y (at worst loop-independent data dependence).
           // Conservatively assume a potential loop-carried data dependence otherwise, avoided by
           // generating an explicit a != b disambiguation runtime test on the two references.
-          if (x != y) {
-            // To avoid excessive overhead, we only accept one a != b test.
-            if (vector_runtime_test_a_ == nullptr) {
-              // First test found.
-              vector_runtime_test_a_ = a;
-              vector_runtime_test_b_ = b;
-            } else if ((vector_runtime_test_a_ != a || vector_runtime_test_b_ != b) &&
-                       (vector_runtime_test_a_ != b || vector_runtime_test_b_ != a)) {
-              return false;  // second test would be needed
-            }
+          if (x != y && !AddRuntimeAliasTest(a, b)) {
+            return false;  // too many tests would be needed
           }
         }
       }
@@ -1220,12 +1225,15 @@ void HLoopOptimization::Vectorize(LoopNode* node,
   }
   vector_index_ = graph_->GetConstant(induc_type, 0);
 
-  // Generate runtime disambiguation test:
-  // vtc = a != b ? vtc : 0;
-  if (vector_runtime_test_a_ != nullptr) {
+  // Generate runtime disambiguation tests, which version the loop so that the
+  // sequential cleanup loop runs all iterations if any pair of arrays is aliased:
+  // vtc = a1 != b1 ? vtc : 0;
+  // ...
+  // vtc = an != bn ? vtc : 0;
+  for (const std::pair<HInstruction*, HInstruction*>& test : *vector_runtime_tests_) {
     HInstruction* rt = Insert(
         preheader,
-        new (global_allocator_) HNotEqual(vector_runtime_test_a_, vector_runtime_test_b_));
+        new (global_allocator_) HNotEqual(test.first, test.second));
     vtc = Insert(preheader,
                  new (global_allocator_)
                  HSelect(rt, vtc, graph_->GetConstant(induc_type, 0), kNoDexPc));
@@ -1268,7 +1276,7 @@ void HLoopOptimization::Vectorize(LoopNode* node,
   // for ( ; i < stc; i += 1)
   //    <loop-body>
   if (needs_cleanup) {
-    DCHECK_IMPLIES(IsInPredicatedVectorizationMode(), vector_runtime_test_a_ != nullptr);
+    DCHECK_IMPLIES(IsInPredicatedVectorizationMode(), !vector_runtime_tests_->empty());
     vector_mode_ = kSequential;
     GenerateNewLoop(node,
                     block,
@@ -1661,6 +1669,9 @@ bool HLoopOptimization::VectorizeUse(LoopNode* node,
         return true;
       }
     }
+  } else if (instruction->IsSelect()) {
+    // Recognize if-converted select idiom.
+    return VectorizeSelectIdiom(node, instruction, generate_code, type, restrictions);
   } else if (instruction->IsAbs()) {
     // Deal with vector restrictions.
     HInstruction* opa = instruction->InputAt(0);
@@ -1696,11 +1707,16 @@ uint32_t HLoopOptimization::GetVectorSizeInBytes() {
 
 bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrictions) {
   const InstructionSetFeatures* features = compiler_options_->GetInstructionSetFeatures();
+  // Vector selects compare signed integral components only.
+  if (!DataType::IsIntegralType(type) || DataType::IsUnsignedType(type)) {
+    *restrictions |= kNoSelect;
+  }
   switch (compiler_options_->GetInstructionSet()) {
     case InstructionSet::kArm:
     case InstructionSet::kThumb2:
       // Allow vectorization for all ARM devices, because Android assumes that
       // ARM 32-bit always supports advanced SIMD (64-bit SIMD).
+      *restrictions |= kNoSelect;
       switch (type) {
         case DataType::Type::kBool:
         case DataType::Type::kUint8:
@@ -1792,8 +1808,15 @@ bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrict
       }
     case InstructionSet::kX86:
     case InstructionSet::kX86_64:
-      // Allow vectorization for SSE4.1-enabled X86 devices only (128-bit SIMD).
+      // Allow vectorization for SSE4.1-enabled X86 devices only (128-bit SIMD, or 256-bit
+      // SIMD with AVX2 on x86_64).
       if (features->AsX86InstructionSetFeatures()->HasSSE4_1()) {
+        size_t vector_length = simd_register_size_ / DataType::Size(type);
+        DCHECK_EQ(simd_register_size_ % DataType::Size(type), 0u);
+        if (simd_register_size_ == 32u) {
+          // The YMM code does not implement the compressed string loads.
+          *restrictions |= kNoStringCharAt;
+        }
         switch (type) {
           case DataType::Type::kBool:
           case DataType::Type::kUint8:
@@ -1806,7 +1829,7 @@ bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrict
                              kNoUnroundedHAdd |
                              kNoSAD |
                              kNoDotProd;
-            return TrySetVectorLength(type, 16);
+            return TrySetVectorLength(type, vector_length);
           case DataType::Type::kUint16:
             *restrictions |= kNoDiv |
                              kNoAbs |
@@ -1814,26 +1837,31 @@ bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrict
                              kNoUnroundedHAdd |
                              kNoSAD |
                              kNoDotProd;
-            return TrySetVectorLength(type, 8);
+            return TrySetVectorLength(type, vector_length);
           case DataType::Type::kInt16:
             *restrictions |= kNoDiv |
                              kNoAbs |
                              kNoSignedHAdd |
                              kNoUnroundedHAdd |
                              kNoSAD;
-            return TrySetVectorLength(type, 8);
+            return TrySetVectorLength(type, vector_length);
           case DataType::Type::kInt32:
             *restrictions |= kNoDiv | kNoSAD;
-            return TrySetVectorLength(type, 4);
+            return TrySetVectorLength(type, vector_length);
           case DataType::Type::kInt64:
             *restrictions |= kNoMul | kNoDiv | kNoShr | kNoAbs | kNoSAD;
-            return TrySetVectorLength(type, 2);
+            // Signed comparison of 64-bit components is only generated with AVX on x86_64.
+            if (compiler_options_->GetInstructionSet() != InstructionSet::kX86_64 ||
+                !features->AsX86InstructionSetFeatures()->HasAVX()) {
+              *restrictions |= kNoSelect;
+            }
+            return TrySetVectorLength(type, vector_length);
           case DataType::Type::kFloat32:
             *restrictions |= kNoReduction;
-            return TrySetVectorLength(type, 4);
+            return TrySetVectorLength(type, vector_length);
           case DataType::Type::kFloat64:
             *restrictions |= kNoReduction;
-            return TrySetVectorLength(type, 2);
+            return TrySetVectorLength(type, vector_length);
           default:
             break;
         }  // switch type
@@ -2376,6 +2404,123 @@ bool HLoopOptimization::VectorizeDotProdIdiom(LoopNode* node,
   return false;
 }
 
+// Method recognizes the following idiom:
+//   a OP b ? x : y for signed integral operands a, b in the precision of the vector type
+// which the select generator produces when if-converting simple diamonds and triangles in
+// the loop-body (e.g. clamping, conditional accumulation, or filtering into a new array).
+// The condition is normalized into an equality or signed greater-than vector comparison,
+// by swapping operands or selected values, whose mask then blends the selected values.
+bool HLoopOptimization::VectorizeSelectIdiom(LoopNode* node,
+                                             HInstruction* instruction,
+                                             bool generate_code,
+                                             DataType::Type type,
+                                             uint64_t restrictions) {
+  DCHECK(instruction->IsSelect());
+  if (HasVectorRestrictions(restrictions, kNoSelect)) {
+    return false;
+  }
+  HSelect* select = instruction->AsSelect();
+  HInstruction* condition = select->GetCondition();
+  // Accept a loop-variant condition that only feeds this select.
+  if (!condition->IsCondition() ||
+      node->loop_info->IsDefinedOutOfTheLoop(condition) ||
+      !condition->HasOnlyOneNonEnvironmentUse()) {
+    return false;
+  }
+  IfCondition cmp = condition->AsCondition()->GetCondition();
+  HInstruction* a = condition->InputAt(0);
+  HInstruction* b = condition->InputAt(1);
+  HInstruction* x = select->GetTrueValue();
+  HInstruction* y = select->GetFalseValue();
+  // Accept comparisons done in the precision of the vector type, where narrower
+  // operands must be represented exactly by the packed components.
+  if (DataType::Kind(a->GetType()) != DataType::Kind(type) ||
+      DataType::Kind(b->GetType()) != DataType::Kind(type) ||
+      (DataType::Size(type) < 4 &&
+       (!IsExactNarrowOperand(a, type) || !IsExactNarrowOperand(b, type)))) {
+    return false;
+  }
+  // Normalize into EQ or GT.
+  HInstruction* r = a;
+  HInstruction* s = b;
+  switch (cmp) {
+    case kCondEQ:
+    case kCondGT:
+      break;
+    case kCondNE:
+      cmp = kCondEQ;
+      std::swap(x, y);
+      break;
+    case kCondLE:
+      cmp = kCondGT;
+      std::swap(x, y);
+      break;
+    case kCondLT:
+      cmp = kCondGT;
+      std::swap(r, s);
+      break;
+    case kCondGE:
+      cmp = kCondGT;
+      std::swap(r, s);
+      std::swap(x, y);
+      break;
+    default:
+      return false;  // unsigned comparison
+  }
+  // Accept select for vectorizable operands.
+  if (VectorizeUse(node, r, generate_code, type, restrictions) &&
+      VectorizeUse(node, s, generate_code, type, restrictions) &&
+      VectorizeUse(node, x, generate_code, type, restrictions) &&
+      VectorizeUse(node, y, generate_code, type, restrictions)) {
+    if (generate_code) {
+      if (vector_mode_ == kVector) {
+        HInstruction* mask = new (global_allocator_) HVecCondition(global_allocator_,
+                                                                   vector_map_->Get(r),
+                                                                   vector_map_->Get(s),
+                                                                   cmp,
+                                                                   type,
+                                                                   vector_length_,
+                                                                   condition->GetDexPc());
+        vector_map_->Put(condition, mask);
+        vector_map_->Put(select, new (global_allocator_) HVecSelect(global_allocator_,
+                                                                    mask,
+                                                                    vector_map_->Get(x),
+                                                                    vector_map_->Get(y),
+                                                                    type,
+                                                                    vector_length_,
+                                                                    select->GetDexPc()));
+        MaybeRecordStat(stats_, MethodCompilationStat::kLoopVectorizedIdiom);
+      } else {
+        // De-idiom into the original condition and select.
+        HInstruction* opa = vector_map_->Get(a);
+        HInstruction* opb = vector_map_->Get(b);
+        HCondition* new_condition = nullptr;
+        switch (condition->AsCondition()->GetCondition()) {
+          case kCondEQ: new_condition = new (global_allocator_) HEqual(opa, opb); break;
+          case kCondNE: new_condition = new (global_allocator_) HNotEqual(opa, opb); break;
+          case kCondLT: new_condition = new (global_allocator_) HLessThan(opa, opb); break;
+          case kCondLE: new_condition = new (global_allocator_) HLessThanOrEqual(opa, opb); break;
+          case kCondGT: new_condition = new (global_allocator_) HGreaterThan(opa, opb); break;
+          case kCondGE:
+            new_condition = new (global_allocator_) HGreaterThanOrEqual(opa, opb);
+            break;
+          default:
+            LOG(FATAL) << "Unexpected condition";
+            UNREACHABLE();
+        }
+        vector_map_->Put(condition, new_condition);
+        vector_map_->Put(select, new (global_allocator_) HSelect(
+            new_condition,
+            vector_map_->Get(select->GetTrueValue()),
+            vector_map_->Get(select->GetFalseValue()),
+            select->GetDexPc()));
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
 //
 // Vectorization heuristics.
 //
@@ -2435,6 +2580,20 @@ bool HLoopOptimization::IsVectorizationProfitable(int64_t trip_count) {
   return true;
 }
 
+bool HLoopOptimization::AddRuntimeAliasTest(HInstruction* a, HInstruction* b) {
+  for (const std::pair<HInstruction*, HInstruction*>& test : *vector_runtime_tests_) {
+    if ((test.first == a && test.second == b) || (test.first == b && test.second == a)) {
+      return true;  // already tested
+    }
+  }
+  // To avoid excessive overhead, only a few a != b tests are accepted.
+  if (vector_runtime_tests_->size() >= kMaxRuntimeAliasTests) {
+    return false;
+  }
+  vector_runtime_tests_->emplace_back(a, b);
+  return true;
+}
+
 //
 // Helpers.
 //
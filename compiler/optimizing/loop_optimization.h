@@ -53,6 +53,9 @@ class HLoopOptimization : public HOptimization {
   // be performed.
   static constexpr int64_t kMaxTotalInstRemoveSuspendCheck = 128;
 
+  // The maximum number of a != b runtime disambiguation tests that guard a vector loop.
+  static constexpr size_t kMaxRuntimeAliasTests = 4;
+
  private:
   /**
    * A single loop inside the loop hierarchy representation.
@@ -101,6 +104,7 @@ class HLoopOptimization : public HOptimization {
     kNoSAD           = 1 << 11,  // no sum of absolute differences (SAD)
     kNoWideSAD       = 1 << 12,  // no sum of absolute differences (SAD) with operand widening
     kNoDotProd       = 1 << 13,  // no dot product
+    kNoSelect        = 1 << 14,  // no select (if-conversion)
   };
 
   /*
@@ -265,6 +269,11 @@ class HLoopOptimization : public HOptimization {
                              bool generate_code,
                              DataType::Type type,
                              uint64_t restrictions);
+  bool VectorizeSelectIdiom(LoopNode* node,
+                            HInstruction* instruction,
+                            bool generate_code,
+                            DataType::Type type,
+                            uint64_t restrictions);
 
   // Vectorization heuristics.
   Alignment ComputeAlignment(HInstruction* offset,
@@ -276,6 +285,10 @@ class HLoopOptimization : public HOptimization {
   uint32_t MaxNumberPeeled();
   bool IsVectorizationProfitable(int64_t trip_count);
 
+  // Records a runtime test a != b that guards the vector loop, unless the same pair is
+  // already tested. Returns false if this would exceed kMaxRuntimeAliasTests.
+  bool AddRuntimeAliasTest(HInstruction* a, HInstruction* b);
+
   //
   // Helpers.
   //
@@ -355,9 +368,10 @@ class HLoopOptimization : public HOptimization {
   uint32_t vector_static_peeling_factor_;
   const ArrayReference* vector_dynamic_peeling_candidate_;
 
-  // Dynamic data dependence test of the form a != b.
-  HInstruction* vector_runtime_test_a_;
-  HInstruction* vector_runtime_test_b_;
+  // Dynamic data dependence tests of the form a != b, which version the loop into
+  // a vector loop and a sequential fallback loop taken when any pair is aliased.
+  // Contents reside in phase-local heap memory.
+  ScopedArenaVector<std::pair<HInstruction*, HInstruction*>>* vector_runtime_tests_;
 
   // Mapping used during vectorization synthesis for both the scalar peeling/cleanup
   // loop (mode is kSequential) and the actual vector loop (mode is kVector). The data
@@ -959,6 +959,88 @@ class HVecUShr final : public HVecBinaryOperation {
   DEFAULT_COPY_CONSTRUCTOR(VecUShr);
 };
 
+// Compares every component in the two vectors, setting all bits of a result component
+// when the comparison holds and clearing them otherwise,
+// viz. [ x1, .. , xn ] OP [ y1, .. , yn ] = [ x1 OP y1 ? -1 : 0, .. , xn OP yn ? -1 : 0 ]
+// for OP either kCondEQ or signed kCondGT (other conditions are expressed by swapping
+// operands or selected values).
+class HVecCondition final : public HVecBinaryOperation {
+ public:
+  HVecCondition(ArenaAllocator* allocator,
+                HInstruction* left,
+                HInstruction* right,
+                IfCondition condition,
+                DataType::Type packed_type,
+                size_t vector_length,
+                uint32_t dex_pc)
+      : HVecBinaryOperation(
+            kVecCondition, allocator, left, right, packed_type, vector_length, dex_pc),
+        condition_(condition) {
+    DCHECK(HasConsistentPackedTypes(left, packed_type));
+    DCHECK(HasConsistentPackedTypes(right, packed_type));
+    DCHECK(condition == kCondEQ || condition == kCondGT);
+    DCHECK(DataType::IsIntegralType(packed_type));
+  }
+
+  IfCondition GetCondition() const { return condition_; }
+
+  bool CanBeMoved() const override { return true; }
+
+  bool InstructionDataEquals(const HInstruction* other) const override {
+    DCHECK(other->IsVecCondition());
+    const HVecCondition* o = other->AsVecCondition();
+    return HVecOperation::InstructionDataEquals(o) && GetCondition() == o->GetCondition();
+  }
+
+  DECLARE_INSTRUCTION(VecCondition);
+
+ protected:
+  DEFAULT_COPY_CONSTRUCTOR(VecCondition);
+
+ private:
+  const IfCondition condition_;
+};
+
+// Selects every component from the first or second vector under control of a mask
+// produced by HVecCondition,
+// viz. select([ m1, .. , mn ], [ x1, .. , xn ], [ y1, .. , yn ]) =
+//      [ m1 ? x1 : y1, .. , mn ? xn : yn ].
+class HVecSelect final : public HVecOperation {
+ public:
+  HVecSelect(ArenaAllocator* allocator,
+             HInstruction* mask,
+             HInstruction* true_value,
+             HInstruction* false_value,
+             DataType::Type packed_type,
+             size_t vector_length,
+             uint32_t dex_pc)
+      : HVecOperation(kVecSelect,
+                      allocator,
+                      packed_type,
+                      SideEffects::None(),
+                      /* number_of_inputs= */ 3,
+                      vector_length,
+                      dex_pc) {
+    DCHECK(mask->IsVecCondition());
+    DCHECK(HasConsistentPackedTypes(true_value, packed_type));
+    DCHECK(HasConsistentPackedTypes(false_value, packed_type));
+    SetRawInputAt(0, mask);
+    SetRawInputAt(1, true_value);
+    SetRawInputAt(2, false_value);
+  }
+
+  HInstruction* GetMask() const { return InputAt(0); }
+  HInstruction* GetTrueValue() const { return InputAt(1); }
+  HInstruction* GetFalseValue() const { return InputAt(2); }
+
+  bool CanBeMoved() const override { return true; }
+
+  DECLARE_INSTRUCTION(VecSelect);
+
+ protected:
+  DEFAULT_COPY_CONSTRUCTOR(VecSelect);
+};
+
 //
 // Definitions of concrete miscellaneous vector operations in HIR.
 //
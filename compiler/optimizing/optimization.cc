@@ -34,6 +34,7 @@
 #include "instruction_simplifier_x86_64.h"
 #endif
 
+#include "argument_type_speculation.h"
 #include "bounds_check_elimination.h"
 #include "cha_guard_optimization.h"
 #include "code_sinking.h"
@@ -84,6 +85,8 @@ const char* OptimizationPassName(OptimizationPass pass) {
       return HDeadCodeElimination::kDeadCodeEliminationPassName;
     case OptimizationPass::kInliner:
       return HInliner::kInlinerPassName;
+    case OptimizationPass::kArgumentTypeSpeculation:
+      return ArgumentTypeSpeculation::kArgumentTypeSpeculationPassName;
     case OptimizationPass::kSelectGenerator:
       return HSelectGenerator::kSelectGeneratorPassName;
     case OptimizationPass::kAggressiveInstructionSimplifier:
@@ -132,6 +135,7 @@ const char* OptimizationPassName(OptimizationPass pass) {
 #define X(x) if (pass_name == OptimizationPassName((x))) return (x)
 
 OptimizationPass OptimizationPassByName(const std::string& pass_name) {
+  X(OptimizationPass::kArgumentTypeSpeculation);
   X(OptimizationPass::kBoundsCheckElimination);
   X(OptimizationPass::kCHAGuardOptimization);
   X(OptimizationPass::kCodeSinking);
@@ -252,6 +256,10 @@ ArenaVector<HOptimization*> ConstructOptimizations(
                                        pass_name);
         break;
       }
+      case OptimizationPass::kArgumentTypeSpeculation:
+        opt = new (allocator) ArgumentTypeSpeculation(
+            graph, codegen, dex_compilation_unit, stats, pass_name);
+        break;
       case OptimizationPass::kSelectGenerator:
         opt = new (allocator) HSelectGenerator(graph, stats, pass_name);
         break;
@@ -69,6 +69,7 @@ class HOptimization : public ArenaObject<kArenaAllocOptimization> {
 enum class OptimizationPass {
   kAggressiveConstantFolding,
   kAggressiveInstructionSimplifier,
+  kArgumentTypeSpeculation,
   kBoundsCheckElimination,
   kCHAGuardOptimization,
   kCodeSinking,
@@ -30,6 +30,7 @@
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "base/scoped_arena_allocator.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "builder.h"
 #include "code_generator.h"
@@ -81,6 +82,8 @@ class PassObserver : public ValueObject {
   PassObserver(HGraph* graph,
                CodeGenerator* codegen,
                std::ostream* visualizer_output,
+               std::ostream* pass_profile_output,
+               Mutex* pass_profile_lock,
                const CompilerOptions& compiler_options)
       : graph_(graph),
         last_seen_graph_size_(0),
@@ -93,6 +96,13 @@ class PassObserver : public ValueObject {
         visualizer_enabled_(!compiler_options.GetDumpCfgFileName().empty()),
         visualizer_(&visualizer_oss_, graph, codegen),
         codegen_(codegen),
+        pass_profile_oss_(),
+        pass_profile_output_(pass_profile_output),
+        pass_profile_lock_(pass_profile_lock),
+        pass_profile_enabled_(pass_profile_output != nullptr),
+        pass_start_ns_(0u),
+        pass_start_graph_bytes_(0u),
+        pass_start_stack_peak_bytes_(0u),
         graph_in_bad_state_(false) {
     if (timing_logger_enabled_ || visualizer_enabled_) {
       if (!IsVerboseMethod(compiler_options, GetMethodName())) {
@@ -114,6 +124,9 @@ class PassObserver : public ValueObject {
       FlushVisualizer();
     }
     DCHECK(visualizer_oss_.str().empty());
+    if (pass_profile_enabled_) {
+      FlushPassProfile();
+    }
   }
 
   void DumpDisassembly() {
@@ -144,6 +157,11 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.StartTiming(pass_name);
     }
+    if (pass_profile_enabled_) {
+      pass_start_ns_ = NanoTime();
+      pass_start_graph_bytes_ = graph_->GetAllocator()->BytesUsed();
+      pass_start_stack_peak_bytes_ = graph_->GetArenaStack()->ApproximatePeakBytes();
+    }
   }
 
   void FlushVisualizer() {
@@ -153,11 +171,44 @@ class PassObserver : public ValueObject {
     visualizer_oss_.clear();
   }
 
+  // Record one tab-separated line for the pass that just finished. The memory columns are the
+  // growth during the pass: graph arena bytes allocated and how far the pass raised the arena
+  // stack high-water mark. The method's lines are buffered and written out together so that
+  // concurrent compilations do not interleave.
+  void RecordPassProfile(const char* pass_name) {
+    uint64_t duration_ns = NanoTime() - pass_start_ns_;
+    size_t num_blocks = 0u;
+    size_t num_instructions = 0u;
+    for (HBasicBlock* block : graph_->GetBlocks()) {
+      if (block != nullptr) {
+        ++num_blocks;
+        num_instructions += block->GetPhis().CountSize() + block->GetInstructions().CountSize();
+      }
+    }
+    pass_profile_oss_ << GetMethodName() << '\t'
+                      << pass_name << '\t'
+                      << duration_ns << '\t'
+                      << graph_->GetAllocator()->BytesUsed() - pass_start_graph_bytes_ << '\t'
+                      << graph_->GetArenaStack()->ApproximatePeakBytes() -
+                             pass_start_stack_peak_bytes_ << '\t'
+                      << num_blocks << '\t'
+                      << num_instructions << '\n';
+  }
+
+  void FlushPassProfile() {
+    MutexLock mu(Thread::Current(), *pass_profile_lock_);
+    *pass_profile_output_ << pass_profile_oss_.str();
+    pass_profile_output_->flush();
+  }
+
   void EndPass(const char* pass_name, bool pass_change) {
     // Pause timer first, then dump graph.
     if (timing_logger_enabled_) {
       timing_logger_.EndTiming();
     }
+    if (pass_profile_enabled_) {
+      RecordPassProfile(pass_name);
+    }
     if (visualizer_enabled_) {
       visualizer_.DumpGraph(pass_name, /* is_after_pass= */ true, graph_in_bad_state_);
       FlushVisualizer();
@@ -212,6 +263,14 @@ class PassObserver : public ValueObject {
   HGraphVisualizer visualizer_;
   CodeGenerator* codegen_;
 
+  std::ostringstream pass_profile_oss_;
+  std::ostream* pass_profile_output_;
+  Mutex* pass_profile_lock_;
+  bool pass_profile_enabled_;
+  uint64_t pass_start_ns_;
+  size_t pass_start_graph_bytes_;
+  size_t pass_start_stack_peak_bytes_;
+
   // Flag to be set by the compiler if the pass failed and the graph is not
   // expected to validate.
   bool graph_in_bad_state_;
@@ -381,6 +440,9 @@ class OptimizingCompiler final : public Compiler {
 
   std::unique_ptr<std::ostream> visualizer_output_;
 
+  // Guards the --compile-pass-profile output, shared by all compiling threads.
+  mutable Mutex pass_profile_lock_;
+
   DISALLOW_COPY_AND_ASSIGN(OptimizingCompiler);
 };
 
@@ -388,7 +450,8 @@ static const int kMaximumCompilationTimeBeforeWarning = 100; /* ms */
 
 OptimizingCompiler::OptimizingCompiler(const CompilerOptions& compiler_options,
                                        CompiledCodeStorage* storage)
-    : Compiler(compiler_options, storage, kMaximumCompilationTimeBeforeWarning) {
+    : Compiler(compiler_options, storage, kMaximumCompilationTimeBeforeWarning),
+      pass_profile_lock_("pass profile lock") {
   // Enable C1visualizer output.
   const std::string& cfg_file_name = compiler_options.GetDumpCfgFileName();
   if (!cfg_file_name.empty()) {
@@ -620,6 +683,8 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
     OptDef(OptimizationPass::kInstructionSimplifier),
     OptDef(OptimizationPass::kDeadCodeElimination,
            "dead_code_elimination$initial"),
+    // Speculate on profiled argument types, so that the inliner can devirtualize calls on them.
+    OptDef(OptimizationPass::kArgumentTypeSpeculation),
     // Inlining.
     OptDef(OptimizationPass::kInliner),
     // Simplification (if inlining occurred, or if we analyzed the invoke as "always throwing").
@@ -826,6 +891,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
   PassObserver pass_observer(graph,
                              codegen.get(),
                              visualizer_output_.get(),
+                             compiler_options.GetPassProfileOutput(),
+                             &pass_profile_lock_,
                              compiler_options);
 
   {
@@ -950,6 +1017,8 @@ CodeGenerator* OptimizingCompiler::TryCompileIntrinsic(
   PassObserver pass_observer(graph,
                              codegen.get(),
                              visualizer_output_.get(),
+                             compiler_options.GetPassProfileOutput(),
+                             &pass_profile_lock_,
                              compiler_options);
 
   {
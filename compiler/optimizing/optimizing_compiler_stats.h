@@ -133,6 +133,10 @@ enum class MethodCompilationStat {
   kPredicatedLoadAdded,
   kPredicatedStoreAdded,
   kDevirtualized,
+  kDevirtualizedMethodHandle,
+  kInlinedMethodHandle,
+  kSpeculatedArgumentNonNull,
+  kSpeculatedArgumentType,
   kLastStat
 };
 std::ostream& operator<<(std::ostream& os, MethodCompilationStat rhs);
@@ -307,6 +307,14 @@ void SchedulingLatencyVisitorARM64::VisitVecUShr(HVecUShr* instr) {
   HandleSimpleArithmeticSIMD(instr);
 }
 
+void SchedulingLatencyVisitorARM64::VisitVecCondition(HVecCondition* instr) {
+  HandleSimpleArithmeticSIMD(instr);
+}
+
+void SchedulingLatencyVisitorARM64::VisitVecSelect([[maybe_unused]] HVecSelect* instr) {
+  last_visited_latency_ = kArm64SIMDIntegerOpLatency;
+}
+
 void SchedulingLatencyVisitorARM64::VisitVecSetScalars(HVecSetScalars* instr) {
   HandleSimpleArithmeticSIMD(instr);
 }
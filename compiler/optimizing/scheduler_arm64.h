@@ -102,6 +102,8 @@ class SchedulingLatencyVisitorARM64 final : public SchedulingLatencyVisitor {
   M(VecShl               , unused)                   \
   M(VecShr               , unused)                   \
   M(VecUShr              , unused)                   \
+  M(VecCondition         , unused)                   \
+  M(VecSelect            , unused)                   \
   M(VecSetScalars        , unused)                   \
   M(VecMultiplyAccumulate, unused)                   \
   M(VecLoad              , unused)                   \
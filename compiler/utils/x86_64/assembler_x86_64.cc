@@ -32,6 +32,10 @@ std::ostream& operator<<(std::ostream& os, const XmmRegister& reg) {
   return os << reg.AsFloatRegister();
 }
 
+std::ostream& operator<<(std::ostream& os, const YmmRegister& reg) {
+  return os << "ymm" << static_cast<int>(reg.AsFloatRegister());
+}
+
 std::ostream& operator<<(std::ostream& os, const X87Register& reg) {
   return os << "ST" << static_cast<int>(reg);
 }
@@ -3509,6 +3513,470 @@ void X86_64Assembler::pcmpgtq(XmmRegister dst, XmmRegister src) {
   EmitXmmRegisterOperand(dst.LowBits(), src);
 }
 
+void X86_64Assembler::vpminsb(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x38, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmaxsb(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x3C, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpminsw(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0xEA, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmaxsw(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0xEE, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpminsd(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x39, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmaxsd(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x3D, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpminub(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0xDA, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmaxub(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0xDE, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpminuw(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x3A, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmaxuw(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x3E, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpminud(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x3B, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmaxud(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x3F, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vminps(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x5D, SET_VEX_PP_NONE, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vmaxps(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x5F, SET_VEX_PP_NONE, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vminpd(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x5D, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vmaxpd(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x5F, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpeqb(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x74, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpeqw(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x75, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpeqd(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x76, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpeqq(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x29, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpgtb(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x64, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpgtw(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x65, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpgtd(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x66, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpgtq(XmmRegister dst, XmmRegister src1, XmmRegister src2) {
+  EmitVexXmmRegisterOperation(0x37, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpblendvb(XmmRegister dst,
+                                XmmRegister src1,
+                                XmmRegister src2,
+                                XmmRegister mask) {
+  EmitVexXmmRegisterOperation(0x4C, SET_VEX_PP_66, SET_VEX_M_0F_3A, dst, src1, src2);
+  // The mask register is encoded in the upper four bits of the trailing immediate.
+  EmitUint8(static_cast<uint8_t>(mask.AsFloatRegister()) << 4);
+}
+
+/**
+ * VEX.256.0F.WIG 28 /r VMOVAPS ymm1, ymm2
+ * VEX.256.0F.WIG 29 /r VMOVAPS ymm2, ymm1
+ */
+void X86_64Assembler::vmovaps(YmmRegister dst, YmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  if (src.NeedsRex() && !dst.NeedsRex()) {
+    // The store form keeps the two-byte VEX prefix.
+    EmitVexRegisterOperation(0x29, SET_VEX_PP_NONE, SET_VEX_M_0F, SET_VEL_L_256,
+                             src.AsFloatRegister(), vvvv_reg, dst.AsFloatRegister());
+  } else {
+    EmitVexRegisterOperation(0x28, SET_VEX_PP_NONE, SET_VEX_M_0F, SET_VEL_L_256,
+                             dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+  }
+}
+
+/** VEX.256.0F.WIG 10 /r VMOVUPS ymm1, m256 */
+void X86_64Assembler::vmovups(YmmRegister dst, const Address& src) {
+  EmitVexMemoryOperation(0x10, SET_VEX_PP_NONE, SET_VEX_M_0F, SET_VEL_L_256,
+                         dst.AsFloatRegister(), src);
+}
+
+/** VEX.256.0F.WIG 11 /r VMOVUPS m256, ymm1 */
+void X86_64Assembler::vmovups(const Address& dst, YmmRegister src) {
+  EmitVexMemoryOperation(0x11, SET_VEX_PP_NONE, SET_VEX_M_0F, SET_VEL_L_256,
+                         src.AsFloatRegister(), dst);
+}
+
+/** VEX.256.F3.0F.WIG 6F /r VMOVDQU ymm1, m256 */
+void X86_64Assembler::vmovdqu(YmmRegister dst, const Address& src) {
+  EmitVexMemoryOperation(0x6F, SET_VEX_PP_F3, SET_VEX_M_0F, SET_VEL_L_256,
+                         dst.AsFloatRegister(), src);
+}
+
+/** VEX.256.F3.0F.WIG 7F /r VMOVDQU m256, ymm1 */
+void X86_64Assembler::vmovdqu(const Address& dst, YmmRegister src) {
+  EmitVexMemoryOperation(0x7F, SET_VEX_PP_F3, SET_VEX_M_0F, SET_VEL_L_256,
+                         src.AsFloatRegister(), dst);
+}
+
+/** VEX.256.66.0F38.W0 78 /r VPBROADCASTB ymm1, xmm2 */
+void X86_64Assembler::vpbroadcastb(YmmRegister dst, XmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x78, SET_VEX_PP_66, SET_VEX_M_0F_38, SET_VEL_L_256,
+                           dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+}
+
+/** VEX.256.66.0F38.W0 79 /r VPBROADCASTW ymm1, xmm2 */
+void X86_64Assembler::vpbroadcastw(YmmRegister dst, XmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x79, SET_VEX_PP_66, SET_VEX_M_0F_38, SET_VEL_L_256,
+                           dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+}
+
+/** VEX.256.66.0F38.W0 58 /r VPBROADCASTD ymm1, xmm2 */
+void X86_64Assembler::vpbroadcastd(YmmRegister dst, XmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x58, SET_VEX_PP_66, SET_VEX_M_0F_38, SET_VEL_L_256,
+                           dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+}
+
+/** VEX.256.66.0F38.W0 59 /r VPBROADCASTQ ymm1, xmm2 */
+void X86_64Assembler::vpbroadcastq(YmmRegister dst, XmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x59, SET_VEX_PP_66, SET_VEX_M_0F_38, SET_VEL_L_256,
+                           dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+}
+
+/** VEX.256.66.0F38.W0 18 /r VBROADCASTSS ymm1, xmm2 */
+void X86_64Assembler::vbroadcastss(YmmRegister dst, XmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x18, SET_VEX_PP_66, SET_VEX_M_0F_38, SET_VEL_L_256,
+                           dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+}
+
+/** VEX.256.66.0F38.W0 19 /r VBROADCASTSD ymm1, xmm2 */
+void X86_64Assembler::vbroadcastsd(YmmRegister dst, XmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x19, SET_VEX_PP_66, SET_VEX_M_0F_38, SET_VEL_L_256,
+                           dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+}
+
+/** VEX.256.66.0F3A.W0 39 /r ib VEXTRACTI128 xmm1, ymm2, imm8 */
+void X86_64Assembler::vextracti128(XmmRegister dst, YmmRegister src, const Immediate& imm) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x39, SET_VEX_PP_66, SET_VEX_M_0F_3A, SET_VEL_L_256,
+                           src.AsFloatRegister(), vvvv_reg, dst.AsFloatRegister());
+  EmitUint8(imm.value());
+}
+
+/** VEX.256.0F.WIG 5B /r VCVTDQ2PS ymm1, ymm2 */
+void X86_64Assembler::vcvtdq2ps(YmmRegister dst, YmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x5B, SET_VEX_PP_NONE, SET_VEX_M_0F, SET_VEL_L_256,
+                           dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+}
+
+/** VEX.256.66.0F38.WIG 1E /r VPABSD ymm1, ymm2 */
+void X86_64Assembler::vpabsd(YmmRegister dst, YmmRegister src) {
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitVexRegisterOperation(0x1E, SET_VEX_PP_66, SET_VEX_M_0F_38, SET_VEL_L_256,
+                           dst.AsFloatRegister(), vvvv_reg, src.AsFloatRegister());
+}
+
+void X86_64Assembler::vpaddb(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xFC, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpaddw(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xFD, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpaddd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xFE, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpaddq(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xD4, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpsubb(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xF8, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpsubw(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xF9, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpsubd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xFA, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpsubq(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xFB, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmullw(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xD5, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmulld(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x40, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpmaddwd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xF5, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpavgb(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xE0, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpavgw(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xE3, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vaddps(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x58, SET_VEX_PP_NONE, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vaddpd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x58, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vsubps(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x5C, SET_VEX_PP_NONE, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vsubpd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x5C, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vmulps(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x59, SET_VEX_PP_NONE, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vmulpd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x59, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vdivps(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x5E, SET_VEX_PP_NONE, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vdivpd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x5E, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpand(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xDB, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpor(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xEB, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpxor(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0xEF, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vxorps(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x57, SET_VEX_PP_NONE, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpeqb(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x74, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpeqw(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x75, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpeqd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x76, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpeqq(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x29, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpgtb(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x64, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpgtw(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x65, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpgtd(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x66, SET_VEX_PP_66, SET_VEX_M_0F, dst, src1, src2);
+}
+
+void X86_64Assembler::vpcmpgtq(YmmRegister dst, YmmRegister src1, YmmRegister src2) {
+  EmitVexYmmRegisterOperation(0x37, SET_VEX_PP_66, SET_VEX_M_0F_38, dst, src1, src2);
+}
+
+void X86_64Assembler::vpblendvb(YmmRegister dst,
+                                YmmRegister src1,
+                                YmmRegister src2,
+                                YmmRegister mask) {
+  EmitVexYmmRegisterOperation(0x4C, SET_VEX_PP_66, SET_VEX_M_0F_3A, dst, src1, src2);
+  // The mask register is encoded in the upper four bits of the trailing immediate.
+  EmitUint8(static_cast<uint8_t>(mask.AsFloatRegister()) << 4);
+}
+
+/** VEX.256.66.0F.WIG 71 /6 ib VPSLLW ymm1, ymm2, imm8 */
+void X86_64Assembler::vpsllw(YmmRegister dst, YmmRegister src, const Immediate& shift_count) {
+  DCHECK(shift_count.is_uint8());
+  EmitVexRegisterOperation(0x71,
+                           SET_VEX_PP_66,
+                           SET_VEX_M_0F,
+                           SET_VEL_L_256,
+                           /*reg=*/ 6,
+                           X86_64ManagedRegister::FromXmmRegister(dst.AsFloatRegister()),
+                           src.AsFloatRegister());
+  EmitUint8(shift_count.value());
+}
+
+/** VEX.256.66.0F.WIG 72 /6 ib VPSLLD ymm1, ymm2, imm8 */
+void X86_64Assembler::vpslld(YmmRegister dst, YmmRegister src, const Immediate& shift_count) {
+  DCHECK(shift_count.is_uint8());
+  EmitVexRegisterOperation(0x72,
+                           SET_VEX_PP_66,
+                           SET_VEX_M_0F,
+                           SET_VEL_L_256,
+                           /*reg=*/ 6,
+                           X86_64ManagedRegister::FromXmmRegister(dst.AsFloatRegister()),
+                           src.AsFloatRegister());
+  EmitUint8(shift_count.value());
+}
+
+/** VEX.256.66.0F.WIG 73 /6 ib VPSLLQ ymm1, ymm2, imm8 */
+void X86_64Assembler::vpsllq(YmmRegister dst, YmmRegister src, const Immediate& shift_count) {
+  DCHECK(shift_count.is_uint8());
+  EmitVexRegisterOperation(0x73,
+                           SET_VEX_PP_66,
+                           SET_VEX_M_0F,
+                           SET_VEL_L_256,
+                           /*reg=*/ 6,
+                           X86_64ManagedRegister::FromXmmRegister(dst.AsFloatRegister()),
+                           src.AsFloatRegister());
+  EmitUint8(shift_count.value());
+}
+
+/** VEX.256.66.0F.WIG 71 /4 ib VPSRAW ymm1, ymm2, imm8 */
+void X86_64Assembler::vpsraw(YmmRegister dst, YmmRegister src, const Immediate& shift_count) {
+  DCHECK(shift_count.is_uint8());
+  EmitVexRegisterOperation(0x71,
+                           SET_VEX_PP_66,
+                           SET_VEX_M_0F,
+                           SET_VEL_L_256,
+                           /*reg=*/ 4,
+                           X86_64ManagedRegister::FromXmmRegister(dst.AsFloatRegister()),
+                           src.AsFloatRegister());
+  EmitUint8(shift_count.value());
+}
+
+/** VEX.256.66.0F.WIG 72 /4 ib VPSRAD ymm1, ymm2, imm8 */
+void X86_64Assembler::vpsrad(YmmRegister dst, YmmRegister src, const Immediate& shift_count) {
+  DCHECK(shift_count.is_uint8());
+  EmitVexRegisterOperation(0x72,
+                           SET_VEX_PP_66,
+                           SET_VEX_M_0F,
+                           SET_VEL_L_256,
+                           /*reg=*/ 4,
+                           X86_64ManagedRegister::FromXmmRegister(dst.AsFloatRegister()),
+                           src.AsFloatRegister());
+  EmitUint8(shift_count.value());
+}
+
+/** VEX.256.66.0F.WIG 71 /2 ib VPSRLW ymm1, ymm2, imm8 */
+void X86_64Assembler::vpsrlw(YmmRegister dst, YmmRegister src, const Immediate& shift_count) {
+  DCHECK(shift_count.is_uint8());
+  EmitVexRegisterOperation(0x71,
+                           SET_VEX_PP_66,
+                           SET_VEX_M_0F,
+                           SET_VEL_L_256,
+                           /*reg=*/ 2,
+                           X86_64ManagedRegister::FromXmmRegister(dst.AsFloatRegister()),
+                           src.AsFloatRegister());
+  EmitUint8(shift_count.value());
+}
+
+/** VEX.256.66.0F.WIG 72 /2 ib VPSRLD ymm1, ymm2, imm8 */
+void X86_64Assembler::vpsrld(YmmRegister dst, YmmRegister src, const Immediate& shift_count) {
+  DCHECK(shift_count.is_uint8());
+  EmitVexRegisterOperation(0x72,
+                           SET_VEX_PP_66,
+                           SET_VEX_M_0F,
+                           SET_VEL_L_256,
+                           /*reg=*/ 2,
+                           X86_64ManagedRegister::FromXmmRegister(dst.AsFloatRegister()),
+                           src.AsFloatRegister());
+  EmitUint8(shift_count.value());
+}
+
+/** VEX.256.66.0F.WIG 73 /2 ib VPSRLQ ymm1, ymm2, imm8 */
+void X86_64Assembler::vpsrlq(YmmRegister dst, YmmRegister src, const Immediate& shift_count) {
+  DCHECK(shift_count.is_uint8());
+  EmitVexRegisterOperation(0x73,
+                           SET_VEX_PP_66,
+                           SET_VEX_M_0F,
+                           SET_VEL_L_256,
+                           /*reg=*/ 2,
+                           X86_64ManagedRegister::FromXmmRegister(dst.AsFloatRegister()),
+                           src.AsFloatRegister());
+  EmitUint8(shift_count.value());
+}
+
+/** VEX.128.0F.WIG 77 VZEROUPPER */
+void X86_64Assembler::vzeroupper() {
+  DCHECK(CpuHasAVXorAVX2FeatureFlag());
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+  EmitUint8(EmitVexPrefixByteZero(/*is_twobyte_form=*/ true));
+  EmitUint8(EmitVexPrefixByteOne(/*R=*/ false, vvvv_reg, SET_VEX_L_128, SET_VEX_PP_NONE));
+  EmitUint8(0x77);
+}
+
 void X86_64Assembler::shufpd(XmmRegister dst, XmmRegister src, const Immediate& imm) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   EmitUint8(0x66);
@@ -5662,6 +6130,97 @@ size_t ConstantArea::AddFloat(float v) {
   return AddInt32(bit_cast<int32_t, float>(v));
 }
 
+void X86_64Assembler::EmitVexXmmRegisterOperation(uint8_t opcode,
+                                                  int set_vex_pp,
+                                                  int set_vex_m,
+                                                  XmmRegister dst,
+                                                  XmmRegister src1,
+                                                  XmmRegister src2) {
+  EmitVexRegisterOperation(opcode,
+                           set_vex_pp,
+                           set_vex_m,
+                           SET_VEX_L_128,
+                           dst.AsFloatRegister(),
+                           X86_64ManagedRegister::FromXmmRegister(src1.AsFloatRegister()),
+                           src2.AsFloatRegister());
+}
+
+void X86_64Assembler::EmitVexYmmRegisterOperation(uint8_t opcode,
+                                                  int set_vex_pp,
+                                                  int set_vex_m,
+                                                  YmmRegister dst,
+                                                  YmmRegister src1,
+                                                  YmmRegister src2) {
+  EmitVexRegisterOperation(opcode,
+                           set_vex_pp,
+                           set_vex_m,
+                           SET_VEL_L_256,
+                           dst.AsFloatRegister(),
+                           X86_64ManagedRegister::FromXmmRegister(src1.AsFloatRegister()),
+                           src2.AsFloatRegister());
+}
+
+void X86_64Assembler::EmitVexRegisterOperation(uint8_t opcode,
+                                               int set_vex_pp,
+                                               int set_vex_m,
+                                               int set_vex_l,
+                                               int reg,
+                                               X86_64ManagedRegister vvvv,
+                                               int rm) {
+  DCHECK(CpuHasAVXorAVX2FeatureFlag());
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  // The two-byte form implies the 0F opcode map and cannot extend the r/m operand.
+  bool is_twobyte_form = (set_vex_m == SET_VEX_M_0F) && rm < 8;
+  uint8_t ByteZero = 0x00, ByteOne = 0x00, ByteTwo = 0x00;
+  ByteZero = EmitVexPrefixByteZero(is_twobyte_form);
+  if (is_twobyte_form) {
+    ByteOne = EmitVexPrefixByteOne(reg > 7, vvvv, set_vex_l, set_vex_pp);
+  } else {
+    ByteOne = EmitVexPrefixByteOne(reg > 7, /*X=*/ false, rm > 7, set_vex_m);
+    ByteTwo = vvvv.IsNoRegister()
+        ? EmitVexPrefixByteTwo(/*W=*/ false, set_vex_l, set_vex_pp)
+        : EmitVexPrefixByteTwo(/*W=*/ false, vvvv, set_vex_l, set_vex_pp);
+  }
+  EmitUint8(ByteZero);
+  EmitUint8(ByteOne);
+  if (!is_twobyte_form) {
+    EmitUint8(ByteTwo);
+  }
+  EmitUint8(opcode);
+  EmitRegisterOperand(reg & 7, static_cast<uint8_t>(rm));
+}
+
+void X86_64Assembler::EmitVexMemoryOperation(uint8_t opcode,
+                                             int set_vex_pp,
+                                             int set_vex_m,
+                                             int set_vex_l,
+                                             int reg,
+                                             const Address& address) {
+  DCHECK(CpuHasAVXorAVX2FeatureFlag());
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  uint8_t rex = address.rex();
+  bool Rex_x = rex & GET_REX_X;
+  bool Rex_b = rex & GET_REX_B;
+  // The two-byte form implies the 0F opcode map and cannot extend the address registers.
+  bool is_twobyte_form = (set_vex_m == SET_VEX_M_0F) && !Rex_x && !Rex_b;
+  uint8_t ByteZero = 0x00, ByteOne = 0x00, ByteTwo = 0x00;
+  ByteZero = EmitVexPrefixByteZero(is_twobyte_form);
+  if (is_twobyte_form) {
+    X86_64ManagedRegister vvvv_reg = ManagedRegister::NoRegister().AsX86_64();
+    ByteOne = EmitVexPrefixByteOne(reg > 7, vvvv_reg, set_vex_l, set_vex_pp);
+  } else {
+    ByteOne = EmitVexPrefixByteOne(reg > 7, Rex_x, Rex_b, set_vex_m);
+    ByteTwo = EmitVexPrefixByteTwo(/*W=*/ false, set_vex_l, set_vex_pp);
+  }
+  EmitUint8(ByteZero);
+  EmitUint8(ByteOne);
+  if (!is_twobyte_form) {
+    EmitUint8(ByteTwo);
+  }
+  EmitUint8(opcode);
+  EmitOperand(reg & 7, address);
+}
+
 uint8_t X86_64Assembler::EmitVexPrefixByteZero(bool is_twobyte_form) {
   // Vex Byte 0,
   // Bits [7:0] must contain the value 11000101b (0xC5) for 2-byte Vex
@@ -700,6 +700,13 @@ class X86_64Assembler final : public Assembler {
   void pminsd(XmmRegister dst, XmmRegister src);
   void pmaxsd(XmmRegister dst, XmmRegister src);
 
+  void vpminsb(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpmaxsb(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpminsw(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpmaxsw(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpminsd(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpmaxsd(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+
   void pminub(XmmRegister dst, XmmRegister src);  // no addr variant (for now)
   void pmaxub(XmmRegister dst, XmmRegister src);
   void pminuw(XmmRegister dst, XmmRegister src);
@@ -707,21 +714,115 @@ class X86_64Assembler final : public Assembler {
   void pminud(XmmRegister dst, XmmRegister src);
   void pmaxud(XmmRegister dst, XmmRegister src);
 
+  void vpminub(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpmaxub(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpminuw(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpmaxuw(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpminud(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpmaxud(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+
   void minps(XmmRegister dst, XmmRegister src);  // no addr variant (for now)
   void maxps(XmmRegister dst, XmmRegister src);
   void minpd(XmmRegister dst, XmmRegister src);
   void maxpd(XmmRegister dst, XmmRegister src);
 
+  void vminps(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vmaxps(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vminpd(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vmaxpd(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+
   void pcmpeqb(XmmRegister dst, XmmRegister src);
   void pcmpeqw(XmmRegister dst, XmmRegister src);
   void pcmpeqd(XmmRegister dst, XmmRegister src);
   void pcmpeqq(XmmRegister dst, XmmRegister src);
 
+  void vpcmpeqb(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpcmpeqw(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpcmpeqd(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpcmpeqq(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+
   void pcmpgtb(XmmRegister dst, XmmRegister src);
   void pcmpgtw(XmmRegister dst, XmmRegister src);
   void pcmpgtd(XmmRegister dst, XmmRegister src);
   void pcmpgtq(XmmRegister dst, XmmRegister src);  // SSE4.2
 
+  void vpcmpgtb(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpcmpgtw(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpcmpgtd(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+  void vpcmpgtq(XmmRegister dst, XmmRegister src1, XmmRegister src2);
+
+  // Selects bytes of src2 where the top bit of the corresponding mask byte is set, else src1.
+  void vpblendvb(XmmRegister dst, XmmRegister src1, XmmRegister src2, XmmRegister mask);
+
+  // AVX2 operations on all 256 bits of the YMM registers.
+  void vmovaps(YmmRegister dst, YmmRegister src);
+  void vmovups(YmmRegister dst, const Address& src);  // load unaligned
+  void vmovups(const Address& dst, YmmRegister src);  // store unaligned
+  void vmovdqu(YmmRegister dst, const Address& src);  // load unaligned
+  void vmovdqu(const Address& dst, YmmRegister src);  // store unaligned
+
+  void vpbroadcastb(YmmRegister dst, XmmRegister src);
+  void vpbroadcastw(YmmRegister dst, XmmRegister src);
+  void vpbroadcastd(YmmRegister dst, XmmRegister src);
+  void vpbroadcastq(YmmRegister dst, XmmRegister src);
+  void vbroadcastss(YmmRegister dst, XmmRegister src);
+  void vbroadcastsd(YmmRegister dst, XmmRegister src);
+  void vextracti128(XmmRegister dst, YmmRegister src, const Immediate& imm);
+
+  void vcvtdq2ps(YmmRegister dst, YmmRegister src);
+  void vpabsd(YmmRegister dst, YmmRegister src);
+
+  void vpaddb(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpaddw(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpaddd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpaddq(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpsubb(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpsubw(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpsubd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpsubq(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpmullw(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpmulld(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpmaddwd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpavgb(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpavgw(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+
+  void vaddps(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vaddpd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vsubps(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vsubpd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vmulps(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vmulpd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vdivps(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vdivpd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+
+  void vpand(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpor(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpxor(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vxorps(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+
+  void vpsllw(YmmRegister dst, YmmRegister src, const Immediate& shift_count);
+  void vpslld(YmmRegister dst, YmmRegister src, const Immediate& shift_count);
+  void vpsllq(YmmRegister dst, YmmRegister src, const Immediate& shift_count);
+  void vpsraw(YmmRegister dst, YmmRegister src, const Immediate& shift_count);
+  void vpsrad(YmmRegister dst, YmmRegister src, const Immediate& shift_count);
+  void vpsrlw(YmmRegister dst, YmmRegister src, const Immediate& shift_count);
+  void vpsrld(YmmRegister dst, YmmRegister src, const Immediate& shift_count);
+  void vpsrlq(YmmRegister dst, YmmRegister src, const Immediate& shift_count);
+
+  void vpcmpeqb(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpcmpeqw(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpcmpeqd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpcmpeqq(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpcmpgtb(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpcmpgtw(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpcmpgtd(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpcmpgtq(YmmRegister dst, YmmRegister src1, YmmRegister src2);
+  void vpblendvb(YmmRegister dst, YmmRegister src1, YmmRegister src2, YmmRegister mask);
+
+  // Zeroes the upper 128 bits of all YMM registers, to avoid the penalty of
+  // transitions to legacy SSE code.
+  void vzeroupper();
+
   void shufpd(XmmRegister dst, XmmRegister src, const Immediate& imm);
   void shufps(XmmRegister dst, XmmRegister src, const Immediate& imm);
   void pshufd(XmmRegister dst, XmmRegister src, const Immediate& imm);
@@ -1163,6 +1264,38 @@ class X86_64Assembler final : public Assembler {
                                            bool normalize_both = false);
   void EmitOptionalByteRegNormalizingRex32(CpuRegister dst, const Operand& operand);
 
+  // Emits a VEX.128 encoded instruction with operands `dst`, `src1` (in VEX.vvvv) and `src2`.
+  void EmitVexXmmRegisterOperation(uint8_t opcode,
+                                   int set_vex_pp,
+                                   int set_vex_m,
+                                   XmmRegister dst,
+                                   XmmRegister src1,
+                                   XmmRegister src2);
+  // Emits a VEX.256 encoded instruction with operands `dst`, `src1` (in VEX.vvvv) and `src2`.
+  void EmitVexYmmRegisterOperation(uint8_t opcode,
+                                   int set_vex_pp,
+                                   int set_vex_m,
+                                   YmmRegister dst,
+                                   YmmRegister src1,
+                                   YmmRegister src2);
+  // Emits a VEX encoded instruction with the register number or opcode extension `reg` in
+  // ModRM.reg, the optional operand `vvvv` in VEX.vvvv and the register `rm` in ModRM.rm.
+  void EmitVexRegisterOperation(uint8_t opcode,
+                                int set_vex_pp,
+                                int set_vex_m,
+                                int set_vex_l,
+                                int reg,
+                                X86_64ManagedRegister vvvv,
+                                int rm);
+  // Emits a VEX encoded instruction without VEX.vvvv operand, with the register number `reg`
+  // in ModRM.reg and the memory operand `address`.
+  void EmitVexMemoryOperation(uint8_t opcode,
+                              int set_vex_pp,
+                              int set_vex_m,
+                              int set_vex_l,
+                              int reg,
+                              const Address& address);
+
   uint8_t EmitVexPrefixByteZero(bool is_twobyte_form);
   uint8_t EmitVexPrefixByteOne(bool R, bool X, bool B, int SET_VEX_M);
   uint8_t EmitVexPrefixByteOne(bool R,
@@ -2017,6 +2017,299 @@ TEST_F(AssemblerX86_64Test, PCmpgtq) {
   DriverStr(RepeatFF(&x86_64::X86_64Assembler::pcmpgtq, "pcmpgtq %{reg2}, %{reg1}"), "pcmpgtq");
 }
 
+TEST_F(AssemblerX86_64AVXTest, VPminsb) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpminsb,
+                      "vpminsb %{reg3}, %{reg2}, %{reg1}"), "vpminsb");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPmaxsb) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpmaxsb,
+                      "vpmaxsb %{reg3}, %{reg2}, %{reg1}"), "vpmaxsb");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPminsw) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpminsw,
+                      "vpminsw %{reg3}, %{reg2}, %{reg1}"), "vpminsw");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPmaxsw) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpmaxsw,
+                      "vpmaxsw %{reg3}, %{reg2}, %{reg1}"), "vpmaxsw");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPminsd) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpminsd,
+                      "vpminsd %{reg3}, %{reg2}, %{reg1}"), "vpminsd");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPmaxsd) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpmaxsd,
+                      "vpmaxsd %{reg3}, %{reg2}, %{reg1}"), "vpmaxsd");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPminub) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpminub,
+                      "vpminub %{reg3}, %{reg2}, %{reg1}"), "vpminub");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPmaxub) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpmaxub,
+                      "vpmaxub %{reg3}, %{reg2}, %{reg1}"), "vpmaxub");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPminuw) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpminuw,
+                      "vpminuw %{reg3}, %{reg2}, %{reg1}"), "vpminuw");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPmaxuw) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpmaxuw,
+                      "vpmaxuw %{reg3}, %{reg2}, %{reg1}"), "vpmaxuw");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPminud) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpminud,
+                      "vpminud %{reg3}, %{reg2}, %{reg1}"), "vpminud");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPmaxud) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpmaxud,
+                      "vpmaxud %{reg3}, %{reg2}, %{reg1}"), "vpmaxud");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VMinps) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vminps,
+                      "vminps %{reg3}, %{reg2}, %{reg1}"), "vminps");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VMaxps) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vmaxps,
+                      "vmaxps %{reg3}, %{reg2}, %{reg1}"), "vmaxps");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VMinpd) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vminpd,
+                      "vminpd %{reg3}, %{reg2}, %{reg1}"), "vminpd");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VMaxpd) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vmaxpd,
+                      "vmaxpd %{reg3}, %{reg2}, %{reg1}"), "vmaxpd");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPcmpeqb) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpcmpeqb,
+                      "vpcmpeqb %{reg3}, %{reg2}, %{reg1}"), "vpcmpeqb");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPcmpeqw) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpcmpeqw,
+                      "vpcmpeqw %{reg3}, %{reg2}, %{reg1}"), "vpcmpeqw");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPcmpeqd) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpcmpeqd,
+                      "vpcmpeqd %{reg3}, %{reg2}, %{reg1}"), "vpcmpeqd");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPcmpeqq) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpcmpeqq,
+                      "vpcmpeqq %{reg3}, %{reg2}, %{reg1}"), "vpcmpeqq");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPcmpgtb) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpcmpgtb,
+                      "vpcmpgtb %{reg3}, %{reg2}, %{reg1}"), "vpcmpgtb");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPcmpgtw) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpcmpgtw,
+                      "vpcmpgtw %{reg3}, %{reg2}, %{reg1}"), "vpcmpgtw");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPcmpgtd) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpcmpgtd,
+                      "vpcmpgtd %{reg3}, %{reg2}, %{reg1}"), "vpcmpgtd");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPcmpgtq) {
+  DriverStr(RepeatFFF(&x86_64::X86_64Assembler::vpcmpgtq,
+                      "vpcmpgtq %{reg3}, %{reg2}, %{reg1}"), "vpcmpgtq");
+}
+
+TEST_F(AssemblerX86_64AVXTest, VPblendvb) {
+  DriverStr(RepeatFFFF(&x86_64::X86_64Assembler::vpblendvb,
+                       "vpblendvb %{reg4}, %{reg3}, %{reg2}, %{reg1}"), "vpblendvb");
+}
+
+TEST_F(AssemblerX86_64AVXTest, YmmMoves) {
+  x86_64::YmmRegister ymm0(x86_64::XMM0);
+  x86_64::YmmRegister ymm3(x86_64::XMM3);
+  x86_64::YmmRegister ymm9(x86_64::XMM9);
+  x86_64::Address rax_address(x86_64::CpuRegister(x86_64::RAX), 16);
+  x86_64::Address r9_address(x86_64::CpuRegister(x86_64::R9),
+                             x86_64::CpuRegister(x86_64::RCX),
+                             x86_64::TIMES_4,
+                             12);
+  GetAssembler()->vmovaps(ymm3, ymm0);
+  GetAssembler()->vmovaps(ymm0, ymm9);
+  GetAssembler()->vmovups(ymm9, rax_address);
+  GetAssembler()->vmovups(r9_address, ymm3);
+  GetAssembler()->vmovdqu(ymm0, r9_address);
+  GetAssembler()->vmovdqu(rax_address, ymm9);
+  const char* expected =
+      "vmovaps %ymm0, %ymm3\n"
+      "vmovaps %ymm9, %ymm0\n"
+      "vmovups 16(%RAX), %ymm9\n"
+      "vmovups %ymm3, 12(%R9,%RCX,4)\n"
+      "vmovdqu 12(%R9,%RCX,4), %ymm0\n"
+      "vmovdqu %ymm9, 16(%RAX)\n";
+  DriverStr(expected, "ymm_moves");
+}
+
+TEST_F(AssemblerX86_64AVXTest, YmmBroadcastsAndExtract) {
+  x86_64::YmmRegister ymm1(x86_64::XMM1);
+  x86_64::YmmRegister ymm12(x86_64::XMM12);
+  GetAssembler()->vpbroadcastb(ymm1, x86_64::XmmRegister(x86_64::XMM2));
+  GetAssembler()->vpbroadcastw(ymm12, x86_64::XmmRegister(x86_64::XMM2));
+  GetAssembler()->vpbroadcastd(ymm1, x86_64::XmmRegister(x86_64::XMM10));
+  GetAssembler()->vpbroadcastq(ymm12, x86_64::XmmRegister(x86_64::XMM15));
+  GetAssembler()->vbroadcastss(ymm1, x86_64::XmmRegister(x86_64::XMM1));
+  GetAssembler()->vbroadcastsd(ymm12, x86_64::XmmRegister(x86_64::XMM12));
+  GetAssembler()->vextracti128(x86_64::XmmRegister(x86_64::XMM3), ymm12, x86_64::Immediate(1));
+  GetAssembler()->vextracti128(x86_64::XmmRegister(x86_64::XMM11), ymm1, x86_64::Immediate(1));
+  const char* expected =
+      "vpbroadcastb %xmm2, %ymm1\n"
+      "vpbroadcastw %xmm2, %ymm12\n"
+      "vpbroadcastd %xmm10, %ymm1\n"
+      "vpbroadcastq %xmm15, %ymm12\n"
+      "vbroadcastss %xmm1, %ymm1\n"
+      "vbroadcastsd %xmm12, %ymm12\n"
+      "vextracti128 $1, %ymm12, %xmm3\n"
+      "vextracti128 $1, %ymm1, %xmm11\n";
+  DriverStr(expected, "ymm_broadcasts_and_extract");
+}
+
+TEST_F(AssemblerX86_64AVXTest, YmmArithmetic) {
+  x86_64::YmmRegister ymm0(x86_64::XMM0);
+  x86_64::YmmRegister ymm5(x86_64::XMM5);
+  x86_64::YmmRegister ymm8(x86_64::XMM8);
+  x86_64::YmmRegister ymm15(x86_64::XMM15);
+  GetAssembler()->vpaddb(ymm0, ymm5, ymm8);
+  GetAssembler()->vpaddw(ymm8, ymm0, ymm5);
+  GetAssembler()->vpaddd(ymm15, ymm8, ymm0);
+  GetAssembler()->vpaddq(ymm0, ymm15, ymm5);
+  GetAssembler()->vpsubb(ymm5, ymm0, ymm15);
+  GetAssembler()->vpsubw(ymm0, ymm5, ymm8);
+  GetAssembler()->vpsubd(ymm8, ymm15, ymm0);
+  GetAssembler()->vpsubq(ymm0, ymm0, ymm5);
+  GetAssembler()->vpmullw(ymm5, ymm8, ymm15);
+  GetAssembler()->vpmulld(ymm0, ymm5, ymm15);
+  GetAssembler()->vpmaddwd(ymm15, ymm0, ymm5);
+  GetAssembler()->vpavgb(ymm0, ymm5, ymm8);
+  GetAssembler()->vpavgw(ymm8, ymm5, ymm0);
+  GetAssembler()->vaddps(ymm0, ymm5, ymm8);
+  GetAssembler()->vaddpd(ymm8, ymm5, ymm0);
+  GetAssembler()->vsubps(ymm15, ymm0, ymm5);
+  GetAssembler()->vsubpd(ymm0, ymm15, ymm8);
+  GetAssembler()->vmulps(ymm5, ymm8, ymm0);
+  GetAssembler()->vmulpd(ymm0, ymm5, ymm15);
+  GetAssembler()->vdivps(ymm8, ymm0, ymm5);
+  GetAssembler()->vdivpd(ymm0, ymm8, ymm15);
+  GetAssembler()->vpand(ymm0, ymm5, ymm8);
+  GetAssembler()->vpor(ymm8, ymm15, ymm0);
+  GetAssembler()->vpxor(ymm5, ymm5, ymm5);
+  GetAssembler()->vxorps(ymm15, ymm15, ymm15);
+  GetAssembler()->vcvtdq2ps(ymm0, ymm15);
+  GetAssembler()->vpabsd(ymm8, ymm5);
+  const char* expected =
+      "vpaddb %ymm8, %ymm5, %ymm0\n"
+      "vpaddw %ymm5, %ymm0, %ymm8\n"
+      "vpaddd %ymm0, %ymm8, %ymm15\n"
+      "vpaddq %ymm5, %ymm15, %ymm0\n"
+      "vpsubb %ymm15, %ymm0, %ymm5\n"
+      "vpsubw %ymm8, %ymm5, %ymm0\n"
+      "vpsubd %ymm0, %ymm15, %ymm8\n"
+      "vpsubq %ymm5, %ymm0, %ymm0\n"
+      "vpmullw %ymm15, %ymm8, %ymm5\n"
+      "vpmulld %ymm15, %ymm5, %ymm0\n"
+      "vpmaddwd %ymm5, %ymm0, %ymm15\n"
+      "vpavgb %ymm8, %ymm5, %ymm0\n"
+      "vpavgw %ymm0, %ymm5, %ymm8\n"
+      "vaddps %ymm8, %ymm5, %ymm0\n"
+      "vaddpd %ymm0, %ymm5, %ymm8\n"
+      "vsubps %ymm5, %ymm0, %ymm15\n"
+      "vsubpd %ymm8, %ymm15, %ymm0\n"
+      "vmulps %ymm0, %ymm8, %ymm5\n"
+      "vmulpd %ymm15, %ymm5, %ymm0\n"
+      "vdivps %ymm5, %ymm0, %ymm8\n"
+      "vdivpd %ymm15, %ymm8, %ymm0\n"
+      "vpand %ymm8, %ymm5, %ymm0\n"
+      "vpor %ymm0, %ymm15, %ymm8\n"
+      "vpxor %ymm5, %ymm5, %ymm5\n"
+      "vxorps %ymm15, %ymm15, %ymm15\n"
+      "vcvtdq2ps %ymm15, %ymm0\n"
+      "vpabsd %ymm5, %ymm8\n";
+  DriverStr(expected, "ymm_arithmetic");
+}
+
+TEST_F(AssemblerX86_64AVXTest, YmmShifts) {
+  x86_64::YmmRegister ymm2(x86_64::XMM2);
+  x86_64::YmmRegister ymm13(x86_64::XMM13);
+  GetAssembler()->vpsllw(ymm2, ymm13, x86_64::Immediate(1));
+  GetAssembler()->vpslld(ymm13, ymm2, x86_64::Immediate(5));
+  GetAssembler()->vpsllq(ymm2, ymm2, x86_64::Immediate(63));
+  GetAssembler()->vpsraw(ymm13, ymm13, x86_64::Immediate(15));
+  GetAssembler()->vpsrad(ymm2, ymm13, x86_64::Immediate(31));
+  GetAssembler()->vpsrlw(ymm13, ymm2, x86_64::Immediate(2));
+  GetAssembler()->vpsrld(ymm2, ymm2, x86_64::Immediate(1));
+  GetAssembler()->vpsrlq(ymm13, ymm2, x86_64::Immediate(1));
+  const char* expected =
+      "vpsllw $1, %ymm13, %ymm2\n"
+      "vpslld $5, %ymm2, %ymm13\n"
+      "vpsllq $63, %ymm2, %ymm2\n"
+      "vpsraw $15, %ymm13, %ymm13\n"
+      "vpsrad $31, %ymm13, %ymm2\n"
+      "vpsrlw $2, %ymm2, %ymm13\n"
+      "vpsrld $1, %ymm2, %ymm2\n"
+      "vpsrlq $1, %ymm2, %ymm13\n";
+  DriverStr(expected, "ymm_shifts");
+}
+
+TEST_F(AssemblerX86_64AVXTest, YmmCompareAndBlend) {
+  x86_64::YmmRegister ymm1(x86_64::XMM1);
+  x86_64::YmmRegister ymm6(x86_64::XMM6);
+  x86_64::YmmRegister ymm9(x86_64::XMM9);
+  x86_64::YmmRegister ymm14(x86_64::XMM14);
+  GetAssembler()->vpcmpeqb(ymm1, ymm6, ymm9);
+  GetAssembler()->vpcmpeqw(ymm9, ymm1, ymm6);
+  GetAssembler()->vpcmpeqd(ymm14, ymm9, ymm1);
+  GetAssembler()->vpcmpeqq(ymm1, ymm14, ymm9);
+  GetAssembler()->vpcmpgtb(ymm6, ymm1, ymm14);
+  GetAssembler()->vpcmpgtw(ymm1, ymm6, ymm9);
+  GetAssembler()->vpcmpgtd(ymm9, ymm14, ymm1);
+  GetAssembler()->vpcmpgtq(ymm1, ymm9, ymm14);
+  GetAssembler()->vpblendvb(ymm1, ymm6, ymm9, ymm14);
+  GetAssembler()->vpblendvb(ymm14, ymm9, ymm1, ymm6);
+  const char* expected =
+      "vpcmpeqb %ymm9, %ymm6, %ymm1\n"
+      "vpcmpeqw %ymm6, %ymm1, %ymm9\n"
+      "vpcmpeqd %ymm1, %ymm9, %ymm14\n"
+      "vpcmpeqq %ymm9, %ymm14, %ymm1\n"
+      "vpcmpgtb %ymm14, %ymm1, %ymm6\n"
+      "vpcmpgtw %ymm9, %ymm6, %ymm1\n"
+      "vpcmpgtd %ymm1, %ymm14, %ymm9\n"
+      "vpcmpgtq %ymm14, %ymm9, %ymm1\n"
+      "vpblendvb %ymm14, %ymm9, %ymm6, %ymm1\n"
+      "vpblendvb %ymm6, %ymm1, %ymm9, %ymm14\n";
+  DriverStr(expected, "ymm_compare_and_blend");
+}
+
+TEST_F(AssemblerX86_64AVXTest, Vzeroupper) {
+  GetAssembler()->vzeroupper();
+  DriverStr("vzeroupper\n", "vzeroupper");
+}
+
 TEST_F(AssemblerX86_64Test, Shufps) {
   DriverStr(RepeatFFI(&x86_64::X86_64Assembler::shufps, /*imm_bytes*/ 1U,
                       "shufps ${imm}, %{reg2}, %{reg1}"), "shufps");
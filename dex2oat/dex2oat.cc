@@ -80,6 +80,7 @@
 #include "dex/verification_results.h"
 #include "dex2oat_options.h"
 #include "dexlayout.h"
+#include "driver/compilation_cache.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
 #include "driver/compiler_options_map-inl.h"
@@ -1095,6 +1096,7 @@ class Dex2Oat final {
     AssignIfExists(args, M::SwapFileFd, &swap_fd_);
     AssignIfExists(args, M::SwapDexSizeThreshold, &min_dex_file_cumulative_size_for_swap_);
     AssignIfExists(args, M::SwapDexCountThreshold, &min_dex_files_for_swap_);
+    AssignIfExists(args, M::CompilationCacheDir, &compilation_cache_dir_);
     AssignIfExists(args, M::VeryLargeAppThreshold, &very_large_threshold_);
     AssignIfExists(args, M::AppImageFile, &app_image_file_name_);
     AssignIfExists(args, M::AppImageFileFd, &app_image_fd_);
@@ -1918,6 +1920,10 @@ class Dex2Oat final {
                                      thread_count_,
                                      swap_fd_));
 
+    if (!compilation_cache_dir_.empty()) {
+      SetUpCompilationCache();
+    }
+
     driver_->PrepareDexFilesForOatFile(timings_);
 
     if (!IsBootImage() && !IsBootImageExtension()) {
@@ -1948,6 +1954,55 @@ class Dex2Oat final {
     return CompileDexFiles(dex_files);
   }
 
+  // Set up the persistent compilation cache. The environment key covers the compiler options,
+  // the target and the boot class path and image. Everything specific to a method, including
+  // the app classes it depends on, is part of the method key, so that entries can be reused
+  // across different versions of the compiled dex files.
+  void SetUpCompilationCache() {
+    TimingLogger::ScopedTiming t("Set up compilation cache", timings_);
+    std::ostringstream oss;
+    oss << "oat-version=" << reinterpret_cast<const char*>(OatHeader::kOatVersion.data())
+        << "\nisa=" << compiler_options_->GetInstructionSet()
+        << "\nisa-features=" << compiler_options_->GetInstructionSetFeatures()->GetFeatureString()
+        << "\nfilter=" << CompilerFilter::NameOfFilter(compiler_options_->GetCompilerFilter())
+        << "\ndebuggable=" << compiler_options_->GetDebuggable()
+        << "\nnative-debuggable=" << compiler_options_->GetNativeDebuggable()
+        << "\ndebug-info=" << compiler_options_->GetGenerateDebugInfo()
+        << "\nmini-debug-info=" << compiler_options_->GetGenerateMiniDebugInfo()
+        << "\ninline-max-code-units=" << compiler_options_->GetInlineMaxCodeUnits()
+        << "\nimplicit-checks=" << compiler_options_->GetImplicitNullChecks()
+        << compiler_options_->GetImplicitStackOverflowChecks()
+        << compiler_options_->GetImplicitSuspendChecks()
+        << "\nimage=" << IsBootImage() << IsBootImageExtension() << IsAppImage()
+        << "\nread-barrier=" << gUseReadBarrier;
+    auto it = key_value_store_->find(OatHeader::kBootClassPathChecksumsKey);
+    if (it != key_value_store_->end()) {
+      oss << "\n" << OatHeader::kBootClassPathChecksumsKey << "=" << it->second;
+    }
+    // Linker patches refer to boot class path dex files by index.
+    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+    const std::vector<const DexFile*>& boot_class_path = class_linker->GetBootClassPath();
+    for (const DexFile* dex_file : boot_class_path) {
+      oss << "\nbcp=" << dex_file->GetLocation();
+    }
+    for (const DexFile* dex_file : compiler_options_->GetNoInlineFromDexFile()) {
+      oss << "\nno-inline-from=" << dex_file->GetLocation();
+    }
+
+    std::string error_msg;
+    std::unique_ptr<CompilationCache> cache = CompilationCache::Create(
+        compilation_cache_dir_,
+        oss.str(),
+        compiler_options_->GetInstructionSet(),
+        boot_class_path,
+        &error_msg);
+    if (cache == nullptr) {
+      LOG(WARNING) << "Not using compilation cache: " << error_msg;
+      return;
+    }
+    driver_->SetCompilationCache(std::move(cache));
+  }
+
   // Create the class loader, use it to compile, and return.
   jobject CompileDexFiles(const std::vector<const DexFile*>& dex_files) {
     ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
@@ -2993,6 +3048,9 @@ class Dex2Oat final {
   int swap_fd_;
   size_t min_dex_files_for_swap_ = kDefaultMinDexFilesForSwap;
   size_t min_dex_file_cumulative_size_for_swap_ = kDefaultMinDexFileCumulativeSizeForSwap;
+
+  // Directory of the persistent compilation cache, if any.
+  std::string compilation_cache_dir_;
   size_t very_large_threshold_ = std::numeric_limits<size_t>::max();
   std::string app_image_file_name_;
   int app_image_fd_;
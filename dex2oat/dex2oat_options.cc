@@ -272,7 +272,13 @@ static void AddCompilerMappings(Builder& builder) {
       .Define("--preloaded-classes-fds=_")
           .WithType<std::vector<int>>().AppendValues()
           .WithHelp("Specify files containing list of classes preloaded in the zygote.")
-          .IntoKey(M::PreloadedClassesFds);
+          .IntoKey(M::PreloadedClassesFds)
+      .Define("--compilation-cache-dir=_")
+          .WithType<std::string>()
+          .WithHelp("Specify a directory used as a persistent cache of compiled methods.\n"
+                    "Methods found in the cache are not recompiled, and newly compiled methods\n"
+                    "are added to it. Eg: --compilation-cache-dir=/tmp/dex2oat-cache")
+          .IntoKey(M::CompilationCacheDir);
   // clang-format on
 }
 
@@ -0,0 +1,706 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compilation_cache.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <ostream>
+#include <unordered_set>
+
+#include "android-base/stringprintf.h"
+
+#include "art_field-inl.h"
+#include "art_method-inl.h"
+#include "base/array_ref.h"
+#include "base/casts.h"
+#include "base/data_hash.h"
+#include "base/os.h"
+#include "base/unix_file/fd_file.h"
+#include "base/utils.h"
+#include "class_linker-inl.h"
+#include "compiled_method-inl.h"
+#include "compiled_method_storage.h"
+#include "dex/code_item_accessors-inl.h"
+#include "dex/dex_file-inl.h"
+#include "dex/dex_instruction-inl.h"
+#include "driver/compiler_options.h"
+#include "gc/heap.h"
+#include "handle_scope-inl.h"
+#include "linker/linker_patch.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/dex_cache-inl.h"
+#include "mirror/iftable-inl.h"
+#include "profile/profile_compilation_info.h"
+#include "runtime.h"
+#include "stack_map.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+
+namespace {
+
+// Bump when the entry layout or the method key changes.
+static constexpr uint8_t kEntryMagic[] = { 'd', 'c', 'c', '\n', '0', '0', '3', '\0' };
+
+// Dex file index used for linker patches that do not reference a dex file.
+static constexpr uint32_t kNoDexFileIndex = static_cast<uint32_t>(-1);
+// Dex file index used for linker patches that reference the dex file of the compiled method.
+// Other values are indexes into the boot class path.
+static constexpr uint32_t kOwnDexFileIndex = static_cast<uint32_t>(-2);
+
+// Builds the method part of the cache key, see `CompilationCache::GetMethodKey()`.
+class MethodKeyBuilder {
+ public:
+  explicit MethodKeyBuilder(const CompilerOptions& compiler_options)
+      : compiler_options_(compiler_options),
+        class_linker_(Runtime::Current()->GetClassLinker()),
+        pointer_size_(class_linker_->GetImagePointerSize()) {}
+
+  void AddMethod(ArtMethod* method, size_t depth) REQUIRES_SHARED(Locks::mutator_lock_) {
+    key_ += method->PrettyMethod();
+    key_ += StringPrintf(":%x:%u;", method->GetAccessFlags(), GetVTableIndex(method));
+    AddClass(method->GetDeclaringClass());
+    const dex::CodeItem* code_item = method->GetCodeItem();
+    if (code_item == nullptr ||
+        (depth != 0u && IsInBootImage(method->GetDeclaringClass())) ||
+        !visited_methods_.insert(method).second) {
+      // The code of boot image methods is covered by the environment key.
+      return;
+    }
+    const DexFile& dex_file = *method->GetDexFile();
+    if (depth == 0u) {
+      dex_file_ = &dex_file;
+    }
+    if (&dex_file == dex_file_) {
+      keyed_methods_.push_back(method->GetDexMethodIndex());
+    }
+    AddProfileInfo(method);
+    key_ += "code=";
+    key_.append(reinterpret_cast<const char*>(code_item), dex_file.GetCodeItemSize(*code_item));
+    key_ += ';';
+
+    // Describe what each index used by the code resolves to. The compiler resolves the same
+    // entities, so this does not change what gets compiled.
+    Thread* self = Thread::Current();
+    StackHandleScope<2> hs(self);
+    Handle<mirror::DexCache> dex_cache(hs.NewHandle(method->GetDexCache()));
+    Handle<mirror::ClassLoader> class_loader(hs.NewHandle(method->GetClassLoader()));
+    for (const DexInstructionPcPair& inst : CodeItemInstructionAccessor(dex_file, code_item)) {
+      Instruction::IndexType index_type = Instruction::IndexTypeOf(inst->Opcode());
+      if (index_type == Instruction::kIndexNone || index_type == Instruction::kIndexUnknown) {
+        continue;
+      }
+      Instruction::Format format = Instruction::FormatOf(inst->Opcode());
+      uint32_t index = (format == Instruction::k22c) ? inst->VRegC() : inst->VRegB();
+      switch (index_type) {
+        case Instruction::kIndexStringRef:
+          key_ += "string=";
+          key_ += dex_file.GetStringData(dex::StringIndex(index));
+          key_ += ';';
+          break;
+        case Instruction::kIndexTypeRef: {
+          ObjPtr<mirror::Class> klass =
+              class_linker_->ResolveType(dex::TypeIndex(index), dex_cache, class_loader);
+          if (klass == nullptr) {
+            AddUnresolved(self, dex_file.StringByTypeIdx(dex::TypeIndex(index)));
+          } else {
+            AddClass(klass);
+          }
+          break;
+        }
+        case Instruction::kIndexFieldRef: {
+          ArtField* field = class_linker_->ResolveField(
+              index, dex_cache, class_loader, /*is_static=*/ format == Instruction::k21c);
+          if (field == nullptr) {
+            AddUnresolved(self, dex_file.PrettyField(index));
+          } else {
+            key_ += StringPrintf("field=%s:%x:%u;",
+                                 field->PrettyField().c_str(),
+                                 field->GetAccessFlags(),
+                                 field->GetOffset().Uint32Value());
+            AddClass(field->GetDeclaringClass());
+          }
+          break;
+        }
+        case Instruction::kIndexMethodRef:
+        case Instruction::kIndexMethodAndProtoRef: {
+          ArtMethod* callee =
+              class_linker_->ResolveMethodWithoutInvokeType(index, dex_cache, class_loader);
+          if (callee == nullptr) {
+            AddUnresolved(self, dex_file.PrettyMethod(index));
+          } else if (IsInlineCandidate(callee)) {
+            // The inliner has no fixed depth limit, so follow callees as deep as they go.
+            key_ += "callee=";
+            AddMethod(callee, depth + 1u);
+          } else {
+            key_ += "method=";
+            key_ += callee->PrettyMethod();
+            key_ += StringPrintf(":%x:%u;", callee->GetAccessFlags(), GetVTableIndex(callee));
+            AddClass(callee->GetDeclaringClass());
+          }
+          break;
+        }
+        default:
+          // Call sites, method handles and prototypes are described by the raw code item and
+          // the dex file data they refer to is not used for compiled code.
+          key_ += StringPrintf("index=%u:%u;", static_cast<uint32_t>(index_type), index);
+          break;
+      }
+    }
+  }
+
+  // Whether the method can be cached. The targets of profiled inline caches are not part of
+  // the key, so methods that use them cannot be cached.
+  bool IsCacheable() const {
+    return cacheable_;
+  }
+
+  std::string& GetKey() {
+    return key_;
+  }
+
+  // The indexes of the methods of the dex file of the keyed method whose code is part of the
+  // key, sorted.
+  std::vector<uint32_t>& GetKeyedMethods() {
+    std::sort(keyed_methods_.begin(), keyed_methods_.end());
+    return keyed_methods_;
+  }
+
+ private:
+  // Classes in the boot image are covered by the environment key. For other classes, record
+  // everything the compiler may rely on: status, hierarchy, object layout and vtable.
+  void AddClass(ObjPtr<mirror::Class> klass) REQUIRES_SHARED(Locks::mutator_lock_) {
+    while (klass->IsArrayClass()) {
+      key_ += '[';
+      klass = klass->GetComponentType();
+    }
+    std::string temp;
+    const char* descriptor = klass->GetDescriptor(&temp);
+    key_ += "class=";
+    key_ += descriptor;
+    key_ += ';';
+    if (klass->IsPrimitive() ||
+        IsInBootImage(klass) ||
+        !visited_classes_.insert(descriptor).second) {
+      return;
+    }
+    key_ += StringPrintf("{%u:%x:%u:",
+                         static_cast<uint32_t>(klass->GetStatus()),
+                         klass->GetAccessFlags(),
+                         klass->IsVariableSize() ? 0u : klass->GetObjectSize());
+    for (ObjPtr<mirror::Class> super = klass->GetSuperClass();
+         super != nullptr;
+         super = super->GetSuperClass()) {
+      key_ += super->GetDescriptor(&temp);
+    }
+    key_ += ':';
+    for (int32_t i = 0, count = klass->GetIfTableCount(); i != count; ++i) {
+      key_ += klass->GetIfTable()->GetInterface(i)->GetDescriptor(&temp);
+    }
+    for (ArtField& field : klass->GetIFields()) {
+      key_ += StringPrintf(":%s@%u", field.GetName(), field.GetOffset().Uint32Value());
+    }
+    for (ArtField& field : klass->GetSFields()) {
+      key_ += StringPrintf(":%s@%u", field.GetName(), field.GetOffset().Uint32Value());
+    }
+    for (int32_t i = 0, length = klass->GetVTableLength(); i != length; ++i) {
+      key_ += ':';
+      key_ += klass->GetVTableEntry(i, pointer_size_)->PrettyMethod();
+    }
+    key_ += "};";
+  }
+
+  static bool IsInBootImage(ObjPtr<mirror::Class> klass) REQUIRES_SHARED(Locks::mutator_lock_) {
+    return Runtime::Current()->GetHeap()->ObjectIsInBootImageSpace(klass);
+  }
+
+  void AddProfileInfo(ArtMethod* method) REQUIRES_SHARED(Locks::mutator_lock_) {
+    const ProfileCompilationInfo* profile = compiler_options_.GetProfileCompilationInfo();
+    if (profile == nullptr) {
+      return;
+    }
+    ProfileCompilationInfo::MethodHotness hotness = profile->GetMethodHotness(
+        MethodReference(method->GetDexFile(), method->GetDexMethodIndex()));
+    if (hotness.IsHot()) {
+      key_ += "hot;";
+      const ProfileCompilationInfo::InlineCacheMap* inline_caches = hotness.GetInlineCacheMap();
+      if (inline_caches != nullptr && !inline_caches->empty()) {
+        cacheable_ = false;
+      }
+    }
+  }
+
+  void AddUnresolved(Thread* self, const std::string& what)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    self->ClearException();
+    key_ += "unresolved=";
+    key_ += what;
+    key_ += ';';
+  }
+
+  uint32_t GetVTableIndex(ArtMethod* method) REQUIRES_SHARED(Locks::mutator_lock_) {
+    return (method->IsStatic() || method->IsDirect()) ? 0u : method->GetMethodIndex();
+  }
+
+  // Whether the inliner may inline the code of `callee`.
+  bool IsInlineCandidate(ArtMethod* callee) REQUIRES_SHARED(Locks::mutator_lock_) {
+    const dex::CodeItem* code_item = callee->GetCodeItem();
+    return code_item != nullptr &&
+           CodeItemInstructionAccessor(*callee->GetDexFile(), code_item).InsnsSizeInCodeUnits() <=
+               compiler_options_.GetInlineMaxCodeUnits();
+  }
+
+  const CompilerOptions& compiler_options_;
+  ClassLinker* const class_linker_;
+  const PointerSize pointer_size_;
+  bool cacheable_ = true;
+  const DexFile* dex_file_ = nullptr;
+  std::string key_;
+  std::vector<uint32_t> keyed_methods_;
+  std::unordered_set<ArtMethod*> visited_methods_;
+  std::unordered_set<std::string> visited_classes_;
+};
+
+class EntryWriter {
+ public:
+  void WriteU32(uint32_t value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    data_.insert(data_.end(), bytes, bytes + sizeof(value));
+  }
+
+  void WriteBytes(ArrayRef<const uint8_t> bytes) {
+    WriteU32(dchecked_integral_cast<uint32_t>(bytes.size()));
+    data_.insert(data_.end(), bytes.begin(), bytes.end());
+  }
+
+  const std::vector<uint8_t>& GetData() const {
+    return data_;
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+class EntryReader {
+ public:
+  explicit EntryReader(ArrayRef<const uint8_t> data) : data_(data), pos_(0u) {}
+
+  bool ReadU32(/*out*/ uint32_t* value) {
+    if (data_.size() - pos_ < sizeof(*value)) {
+      return false;
+    }
+    memcpy(value, data_.data() + pos_, sizeof(*value));
+    pos_ += sizeof(*value);
+    return true;
+  }
+
+  bool ReadBytes(/*out*/ ArrayRef<const uint8_t>* bytes) {
+    uint32_t size;
+    if (!ReadU32(&size) || data_.size() - pos_ < size) {
+      return false;
+    }
+    *bytes = data_.SubArray(pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  bool AtEnd() const {
+    return pos_ == data_.size();
+  }
+
+ private:
+  const ArrayRef<const uint8_t> data_;
+  size_t pos_;
+};
+
+ArrayRef<const uint8_t> AsBytes(const std::string& str) {
+  return ArrayRef<const uint8_t>(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+}
+
+// Returns the dex file that a patch refers to, or null if the patch does not reference one.
+const DexFile* GetPatchDexFile(const linker::LinkerPatch& patch) {
+  switch (patch.GetType()) {
+    case linker::LinkerPatch::Type::kMethodRelative:
+    case linker::LinkerPatch::Type::kMethodBssEntry:
+    case linker::LinkerPatch::Type::kJniEntrypointRelative:
+    case linker::LinkerPatch::Type::kCallRelative:
+      return patch.TargetMethod().dex_file;
+    case linker::LinkerPatch::Type::kTypeRelative:
+    case linker::LinkerPatch::Type::kTypeBssEntry:
+    case linker::LinkerPatch::Type::kPublicTypeBssEntry:
+    case linker::LinkerPatch::Type::kPackageTypeBssEntry:
+      return patch.TargetTypeDexFile();
+    case linker::LinkerPatch::Type::kStringRelative:
+    case linker::LinkerPatch::Type::kStringBssEntry:
+      return patch.TargetStringDexFile();
+    case linker::LinkerPatch::Type::kIntrinsicReference:
+    case linker::LinkerPatch::Type::kDataBimgRelRo:
+    case linker::LinkerPatch::Type::kCallEntrypoint:
+    case linker::LinkerPatch::Type::kBakerReadBarrierBranch:
+      return nullptr;
+  }
+}
+
+// Returns the two type-specific values of a patch, see `MakePatch()`.
+std::pair<uint32_t, uint32_t> GetPatchValues(const linker::LinkerPatch& patch) {
+  switch (patch.GetType()) {
+    case linker::LinkerPatch::Type::kIntrinsicReference:
+      return {patch.IntrinsicData(), patch.PcInsnOffset()};
+    case linker::LinkerPatch::Type::kDataBimgRelRo:
+      return {patch.BootImageOffset(), patch.PcInsnOffset()};
+    case linker::LinkerPatch::Type::kMethodRelative:
+    case linker::LinkerPatch::Type::kMethodBssEntry:
+    case linker::LinkerPatch::Type::kJniEntrypointRelative:
+      return {patch.TargetMethod().index, patch.PcInsnOffset()};
+    case linker::LinkerPatch::Type::kCallRelative:
+      return {patch.TargetMethod().index, 0u};
+    case linker::LinkerPatch::Type::kTypeRelative:
+    case linker::LinkerPatch::Type::kTypeBssEntry:
+    case linker::LinkerPatch::Type::kPublicTypeBssEntry:
+    case linker::LinkerPatch::Type::kPackageTypeBssEntry:
+      return {patch.TargetTypeIndex().index_, patch.PcInsnOffset()};
+    case linker::LinkerPatch::Type::kStringRelative:
+    case linker::LinkerPatch::Type::kStringBssEntry:
+      return {patch.TargetStringIndex().index_, patch.PcInsnOffset()};
+    case linker::LinkerPatch::Type::kCallEntrypoint:
+      return {patch.EntrypointOffset(), 0u};
+    case linker::LinkerPatch::Type::kBakerReadBarrierBranch:
+      return {patch.GetBakerCustomValue1(), patch.GetBakerCustomValue2()};
+  }
+}
+
+// Recreate a patch from the values returned by `GetPatchValues()`.
+bool MakePatch(uint32_t type,
+               uint32_t literal_offset,
+               const DexFile* dex_file,
+               uint32_t value1,
+               uint32_t value2,
+               /*out*/ linker::LinkerPatch* patch) {
+  using Type = linker::LinkerPatch::Type;
+  using LinkerPatch = linker::LinkerPatch;
+  if (!IsUint<24>(literal_offset)) {
+    return false;
+  }
+  switch (static_cast<Type>(type)) {
+    case Type::kIntrinsicReference:
+      *patch = LinkerPatch::IntrinsicReferencePatch(literal_offset, value2, value1);
+      return true;
+    case Type::kDataBimgRelRo:
+      *patch = LinkerPatch::DataBimgRelRoPatch(literal_offset, value2, value1);
+      return true;
+    case Type::kMethodRelative:
+      *patch = LinkerPatch::RelativeMethodPatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kMethodBssEntry:
+      *patch = LinkerPatch::MethodBssEntryPatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kJniEntrypointRelative:
+      *patch = LinkerPatch::RelativeJniEntrypointPatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kCallRelative:
+      *patch = LinkerPatch::RelativeCodePatch(literal_offset, dex_file, value1);
+      return dex_file != nullptr;
+    case Type::kTypeRelative:
+      *patch = LinkerPatch::RelativeTypePatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kTypeBssEntry:
+      *patch = LinkerPatch::TypeBssEntryPatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kPublicTypeBssEntry:
+      *patch = LinkerPatch::PublicTypeBssEntryPatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kPackageTypeBssEntry:
+      *patch = LinkerPatch::PackageTypeBssEntryPatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kStringRelative:
+      *patch = LinkerPatch::RelativeStringPatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kStringBssEntry:
+      *patch = LinkerPatch::StringBssEntryPatch(literal_offset, dex_file, value2, value1);
+      return dex_file != nullptr;
+    case Type::kCallEntrypoint:
+      *patch = LinkerPatch::CallEntrypointPatch(literal_offset, value1);
+      return true;
+    case Type::kBakerReadBarrierBranch:
+      *patch = LinkerPatch::BakerReadBarrierBranchPatch(literal_offset, value1, value2);
+      return true;
+  }
+  return false;
+}
+
+}  // anonymous namespace
+
+std::unique_ptr<CompilationCache> CompilationCache::Create(
+    const std::string& cache_dir,
+    const std::string& environment_key,
+    InstructionSet instruction_set,
+    const std::vector<const DexFile*>& boot_class_path,
+    /*out*/ std::string* error_msg) {
+  if (!OS::DirectoryExists(cache_dir.c_str())) {
+    *error_msg = "Compilation cache directory does not exist: " + cache_dir;
+    return nullptr;
+  }
+  if (access(cache_dir.c_str(), R_OK | W_OK | X_OK) != 0) {
+    *error_msg = "Compilation cache directory is not accessible: " + cache_dir;
+    return nullptr;
+  }
+  return std::unique_ptr<CompilationCache>(
+      new CompilationCache(cache_dir, environment_key, instruction_set, boot_class_path));
+}
+
+CompilationCache::CompilationCache(const std::string& cache_dir,
+                                   const std::string& environment_key,
+                                   InstructionSet instruction_set,
+                                   const std::vector<const DexFile*>& boot_class_path)
+    : cache_dir_(cache_dir),
+      environment_key_(environment_key),
+      instruction_set_(instruction_set),
+      boot_class_path_(boot_class_path),
+      hits_(0u),
+      misses_(0u),
+      stores_(0u),
+      rejected_stores_(0u),
+      failed_reads_(0u) {}
+
+bool CompilationCache::GetMethodKey(const CompilerOptions& compiler_options,
+                                    ArtMethod* method,
+                                    /*out*/ std::string* method_key,
+                                    /*out*/ std::vector<uint32_t>* keyed_methods) {
+  MethodKeyBuilder builder(compiler_options);
+  builder.AddMethod(method, /*depth=*/ 0u);
+  if (!builder.IsCacheable()) {
+    return false;
+  }
+  *method_key = std::move(builder.GetKey());
+  *keyed_methods = std::move(builder.GetKeyedMethods());
+  return true;
+}
+
+std::string CompilationCache::GetFullKey(const std::string& method_key) const {
+  std::string full_key = environment_key_;
+  full_key.push_back('\0');
+  full_key.append(method_key);
+  return full_key;
+}
+
+std::string CompilationCache::GetEntryPath(const std::string& full_key) const {
+  // Combine two independent hashes to make collisions between distinct keys unlikely. The full
+  // key is verified on lookup anyway.
+  uint32_t hash1 = DataHash()(full_key);
+  uint32_t hash2 = static_cast<uint32_t>(
+      DataHash::HashBytes(reinterpret_cast<const uint8_t*>(full_key.data()), full_key.size()));
+  return StringPrintf("%s/%08x%08x.dcc", cache_dir_.c_str(), hash1, hash2);
+}
+
+CompiledMethod* CompilationCache::Lookup(const std::string& method_key,
+                                         const DexFile* dex_file,
+                                         CompiledMethodStorage* storage) {
+  std::string full_key = GetFullKey(method_key);
+  std::string path = GetEntryPath(full_key);
+  std::unique_ptr<File> file(OS::OpenFileForReading(path.c_str()));
+  if (file == nullptr) {
+    misses_.fetch_add(1u, std::memory_order_relaxed);
+    return nullptr;
+  }
+  int64_t length = file->GetLength();
+  std::vector<uint8_t> data(std::max<int64_t>(length, 0));
+  if (length < 0 || !file->ReadFully(data.data(), data.size())) {
+    failed_reads_.fetch_add(1u, std::memory_order_relaxed);
+    misses_.fetch_add(1u, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  auto fail = [this]() {
+    failed_reads_.fetch_add(1u, std::memory_order_relaxed);
+    misses_.fetch_add(1u, std::memory_order_relaxed);
+    return nullptr;
+  };
+  EntryReader reader{ArrayRef<const uint8_t>(data)};
+  ArrayRef<const uint8_t> magic;
+  ArrayRef<const uint8_t> stored_key;
+  if (!reader.ReadBytes(&magic) ||
+      magic != ArrayRef<const uint8_t>(kEntryMagic) ||
+      !reader.ReadBytes(&stored_key)) {
+    return fail();
+  }
+  if (stored_key != AsBytes(full_key)) {
+    // Hash collision with a different method. Not an error.
+    misses_.fetch_add(1u, std::memory_order_relaxed);
+    return nullptr;
+  }
+  uint32_t is_intrinsic;
+  ArrayRef<const uint8_t> code;
+  ArrayRef<const uint8_t> vmap_table;
+  ArrayRef<const uint8_t> cfi_info;
+  uint32_t num_patches;
+  if (!reader.ReadU32(&is_intrinsic) ||
+      !reader.ReadBytes(&code) ||
+      !reader.ReadBytes(&vmap_table) ||
+      !reader.ReadBytes(&cfi_info) ||
+      !reader.ReadU32(&num_patches) ||
+      code.empty()) {
+    return fail();
+  }
+  std::vector<linker::LinkerPatch> patches;
+  patches.reserve(std::min<uint32_t>(num_patches, data.size()));
+  for (uint32_t i = 0; i != num_patches; ++i) {
+    uint32_t type;
+    uint32_t literal_offset;
+    uint32_t dex_file_index;
+    uint32_t value1;
+    uint32_t value2;
+    if (!reader.ReadU32(&type) ||
+        !reader.ReadU32(&literal_offset) ||
+        !reader.ReadU32(&dex_file_index) ||
+        !reader.ReadU32(&value1) ||
+        !reader.ReadU32(&value2)) {
+      return fail();
+    }
+    const DexFile* target_dex_file = nullptr;
+    if (dex_file_index == kOwnDexFileIndex) {
+      target_dex_file = dex_file;
+    } else if (dex_file_index != kNoDexFileIndex) {
+      if (dex_file_index >= boot_class_path_.size()) {
+        return fail();
+      }
+      target_dex_file = boot_class_path_[dex_file_index];
+    }
+    linker::LinkerPatch patch = linker::LinkerPatch::CallEntrypointPatch(0u, 0u);
+    if (!MakePatch(type, literal_offset, target_dex_file, value1, value2, &patch)) {
+      return fail();
+    }
+    patches.push_back(patch);
+  }
+  if (!reader.AtEnd()) {
+    return fail();
+  }
+
+  hits_.fetch_add(1u, std::memory_order_relaxed);
+  return storage->CreateCompiledMethod(instruction_set_,
+                                       code,
+                                       vmap_table,
+                                       cfi_info,
+                                       ArrayRef<const linker::LinkerPatch>(patches),
+                                       is_intrinsic != 0u);
+}
+
+void CompilationCache::Store(const std::string& method_key,
+                             ArrayRef<const uint32_t> keyed_methods,
+                             const DexFile* dex_file,
+                             const CompiledMethod* compiled_method) {
+  DCHECK_EQ(compiled_method->GetInstructionSet(), instruction_set_);
+  DCHECK(std::is_sorted(keyed_methods.begin(), keyed_methods.end()));
+  // Stack maps of code inlined from other non-boot dex files refer to them by their index in
+  // the oat file, which is not part of the key. Code inlined from the same dex file must be
+  // part of the key. This is not the case for a method the inliner found other than through
+  // the invokes of keyed code, such as the override called for a known receiver type.
+  if (!compiled_method->GetVmapTable().empty()) {
+    CodeInfo code_info(compiled_method->GetVmapTable().data());
+    for (StackMap stack_map : code_info.GetStackMaps()) {
+      for (InlineInfo inline_info : code_info.GetInlineInfosOf(stack_map)) {
+        if (inline_info.EncodesArtMethod()) {
+          continue;
+        }
+        MethodInfo method_info = code_info.GetMethodInfoOf(inline_info);
+        if (method_info.GetDexFileIndexKind() != MethodInfo::kKindNonBCP) {
+          // The boot class path is covered by the environment key.
+          continue;
+        }
+        if (method_info.GetDexFileIndex() != MethodInfo::kSameDexFile ||
+            !std::binary_search(
+                keyed_methods.begin(), keyed_methods.end(), method_info.GetMethodIndex())) {
+          rejected_stores_.fetch_add(1u, std::memory_order_relaxed);
+          return;
+        }
+      }
+    }
+  }
+  std::string full_key = GetFullKey(method_key);
+  EntryWriter writer;
+  writer.WriteBytes(ArrayRef<const uint8_t>(kEntryMagic));
+  writer.WriteBytes(AsBytes(full_key));
+  writer.WriteU32(compiled_method->IsIntrinsic() ? 1u : 0u);
+  writer.WriteBytes(compiled_method->GetQuickCode());
+  writer.WriteBytes(compiled_method->GetVmapTable());
+  writer.WriteBytes(compiled_method->GetCFIInfo());
+  ArrayRef<const linker::LinkerPatch> patches = compiled_method->GetPatches();
+  writer.WriteU32(dchecked_integral_cast<uint32_t>(patches.size()));
+  for (const linker::LinkerPatch& patch : patches) {
+    uint32_t dex_file_index = kNoDexFileIndex;
+    const DexFile* target_dex_file = GetPatchDexFile(patch);
+    if (target_dex_file != nullptr && target_dex_file == dex_file) {
+      dex_file_index = kOwnDexFileIndex;
+    } else if (target_dex_file != nullptr) {
+      auto it = std::find(boot_class_path_.begin(), boot_class_path_.end(), target_dex_file);
+      if (it == boot_class_path_.end()) {
+        // We cannot describe this dex file in a way that is stable across invocations.
+        rejected_stores_.fetch_add(1u, std::memory_order_relaxed);
+        return;
+      }
+      dex_file_index =
+          dchecked_integral_cast<uint32_t>(std::distance(boot_class_path_.begin(), it));
+    }
+    std::pair<uint32_t, uint32_t> values = GetPatchValues(patch);
+    writer.WriteU32(static_cast<uint32_t>(patch.GetType()));
+    writer.WriteU32(dchecked_integral_cast<uint32_t>(patch.LiteralOffset()));
+    writer.WriteU32(dex_file_index);
+    writer.WriteU32(values.first);
+    writer.WriteU32(values.second);
+  }
+
+  // Write to a unique temporary file and rename it into place so that readers never see a
+  // partially written entry.
+  std::string path = GetEntryPath(full_key);
+  std::string temp_path = StringPrintf("%s.%d.%u.tmp", path.c_str(), getpid(), GetTid());
+  std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(temp_path.c_str()));
+  if (file == nullptr) {
+    PLOG(WARNING) << "Failed to create compilation cache entry " << temp_path;
+    return;
+  }
+  const std::vector<uint8_t>& data = writer.GetData();
+  if (!file->WriteFully(data.data(), data.size()) || file->FlushClose() != 0) {
+    PLOG(WARNING) << "Failed to write compilation cache entry " << temp_path;
+    file->Erase(/*unlink=*/ true);
+    return;
+  }
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    PLOG(WARNING) << "Failed to rename compilation cache entry " << temp_path;
+    unlink(temp_path.c_str());
+    return;
+  }
+  stores_.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void CompilationCache::DumpStats(std::ostream& os) const {
+  size_t hits = GetHits();
+  size_t misses = GetMisses();
+  size_t lookups = hits + misses;
+  os << "Compilation cache " << cache_dir_ << ": "
+     << hits << " hits, " << misses << " misses";
+  if (lookups != 0u) {
+    os << " (" << (100.0 * hits / lookups) << "% hit rate)";
+  }
+  os << ", " << GetStores() << " stores, "
+     << rejected_stores_.load(std::memory_order_relaxed) << " uncacheable, "
+     << failed_reads_.load(std::memory_order_relaxed) << " corrupt entries";
+}
+
+}  // namespace art
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_DEX2OAT_DRIVER_COMPILATION_CACHE_H_
+#define ART_DEX2OAT_DRIVER_COMPILATION_CACHE_H_
+
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arch/instruction_set.h"
+#include "base/array_ref.h"
+#include "base/locks.h"
+#include "base/macros.h"
+
+namespace art {
+
+class ArtMethod;
+class CompiledMethod;
+class CompiledMethodStorage;
+class CompilerOptions;
+class DexFile;
+
+// A persistent, content-addressed cache of compiled methods, backed by a local directory.
+//
+// Each entry is stored in its own file, named after a hash of the entry key. The full key is
+// stored in the entry and compared on lookup, so hash collisions only cause cache misses.
+// The key consists of an environment key shared by all methods of a dex2oat invocation
+// (instruction set and features, compiler options and the boot class path and image) and a
+// method key. The method key does not depend on the checksums of the dex files, so entries
+// can be reused across variants of an app that share code. Instead, it describes the method
+// (its signature, access flags and raw code item) and the resolved entities its code, or code
+// it may inline, depends on: string contents, the layout and status of referenced classes,
+// field offsets, vtable indexes and the code of small callees, at any depth. See
+// `GetMethodKey()`.
+//
+// Linker patches refer either to the dex file of the compiled method or to a boot class path
+// dex file by index. Methods that inline code from other dex files, or code that is not part
+// of the key, are not cached.
+//
+// Entries are written to a temporary file and renamed into place, so concurrent dex2oat
+// invocations sharing a cache directory never observe partially written entries.
+class CompilationCache {
+ public:
+  static std::unique_ptr<CompilationCache> Create(
+      const std::string& cache_dir,
+      const std::string& environment_key,
+      InstructionSet instruction_set,
+      const std::vector<const DexFile*>& boot_class_path,
+      /*out*/ std::string* error_msg);
+
+  // Compute the method part of the cache key. This resolves the types, fields and methods
+  // referenced by the method, as the compiler does. Returns false if the method should not
+  // be cached, for example because the profile has inline caches for it. `keyed_methods`
+  // receives the sorted indexes of the methods of the same dex file whose code is in the key.
+  static bool GetMethodKey(const CompilerOptions& compiler_options,
+                           ArtMethod* method,
+                           /*out*/ std::string* method_key,
+                           /*out*/ std::vector<uint32_t>* keyed_methods)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Look up a compiled method of `dex_file`. Returns null on cache miss.
+  CompiledMethod* Lookup(const std::string& method_key,
+                         const DexFile* dex_file,
+                         CompiledMethodStorage* storage);
+
+  // Store a compiled method of `dex_file`. Methods with linker patches or inlined frames that
+  // refer to dex files other than `dex_file` and the boot class path are not cached, nor are
+  // methods with inlined frames of `dex_file` methods missing from `keyed_methods`, as
+  // returned by `GetMethodKey()`.
+  void Store(const std::string& method_key,
+             ArrayRef<const uint32_t> keyed_methods,
+             const DexFile* dex_file,
+             const CompiledMethod* compiled_method);
+
+  void DumpStats(std::ostream& os) const;
+
+  size_t GetHits() const {
+    return hits_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetMisses() const {
+    return misses_.load(std::memory_order_relaxed);
+  }
+
+  size_t GetStores() const {
+    return stores_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  CompilationCache(const std::string& cache_dir,
+                   const std::string& environment_key,
+                   InstructionSet instruction_set,
+                   const std::vector<const DexFile*>& boot_class_path);
+
+  std::string GetFullKey(const std::string& method_key) const;
+  std::string GetEntryPath(const std::string& full_key) const;
+
+  const std::string cache_dir_;
+  const std::string environment_key_;
+  const InstructionSet instruction_set_;
+  const std::vector<const DexFile*> boot_class_path_;
+
+  std::atomic<size_t> hits_;
+  std::atomic<size_t> misses_;
+  std::atomic<size_t> stores_;
+  std::atomic<size_t> rejected_stores_;
+  std::atomic<size_t> failed_reads_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompilationCache);
+};
+
+}  // namespace art
+
+#endif  // ART_DEX2OAT_DRIVER_COMPILATION_CACHE_H_
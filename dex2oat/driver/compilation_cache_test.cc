@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compilation_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "base/common_art_test.h"
+#include "compiled_method-inl.h"
+#include "compiled_method_storage.h"
+#include "dex/dex_file.h"
+#include "linker/linker_patch.h"
+
+namespace art {
+
+class CompilationCacheTest : public CommonArtTest {};
+
+TEST(CompilationCache, StoreAndLookup) {
+  ScratchDir cache_dir;
+  CompiledMethodStorage storage(/* swap_fd= */ -1);
+  std::string error_msg;
+  std::unique_ptr<CompilationCache> cache = CompilationCache::Create(
+      cache_dir.GetPath(), "env1", InstructionSet::kArm64, /*boot_class_path=*/ {}, &error_msg);
+  ASSERT_TRUE(cache != nullptr) << error_msg;
+
+  const uint8_t raw_code[] = { 1u, 2u, 3u, 4u };
+  const uint8_t raw_cfi_info[] = { 1u, 3u, 5u };
+  const linker::LinkerPatch raw_patches[] = {
+      linker::LinkerPatch::IntrinsicReferencePatch(0u, 4u, 7u),
+      linker::LinkerPatch::CallEntrypointPatch(8u, 16u),
+      linker::LinkerPatch::BakerReadBarrierBranchPatch(12u, 1u, 2u),
+  };
+  CompiledMethod* method = storage.CreateCompiledMethod(
+      InstructionSet::kArm64,
+      ArrayRef<const uint8_t>(raw_code),
+      /*vmap_table=*/ ArrayRef<const uint8_t>(),
+      ArrayRef<const uint8_t>(raw_cfi_info),
+      ArrayRef<const linker::LinkerPatch>(raw_patches),
+      /*is_intrinsic=*/ false);
+
+  EXPECT_EQ(nullptr, cache->Lookup("method1", /*dex_file=*/ nullptr, &storage));
+  cache->Store("method1", /*keyed_methods=*/ {}, /*dex_file=*/ nullptr, method);
+  EXPECT_EQ(1u, cache->GetStores());
+
+  CompiledMethod* cached = cache->Lookup("method1", /*dex_file=*/ nullptr, &storage);
+  ASSERT_TRUE(cached != nullptr);
+  EXPECT_EQ(method->GetInstructionSet(), cached->GetInstructionSet());
+  EXPECT_EQ(method->GetQuickCode(), cached->GetQuickCode());
+  EXPECT_EQ(method->GetVmapTable(), cached->GetVmapTable());
+  EXPECT_EQ(method->GetCFIInfo(), cached->GetCFIInfo());
+  EXPECT_EQ(method->GetPatches(), cached->GetPatches());
+  EXPECT_FALSE(cached->IsIntrinsic());
+  EXPECT_EQ(1u, cache->GetHits());
+  EXPECT_EQ(1u, cache->GetMisses());
+
+  // Other methods and other environments do not see the entry.
+  EXPECT_EQ(nullptr, cache->Lookup("method2", /*dex_file=*/ nullptr, &storage));
+  std::unique_ptr<CompilationCache> other_cache = CompilationCache::Create(
+      cache_dir.GetPath(), "env2", InstructionSet::kArm64, /*boot_class_path=*/ {}, &error_msg);
+  ASSERT_TRUE(other_cache != nullptr) << error_msg;
+  EXPECT_EQ(nullptr, other_cache->Lookup("method1", /*dex_file=*/ nullptr, &storage));
+
+  // A new cache instance with the same environment sees the entry.
+  std::unique_ptr<CompilationCache> same_cache = CompilationCache::Create(
+      cache_dir.GetPath(), "env1", InstructionSet::kArm64, /*boot_class_path=*/ {}, &error_msg);
+  ASSERT_TRUE(same_cache != nullptr) << error_msg;
+  CompiledMethod* cached2 = same_cache->Lookup("method1", /*dex_file=*/ nullptr, &storage);
+  ASSERT_TRUE(cached2 != nullptr);
+  EXPECT_EQ(method->GetQuickCode(), cached2->GetQuickCode());
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, cached2);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, cached);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, method);
+}
+
+TEST_F(CompilationCacheTest, DexFilePatches) {
+  std::unique_ptr<const DexFile> main(OpenTestDexFile("Main"));
+  std::unique_ptr<const DexFile> other_main(OpenTestDexFile("Main"));
+  std::unique_ptr<const DexFile> nested(OpenTestDexFile("Nested"));
+  std::unique_ptr<const DexFile> statics(OpenTestDexFile("Statics"));
+  ScratchDir cache_dir;
+  CompiledMethodStorage storage(/* swap_fd= */ -1);
+  std::string error_msg;
+  std::unique_ptr<CompilationCache> cache = CompilationCache::Create(
+      cache_dir.GetPath(), "env", InstructionSet::kArm64, { nested.get() }, &error_msg);
+  ASSERT_TRUE(cache != nullptr) << error_msg;
+
+  const uint8_t raw_code[] = { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u };
+  const linker::LinkerPatch raw_patches[] = {
+      linker::LinkerPatch::StringBssEntryPatch(0u, main.get(), 0u, 1u),
+      linker::LinkerPatch::StringBssEntryPatch(4u, nested.get(), 4u, 2u),
+  };
+  CompiledMethod* method = storage.CreateCompiledMethod(
+      InstructionSet::kArm64,
+      ArrayRef<const uint8_t>(raw_code),
+      /*vmap_table=*/ ArrayRef<const uint8_t>(),
+      /*cfi_info=*/ ArrayRef<const uint8_t>(),
+      ArrayRef<const linker::LinkerPatch>(raw_patches),
+      /*is_intrinsic=*/ false);
+  cache->Store("method", /*keyed_methods=*/ {}, main.get(), method);
+  EXPECT_EQ(1u, cache->GetStores());
+
+  // Patches to the method's own dex file follow the dex file of the lookup, while patches to
+  // the boot class path keep their target.
+  CompiledMethod* cached = cache->Lookup("method", other_main.get(), &storage);
+  ASSERT_TRUE(cached != nullptr);
+  ArrayRef<const linker::LinkerPatch> patches = cached->GetPatches();
+  ASSERT_EQ(2u, patches.size());
+  EXPECT_EQ(other_main.get(), patches[0].TargetStringDexFile());
+  EXPECT_EQ(nested.get(), patches[1].TargetStringDexFile());
+
+  // Patches to other dex files cannot be described independently of the invocation.
+  const linker::LinkerPatch other_patches[] = {
+      linker::LinkerPatch::StringBssEntryPatch(0u, statics.get(), 0u, 1u),
+  };
+  CompiledMethod* other_method = storage.CreateCompiledMethod(
+      InstructionSet::kArm64,
+      ArrayRef<const uint8_t>(raw_code),
+      /*vmap_table=*/ ArrayRef<const uint8_t>(),
+      /*cfi_info=*/ ArrayRef<const uint8_t>(),
+      ArrayRef<const linker::LinkerPatch>(other_patches),
+      /*is_intrinsic=*/ false);
+  cache->Store("other_method", /*keyed_methods=*/ {}, main.get(), other_method);
+  EXPECT_EQ(1u, cache->GetStores());
+  EXPECT_EQ(nullptr, cache->Lookup("other_method", main.get(), &storage));
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, other_method);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, cached);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(&storage, method);
+}
+
+TEST(CompilationCache, MissingDirectory) {
+  std::string error_msg;
+  std::unique_ptr<CompilationCache> cache = CompilationCache::Create(
+      "/nonexistent/dex2oat-cache",
+      "env",
+      InstructionSet::kArm64,
+      /*boot_class_path=*/ {},
+      &error_msg);
+  EXPECT_TRUE(cache == nullptr);
+  EXPECT_FALSE(error_msg.empty());
+}
+
+}  // namespace art
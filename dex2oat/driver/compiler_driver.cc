@@ -22,6 +22,9 @@
 #include <malloc.h>  // For mallinfo
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <set>
 #include <string_view>
 #include <vector>
 
@@ -34,6 +37,7 @@
 #include "base/arena_allocator.h"
 #include "base/array_ref.h"
 #include "base/bit_vector.h"
+#include "base/casts.h"
 #include "base/enums.h"
 #include "base/hash_set.h"
 #include "base/logging.h"  // For VLOG
@@ -43,6 +47,7 @@
 #include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "class_linker-inl.h"
+#include "compilation_cache.h"
 #include "compiled_method-inl.h"
 #include "compiler.h"
 #include "compiler_callbacks.h"
@@ -350,6 +355,12 @@ void CompilerDriver::CompileAll(jobject class_loader,
   if (GetCompilerOptions().GetDumpStats()) {
     stats_->Dump();
   }
+  if (compilation_cache_ != nullptr &&
+      (GetCompilerOptions().GetDumpStats() || VLOG_IS_ON(compiler))) {
+    std::ostringstream oss;
+    compilation_cache_->DumpStats(oss);
+    LOG(INFO) << oss.str();
+  }
 }
 
 // Does the runtime for the InstructionSet provide an implementation returned by
@@ -459,7 +470,7 @@ static void CompileMethodQuick(
     const DexFile& dex_file,
     Handle<mirror::DexCache> dex_cache,
     ProfileCompilationInfo::ProfileIndexType profile_index) {
-  auto quick_fn = [profile_index]([[maybe_unused]] Thread* self,
+  auto quick_fn = [profile_index](Thread* self,
                                   CompilerDriver* driver,
                                   const dex::CodeItem* code_item,
                                   uint32_t access_flags,
@@ -508,15 +519,39 @@ static void CompileMethodQuick(
       compile = compile && ShouldCompileBasedOnProfile(compiler_options, profile_index, method_ref);
 
       if (compile) {
-        // NOTE: if compiler declines to compile this method, it will return null.
-        compiled_method = driver->GetCompiler()->Compile(code_item,
-                                                         access_flags,
-                                                         invoke_type,
-                                                         class_def_idx,
-                                                         method_idx,
-                                                         class_loader,
-                                                         dex_file,
-                                                         dex_cache);
+        CompilationCache* cache = driver->GetCompilationCache();
+        std::string cache_key;
+        std::vector<uint32_t> cache_keyed_methods;
+        if (cache != nullptr) {
+          ScopedObjectAccess soa(self);
+          ArtMethod* method = Runtime::Current()->GetClassLinker()->LookupResolvedMethod(
+              method_idx, dex_cache.Get(), class_loader.Get());
+          if (method == nullptr ||
+              !CompilationCache::GetMethodKey(
+                  compiler_options, method, &cache_key, &cache_keyed_methods)) {
+            cache = nullptr;
+          }
+        }
+        if (cache != nullptr) {
+          compiled_method = cache->Lookup(cache_key, &dex_file, driver->GetCompiledMethodStorage());
+        }
+        if (compiled_method == nullptr) {
+          // NOTE: if compiler declines to compile this method, it will return null.
+          compiled_method = driver->GetCompiler()->Compile(code_item,
+                                                           access_flags,
+                                                           invoke_type,
+                                                           class_def_idx,
+                                                           method_idx,
+                                                           class_loader,
+                                                           dex_file,
+                                                           dex_cache);
+          if (cache != nullptr && compiled_method != nullptr) {
+            cache->Store(cache_key,
+                         ArrayRef<const uint32_t>(cache_keyed_methods),
+                         &dex_file,
+                         compiled_method);
+          }
+        }
         ProfileMethodsCheck check_type = compiler_options.CheckProfiledMethodsCompiled();
         if (UNLIKELY(check_type != ProfileMethodsCheck::kNone)) {
           DCHECK(ShouldCompileBasedOnProfile(compiler_options, profile_index, method_ref));
@@ -1720,6 +1755,53 @@ static void LoadAndUpdateStatus(const ClassAccessor& accessor,
   }
 }
 
+// A class whose superclass or interface needs to be verified again is verified again too, so
+// that it observes the new status of its supertypes. Returns the number of classes added to
+// `invalid_classes`.
+static size_t InvalidateSubclassesOfInvalidClasses(
+    const std::vector<const DexFile*>& dex_files,
+    /*inout*/ std::vector<std::vector<bool>>* invalid_classes) {
+  std::set<std::string_view> invalid_descriptors;
+  for (size_t i = 0, size = dex_files.size(); i != size; ++i) {
+    for (ClassAccessor accessor : dex_files[i]->GetClasses()) {
+      if ((*invalid_classes)[i][accessor.GetClassDefIndex()]) {
+        invalid_descriptors.insert(accessor.GetDescriptor());
+      }
+    }
+  }
+  size_t num_added = 0u;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 0, size = dex_files.size(); i != size; ++i) {
+      const DexFile& dex_file = *dex_files[i];
+      for (ClassAccessor accessor : dex_file.GetClasses()) {
+        uint32_t class_def_index = accessor.GetClassDefIndex();
+        if ((*invalid_classes)[i][class_def_index]) {
+          continue;
+        }
+        const dex::ClassDef& class_def = accessor.GetClassDef();
+        bool invalid =
+            class_def.superclass_idx_.IsValid() &&
+            ContainsElement(invalid_descriptors,
+                            dex_file.StringByTypeIdx(class_def.superclass_idx_));
+        const dex::TypeList* interfaces = dex_file.GetInterfacesList(class_def);
+        for (uint32_t j = 0; !invalid && interfaces != nullptr && j != interfaces->Size(); ++j) {
+          invalid = ContainsElement(invalid_descriptors,
+                                    dex_file.StringByTypeIdx(interfaces->GetTypeItem(j).type_idx_));
+        }
+        if (invalid) {
+          (*invalid_classes)[i][class_def_index] = true;
+          invalid_descriptors.insert(accessor.GetDescriptor());
+          ++num_added;
+          changed = true;
+        }
+      }
+    }
+  }
+  return num_added;
+}
+
 bool CompilerDriver::FastVerify(jobject jclass_loader,
                                 const std::vector<const DexFile*>& dex_files,
                                 TimingLogger* timings) {
@@ -1737,19 +1819,28 @@ bool CompilerDriver::FastVerify(jobject jclass_loader,
       hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
   std::string error_msg;
 
-  if (!verifier_deps->ValidateDependencies(
-      soa.Self(),
-      class_loader,
-      dex_files,
-      &error_msg)) {
-    // Clear the information we have as we are going to re-verify and we do not
-    // want to keep that a class is verified.
-    verifier_deps->ClearData(dex_files);
-    LOG(WARNING) << "Fast verification failed: " << error_msg;
-    return false;
-  }
-
+  // Validate the dependencies class by class, so that a change in the class path or in a few
+  // classes only requires re-verifying the affected classes.
+  std::vector<std::vector<bool>> invalid_classes;
+  size_t num_invalid_classes = verifier_deps->ValidateDependenciesPerClass(
+      soa.Self(), class_loader, dex_files, &invalid_classes, &error_msg);
+  if (num_invalid_classes != 0u) {
+    num_invalid_classes += InvalidateSubclassesOfInvalidClasses(dex_files, &invalid_classes);
+    size_t num_classes = 0u;
+    for (size_t i = 0, size = dex_files.size(); i != size; ++i) {
+      num_classes += dex_files[i]->NumClassDefs();
+      // Clear the information we have for invalidated classes as we are going to re-verify
+      // them and we do not want to keep that they are verified.
+      verifier_deps->ClearClassData(*dex_files[i], invalid_classes[i]);
+    }
+    LOG(WARNING) << "Fast verification failed for " << num_invalid_classes << " of "
+                 << num_classes << " classes, verifying them again: " << error_msg;
+  }
+
+  // When only some classes need to be verified again, the regular verification that follows
+  // must see the status of the others, so we need to load them.
   bool compiler_only_verifies =
+      num_invalid_classes == 0u &&
       !GetCompilerOptions().IsAnyCompilationEnabled() &&
       !GetCompilerOptions().IsGeneratingImage();
 
@@ -1760,11 +1851,16 @@ bool CompilerDriver::FastVerify(jobject jclass_loader,
   // could not be fully verified; we could try again, but that would hurt verification
   // time. So instead we assume these classes still need to be verified at
   // runtime.
-  for (const DexFile* dex_file : dex_files) {
+  for (size_t i = 0, size = dex_files.size(); i != size; ++i) {
+    const DexFile* dex_file = dex_files[i];
     // Fetch the list of verified classes.
     const std::vector<bool>& verified_classes = verifier_deps->GetVerifiedClasses(*dex_file);
     DCHECK_EQ(verified_classes.size(), dex_file->NumClassDefs());
     for (ClassAccessor accessor : dex_file->GetClasses()) {
+      if (num_invalid_classes != 0u && invalid_classes[i][accessor.GetClassDefIndex()]) {
+        // Leave the class to the regular verification.
+        continue;
+      }
       ClassStatus status = verified_classes[accessor.GetClassDefIndex()]
           ? ClassStatus::kVerifiedNeedsAccessChecks
           : ClassStatus::kRetryVerificationAtRuntime;
@@ -1803,10 +1899,16 @@ bool CompilerDriver::FastVerify(jobject jclass_loader,
       if (status == ClassStatus::kRetryVerificationAtRuntime) {
         ClassReference ref(dex_file, accessor.GetClassDefIndex());
         callbacks->AddUncompilableClass(ref);
+        if (num_invalid_classes != 0u) {
+          // The regular verification that follows reports this class as a soft failure again,
+          // but the failure was already there when the vdex was created.
+          unverified_classes_from_vdex_.insert(ref);
+        }
       }
     }
   }
-  return true;
+  // Verify the invalidated classes, if any, through the regular path.
+  return num_invalid_classes == 0u;
 }
 
 void CompilerDriver::Verify(jobject jclass_loader,
@@ -1914,7 +2016,9 @@ class VerifyClassVisitor : public CompilationVisitor {
           break;
         }
         case verifier::FailureKind::kSoftFailure: {
-          manager_->GetCompiler()->AddSoftVerifierFailure();
+          if (!manager_->GetCompiler()->IsUnverifiedClassFromVdex(ref)) {
+            manager_->GetCompiler()->AddSoftVerifierFailure();
+          }
           break;
         }
         case verifier::FailureKind::kTypeChecksFailure: {
@@ -1946,7 +2050,8 @@ class VerifyClassVisitor : public CompilationVisitor {
         CHECK(soa.Self()->IsExceptionPending());
         soa.Self()->ClearException();
         manager_->GetCompiler()->SetHadHardVerifierFailure();
-      } else if (failure_kind == verifier::FailureKind::kSoftFailure) {
+      } else if (failure_kind == verifier::FailureKind::kSoftFailure &&
+                 !manager_->GetCompiler()->IsUnverifiedClassFromVdex(ref)) {
         manager_->GetCompiler()->AddSoftVerifierFailure();
       }
 
@@ -2567,6 +2672,43 @@ void CompilerDriver::InitializeClasses(jobject class_loader,
   }
 }
 
+// A single method to compile, collected from a class def that passed the SkipClass checks.
+struct MethodCompilationItem {
+  const dex::CodeItem* code_item;
+  uint32_t access_flags;
+  InvokeType invoke_type;
+  uint16_t class_def_index;
+  uint32_t method_idx;
+  // Estimated relative compilation cost, used to schedule expensive methods first.
+  uint32_t cost;
+};
+
+// Estimate the relative cost of compiling a method. The estimate only needs to be good enough
+// to start the largest methods early so that they do not end up as stragglers at the end of
+// the parallel compilation, leaving the other threads idle.
+static uint32_t EstimateCompilationCost(const CompilerOptions& compiler_options,
+                                        ProfileCompilationInfo::ProfileIndexType profile_index,
+                                        const ClassAccessor::Method& method) {
+  // Native methods only get a small JNI stub, if anything.
+  static constexpr uint32_t kJniStubCost = 16u;
+  // Methods that we skip (abstract, not in the profile) are nearly free.
+  static constexpr uint32_t kSkippedMethodCost = 1u;
+  if ((method.GetAccessFlags() & kAccNative) != 0) {
+    return kJniStubCost;
+  }
+  if (method.GetCodeItem() == nullptr) {
+    return kSkippedMethodCost;
+  }
+  if (profile_index != ProfileCompilationInfo::MaxProfileIndex() &&
+      !compiler_options.GetProfileCompilationInfo()->IsHotMethod(profile_index,
+                                                                 method.GetIndex())) {
+    return kSkippedMethodCost;
+  }
+  // The optimizing compiler is roughly linear in the size of the graph, so the number of code
+  // units is a reasonable proxy. Add the fixed per-method overhead.
+  return kJniStubCost + method.GetInstructions().InsnsSizeInCodeUnits();
+}
+
 template <typename CompileFn>
 static void CompileDexFile(CompilerDriver* driver,
                            jobject class_loader,
@@ -2591,9 +2733,12 @@ static void CompileDexFile(CompilerDriver* driver,
       ? compiler_options.GetProfileCompilationInfo()->FindDexFile(dex_file)
       : ProfileCompilationInfo::MaxProfileIndex();
 
-  auto compile = [&context, &compile_fn, profile_index](size_t class_def_index) {
+  // First, collect the methods to compile. Each class def fills only its own slot, so no
+  // synchronization is needed between the workers.
+  std::vector<std::vector<MethodCompilationItem>> methods_per_class(dex_file.NumClassDefs());
+  auto collect = [&context, &compiler_options, &methods_per_class, profile_index](
+      size_t class_def_index) {
     const DexFile& dex_file = *context.GetDexFile();
-    SCOPED_TRACE << "compile " << dex_file.GetLocation() << "@" << class_def_index;
     ClassLinker* class_linker = context.GetClassLinker();
     jobject jclass_loader = context.GetClassLoader();
     ClassReference ref(&dex_file, class_def_index);
@@ -2605,36 +2750,31 @@ static void CompileDexFile(CompilerDriver* driver,
     if (driver->GetVerificationResults()->IsClassRejected(ref)) {
       return;
     }
-    // Use a scoped object access to perform to the quick SkipClass check.
-    ScopedObjectAccess soa(Thread::Current());
-    StackHandleScope<3> hs(soa.Self());
-    Handle<mirror::ClassLoader> class_loader(
-        hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
-    Handle<mirror::Class> klass(
-        hs.NewHandle(class_linker->FindClass(soa.Self(), accessor.GetDescriptor(), class_loader)));
-    Handle<mirror::DexCache> dex_cache;
-    if (klass == nullptr) {
-      soa.Self()->AssertPendingException();
-      soa.Self()->ClearException();
-      dex_cache = hs.NewHandle(class_linker->FindDexCache(soa.Self(), dex_file));
-    } else if (SkipClass(jclass_loader, dex_file, klass.Get())) {
-      return;
-    } else if (&klass->GetDexFile() != &dex_file) {
-      // Skip a duplicate class (as the resolved class is from another, earlier dex file).
-      return;  // Do not update state.
-    } else {
-      dex_cache = hs.NewHandle(klass->GetDexCache());
-    }
-
-    // Avoid suspension if there are no methods to compile.
+    // Avoid looking up the class if there are no methods to compile.
     if (accessor.NumDirectMethods() + accessor.NumVirtualMethods() == 0) {
       return;
     }
+    {
+      // Use a scoped object access to perform to the quick SkipClass check.
+      ScopedObjectAccess soa(Thread::Current());
+      StackHandleScope<1> hs(soa.Self());
+      Handle<mirror::ClassLoader> h_class_loader(
+          hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
+      ObjPtr<mirror::Class> klass =
+          class_linker->FindClass(soa.Self(), accessor.GetDescriptor(), h_class_loader);
+      if (klass == nullptr) {
+        soa.Self()->AssertPendingException();
+        soa.Self()->ClearException();
+      } else if (SkipClass(jclass_loader, dex_file, klass)) {
+        return;
+      } else if (&klass->GetDexFile() != &dex_file) {
+        // Skip a duplicate class (as the resolved class is from another, earlier dex file).
+        return;  // Do not update state.
+      }
+    }
 
-    // Go to native so that we don't block GC during compilation.
-    ScopedThreadSuspension sts(soa.Self(), ThreadState::kNative);
-
-    // Compile direct and virtual methods.
+    std::vector<MethodCompilationItem>& methods = methods_per_class[class_def_index];
+    methods.reserve(accessor.NumDirectMethods() + accessor.NumVirtualMethods());
     int64_t previous_method_idx = -1;
     for (const ClassAccessor::Method& method : accessor.GetMethods()) {
       const uint32_t method_idx = method.GetIndex();
@@ -2644,20 +2784,111 @@ static void CompileDexFile(CompilerDriver* driver,
         continue;
       }
       previous_method_idx = method_idx;
+      methods.push_back({method.GetCodeItem(),
+                         method.GetAccessFlags(),
+                         method.GetInvokeType(class_def.access_flags_),
+                         dchecked_integral_cast<uint16_t>(class_def_index),
+                         method_idx,
+                         EstimateCompilationCost(compiler_options, profile_index, method)});
+    }
+  };
+  {
+    TimingLogger::ScopedTiming t2("Collect methods", timings);
+    context.ForAllLambda(0, dex_file.NumClassDefs(), collect, thread_count);
+  }
+
+  // Flatten and hand out the most expensive methods first. Workers pull the next item from the
+  // shared cursor, so a thread that finishes early immediately takes over remaining work and a
+  // single huge class no longer serializes the tail of the compilation.
+  std::vector<MethodCompilationItem> methods;
+  for (std::vector<MethodCompilationItem>& class_methods : methods_per_class) {
+    methods.insert(methods.end(), class_methods.begin(), class_methods.end());
+    std::vector<MethodCompilationItem>().swap(class_methods);
+  }
+  std::stable_sort(methods.begin(),
+                   methods.end(),
+                   [](const MethodCompilationItem& lhs, const MethodCompilationItem& rhs) {
+                     return lhs.cost > rhs.cost;
+                   });
+
+  // Each worker sets up its object access, handles and dex cache lookup once and then pulls
+  // methods from the shared cursor until none are left. The statistics are kept per worker so
+  // that the slowest method and its time always come from the same compilation.
+  struct WorkerStats {
+    uint64_t busy_ns = 0u;
+    uint64_t slowest_ns = 0u;
+    uint32_t slowest_method_idx = dex::kDexNoIndex;
+  };
+  std::vector<WorkerStats> worker_stats(thread_count);
+  std::atomic<size_t> next_method(0u);
+  auto compile = [&context, &compile_fn, &methods, &worker_stats, &next_method, profile_index](
+      size_t worker_index) {
+    const DexFile& dex_file = *context.GetDexFile();
+    WorkerStats& stats = worker_stats[worker_index];
+    ScopedObjectAccess soa(Thread::Current());
+    StackHandleScope<2> hs(soa.Self());
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(context.GetClassLoader())));
+    Handle<mirror::DexCache> dex_cache(
+        hs.NewHandle(context.GetClassLinker()->FindDexCache(soa.Self(), dex_file)));
+
+    // Go to native so that we don't block GC during compilation.
+    ScopedThreadSuspension sts(soa.Self(), ThreadState::kNative);
+    while (true) {
+      const size_t index = next_method.fetch_add(1u, std::memory_order_relaxed);
+      if (index >= methods.size()) {
+        break;
+      }
+      const MethodCompilationItem& item = methods[index];
+      SCOPED_TRACE << "compile " << dex_file.GetLocation() << "@" << item.class_def_index
+                   << ":" << item.method_idx;
+      uint64_t start_ns = NanoTime();
       compile_fn(soa.Self(),
-                 driver,
-                 method.GetCodeItem(),
-                 method.GetAccessFlags(),
-                 method.GetInvokeType(class_def.access_flags_),
-                 class_def_index,
-                 method_idx,
+                 context.GetCompiler(),
+                 item.code_item,
+                 item.access_flags,
+                 item.invoke_type,
+                 item.class_def_index,
+                 item.method_idx,
                  class_loader,
                  dex_file,
                  dex_cache,
                  profile_index);
+      soa.Self()->AssertNoPendingException();
+
+      uint64_t duration_ns = NanoTime() - start_ns;
+      stats.busy_ns += duration_ns;
+      if (duration_ns > stats.slowest_ns) {
+        stats.slowest_ns = duration_ns;
+        stats.slowest_method_idx = item.method_idx;
+      }
     }
   };
-  context.ForAllLambda(0, dex_file.NumClassDefs(), compile, thread_count);
+  uint64_t start_ns = NanoTime();
+  context.ForAllLambda(0, thread_count, compile, thread_count);
+  uint64_t wall_ns = NanoTime() - start_ns;
+
+  if (compiler_options.GetDumpTimings() && wall_ns != 0u) {
+    // The thread pool wait above orders the workers' writes before these reads.
+    WorkerStats total;
+    for (const WorkerStats& stats : worker_stats) {
+      total.busy_ns += stats.busy_ns;
+      if (stats.slowest_ns > total.slowest_ns) {
+        total.slowest_ns = stats.slowest_ns;
+        total.slowest_method_idx = stats.slowest_method_idx;
+      }
+    }
+    std::ostringstream oss;
+    oss << "Compiled " << methods.size() << " methods of " << dex_file.GetLocation()
+        << " in " << PrettyDuration(wall_ns) << " on " << thread_count << " threads, "
+        << "thread utilization "
+        << (100.0 * total.busy_ns / (static_cast<double>(wall_ns) * thread_count)) << "%";
+    if (total.slowest_method_idx != dex::kDexNoIndex) {
+      oss << ", slowest method " << dex_file.PrettyMethod(total.slowest_method_idx)
+          << " took " << PrettyDuration(total.slowest_ns);
+    }
+    LOG(INFO) << oss.str();
+  }
 }
 
 void CompilerDriver::Compile(jobject class_loader,
@@ -2813,6 +3044,10 @@ void CompilerDriver::FreeThreadPools() {
   single_thread_pool_.reset();
 }
 
+void CompilerDriver::SetCompilationCache(std::unique_ptr<CompilationCache> compilation_cache) {
+  compilation_cache_ = std::move(compilation_cache);
+}
+
 void CompilerDriver::SetClasspathDexFiles(const std::vector<const DexFile*>& dex_files) {
   classpath_classes_.AddDexFiles(dex_files);
 }
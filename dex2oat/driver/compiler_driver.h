@@ -30,6 +30,7 @@
 #include "base/os.h"
 #include "base/quasi_atomic.h"
 #include "base/safe_map.h"
+#include "base/stl_util.h"
 #include "base/timing_logger.h"
 #include "class_status.h"
 #include "compiler.h"
@@ -58,6 +59,7 @@ class VerifierDepsTest;
 
 class ArtField;
 class BitVector;
+class CompilationCache;
 class CompiledMethod;
 class CompilerOptions;
 class DexCompilationUnit;
@@ -214,6 +216,12 @@ class CompilerDriver {
     number_of_soft_verifier_failures_++;
   }
 
+  // Whether the class was already unverified in the input vdex and kept that status when
+  // fast verification only invalidated other classes.
+  bool IsUnverifiedClassFromVdex(const ClassReference& ref) const {
+    return ContainsElement(unverified_classes_from_vdex_, ref);
+  }
+
   Compiler::Kind GetCompilerKind() {
     return compiler_kind_;
   }
@@ -226,6 +234,13 @@ class CompilerDriver {
     return &compiled_method_storage_;
   }
 
+  // Use a persistent cache to reuse compiled methods across dex2oat invocations.
+  void SetCompilationCache(std::unique_ptr<CompilationCache> compilation_cache);
+
+  CompilationCache* GetCompilationCache() const {
+    return compilation_cache_.get();
+  }
+
  private:
   void LoadImageClasses(TimingLogger* timings, /*inout*/ HashSet<std::string>* image_classes)
       REQUIRES(!Locks::mutator_lock_);
@@ -246,7 +261,10 @@ class CompilerDriver {
       REQUIRES(!Locks::mutator_lock_);
 
   // Do fast verification through VerifierDeps if possible. Return whether
-  // verification was successful.
+  // verification was successful. Classes whose dependencies no longer hold are left to the
+  // regular verification. This only saves verification work: the methods of all classes are
+  // compiled again, as the code of the input oat file cannot be reused without its linker
+  // patches, which linked oat files do not keep.
   bool FastVerify(jobject class_loader,
                   const std::vector<const DexFile*>& dex_files,
                   TimingLogger* timings);
@@ -318,6 +336,10 @@ class CompilerDriver {
 
   std::atomic<uint32_t> number_of_soft_verifier_failures_;
 
+  // Classes that the input vdex recorded as unverified, see `IsUnverifiedClassFromVdex()`.
+  // Only written by `FastVerify()`, before the parallel verification reads it.
+  std::set<ClassReference> unverified_classes_from_vdex_;
+
   bool had_hard_verifier_failure_;
 
   // A thread pool that can (potentially) run tasks in parallel.
@@ -332,6 +354,9 @@ class CompilerDriver {
 
   CompiledMethodStorage compiled_method_storage_;
 
+  // Optional persistent cache of compiled methods.
+  std::unique_ptr<CompilationCache> compilation_cache_;
+
   size_t max_arena_alloc_;
 
   friend class CommonCompilerDriverTest;
@@ -172,7 +172,7 @@ static ObjPtr<mirror::ObjectArray<mirror::Object>> AllocateBootImageLiveObjects(
 template <typename MirrorType>
 ObjPtr<MirrorType> ImageWriter::DecodeGlobalWithoutRB(JavaVMExt* vm, jobject obj) {
   DCHECK_EQ(IndirectReferenceTable::GetIndirectRefKind(obj), kGlobal);
-  return ObjPtr<MirrorType>::DownCast(vm->globals_.Get<kWithoutReadBarrier>(obj));
+  return ObjPtr<MirrorType>::DownCast(vm->GetGlobalsTable(obj)->Get<kWithoutReadBarrier>(obj));
 }
 
 template <typename MirrorType>
@@ -180,7 +180,7 @@ ObjPtr<MirrorType> ImageWriter::DecodeWeakGlobalWithoutRB(
     JavaVMExt* vm, Thread* self, jobject obj) {
   DCHECK_EQ(IndirectReferenceTable::GetIndirectRefKind(obj), kWeakGlobal);
   DCHECK(vm->MayAccessWeakGlobals(self));
-  return ObjPtr<MirrorType>::DownCast(vm->weak_globals_.Get<kWithoutReadBarrier>(obj));
+  return ObjPtr<MirrorType>::DownCast(vm->GetGlobalsTable(obj)->Get<kWithoutReadBarrier>(obj));
 }
 
 ObjPtr<mirror::ClassLoader> ImageWriter::GetAppClassLoader() const
@@ -1053,6 +1053,7 @@ void ImageWriter::PromoteWeakInternsToStrong(Thread* self) {
     intern_table->InsertStrong(s, hash);
   }
   intern_table->weak_interns_.tables_.front().set_.clear();
+  intern_table->weak_interns_.PublishSnapshot();
 }
 
 void ImageWriter::DumpImageClasses() {
@@ -25,6 +25,7 @@
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "thread-current-inl.h"
+#include "thread.h"
 
 namespace art {
 
@@ -46,35 +47,43 @@ static void DumpFreeMap(const FreeBySizeSet& free_by_size) {
   }
 }
 
-void SwapSpace::RemoveChunk(FreeBySizeSet::const_iterator free_by_size_pos) {
+void SwapSpace::Shard::RemoveChunk(FreeBySizeSet::const_iterator free_by_size_pos) {
   auto free_by_start_pos = free_by_size_pos->free_by_start_entry;
-  free_by_size_.erase(free_by_size_pos);
-  free_by_start_.erase(free_by_start_pos);
+  free_by_size.erase(free_by_size_pos);
+  free_by_start.erase(free_by_start_pos);
 }
 
-inline void SwapSpace::InsertChunk(const SpaceChunk& chunk) {
+inline void SwapSpace::Shard::InsertChunk(const SpaceChunk& chunk) {
   DCHECK_NE(chunk.size, 0u);
-  auto insert_result = free_by_start_.insert(chunk);
+  auto insert_result = free_by_start.insert(chunk);
   DCHECK(insert_result.second);
-  free_by_size_.emplace(chunk.size, insert_result.first);
+  free_by_size.emplace(chunk.size, insert_result.first);
 }
 
+SwapSpace::Shard::Shard()
+    : lock("SwapSpace shard lock", static_cast<LockLevel>(LockLevel::kDefaultMutexLevel - 1)) {}
+
 SwapSpace::SwapSpace(int fd, size_t initial_size)
     : fd_(fd),
       size_(0),
-      lock_("SwapSpace lock", static_cast<LockLevel>(LockLevel::kDefaultMutexLevel - 1)) {
+      file_lock_("SwapSpace file lock",
+                 static_cast<LockLevel>(LockLevel::kDefaultMutexLevel - 2)),
+      regions_lock_("SwapSpace regions lock",
+                    static_cast<LockLevel>(LockLevel::kDefaultMutexLevel - 3)) {
   // Assume that the file is unlinked.
 
-  InsertChunk(NewFileChunk(initial_size));
+  SpaceChunk initial_chunk = NewFileChunk(initial_size, /*shard_index=*/ 0u);
+  MutexLock lock(Thread::Current(), shards_[0].lock);
+  shards_[0].InsertChunk(initial_chunk);
 }
 
 SwapSpace::~SwapSpace() {
-  // Unmap all mmapped chunks. Nothing should be allocated anymore at
-  // this point, so there should be only full size chunks in free_by_start_.
-  for (const SpaceChunk& chunk : free_by_start_) {
-    if (munmap(chunk.ptr, chunk.size) != 0) {
+  // Unmap all mmapped chunks. Nothing should be allocated anymore at this point.
+  for (const auto& entry : regions_) {
+    const Region& region = entry.second;
+    if (munmap(region.begin, region.size) != 0) {
       PLOG(ERROR) << "Failed to unmap swap space chunk at "
-          << static_cast<const void*>(chunk.ptr) << " size=" << chunk.size;
+          << static_cast<const void*>(region.begin) << " size=" << region.size;
     }
   }
   // All arenas are backed by the same file. Just close the descriptor.
@@ -105,67 +114,83 @@ static size_t CollectFree(const FreeByStartSet& free_by_start, const FreeBySizeS
   return sum1;
 }
 
+SwapSpace::Shard* SwapSpace::GetShardForCurrentThread() {
+  Thread* self = Thread::Current();
+  size_t index = (self != nullptr) ? static_cast<size_t>(self->GetTid()) % kNumShards : 0u;
+  return &shards_[index];
+}
+
 void* SwapSpace::Alloc(size_t size) {
-  MutexLock lock(Thread::Current(), lock_);
+  Shard* shard = GetShardForCurrentThread();
+  MutexLock lock(Thread::Current(), shard->lock);
   size = RoundUp(size, 8U);
 
   // Check the free list for something that fits.
   // TODO: Smarter implementation. Global biggest chunk, ...
-  auto it = free_by_start_.empty()
-      ? free_by_size_.end()
-      : free_by_size_.lower_bound(FreeBySizeEntry { size, free_by_start_.begin() });
-  if (it != free_by_size_.end()) {
+  auto it = shard->free_by_start.empty()
+      ? shard->free_by_size.end()
+      : shard->free_by_size.lower_bound(FreeBySizeEntry { size, shard->free_by_start.begin() });
+  if (it != shard->free_by_size.end()) {
     SpaceChunk old_chunk = *it->free_by_start_entry;
     if (old_chunk.size == size) {
-      RemoveChunk(it);
+      shard->RemoveChunk(it);
     } else {
       // Avoid deallocating and allocating the std::set<> nodes.
       // This would be much simpler if we could use replace() from Boost.Bimap.
 
-      // The free_by_start_ map contains disjoint intervals ordered by the `ptr`.
+      // The free_by_start map contains disjoint intervals ordered by the `ptr`.
       // Shrinking the interval does not affect the ordering.
       it->free_by_start_entry->ptr += size;
       it->free_by_start_entry->size -= size;
 
-      auto node = free_by_size_.extract(it);
+      auto node = shard->free_by_size.extract(it);
       node.value().size -= size;
-      free_by_size_.insert(std::move(node));
+      shard->free_by_size.insert(std::move(node));
     }
     return old_chunk.ptr;
   } else {
     // Not a big enough free chunk, need to increase file size.
-    SpaceChunk new_chunk = NewFileChunk(size);
+    SpaceChunk new_chunk = NewFileChunk(size, static_cast<size_t>(shard - shards_));
     if (new_chunk.size != size) {
       // Insert the remainder.
       SpaceChunk remainder = { new_chunk.ptr + size, new_chunk.size - size };
-      InsertChunk(remainder);
+      shard->InsertChunk(remainder);
     }
     return new_chunk.ptr;
   }
 }
 
-SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
+SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size, size_t shard_index) {
 #if !defined(__APPLE__)
+  Thread* self = Thread::Current();
   size_t next_part = std::max(RoundUp(min_size, kPageSize), RoundUp(kMininumMapSize, kPageSize));
-  int result = TEMP_FAILURE_RETRY(ftruncate64(fd_, size_ + next_part));
-  if (result != 0) {
-    PLOG(FATAL) << "Unable to increase swap file.";
+  uint8_t* ptr;
+  {
+    MutexLock lock(self, file_lock_);
+    size_t current_size = size_.load(std::memory_order_relaxed);
+    int result = TEMP_FAILURE_RETRY(ftruncate64(fd_, current_size + next_part));
+    if (result != 0) {
+      PLOG(FATAL) << "Unable to increase swap file.";
+    }
+    ptr = reinterpret_cast<uint8_t*>(
+        mmap(nullptr, next_part, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, current_size));
+    if (ptr == MAP_FAILED) {
+      LOG(ERROR) << "Unable to mmap new swap file chunk.";
+      LOG(ERROR) << "Current size: " << current_size << " requested: " << next_part << "/"
+                 << min_size;
+      PLOG(FATAL) << "Unable to mmap new swap file chunk.";
+    }
+    size_.store(current_size + next_part, std::memory_order_relaxed);
   }
-  uint8_t* ptr = reinterpret_cast<uint8_t*>(
-      mmap(nullptr, next_part, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, size_));
-  if (ptr == MAP_FAILED) {
-    LOG(ERROR) << "Unable to mmap new swap file chunk.";
-    LOG(ERROR) << "Current size: " << size_ << " requested: " << next_part << "/" << min_size;
-    LOG(ERROR) << "Free list:";
-    DumpFreeMap(free_by_size_);
-    LOG(ERROR) << "In free list: " << CollectFree(free_by_start_, free_by_size_);
-    PLOG(FATAL) << "Unable to mmap new swap file chunk.";
+  {
+    WriterMutexLock lock(self, regions_lock_);
+    uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + next_part;
+    regions_.emplace(end, Region { ptr, next_part, shard_index });
   }
-  size_ += next_part;
   SpaceChunk new_chunk = {ptr, next_part};
   return new_chunk;
 #else
-  UNUSED(min_size, kMininumMapSize);
+  UNUSED(min_size, shard_index, kMininumMapSize);
   LOG(FATAL) << "No swap file support on the Mac.";
   UNREACHABLE();
 #endif
@@ -173,17 +198,29 @@ SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
 
 // TODO: Full coalescing.
 void SwapSpace::Free(void* ptr, size_t size) {
-  MutexLock lock(Thread::Current(), lock_);
+  Thread* self = Thread::Current();
   size = RoundUp(size, 8U);
 
+  // Find the shard that owns the file chunk containing `ptr`.
+  size_t shard_index;
+  {
+    ReaderMutexLock lock(self, regions_lock_);
+    auto region_it = regions_.upper_bound(reinterpret_cast<uintptr_t>(ptr));
+    CHECK(region_it != regions_.end());
+    CHECK_GE(reinterpret_cast<uint8_t*>(ptr), region_it->second.begin);
+    shard_index = region_it->second.shard_index;
+  }
+  Shard* shard = &shards_[shard_index];
+  MutexLock lock(self, shard->lock);
+
   size_t free_before = 0;
   if (kCheckFreeMaps) {
-    free_before = CollectFree(free_by_start_, free_by_size_);
+    free_before = CollectFree(shard->free_by_start, shard->free_by_size);
   }
 
   SpaceChunk chunk = { reinterpret_cast<uint8_t*>(ptr), size };
-  auto it = free_by_start_.lower_bound(chunk);
-  if (it != free_by_start_.begin()) {
+  auto it = shard->free_by_start.lower_bound(chunk);
+  if (it != shard->free_by_start.begin()) {
     auto prev = it;
     --prev;
     CHECK_LE(prev->End(), chunk.Start());
@@ -191,30 +228,30 @@ void SwapSpace::Free(void* ptr, size_t size) {
       // Merge *prev with this chunk.
       chunk.size += prev->size;
       chunk.ptr -= prev->size;
-      auto erase_pos = free_by_size_.find(FreeBySizeEntry { prev->size, prev });
-      DCHECK(erase_pos != free_by_size_.end());
-      RemoveChunk(erase_pos);
+      auto erase_pos = shard->free_by_size.find(FreeBySizeEntry { prev->size, prev });
+      DCHECK(erase_pos != shard->free_by_size.end());
+      shard->RemoveChunk(erase_pos);
       // "prev" is invalidated but "it" remains valid.
     }
   }
-  if (it != free_by_start_.end()) {
+  if (it != shard->free_by_start.end()) {
     CHECK_LE(chunk.End(), it->Start());
     if (chunk.End() == it->Start()) {
       // Merge *it with this chunk.
       chunk.size += it->size;
-      auto erase_pos = free_by_size_.find(FreeBySizeEntry { it->size, it });
-      DCHECK(erase_pos != free_by_size_.end());
-      RemoveChunk(erase_pos);
+      auto erase_pos = shard->free_by_size.find(FreeBySizeEntry { it->size, it });
+      DCHECK(erase_pos != shard->free_by_size.end());
+      shard->RemoveChunk(erase_pos);
       // "it" is invalidated but we don't need it anymore.
     }
   }
-  InsertChunk(chunk);
+  shard->InsertChunk(chunk);
 
   if (kCheckFreeMaps) {
-    size_t free_after = CollectFree(free_by_start_, free_by_size_);
+    size_t free_after = CollectFree(shard->free_by_start, shard->free_by_size);
 
     if (free_after != free_before + size) {
-      DumpFreeMap(free_by_size_);
+      DumpFreeMap(shard->free_by_size);
       CHECK_EQ(free_after, free_before + size) << "Should be " << size << " difference from " << free_before;
     }
   }
@@ -19,8 +19,10 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <atomic>
 #include <cstdlib>
 #include <list>
+#include <map>
 #include <set>
 #include <vector>
 
@@ -33,18 +35,27 @@
 namespace art {
 
 // An arena pool that creates arenas backed by an mmaped file.
+//
+// The free space is split into shards, each with its own lock. Threads allocate from the shard
+// selected by their thread id, so that compiler threads storing compiled methods in parallel do
+// not serialize on a single lock. Each chunk mapped from the swap file is owned by one shard,
+// and freed memory is returned to the shard owning the chunk it was allocated from.
 class SwapSpace {
  public:
   SwapSpace(int fd, size_t initial_size);
   ~SwapSpace();
-  void* Alloc(size_t size) REQUIRES(!lock_);
-  void Free(void* ptr, size_t size) REQUIRES(!lock_);
+  void* Alloc(size_t size) REQUIRES(!file_lock_, !regions_lock_);
+  void Free(void* ptr, size_t size) REQUIRES(!regions_lock_);
 
   size_t GetSize() {
-    return size_;
+    return size_.load(std::memory_order_relaxed);
   }
 
  private:
+  // Number of shards. More shards reduce contention but leave more free space unused in
+  // partially used file chunks.
+  static constexpr size_t kNumShards = 8u;
+
   // Chunk of space.
   struct SpaceChunk {
     // We need mutable members as we keep these objects in a std::set<> (providing only const
@@ -90,22 +101,46 @@ class SwapSpace {
   };
   using FreeBySizeSet = std::set<FreeBySizeEntry, FreeBySizeComparator>;
 
-  SpaceChunk NewFileChunk(size_t min_size) REQUIRES(lock_);
+  // Free chunks of one shard.
+  struct Shard {
+    Shard();
+
+    void RemoveChunk(FreeBySizeSet::const_iterator free_by_size_pos) REQUIRES(lock);
+    void InsertChunk(const SpaceChunk& chunk) REQUIRES(lock);
+
+    // NOTE: Boost.Bimap would be useful for the two following members.
 
-  void RemoveChunk(FreeBySizeSet::const_iterator free_by_size_pos) REQUIRES(lock_);
-  void InsertChunk(const SpaceChunk& chunk) REQUIRES(lock_);
+    // Map start of a free chunk to its size.
+    FreeByStartSet free_by_start GUARDED_BY(lock);
+    // Free chunks ordered by size.
+    FreeBySizeSet free_by_size GUARDED_BY(lock);
+
+    Mutex lock;
+  };
 
-  int fd_;
-  size_t size_;
+  Shard* GetShardForCurrentThread();
 
-  // NOTE: Boost.Bimap would be useful for the two following members.
+  // Map a new chunk of at least `min_size` bytes from the swap file and assign it to `shard`.
+  SpaceChunk NewFileChunk(size_t min_size, size_t shard_index)
+      REQUIRES(!file_lock_, !regions_lock_);
 
-  // Map start of a free chunk to its size.
-  FreeByStartSet free_by_start_ GUARDED_BY(lock_);
-  // Free chunks ordered by size.
-  FreeBySizeSet free_by_size_ GUARDED_BY(lock_);
+  const int fd_;
+  std::atomic<size_t> size_;
+
+  Shard shards_[kNumShards];
+
+  // Serializes growing the swap file.
+  Mutex file_lock_;
+
+  // Mapped file chunks, keyed by their end address, with the index of the owning shard.
+  struct Region {
+    uint8_t* begin;
+    size_t size;
+    size_t shard_index;
+  };
+  std::map<uintptr_t, Region> regions_ GUARDED_BY(regions_lock_);
+  mutable ReaderWriterMutex regions_lock_;
 
-  mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   DISALLOW_COPY_AND_ASSIGN(SwapSpace);
 };
 
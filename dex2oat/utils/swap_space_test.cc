@@ -21,6 +21,9 @@
 #include <sys/types.h>
 
 #include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -79,4 +82,43 @@ TEST_F(SwapSpaceTest, Swap) {
   SwapTest(true);
 }
 
+TEST_F(SwapSpaceTest, ConcurrentAllocAndFree) {
+  ScratchFile scratch;
+  int fd = scratch.GetFd();
+  unlink(scratch.GetFilename().c_str());
+
+  SwapSpace pool(fd, 1 * MB);
+  static constexpr size_t kNumThreads = 4u;
+  static constexpr size_t kNumAllocations = 10000u;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t != kNumThreads; ++t) {
+    threads.emplace_back([&pool, t]() {
+      std::vector<std::pair<uint8_t*, size_t>> allocations;
+      for (size_t i = 0; i != kNumAllocations; ++i) {
+        size_t size = 8u + (i * 37u + t) % 4096u;
+        uint8_t* ptr = reinterpret_cast<uint8_t*>(pool.Alloc(size));
+        memset(ptr, static_cast<int>(t), size);
+        allocations.emplace_back(ptr, size);
+        if (i % 3u == 2u) {
+          // Free an older allocation to exercise the free lists.
+          auto [old_ptr, old_size] = allocations[allocations.size() / 2u];
+          allocations.erase(allocations.begin() + allocations.size() / 2u);
+          pool.Free(old_ptr, old_size);
+        }
+      }
+      for (auto [ptr, size] : allocations) {
+        for (size_t i = 0; i != size; ++i) {
+          ASSERT_EQ(static_cast<uint8_t>(t), ptr[i]);
+        }
+        pool.Free(ptr, size);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  scratch.Close();
+}
+
 }  // namespace art
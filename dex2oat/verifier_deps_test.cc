@@ -335,6 +335,50 @@ class VerifierDepsTest : public CommonCompilerDriverTest {
                                              error_msg);
   }
 
+  // Load the dex file again with a new class loader, decode the VerifierDeps in `buffer`,
+  // record that `source` must be assignable to `destination` for the given class def and
+  // run the per-class validation. Checks that clearing the data of the invalid classes makes
+  // the dependencies valid again. Returns the number of invalid classes.
+  size_t RunPerClassValidation(uint32_t class_def_index,
+                               const std::string& destination,
+                               const std::string& source,
+                               const std::vector<uint8_t>& buffer,
+                               /*out*/ std::vector<std::vector<bool>>* invalid_classes,
+                               /*out*/ std::string* error_msg) {
+    ScopedObjectAccess soa(Thread::Current());
+
+    jobject second_loader = LoadDex("VerifierDeps");
+    const auto& second_dex_files = GetDexFiles(second_loader);
+    const DexFile& dex_file = *second_dex_files.front();
+
+    VerifierDeps decoded_deps(second_dex_files, /*output_only=*/ false);
+    bool parsed = decoded_deps.ParseStoredData(second_dex_files, ArrayRef<const uint8_t>(buffer));
+    CHECK(parsed);
+    VerifierDeps::DexFileDeps* decoded_dex_deps = decoded_deps.GetDexFileDeps(dex_file);
+    decoded_dex_deps->assignable_types_[class_def_index].emplace(
+        decoded_deps.GetIdFromString(dex_file, destination),
+        decoded_deps.GetIdFromString(dex_file, source));
+
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::ClassLoader> new_class_loader =
+        hs.NewHandle<mirror::ClassLoader>(soa.Decode<mirror::ClassLoader>(second_loader));
+    size_t num_invalid_classes = decoded_deps.ValidateDependenciesPerClass(
+        soa.Self(), new_class_loader, second_dex_files, invalid_classes, error_msg);
+
+    for (size_t i = 0; i != second_dex_files.size(); ++i) {
+      decoded_deps.ClearClassData(*second_dex_files[i], (*invalid_classes)[i]);
+    }
+    std::vector<std::vector<bool>> remaining_invalid_classes;
+    std::string remaining_error_msg;
+    CHECK_EQ(0u, decoded_deps.ValidateDependenciesPerClass(soa.Self(),
+                                                           new_class_loader,
+                                                           second_dex_files,
+                                                           &remaining_invalid_classes,
+                                                           &remaining_error_msg))
+        << remaining_error_msg;
+    return num_invalid_classes;
+  }
+
   std::unique_ptr<verifier::VerifierDeps> verifier_deps_;
   std::vector<const DexFile*> dex_files_;
   const DexFile* primary_dex_file_;
@@ -583,6 +627,28 @@ TEST_F(VerifierDepsTest, VerifyDeps) {
       << error_msg;
 }
 
+TEST_F(VerifierDepsTest, VerifyDepsPerClass) {
+  std::string error_msg;
+
+  VerifyDexFile();
+  std::vector<uint8_t> buffer;
+  verifier_deps_->Encode(dex_files_, &buffer);
+  ASSERT_FALSE(buffer.empty());
+
+  // Record a dependency that does not hold for the first class only.
+  std::vector<std::vector<bool>> invalid_classes;
+  ASSERT_EQ(1u, RunPerClassValidation(/* class_def_index= */ 0u,
+                                      "Ljava/lang/String;",
+                                      "Ljava/lang/Object;",
+                                      buffer,
+                                      &invalid_classes,
+                                      &error_msg));
+  ASSERT_EQ(1u, invalid_classes.size());
+  EXPECT_TRUE(invalid_classes[0][0]);
+  EXPECT_EQ(1, std::count(invalid_classes[0].begin(), invalid_classes[0].end(), true));
+  EXPECT_FALSE(error_msg.empty());
+}
+
 TEST_F(VerifierDepsTest, CompilerDriver) {
   TEST_DISABLED_FOR_RISCV64();
   SetupCompilerDriver();
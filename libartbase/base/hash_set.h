@@ -672,6 +672,12 @@ class HashSet {
     return num_buckets_;
   }
 
+  // Return the bucket array, with NumBuckets() elements. Users that keep a replaced bucket
+  // array alive by other means can use it for lookups that do not synchronize with writers.
+  const T* GetBuckets() const {
+    return data_;
+  }
+
  private:
   T& ElementForIndex(size_t index) {
     DCHECK_LT(index, NumBuckets());
@@ -60,6 +60,7 @@
   METRIC(FullGcThroughput, MetricsHistogram, 15, 0, 10'000)         \
   METRIC(YoungGcTracingThroughput, MetricsHistogram, 15, 0, 10'000) \
   METRIC(FullGcTracingThroughput, MetricsHistogram, 15, 0, 10'000)  \
+  METRIC(TimeToSafepoint, MetricsHistogram, 15, 0, 10'000)          \
   METRIC(GcWorldStopTime, MetricsCounter)                           \
   METRIC(GcWorldStopCount, MetricsCounter)                          \
   METRIC(YoungGcScannedBytes, MetricsCounter)                       \
@@ -29,6 +29,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>
 #include <numeric>
 #include <random>
 #include <string>
@@ -45,6 +46,7 @@
 #include "base/globals.h"
 #include "base/logging.h"  // For VLOG.
 #include "base/malloc_arena_pool.h"
+#include "base/mman.h"  // For the PROT_* and MAP_* constants.
 #include "base/os.h"
 #include "base/safe_map.h"
 #include "base/scoped_flock.h"
@@ -231,8 +233,12 @@ enum class ProfileCompilationInfo::FileSectionType : uint32_t {
   // an optional reserved section not implemented on client yet.
   kAggregationCounts = 4,
 
+  // Uncompressed and sorted copy of the classes, hot methods and method flags,
+  // for queries from a memory map. See `MappedProfileCompilationInfo`.
+  kMappableIndex = 5,
+
   // The number of known sections.
-  kNumberOfSections = 5
+  kNumberOfSections = 6
 };
 
 class ProfileCompilationInfo::FileSectionInfo {
@@ -383,9 +389,15 @@ class ProfileCompilationInfo::ProfileSource {
     return new ProfileSource(/*fd*/ -1, std::move(mem_map));
   }
 
-  // Seek to the given offset in the source.
+  // Seek to the given offset in the source, relative to the current segment.
   bool Seek(off_t offset);
 
+  // Set the offset of the profile segment to read. See `ProfileCompilationInfo::Append()`.
+  void SetSegmentOffset(off_t segment_offset) {
+    DCHECK_GE(segment_offset, 0);
+    segment_offset_ = segment_offset;
+  }
+
   /**
    * Read bytes from this source.
    * Reading will advance the current source position so subsequent
@@ -399,9 +411,12 @@ class ProfileCompilationInfo::ProfileSource {
   /** Return true if the source has 0 data. */
   bool HasEmptyContent() const;
 
+  /** Return the size of the source data, or 0 if it cannot be determined. */
+  uint64_t GetSize() const;
+
  private:
   ProfileSource(int32_t fd, MemMap&& mem_map)
-      : fd_(fd), mem_map_(std::move(mem_map)), mem_map_cur_(0) {}
+      : fd_(fd), mem_map_(std::move(mem_map)), mem_map_cur_(0), segment_offset_(0) {}
 
   bool IsMemMap() const {
     return fd_ == -1;
@@ -410,6 +425,7 @@ class ProfileCompilationInfo::ProfileSource {
   int32_t fd_;  // The fd is not owned by this class.
   MemMap mem_map_;
   size_t mem_map_cur_;  // Current position in the map to read from.
+  off_t segment_offset_;  // Offset of the current profile segment.
 };
 
 // A helper structure to make sure we don't read past our buffers in the loops.
@@ -818,11 +834,13 @@ bool ProfileCompilationInfo::Load(const std::string& filename, bool clear_if_inv
   return false;
 }
 
-bool ProfileCompilationInfo::Save(const std::string& filename, uint64_t* bytes_written) {
+bool ProfileCompilationInfo::Save(const std::string& filename,
+                                  uint64_t* bytes_written,
+                                  bool add_mappable_section) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
 
 #ifndef ART_TARGET_ANDROID
-  return SaveFallback(filename, bytes_written);
+  return SaveFallback(filename, bytes_written, add_mappable_section);
 #else
   // Prior to U, SELinux policy doesn't allow apps to create profile files.
   // Additionally, when installd is being used for dexopt, it acquires a flock when working on a
@@ -831,7 +849,7 @@ bool ProfileCompilationInfo::Save(const std::string& filename, uint64_t* bytes_w
   // partners. Therefore, we fall back to using a flock as well just to be safe.
   if (!android::modules::sdklevel::IsAtLeastU() ||
       !android::base::GetBoolProperty("dalvik.vm.useartservice", /*default_value=*/false)) {
-    return SaveFallback(filename, bytes_written);
+    return SaveFallback(filename, bytes_written, add_mappable_section);
   }
 
   std::string tmp_filename = filename + ".XXXXXX.tmp";
@@ -850,7 +868,7 @@ bool ProfileCompilationInfo::Save(const std::string& filename, uint64_t* bytes_w
     }
   });
 
-  bool result = Save(fd.get());
+  bool result = Save(fd.get(), add_mappable_section);
   if (!result) {
     VLOG(profiler) << "Failed to save profile info to temp profile file " << tmp_filename;
     return false;
@@ -881,7 +899,9 @@ bool ProfileCompilationInfo::Save(const std::string& filename, uint64_t* bytes_w
 #endif
 }
 
-bool ProfileCompilationInfo::SaveFallback(const std::string& filename, uint64_t* bytes_written) {
+bool ProfileCompilationInfo::SaveFallback(const std::string& filename,
+                                          uint64_t* bytes_written,
+                                          bool add_mappable_section) {
   std::string error;
 #ifdef _WIN32
   int flags = O_WRONLY | O_CREAT;
@@ -908,7 +928,7 @@ bool ProfileCompilationInfo::SaveFallback(const std::string& filename, uint64_t*
 
   // This doesn't need locking because we are trying to lock the file for exclusive
   // access and fail immediately if we can't.
-  bool result = Save(fd);
+  bool result = Save(fd, add_mappable_section);
   if (result) {
     int64_t size = OS::GetFileSizeBytes(filename.c_str());
     if (size != -1) {
@@ -928,6 +948,54 @@ bool ProfileCompilationInfo::SaveFallback(const std::string& filename, uint64_t*
   return result;
 }
 
+bool ProfileCompilationInfo::Append(const std::string& filename,
+                                    uint64_t expected_size,
+                                    /*out*/ uint64_t* bytes_written) {
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  std::string error;
+#ifdef _WIN32
+  int flags = O_WRONLY;
+#else
+  int flags = O_WRONLY | O_NOFOLLOW | O_CLOEXEC;
+#endif
+  ScopedFlock profile_file =
+      LockedFile::Open(filename.c_str(), flags, /*block=*/false, &error);
+  if (profile_file.get() == nullptr) {
+    LOG(WARNING) << "Couldn't lock the profile file " << filename << ": " << error;
+    return false;
+  }
+
+  int fd = profile_file->Fd();
+
+  // Do not append to a file that was cleared or rewritten by someone else, its content
+  // may not be compatible with the current profile anymore.
+  off64_t file_size = lseek64(fd, 0, SEEK_END);
+  if (file_size < 0 || static_cast<uint64_t>(file_size) != expected_size) {
+    VLOG(profiler) << "Not appending to modified profile file " << filename
+                   << " Size: " << file_size << " Expected: " << expected_size;
+    return false;
+  }
+
+  // The segment header is written last, so readers ignore the segment until it is complete.
+  if (!Save(fd)) {
+    VLOG(profiler) << "Failed to append profile info to " << filename;
+    if (ftruncate(fd, file_size) != 0) {
+      PLOG(WARNING) << "Could not remove partial profile segment from " << filename;
+    }
+    return false;
+  }
+
+  off64_t new_file_size = lseek64(fd, 0, SEEK_END);
+  if (new_file_size < file_size) {
+    PLOG(WARNING) << "Failed to get size of profile file " << filename;
+    return false;
+  }
+  *bytes_written = static_cast<uint64_t>(new_file_size - file_size);
+  VLOG(profiler) << "Successfully appended profile info to " << filename
+                 << " Size: " << new_file_size << " Appended: " << *bytes_written;
+  return true;
+}
+
 // Returns true if all the bytes were successfully written to the file descriptor.
 static bool WriteBuffer(int fd, const void* buffer, size_t byte_count) {
   while (byte_count > 0) {
@@ -958,6 +1026,7 @@ static bool WriteBuffer(int fd, const void* buffer, size_t byte_count) {
  *   Classes - optional, zipped
  *   Methods - optional, zipped
  *   AggregationCounts - optional, zipped, server-side
+ *   MappableIndex - optional, plaintext
  *
  * DexFiles:
  *    number_of_dex_files
@@ -996,8 +1065,27 @@ static bool WriteBuffer(int fd, const void* buffer, size_t byte_count) {
  *    type_index_diff[dex_map_size]
  * where `M` stands for special encodings indicating missing types (kIsMissingTypesEncoding)
  * or memamorphic call (kIsMegamorphicEncoding) which both imply `dex_map_size == 0`.
+ *
+ * MappableIndex:
+ *    number_of_dex_files
+ *    dex_data_offset[number_of_dex_files]
+ * where `dex_data_offset` is the offset from the start of the section to the following
+ * record for the dex file with the same index in DexFiles section:
+ *    number_of_classes
+ *    number_of_hot_methods
+ *    type_index[number_of_classes]
+ *    method_index[number_of_hot_methods]
+ *    method_bitmap
+ * where the type and method indexes are sorted and `method_bitmap` is the bitmap of all
+ * method flags other than "hot" for `num_method_ids` methods, as held in memory. All
+ * values are plain little-endian integers, so the section can be used in place.
+ *
+ * A file can contain several such profiles, or segments, one after the other. The first
+ * one is written by `Save(const std::string&, ...)` and the following ones are appended
+ * by `Append()`. The file offsets in the section information are relative to the start of
+ * their segment, and loading the file merges the data of all segments.
  **/
-bool ProfileCompilationInfo::Save(int fd) {
+bool ProfileCompilationInfo::Save(int fd, bool add_mappable_section) {
   uint64_t start = NanoTime();
   ScopedTrace trace(__PRETTY_FUNCTION__);
   DCHECK_GE(fd, 0);
@@ -1015,6 +1103,11 @@ bool ProfileCompilationInfo::Save(int fd) {
   uint64_t dex_files_section_size = sizeof(ProfileIndexType);  // Number of dex files.
   uint64_t classes_section_size = 0u;
   uint64_t methods_section_size = 0u;
+  uint64_t mappable_index_section_size = 0u;
+  if (add_mappable_section) {
+    // Number of dex files and offsets.
+    mappable_index_section_size = sizeof(uint32_t) + info_.size() * sizeof(uint32_t);
+  }
   DCHECK_LE(info_.size(), MaxProfileIndex());
   for (const std::unique_ptr<DexFileData>& dex_data : info_) {
     if (dex_data->profile_key.size() > kMaxDexFileKeyLength) {
@@ -1027,13 +1120,20 @@ bool ProfileCompilationInfo::Save(int fd) {
         sizeof(uint16_t) + dex_data->profile_key.size();
     classes_section_size += dex_data->ClassesDataSize();
     methods_section_size += dex_data->MethodsDataSize();
+    if (add_mappable_section) {
+      mappable_index_section_size +=
+          2 * sizeof(uint32_t) +  // Number of classes and hot methods.
+          sizeof(uint16_t) * (dex_data->class_set.size() + dex_data->method_map.size()) +
+          dex_data->bitmap_storage.size();
+    }
   }
 
   const uint32_t file_section_count =
       /* dex files */ 1u +
       /* extra descriptors */ (extra_descriptors_section_size != 0u ? 1u : 0u) +
       /* classes */ (classes_section_size != 0u ? 1u : 0u) +
-      /* methods */ (methods_section_size != 0u ? 1u : 0u);
+      /* methods */ (methods_section_size != 0u ? 1u : 0u) +
+      /* mappable index */ (mappable_index_section_size != 0u ? 1u : 0u);
   uint64_t header_and_infos_size =
       sizeof(FileHeader) + file_section_count * sizeof(FileSectionInfo);
 
@@ -1044,7 +1144,8 @@ bool ProfileCompilationInfo::Save(int fd) {
       dex_files_section_size +
       extra_descriptors_section_size +
       classes_section_size +
-      methods_section_size;
+      methods_section_size +
+      mappable_index_section_size;
   VLOG(profiler) << "Required capacity: " << total_uncompressed_size << " bytes.";
   if (total_uncompressed_size > GetSizeErrorThresholdBytes()) {
     LOG(WARNING) << "Profile data size exceeds "
@@ -1055,7 +1156,11 @@ bool ProfileCompilationInfo::Save(int fd) {
   }
 
   // Start with an invalid file header and section infos.
-  DCHECK_EQ(lseek(fd, 0, SEEK_CUR), 0);
+  // The profile is written at the current offset, which is not zero when appending.
+  off64_t segment_offset = lseek64(fd, 0, SEEK_CUR);
+  if (segment_offset < 0) {
+    return false;
+  }
   constexpr uint32_t kMaxNumberOfSections = enum_cast<uint32_t>(FileSectionType::kNumberOfSections);
   constexpr uint64_t kMaxHeaderAndInfosSize =
       sizeof(FileHeader) + kMaxNumberOfSections * sizeof(FileSectionInfo);
@@ -1143,6 +1248,37 @@ bool ProfileCompilationInfo::Save(int fd) {
     add_section_info(FileSectionType::kMethods, buffer.Size(), methods_section_size);
   }
 
+  // Write the mappable index section uncompressed.
+  if (mappable_index_section_size != 0u) {
+    SafeBuffer buffer(mappable_index_section_size);
+    buffer.WriteUintAndAdvance(dchecked_integral_cast<uint32_t>(info_.size()));
+    uint32_t dex_data_offset = sizeof(uint32_t) + info_.size() * sizeof(uint32_t);
+    for (const std::unique_ptr<DexFileData>& dex_data : info_) {
+      buffer.WriteUintAndAdvance(dex_data_offset);
+      dex_data_offset +=
+          2 * sizeof(uint32_t) +
+          sizeof(uint16_t) * (dex_data->class_set.size() + dex_data->method_map.size()) +
+          dex_data->bitmap_storage.size();
+    }
+    for (const std::unique_ptr<DexFileData>& dex_data : info_) {
+      buffer.WriteUintAndAdvance(dchecked_integral_cast<uint32_t>(dex_data->class_set.size()));
+      buffer.WriteUintAndAdvance(dchecked_integral_cast<uint32_t>(dex_data->method_map.size()));
+      for (dex::TypeIndex type_index : dex_data->class_set) {
+        buffer.WriteUintAndAdvance(type_index.index_);
+      }
+      for (const auto& method_it : dex_data->method_map) {
+        buffer.WriteUintAndAdvance(method_it.first);
+      }
+      buffer.WriteAndAdvance(dex_data->bitmap_storage.data(), dex_data->bitmap_storage.size());
+    }
+    DCHECK_EQ(buffer.GetAvailableBytes(), 0u);
+    if (!WriteBuffer(fd, buffer.Get(), mappable_index_section_size)) {
+      return false;
+    }
+    add_section_info(
+        FileSectionType::kMappableIndex, mappable_index_section_size, /*inflated_size=*/ 0u);
+  }
+
   if (file_offset > GetSizeWarningThresholdBytes()) {
     LOG(WARNING) << "Profile data size exceeds "
         << GetSizeWarningThresholdBytes()
@@ -1150,7 +1286,8 @@ bool ProfileCompilationInfo::Save(int fd) {
   }
 
   // Write section infos.
-  if (lseek64(fd, sizeof(FileHeader), SEEK_SET) != sizeof(FileHeader)) {
+  off64_t section_infos_offset = segment_offset + sizeof(FileHeader);
+  if (lseek64(fd, section_infos_offset, SEEK_SET) != section_infos_offset) {
     return false;
   }
   SafeBuffer section_infos_buffer(section_index * 4u * sizeof(uint32_t));
@@ -1168,7 +1305,7 @@ bool ProfileCompilationInfo::Save(int fd) {
 
   // Write header.
   FileHeader header(version_, section_index);
-  if (lseek(fd, 0, SEEK_SET) != 0) {
+  if (lseek64(fd, segment_offset, SEEK_SET) != segment_offset) {
     return false;
   }
   if (!WriteBuffer(fd, &header, sizeof(FileHeader))) {
@@ -1484,6 +1621,7 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::OpenSource(
 
 bool ProfileCompilationInfo::ProfileSource::Seek(off_t offset) {
   DCHECK_GE(offset, 0);
+  offset += segment_offset_;
   if (IsMemMap()) {
     if (offset > static_cast<int64_t>(mem_map_.Size())) {
       return false;
@@ -1540,6 +1678,18 @@ bool ProfileCompilationInfo::ProfileSource::HasEmptyContent() const {
   }
 }
 
+uint64_t ProfileCompilationInfo::ProfileSource::GetSize() const {
+  if (IsMemMap()) {
+    return mem_map_.IsValid() ? mem_map_.Size() : 0u;
+  } else {
+    struct stat stat_buffer;
+    if (fstat(fd_, &stat_buffer) != 0) {
+      return 0u;
+    }
+    return static_cast<uint64_t>(stat_buffer.st_size);
+  }
+}
+
 ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::ReadSectionData(
     ProfileSource& source,
     const FileSectionInfo& section_info,
@@ -1755,31 +1905,14 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::ReadMethodsSec
   return ProfileLoadStatus::kSuccess;
 }
 
-// TODO(calin): fail fast if the dex checksums don't match.
-ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::LoadInternal(
-    int32_t fd,
-    std::string* error,
-    bool merge_classes,
-    const ProfileLoadFilterFn& filter_fn) {
-  ScopedTrace trace(__PRETTY_FUNCTION__);
-  DCHECK_GE(fd, 0);
-
-  std::unique_ptr<ProfileSource> source;
-  ProfileLoadStatus status = OpenSource(fd, &source, error);
-  if (status != ProfileLoadStatus::kSuccess) {
-    return status;
-  }
-
-  // We allow empty profile files.
-  // Profiles may be created by ActivityManager or installd before we manage to
-  // process them in the runtime or profman.
-  if (source->HasEmptyContent()) {
-    return ProfileLoadStatus::kSuccess;
-  }
-
+ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::ReadSegmentHeader(
+    ProfileSource& source,
+    /*out*/ dchecked_vector<FileSectionInfo>* section_infos,
+    /*out*/ uint64_t* segment_size,
+    /*out*/ std::string* error) {
   // Read file header.
   FileHeader header;
-  status = source->Read(&header, sizeof(FileHeader), "ReadProfileHeader", error);
+  ProfileLoadStatus status = source.Read(&header, sizeof(FileHeader), "ReadProfileHeader", error);
   if (status != ProfileLoadStatus::kSuccess) {
     return status;
   }
@@ -1802,21 +1935,25 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::LoadInternal(
   }
 
   // Read section infos.
-  dchecked_vector<FileSectionInfo> section_infos(section_count);
-  status = source->Read(
-      section_infos.data(), section_count * sizeof(FileSectionInfo), "ReadSectionInfos", error);
+  section_infos->resize(section_count);
+  status = source.Read(
+      section_infos->data(), section_count * sizeof(FileSectionInfo), "ReadSectionInfos", error);
   if (status != ProfileLoadStatus::kSuccess) {
     return status;
   }
 
-  // Finish uncompressed data size calculation.
-  for (const FileSectionInfo& section_info : section_infos) {
+  // Finish uncompressed data size calculation and find the end of the segment.
+  *segment_size = sizeof(FileHeader) + section_count * sizeof(FileSectionInfo);
+  for (const FileSectionInfo& section_info : *section_infos) {
     uint32_t mem_size = section_info.GetMemSize();
     if (UNLIKELY(mem_size > std::numeric_limits<uint32_t>::max() - uncompressed_data_size)) {
       *error = "Total memory size overflow.";
       return ProfileLoadStatus::kBadData;
     }
     uncompressed_data_size += mem_size;
+    *segment_size = std::max<uint64_t>(
+        *segment_size,
+        static_cast<uint64_t>(section_info.GetFileOffset()) + section_info.GetFileSize());
   }
 
   // Allow large profiles for non target builds for the case where we are merging many profiles
@@ -1833,16 +1970,26 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::LoadInternal(
                  << " bytes. It has " << uncompressed_data_size << " bytes.";
   }
 
+  return ProfileLoadStatus::kSuccess;
+}
+
+ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::ReadSegmentSections(
+    ProfileSource& source,
+    const dchecked_vector<FileSectionInfo>& section_infos,
+    bool merge_classes,
+    const ProfileLoadFilterFn& filter_fn,
+    /*out*/ std::string* error) {
   // Process the mandatory dex files section.
-  DCHECK_NE(section_count, 0u);  // Checked by `header.IsValid()` above.
+  uint32_t section_count = section_infos.size();
+  DCHECK_NE(section_count, 0u);  // Checked by `ReadSegmentHeader()`.
   const FileSectionInfo& dex_files_section_info = section_infos[0];
   if (dex_files_section_info.GetType() != FileSectionType::kDexFiles) {
     *error = "First section is not dex files section.";
     return ProfileLoadStatus::kBadData;
   }
   dchecked_vector<ProfileIndexType> dex_profile_index_remap;
-  status = ReadDexFilesSection(
-      *source, dex_files_section_info, filter_fn, &dex_profile_index_remap, error);
+  ProfileLoadStatus status = ReadDexFilesSection(
+      source, dex_files_section_info, filter_fn, &dex_profile_index_remap, error);
   if (status != ProfileLoadStatus::kSuccess) {
     DCHECK(!error->empty());
     return status;
@@ -1860,25 +2007,28 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::LoadInternal(
         break;
       case FileSectionType::kExtraDescriptors:
         status = ReadExtraDescriptorsSection(
-            *source, section_info, &extra_descriptors_remap, error);
+            source, section_info, &extra_descriptors_remap, error);
         break;
       case FileSectionType::kClasses:
         // Skip if all dex files were filtered out.
         if (!info_.empty() && merge_classes) {
           status = ReadClassesSection(
-              *source, section_info, dex_profile_index_remap, extra_descriptors_remap, error);
+              source, section_info, dex_profile_index_remap, extra_descriptors_remap, error);
         }
         break;
       case FileSectionType::kMethods:
         // Skip if all dex files were filtered out.
         if (!info_.empty()) {
           status = ReadMethodsSection(
-              *source, section_info, dex_profile_index_remap, extra_descriptors_remap, error);
+              source, section_info, dex_profile_index_remap, extra_descriptors_remap, error);
         }
         break;
       case FileSectionType::kAggregationCounts:
         // This section is only used on server side.
         break;
+      case FileSectionType::kMappableIndex:
+        // This section is only used by `MappedProfileCompilationInfo`.
+        break;
       default:
         // Unknown section. Skip it. New versions of ART are allowed
         // to add sections that shall be ignored by old versions.
@@ -1893,6 +2043,69 @@ ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::LoadInternal(
   return ProfileLoadStatus::kSuccess;
 }
 
+// TODO(calin): fail fast if the dex checksums don't match.
+ProfileCompilationInfo::ProfileLoadStatus ProfileCompilationInfo::LoadInternal(
+    int32_t fd,
+    std::string* error,
+    bool merge_classes,
+    const ProfileLoadFilterFn& filter_fn) {
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  DCHECK_GE(fd, 0);
+
+  std::unique_ptr<ProfileSource> source;
+  ProfileLoadStatus status = OpenSource(fd, &source, error);
+  if (status != ProfileLoadStatus::kSuccess) {
+    return status;
+  }
+
+  // We allow empty profile files.
+  // Profiles may be created by ActivityManager or installd before we manage to
+  // process them in the runtime or profman.
+  if (source->HasEmptyContent()) {
+    return ProfileLoadStatus::kSuccess;
+  }
+
+  // Load the first profile segment and then the segments appended after it, if any.
+  uint64_t source_size = source->GetSize();
+  uint64_t segment_offset = 0u;
+  do {
+    bool is_appended_segment = (segment_offset != 0u);
+    if (is_appended_segment) {
+      source->SetSegmentOffset(segment_offset);
+      if (!source->Seek(0)) {
+        *error = "Failed to seek to profile segment.";
+        return ProfileLoadStatus::kIOError;
+      }
+    }
+    dchecked_vector<FileSectionInfo> section_infos;
+    uint64_t segment_size = 0u;
+    status = ReadSegmentHeader(*source, &section_infos, &segment_size, error);
+    if (status == ProfileLoadStatus::kSuccess && segment_size > source_size - segment_offset) {
+      *error = "Profile segment extends past the end of the file.";
+      status = ProfileLoadStatus::kBadData;
+    }
+    if (is_appended_segment &&
+        (status == ProfileLoadStatus::kBadMagic || status == ProfileLoadStatus::kBadData)) {
+      // The last append did not complete, e.g. the process doing it was killed. Ignore it,
+      // the next save shall rewrite the file.
+      LOG(WARNING) << "Ignoring incomplete profile segment at offset " << segment_offset
+                   << ": " << *error;
+      error->clear();
+      break;
+    }
+    if (status != ProfileLoadStatus::kSuccess) {
+      return status;
+    }
+    status = ReadSegmentSections(*source, section_infos, merge_classes, filter_fn, error);
+    if (status != ProfileLoadStatus::kSuccess) {
+      return status;
+    }
+    segment_offset += segment_size;
+  } while (segment_offset < source_size);
+
+  return ProfileLoadStatus::kSuccess;
+}
+
 bool ProfileCompilationInfo::MergeWith(const ProfileCompilationInfo& other,
                                        bool merge_classes) {
   if (!SameVersion(other)) {
@@ -2023,6 +2236,390 @@ bool ProfileCompilationInfo::MergeWith(const ProfileCompilationInfo& other,
   return true;
 }
 
+bool ProfileCompilationInfo::RemoveDataContainedIn(const ProfileCompilationInfo& other) {
+  if (!SameVersion(other)) {
+    LOG(WARNING) << "Cannot compare different profile versions";
+    return false;
+  }
+
+  // First verify that the profiles can be merged, so that we leave the current
+  // profile unchanged otherwise.
+  for (const std::unique_ptr<DexFileData>& dex_data : info_) {
+    const DexFileData* other_dex_data = other.FindDexData(dex_data->profile_key,
+                                                          /* checksum= */ 0u,
+                                                          /* verify_checksum= */ false);
+    if (other_dex_data != nullptr &&
+        (other_dex_data->checksum != dex_data->checksum ||
+         other_dex_data->num_type_ids != dex_data->num_type_ids ||
+         other_dex_data->num_method_ids != dex_data->num_method_ids)) {
+      LOG(WARNING) << "Checksum, NumTypeIds, or NumMethodIds mismatch for dex "
+                   << dex_data->profile_key;
+      return false;
+    }
+  }
+
+  for (const std::unique_ptr<DexFileData>& dex_data : info_) {
+    const DexFileData* other_dex_data = other.FindDexData(dex_data->profile_key,
+                                                          dex_data->checksum);
+    if (other_dex_data == nullptr) {
+      continue;
+    }
+
+    // Types with an extra descriptor can have a different index in the other profile.
+    uint32_t num_type_ids = dex_data->num_type_ids;
+    auto contains_type = [&](const ArenaSet<dex::TypeIndex>& other_types,
+                             dex::TypeIndex type_index) {
+      if (type_index.index_ >= num_type_ids) {
+        std::string_view descriptor = extra_descriptors_[type_index.index_ - num_type_ids];
+        auto it = other.extra_descriptors_indexes_.find(descriptor);
+        if (it == other.extra_descriptors_indexes_.end() ||
+            *it >= DexFile::kDexNoIndex16 - num_type_ids) {
+          return false;
+        }
+        type_index = dex::TypeIndex(num_type_ids + *it);
+      }
+      return other_types.find(type_index) != other_types.end();
+    };
+
+    // Remove the classes.
+    for (auto it = dex_data->class_set.begin(); it != dex_data->class_set.end(); ) {
+      if (contains_type(other_dex_data->class_set, *it)) {
+        it = dex_data->class_set.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    // Remove the method flags.
+    DCHECK_EQ(dex_data->bitmap_storage.size(), other_dex_data->bitmap_storage.size());
+    for (size_t i = 0; i < dex_data->bitmap_storage.size(); ++i) {
+      dex_data->bitmap_storage[i] &= ~other_dex_data->bitmap_storage[i];
+    }
+
+    // Remove the hot methods whose inline caches would not change when merged into the
+    // other profile. Missing types take precedence over megamorphic calls, which take
+    // precedence over classes.
+    for (auto method_it = dex_data->method_map.begin();
+         method_it != dex_data->method_map.end(); ) {
+      auto other_method_it = other_dex_data->method_map.find(method_it->first);
+      if (other_method_it == other_dex_data->method_map.end()) {
+        ++method_it;
+        continue;
+      }
+      InlineCacheMap& inline_cache = method_it->second;
+      const InlineCacheMap& other_inline_cache = other_method_it->second;
+      for (auto ic_it = inline_cache.begin(); ic_it != inline_cache.end(); ) {
+        auto other_ic_it = other_inline_cache.find(ic_it->first);
+        bool contained = false;
+        if (other_ic_it != other_inline_cache.end()) {
+          const DexPcData& dex_pc_data = ic_it->second;
+          const DexPcData& other_dex_pc_data = other_ic_it->second;
+          if (other_dex_pc_data.is_missing_types) {
+            contained = true;
+          } else if (other_dex_pc_data.is_megamorphic) {
+            contained = !dex_pc_data.is_missing_types;
+          } else if (!dex_pc_data.is_missing_types && !dex_pc_data.is_megamorphic) {
+            contained = std::all_of(
+                dex_pc_data.classes.begin(),
+                dex_pc_data.classes.end(),
+                [&](dex::TypeIndex type_index) {
+                  return contains_type(other_dex_pc_data.classes, type_index);
+                });
+          }
+        }
+        if (contained) {
+          ic_it = inline_cache.erase(ic_it);
+        } else {
+          ++ic_it;
+        }
+      }
+      if (inline_cache.empty()) {
+        method_it = dex_data->method_map.erase(method_it);
+      } else {
+        ++method_it;
+      }
+    }
+  }
+  return true;
+}
+
+const ProfileCompilationInfo::CompactData::DexFileData*
+ProfileCompilationInfo::CompactData::FindDexData(const std::string& profile_key) const {
+  auto it = std::find_if(dex_data_.begin(), dex_data_.end(), [&](const DexFileData& dex_data) {
+    return dex_data.profile_key == profile_key;
+  });
+  return (it != dex_data_.end()) ? &*it : nullptr;
+}
+
+// Merge the sorted `other` into the sorted `data`.
+template <typename T>
+static void MergeSortedData(std::vector<T>* data, const std::vector<T>& other) {
+  std::vector<T> result;
+  result.reserve(data->size() + other.size());
+  std::set_union(
+      data->begin(), data->end(), other.begin(), other.end(), std::back_inserter(result));
+  result.shrink_to_fit();
+  data->swap(result);
+}
+
+bool ProfileCompilationInfo::CompactData::MergeWith(const ProfileCompilationInfo& info) {
+  if (info.IsForBootImage() != for_boot_image_) {
+    LOG(WARNING) << "Cannot merge different profile versions";
+    return false;
+  }
+
+  // First verify that the profile can be merged, so that we leave the data unchanged otherwise.
+  for (const std::unique_ptr<ProfileCompilationInfo::DexFileData>& info_dex_data : info.info_) {
+    const DexFileData* dex_data = FindDexData(info_dex_data->profile_key);
+    if (dex_data != nullptr &&
+        (dex_data->checksum != info_dex_data->checksum ||
+         dex_data->num_type_ids != info_dex_data->num_type_ids ||
+         dex_data->num_method_ids != info_dex_data->num_method_ids)) {
+      LOG(WARNING) << "Checksum, NumTypeIds, or NumMethodIds mismatch for dex "
+                   << info_dex_data->profile_key;
+      return false;
+    }
+  }
+
+  for (const std::unique_ptr<ProfileCompilationInfo::DexFileData>& info_dex_data : info.info_) {
+    auto dex_data_it =
+        std::find_if(dex_data_.begin(), dex_data_.end(), [&](const DexFileData& dex_data) {
+          return dex_data.profile_key == info_dex_data->profile_key;
+        });
+    if (dex_data_it == dex_data_.end()) {
+      dex_data_.push_back(
+          DexFileData{info_dex_data->profile_key,
+                      info_dex_data->checksum,
+                      info_dex_data->num_type_ids,
+                      info_dex_data->num_method_ids,
+                      std::vector<uint8_t>(info_dex_data->bitmap_storage.size(), 0u),
+                      /*hot_methods=*/ {},
+                      /*inline_caches=*/ {},
+                      /*classes=*/ {}});
+      dex_data_it = dex_data_.end() - 1;
+    }
+    DexFileData& dex_data = *dex_data_it;
+
+    uint32_t num_type_ids = dex_data.num_type_ids;
+    auto get_type = [&](dex::TypeIndex type_index) {
+      if (type_index.index_ < num_type_ids) {
+        return static_cast<uint32_t>(type_index.index_);
+      }
+      const std::string& descriptor = info.extra_descriptors_[type_index.index_ - num_type_ids];
+      auto it = extra_descriptor_indexes_.FindOrAdd(
+          descriptor, static_cast<uint32_t>(extra_descriptor_indexes_.size()));
+      return num_type_ids + it->second;
+    };
+
+    // Merge the method flags.
+    DCHECK_EQ(dex_data.bitmap_storage.size(), info_dex_data->bitmap_storage.size());
+    for (size_t i = 0; i < dex_data.bitmap_storage.size(); ++i) {
+      dex_data.bitmap_storage[i] |= info_dex_data->bitmap_storage[i];
+    }
+
+    // Merge the classes.
+    std::vector<uint32_t> classes;
+    classes.reserve(info_dex_data->class_set.size());
+    for (dex::TypeIndex type_index : info_dex_data->class_set) {
+      classes.push_back(get_type(type_index));
+    }
+    std::sort(classes.begin(), classes.end());
+    MergeSortedData(&dex_data.classes, classes);
+
+    // Merge the hot methods and their inline caches. Missing types take precedence over
+    // megamorphic calls, which take precedence over classes.
+    std::vector<uint16_t> hot_methods;
+    hot_methods.reserve(info_dex_data->method_map.size());
+    std::vector<InlineCache> inline_caches;
+    for (const auto& [method_index, inline_cache_map] : info_dex_data->method_map) {
+      hot_methods.push_back(method_index);
+      for (const auto& [dex_pc, dex_pc_data] : inline_cache_map) {
+        InlineCache inline_cache = {method_index,
+                                    dex_pc,
+                                    dex_pc_data.is_missing_types,
+                                    dex_pc_data.is_megamorphic,
+                                    /*num_classes=*/ 0u,
+                                    /*classes=*/ {}};
+        DCHECK_LE(dex_pc_data.classes.size(), inline_cache.classes.size());
+        for (dex::TypeIndex type_index : dex_pc_data.classes) {
+          inline_cache.classes[inline_cache.num_classes++] = get_type(type_index);
+        }
+        std::sort(inline_cache.classes.begin(),
+                  inline_cache.classes.begin() + inline_cache.num_classes);
+        inline_caches.push_back(inline_cache);
+      }
+    }
+    MergeSortedData(&dex_data.hot_methods, hot_methods);
+
+    std::vector<InlineCache> merged_inline_caches;
+    merged_inline_caches.reserve(dex_data.inline_caches.size() + inline_caches.size());
+    auto less = [](const InlineCache& lhs, const InlineCache& rhs) {
+      return std::make_pair(lhs.method_index, lhs.dex_pc) <
+             std::make_pair(rhs.method_index, rhs.dex_pc);
+    };
+    auto old_it = dex_data.inline_caches.begin();
+    for (const InlineCache& inline_cache : inline_caches) {
+      while (old_it != dex_data.inline_caches.end() && less(*old_it, inline_cache)) {
+        merged_inline_caches.push_back(*old_it++);
+      }
+      if (old_it == dex_data.inline_caches.end() || less(inline_cache, *old_it)) {
+        merged_inline_caches.push_back(inline_cache);
+        continue;
+      }
+      InlineCache merged = *old_it++;
+      if (merged.is_missing_types) {
+        // Nothing to add.
+      } else if (inline_cache.is_missing_types) {
+        merged.is_missing_types = true;
+        merged.is_megamorphic = false;
+        merged.num_classes = 0u;
+      } else if (merged.is_megamorphic) {
+        // Nothing to add.
+      } else if (inline_cache.is_megamorphic) {
+        merged.is_megamorphic = true;
+        merged.num_classes = 0u;
+      } else {
+        std::array<uint32_t, 2u * (kIndividualInlineCacheSize - 1u)> classes_union;
+        size_t num_classes =
+            std::set_union(merged.classes.begin(),
+                           merged.classes.begin() + merged.num_classes,
+                           inline_cache.classes.begin(),
+                           inline_cache.classes.begin() + inline_cache.num_classes,
+                           classes_union.begin()) - classes_union.begin();
+        if (num_classes >= kIndividualInlineCacheSize) {
+          // Like `DexPcData::AddClass()`.
+          merged.is_megamorphic = true;
+          merged.num_classes = 0u;
+        } else {
+          std::copy_n(classes_union.begin(), num_classes, merged.classes.begin());
+          merged.num_classes = static_cast<uint8_t>(num_classes);
+        }
+      }
+      merged_inline_caches.push_back(merged);
+    }
+    merged_inline_caches.insert(
+        merged_inline_caches.end(), old_it, dex_data.inline_caches.end());
+    merged_inline_caches.shrink_to_fit();
+    dex_data.inline_caches.swap(merged_inline_caches);
+  }
+  return true;
+}
+
+bool ProfileCompilationInfo::RemoveDataContainedIn(const CompactData& other) {
+  if (IsForBootImage() != other.for_boot_image_) {
+    LOG(WARNING) << "Cannot compare different profile versions";
+    return false;
+  }
+
+  // First verify that the profiles can be merged, so that we leave the current
+  // profile unchanged otherwise.
+  for (const std::unique_ptr<DexFileData>& dex_data : info_) {
+    const CompactData::DexFileData* other_dex_data = other.FindDexData(dex_data->profile_key);
+    if (other_dex_data != nullptr &&
+        (other_dex_data->checksum != dex_data->checksum ||
+         other_dex_data->num_type_ids != dex_data->num_type_ids ||
+         other_dex_data->num_method_ids != dex_data->num_method_ids)) {
+      LOG(WARNING) << "Checksum, NumTypeIds, or NumMethodIds mismatch for dex "
+                   << dex_data->profile_key;
+      return false;
+    }
+  }
+
+  for (const std::unique_ptr<DexFileData>& dex_data : info_) {
+    const CompactData::DexFileData* other_dex_data = other.FindDexData(dex_data->profile_key);
+    if (other_dex_data == nullptr) {
+      continue;
+    }
+
+    // Types with an extra descriptor have the index of the descriptor in the other data.
+    uint32_t num_type_ids = dex_data->num_type_ids;
+    auto contains_type = [&](auto other_types_begin,
+                             auto other_types_end,
+                             dex::TypeIndex type_index) {
+      uint32_t other_type_index = type_index.index_;
+      if (type_index.index_ >= num_type_ids) {
+        const std::string& descriptor = extra_descriptors_[type_index.index_ - num_type_ids];
+        auto it = other.extra_descriptor_indexes_.find(descriptor);
+        if (it == other.extra_descriptor_indexes_.end()) {
+          return false;
+        }
+        other_type_index = num_type_ids + it->second;
+      }
+      return std::binary_search(other_types_begin, other_types_end, other_type_index);
+    };
+
+    // Remove the classes.
+    for (auto it = dex_data->class_set.begin(); it != dex_data->class_set.end(); ) {
+      if (contains_type(other_dex_data->classes.begin(), other_dex_data->classes.end(), *it)) {
+        it = dex_data->class_set.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    // Remove the method flags.
+    DCHECK_EQ(dex_data->bitmap_storage.size(), other_dex_data->bitmap_storage.size());
+    for (size_t i = 0; i < dex_data->bitmap_storage.size(); ++i) {
+      dex_data->bitmap_storage[i] &= ~other_dex_data->bitmap_storage[i];
+    }
+
+    // Remove the hot methods whose inline caches would not change when merged into the
+    // other data, as for a profile.
+    for (auto method_it = dex_data->method_map.begin();
+         method_it != dex_data->method_map.end(); ) {
+      uint16_t method_index = method_it->first;
+      if (!std::binary_search(other_dex_data->hot_methods.begin(),
+                              other_dex_data->hot_methods.end(),
+                              method_index)) {
+        ++method_it;
+        continue;
+      }
+      InlineCacheMap& inline_cache = method_it->second;
+      for (auto ic_it = inline_cache.begin(); ic_it != inline_cache.end(); ) {
+        uint16_t dex_pc = ic_it->first;
+        auto other_ic_it = std::lower_bound(
+            other_dex_data->inline_caches.begin(),
+            other_dex_data->inline_caches.end(),
+            std::make_pair(method_index, dex_pc),
+            [](const CompactData::InlineCache& lhs, std::pair<uint16_t, uint16_t> rhs) {
+              return std::make_pair(lhs.method_index, lhs.dex_pc) < rhs;
+            });
+        bool contained = false;
+        if (other_ic_it != other_dex_data->inline_caches.end() &&
+            other_ic_it->method_index == method_index &&
+            other_ic_it->dex_pc == dex_pc) {
+          const DexPcData& dex_pc_data = ic_it->second;
+          if (other_ic_it->is_missing_types) {
+            contained = true;
+          } else if (other_ic_it->is_megamorphic) {
+            contained = !dex_pc_data.is_missing_types;
+          } else if (!dex_pc_data.is_missing_types && !dex_pc_data.is_megamorphic) {
+            auto other_classes_begin = other_ic_it->classes.begin();
+            auto other_classes_end = other_classes_begin + other_ic_it->num_classes;
+            contained = std::all_of(
+                dex_pc_data.classes.begin(),
+                dex_pc_data.classes.end(),
+                [&](dex::TypeIndex type_index) {
+                  return contains_type(other_classes_begin, other_classes_end, type_index);
+                });
+          }
+        }
+        if (contained) {
+          ic_it = inline_cache.erase(ic_it);
+        } else {
+          ++ic_it;
+        }
+      }
+      if (inline_cache.empty()) {
+        method_it = dex_data->method_map.erase(method_it);
+      } else {
+        ++method_it;
+      }
+    }
+  }
+  return true;
+}
+
 ProfileCompilationInfo::MethodHotness ProfileCompilationInfo::GetMethodHotness(
     const MethodReference& method_ref,
     const ProfileSampleAnnotation& annotation) const {
@@ -3062,4 +3659,300 @@ void FlattenProfileData::MergeData(const FlattenProfileData& other) {
   }
 }
 
+// Reads an integer written with `SafeBuffer::WriteUintAndAdvance()` from a memory map.
+template <typename T>
+static T ReadMappedUint(const uint8_t* ptr) {
+  static_assert(std::is_unsigned<T>::value, "Type is not unsigned");
+  T value;
+  memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+// Returns true if the sorted `uint16_t` array at `data` contains `value`.
+static bool MappedSortedArrayContains(const uint8_t* data, uint32_t size, uint16_t value) {
+  uint32_t low = 0u;
+  uint32_t high = size;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2u;
+    uint16_t mid_value = ReadMappedUint<uint16_t>(data + mid * sizeof(uint16_t));
+    if (mid_value < value) {
+      low = mid + 1u;
+    } else if (mid_value > value) {
+      high = mid;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::unique_ptr<MappedProfileCompilationInfo> MappedProfileCompilationInfo::Create(
+    int fd, /*out*/ std::string* error) {
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  using FileHeader = ProfileCompilationInfo::FileHeader;
+  using FileSectionInfo = ProfileCompilationInfo::FileSectionInfo;
+  using FileSectionType = ProfileCompilationInfo::FileSectionType;
+
+  struct stat stat_buffer;
+  if (fstat(fd, &stat_buffer) != 0) {
+    *error = std::string("Failed to stat profile: ") + strerror(errno);
+    return nullptr;
+  }
+  size_t file_size = static_cast<size_t>(stat_buffer.st_size);
+  if (file_size < sizeof(FileHeader)) {
+    *error = "Profile is too small.";
+    return nullptr;
+  }
+  MemMap map = MemMap::MapFile(file_size,
+                               PROT_READ,
+                               MAP_PRIVATE,
+                               fd,
+                               /*start=*/ 0,
+                               /*low_4gb=*/ false,
+                               "profile",
+                               error);
+  if (!map.IsValid()) {
+    return nullptr;
+  }
+  const uint8_t* begin = map.Begin();
+
+  // Read the header and section infos.
+  FileHeader header;
+  memcpy(&header, begin, sizeof(FileHeader));
+  if (!header.IsValid()) {
+    header.InvalidHeaderMessage(error);
+    return nullptr;
+  }
+  bool is_for_boot_image = memcmp(header.GetVersion(),
+                                  ProfileCompilationInfo::kProfileVersionForBootImage,
+                                  ProfileCompilationInfo::kProfileVersionSize) == 0;
+  uint32_t section_count = header.GetFileSectionCount();
+  if (section_count > (file_size - sizeof(FileHeader)) / sizeof(FileSectionInfo)) {
+    *error = "Profile is too small for its section infos.";
+    return nullptr;
+  }
+  dchecked_vector<FileSectionInfo> section_infos(section_count);
+  memcpy(section_infos.data(),
+         begin + sizeof(FileHeader),
+         section_count * sizeof(FileSectionInfo));
+  if (section_infos[0].GetType() != FileSectionType::kDexFiles) {
+    *error = "First section is not dex files section.";
+    return nullptr;
+  }
+  uint64_t segment_size = sizeof(FileHeader) + section_count * sizeof(FileSectionInfo);
+  const FileSectionInfo* index_section_info = nullptr;
+  for (const FileSectionInfo& section_info : section_infos) {
+    uint64_t section_end =
+        static_cast<uint64_t>(section_info.GetFileOffset()) + section_info.GetFileSize();
+    if (section_end > file_size) {
+      *error = "Profile section extends past the end of the file.";
+      return nullptr;
+    }
+    segment_size = std::max(segment_size, section_end);
+    if (section_info.GetType() == FileSectionType::kMappableIndex) {
+      index_section_info = &section_info;
+    }
+  }
+  if (segment_size != file_size) {
+    // The data appended to the profile is not in the mappable index.
+    *error = "Profile has appended segments.";
+    return nullptr;
+  }
+  if (index_section_info == nullptr) {
+    *error = "Profile does not have a mappable index section.";
+    return nullptr;
+  }
+  const FileSectionInfo& dex_files_section_info = section_infos[0];
+  if (dex_files_section_info.GetInflatedSize() != 0u ||
+      index_section_info->GetInflatedSize() != 0u) {
+    *error = "Compressed dex files or mappable index section.";
+    return nullptr;
+  }
+
+  std::unique_ptr<MappedProfileCompilationInfo> result(
+      new MappedProfileCompilationInfo(std::move(map), is_for_boot_image));
+
+  // Read the dex files section. The profile keys point into the map.
+  const uint8_t* ptr = begin + dex_files_section_info.GetFileOffset();
+  const uint8_t* end = ptr + dex_files_section_info.GetFileSize();
+  auto read_uint = [&](auto* value) {
+    if (sizeof(*value) > static_cast<size_t>(end - ptr)) {
+      return false;
+    }
+    memcpy(value, ptr, sizeof(*value));
+    ptr += sizeof(*value);
+    return true;
+  };
+  ProfileCompilationInfo::ProfileIndexType num_dex_files;
+  if (!read_uint(&num_dex_files)) {
+    *error = "Error reading number of dex files.";
+    return nullptr;
+  }
+  result->dex_files_.resize(num_dex_files);
+  for (DexFileEntry& entry : result->dex_files_) {
+    uint32_t num_type_ids;
+    uint16_t profile_key_size;
+    if (!read_uint(&entry.checksum) ||
+        !read_uint(&num_type_ids) ||
+        !read_uint(&entry.num_method_ids) ||
+        !read_uint(&profile_key_size) ||
+        profile_key_size > static_cast<size_t>(end - ptr)) {
+      *error = "Error reading dex file data.";
+      return nullptr;
+    }
+    entry.profile_key = std::string_view(reinterpret_cast<const char*>(ptr), profile_key_size);
+    ptr += profile_key_size;
+  }
+
+  // Read the mappable index section.
+  const uint8_t* index_begin = begin + index_section_info->GetFileOffset();
+  size_t index_size = index_section_info->GetFileSize();
+  ptr = index_begin;
+  end = index_begin + index_size;
+  uint32_t num_index_dex_files;
+  if (!read_uint(&num_index_dex_files) || num_index_dex_files != num_dex_files) {
+    *error = "Mappable index does not match the dex files.";
+    return nullptr;
+  }
+  for (DexFileEntry& entry : result->dex_files_) {
+    uint32_t dex_data_offset;
+    if (!read_uint(&dex_data_offset) ||
+        dex_data_offset > index_size ||
+        2 * sizeof(uint32_t) > index_size - dex_data_offset) {
+      *error = "Bad mappable index dex data offset.";
+      return nullptr;
+    }
+    const uint8_t* dex_data = index_begin + dex_data_offset;
+    entry.number_of_classes = ReadMappedUint<uint32_t>(dex_data);
+    entry.number_of_hot_methods = ReadMappedUint<uint32_t>(dex_data + sizeof(uint32_t));
+    uint64_t dex_data_size =
+        2 * sizeof(uint32_t) +
+        sizeof(uint16_t) * (static_cast<uint64_t>(entry.number_of_classes) +
+                            entry.number_of_hot_methods) +
+        ProfileCompilationInfo::DexFileData::ComputeBitmapStorage(is_for_boot_image,
+                                                                  entry.num_method_ids);
+    if (dex_data_size > index_size - dex_data_offset) {
+      *error = "Mappable index dex data extends past the end of the section.";
+      return nullptr;
+    }
+    entry.classes = dex_data + 2 * sizeof(uint32_t);
+    entry.hot_methods = entry.classes + sizeof(uint16_t) * entry.number_of_classes;
+    entry.method_bitmap = entry.hot_methods + sizeof(uint16_t) * entry.number_of_hot_methods;
+  }
+  return result;
+}
+
+const MappedProfileCompilationInfo::DexFileEntry* MappedProfileCompilationInfo::FindDexFile(
+    const DexFile* dex_file,
+    const ProfileSampleAnnotation& annotation) const {
+  // Same lookup as `ProfileCompilationInfo::FindDexDataUsingAnnotations()`.
+  if (annotation == ProfileSampleAnnotation::kNone) {
+    std::string_view profile_key =
+        ProfileCompilationInfo::GetProfileDexFileBaseKeyView(dex_file->GetLocation());
+    for (const DexFileEntry& entry : dex_files_) {
+      if (profile_key == ProfileCompilationInfo::GetBaseKeyViewFromAugmentedKey(
+                             entry.profile_key)) {
+        return ChecksumMatch(entry.checksum, dex_file->GetLocationChecksum()) ? &entry : nullptr;
+      }
+    }
+  } else {
+    std::string profile_key = ProfileCompilationInfo::GetProfileDexFileAugmentedKey(
+        dex_file->GetLocation(), annotation);
+    for (const DexFileEntry& entry : dex_files_) {
+      if (entry.profile_key == profile_key) {
+        return ChecksumMatch(entry.checksum, dex_file->GetLocationChecksum()) ? &entry : nullptr;
+      }
+    }
+  }
+  return nullptr;
+}
+
+uint32_t MappedProfileCompilationInfo::GetNumberOfMethods(
+    const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn) const {
+  uint32_t total = 0;
+  for (const DexFileEntry& entry : dex_files_) {
+    if (filter_fn(std::string(entry.profile_key), entry.checksum)) {
+      total += entry.number_of_hot_methods;
+    }
+  }
+  return total;
+}
+
+uint32_t MappedProfileCompilationInfo::GetNumberOfResolvedClasses(
+    const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn) const {
+  uint32_t total = 0;
+  for (const DexFileEntry& entry : dex_files_) {
+    if (filter_fn(std::string(entry.profile_key), entry.checksum)) {
+      total += entry.number_of_classes;
+    }
+  }
+  return total;
+}
+
+bool MappedProfileCompilationInfo::IsHotMethod(const DexFileEntry& entry,
+                                               uint32_t method_index) const {
+  return method_index < entry.num_method_ids &&
+         MappedSortedArrayContains(entry.hot_methods,
+                                   entry.number_of_hot_methods,
+                                   dchecked_integral_cast<uint16_t>(method_index));
+}
+
+ProfileCompilationInfo::MethodHotness MappedProfileCompilationInfo::GetMethodHotness(
+    const MethodReference& method_ref,
+    const ProfileSampleAnnotation& annotation) const {
+  MethodHotness hotness;
+  const DexFileEntry* entry = FindDexFile(method_ref.dex_file, annotation);
+  if (entry == nullptr || method_ref.index >= entry->num_method_ids) {
+    return hotness;
+  }
+  // The bitmap has one `num_method_ids` bits region for each flag, starting with
+  // the startup flag. There is no region for the hot flag.
+  size_t bitmap_bits = ProfileCompilationInfo::DexFileData::ComputeBitmapBits(
+      is_for_boot_image_, entry->num_method_ids);
+  BitMemoryRegion method_bitmap(
+      const_cast<uint8_t*>(entry->method_bitmap), /*bit_start=*/ 0, bitmap_bits);
+  uint32_t last_flag = is_for_boot_image_
+      ? MethodHotness::kFlagLastBoot
+      : MethodHotness::kFlagLastRegular;
+  for (uint32_t flag = MethodHotness::kFlagStartup; flag <= last_flag; flag = flag << 1) {
+    size_t flag_bitmap_index = WhichPowerOf2(flag) - 1u;
+    if (method_bitmap.LoadBit(method_ref.index + flag_bitmap_index * entry->num_method_ids)) {
+      hotness.AddFlag(static_cast<MethodHotness::Flag>(flag));
+    }
+  }
+  if (IsHotMethod(*entry, method_ref.index)) {
+    hotness.AddFlag(MethodHotness::kFlagHot);
+  }
+  return hotness;
+}
+
+bool MappedProfileCompilationInfo::IsHotMethod(const MethodReference& method_ref,
+                                               const ProfileSampleAnnotation& annotation) const {
+  const DexFileEntry* entry = FindDexFile(method_ref.dex_file, annotation);
+  return entry != nullptr && IsHotMethod(*entry, method_ref.index);
+}
+
+bool MappedProfileCompilationInfo::ContainsClass(const DexFile& dex_file,
+                                                 dex::TypeIndex type_idx,
+                                                 const ProfileSampleAnnotation& annotation) const {
+  const DexFileEntry* entry = FindDexFile(&dex_file, annotation);
+  return entry != nullptr &&
+         MappedSortedArrayContains(entry->classes, entry->number_of_classes, type_idx.index_);
+}
+
+bool MappedProfileCompilationInfo::GetClasses(const DexFile& dex_file,
+                                              /*out*/ std::vector<dex::TypeIndex>* class_types,
+                                              const ProfileSampleAnnotation& annotation) const {
+  const DexFileEntry* entry = FindDexFile(&dex_file, annotation);
+  if (entry == nullptr) {
+    return false;
+  }
+  class_types->reserve(class_types->size() + entry->number_of_classes);
+  for (uint32_t i = 0; i != entry->number_of_classes; ++i) {
+    class_types->push_back(
+        dex::TypeIndex(ReadMappedUint<uint16_t>(entry->classes + i * sizeof(uint16_t))));
+  }
+  return true;
+}
+
 }  // namespace art
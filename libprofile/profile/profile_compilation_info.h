@@ -76,6 +76,7 @@ struct ProfileMethodInfo {
 };
 
 class FlattenProfileData;
+class MappedProfileCompilationInfo;
 
 /**
  * Profile information in a format suitable to be queried by the compiler and
@@ -443,6 +444,7 @@ class ProfileCompilationInfo {
   // If filter_fn is present, it will be used to filter out profile data belonging
   // to dex file which do not comply with the filter
   // (i.e. for which filter_fn(dex_location, dex_checksum) is false).
+  // If the file contains several profile segments (see `Append()`), their data is merged.
   using ProfileLoadFilterFn = std::function<bool(const std::string&, uint32_t)>;
   // Profile filter method which accepts all dex locations.
   // This is convenient to use when we need to accept all locations without repeating the same
@@ -479,14 +481,87 @@ class ProfileCompilationInfo {
   // Merge profile information from the given file descriptor.
   bool MergeWith(const std::string& filename);
 
-  // Save the profile data to the given file descriptor.
-  bool Save(int fd);
+  // Save the profile data to the given file descriptor, at its current offset.
+  // If `add_mappable_section` is true, also write the hot methods, classes and method
+  // flags uncompressed and sorted, so that the profile can be queried with
+  // MappedProfileCompilationInfo without loading it.
+  bool Save(int fd, bool add_mappable_section = false);
 
   // Save the current profile into the given file. Overwrites any existing data.
-  bool Save(const std::string& filename, uint64_t* bytes_written);
+  // See `Save(int, bool)` for `add_mappable_section`.
+  bool Save(const std::string& filename,
+            uint64_t* bytes_written,
+            bool add_mappable_section = false);
+
+  // Append the current profile to the given file as a new profile segment.
+  // Loading a file merges the data of all its segments, so this is equivalent to
+  // merging the current profile into the file and saving it, but only writes the new data.
+  // Fails without writing anything if the size of the file is not `expected_size`, i.e. if
+  // the file was modified since the caller last wrote it. On success, `bytes_written` is
+  // the size of the new segment.
+  bool Append(const std::string& filename,
+              uint64_t expected_size,
+              /*out*/ uint64_t* bytes_written);
+
+  // Remove from the current profile the data that is already contained in `other`, so
+  // that only the data that merging the current profile into `other` would add remains.
+  // Returns false and leaves the current profile unchanged if the two profiles cannot
+  // be merged (e.g. a dex file checksum mismatch).
+  bool RemoveDataContainedIn(const ProfileCompilationInfo& other);
+
+  // A compact copy of the data of profiles, for callers that only keep profile data to find
+  // out which data of another profile is new, see `RemoveDataContainedIn()`. It keeps the
+  // method flags, the hot methods with their inline caches and the classes in flat sorted
+  // arrays, instead of the arena-allocated maps of a profile.
+  class CompactData {
+   public:
+    explicit CompactData(bool for_boot_image) : for_boot_image_(for_boot_image) {}
+
+    // Add the data of `info`. Returns false and leaves the data unchanged if it cannot be
+    // merged (e.g. a dex file checksum mismatch).
+    bool MergeWith(const ProfileCompilationInfo& info);
+
+   private:
+    // The inline cache of a hot method at a dex pc, see `DexPcData`. Types of extra
+    // descriptors have the index `num_type_ids` + their index in `extra_descriptor_indexes_`.
+    struct InlineCache {
+      uint16_t method_index;
+      uint16_t dex_pc;
+      bool is_missing_types;
+      bool is_megamorphic;
+      uint8_t num_classes;
+      std::array<uint32_t, kIndividualInlineCacheSize - 1u> classes;  // Sorted.
+    };
+
+    struct DexFileData {
+      std::string profile_key;
+      uint32_t checksum;
+      uint32_t num_type_ids;
+      uint32_t num_method_ids;
+      std::vector<uint8_t> bitmap_storage;
+      std::vector<uint16_t> hot_methods;  // Sorted.
+      std::vector<InlineCache> inline_caches;  // Sorted by method index and dex pc.
+      std::vector<uint32_t> classes;  // Sorted.
+    };
+
+    const DexFileData* FindDexData(const std::string& profile_key) const;
+
+    const bool for_boot_image_;
+    std::vector<DexFileData> dex_data_;
+    SafeMap<std::string, uint32_t> extra_descriptor_indexes_;
+
+    friend class ProfileCompilationInfo;
+
+    DISALLOW_COPY_AND_ASSIGN(CompactData);
+  };
+
+  // Same as above, for profile data kept as `CompactData`.
+  bool RemoveDataContainedIn(const CompactData& other);
 
   // A fallback implementation of `Save` that uses a flock.
-  bool SaveFallback(const std::string& filename, uint64_t* bytes_written);
+  bool SaveFallback(const std::string& filename,
+                    uint64_t* bytes_written,
+                    bool add_mappable_section);
 
   // Return the number of dex files referenced in the profile.
   size_t GetNumberOfDexFiles() const {
@@ -1025,6 +1100,22 @@ class ProfileCompilationInfo {
       const dchecked_vector<ExtraDescriptorIndex>& extra_descriptors_remap,
       /*out*/ std::string* error);
 
+  // Read the header and section infos of the profile segment at the current source offset.
+  // The `segment_size` is the size of the segment in the file, including all its sections.
+  ProfileLoadStatus ReadSegmentHeader(
+      ProfileSource& source,
+      /*out*/ dchecked_vector<FileSectionInfo>* section_infos,
+      /*out*/ uint64_t* segment_size,
+      /*out*/ std::string* error);
+
+  // Read and merge the sections of a profile segment.
+  ProfileLoadStatus ReadSegmentSections(
+      ProfileSource& source,
+      const dchecked_vector<FileSectionInfo>& section_infos,
+      bool merge_classes,
+      const ProfileLoadFilterFn& filter_fn,
+      /*out*/ std::string* error);
+
   // Entry point for profile loading functionality.
   ProfileLoadStatus LoadInternal(
       int32_t fd,
@@ -1067,6 +1158,7 @@ class ProfileCompilationInfo {
   friend class CompilerDriverProfileTest;
   friend class ProfileAssistantTest;
   friend class Dex2oatLayoutTest;
+  friend class MappedProfileCompilationInfo;
 
   MallocArenaPool default_arena_pool_;
   ArenaAllocator allocator_;
@@ -1191,6 +1283,95 @@ inline ProfileCompilationInfo::DexReferenceDumper ProfileCompilationInfo::DumpDe
 
 std::ostream& operator<<(std::ostream& stream, ProfileCompilationInfo::DexReferenceDumper dumper);
 
+/**
+ * Read-only view of a profile saved with a mappable section (see ProfileCompilationInfo::Save).
+ * Queries are answered directly from a memory map of the profile file, without
+ * decompressing the profile or building its method and class maps. This makes it
+ * cheap to check a few methods or classes of a large profile.
+ *
+ * The view does not provide inline caches. Use ProfileCompilationInfo for those.
+ */
+class MappedProfileCompilationInfo {
+ public:
+  using MethodHotness = ProfileCompilationInfo::MethodHotness;
+  using ProfileSampleAnnotation = ProfileCompilationInfo::ProfileSampleAnnotation;
+
+  // Map the profile in the given file. Returns null and sets `error` if the file is not
+  // a profile, does not have the mappable section or has appended segments
+  // (see ProfileCompilationInfo::Append).
+  static std::unique_ptr<MappedProfileCompilationInfo> Create(int fd,
+                                                              /*out*/ std::string* error);
+
+  bool IsForBootImage() const {
+    return is_for_boot_image_;
+  }
+
+  // Return the number of dex files referenced in the profile.
+  size_t GetNumberOfDexFiles() const {
+    return dex_files_.size();
+  }
+
+  // Return the number of hot methods and resolved classes of the dex files accepted by
+  // `filter_fn`, as `ProfileCompilationInfo` would after loading the profile with it.
+  uint32_t GetNumberOfMethods(const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn =
+                                  ProfileCompilationInfo::ProfileFilterFnAcceptAll) const;
+  uint32_t GetNumberOfResolvedClasses(
+      const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn =
+          ProfileCompilationInfo::ProfileFilterFnAcceptAll) const;
+
+  // Return the hotness of the given method. The inline cache map is always null.
+  MethodHotness GetMethodHotness(
+      const MethodReference& method_ref,
+      const ProfileSampleAnnotation& annotation = ProfileSampleAnnotation::kNone) const;
+
+  // Return true if the given method is hot.
+  bool IsHotMethod(
+      const MethodReference& method_ref,
+      const ProfileSampleAnnotation& annotation = ProfileSampleAnnotation::kNone) const;
+
+  // Return true if the class's type is present in the profiling info.
+  bool ContainsClass(
+      const DexFile& dex_file,
+      dex::TypeIndex type_idx,
+      const ProfileSampleAnnotation& annotation = ProfileSampleAnnotation::kNone) const;
+
+  // Append the classes of the given dex file to `class_types`, in increasing type index
+  // order. Returns false if the profile does not contain the dex file.
+  bool GetClasses(
+      const DexFile& dex_file,
+      /*out*/ std::vector<dex::TypeIndex>* class_types,
+      const ProfileSampleAnnotation& annotation = ProfileSampleAnnotation::kNone) const;
+
+ private:
+  // The data of a dex file. All pointers point into the memory map.
+  struct DexFileEntry {
+    std::string_view profile_key;
+    uint32_t checksum;
+    uint32_t num_method_ids;
+    uint32_t number_of_classes;
+    uint32_t number_of_hot_methods;
+    const uint8_t* classes;      // Sorted `uint16_t` type indexes.
+    const uint8_t* hot_methods;  // Sorted `uint16_t` method indexes.
+    const uint8_t* method_bitmap;
+  };
+
+  MappedProfileCompilationInfo(MemMap&& map, bool is_for_boot_image)
+      : map_(std::move(map)), is_for_boot_image_(is_for_boot_image) {}
+
+  // Find the data for the given dex file, or null if the profile does not contain it
+  // or has a different checksum.
+  const DexFileEntry* FindDexFile(const DexFile* dex_file,
+                                  const ProfileSampleAnnotation& annotation) const;
+
+  bool IsHotMethod(const DexFileEntry& entry, uint32_t method_index) const;
+
+  MemMap map_;
+  const bool is_for_boot_image_;
+  std::vector<DexFileEntry> dex_files_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedProfileCompilationInfo);
+};
+
 }  // namespace art
 
 #endif  // ART_LIBPROFILE_PROFILE_PROFILE_COMPILATION_INFO_H_
@@ -316,6 +316,207 @@ TEST_F(ProfileCompilationInfoTest, SaveFd) {
   ASSERT_TRUE(loaded_info2.Equals(saved_info));
 }
 
+TEST_F(ProfileCompilationInfoTest, AppendDelta) {
+  ScratchFile profile;
+
+  ProfileCompilationInfo saved_info;
+  for (uint16_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(AddMethod(&saved_info, dex1, /*method_idx=*/ i));
+    ASSERT_TRUE(AddMethod(&saved_info, dex2, /*method_idx=*/ i, Hotness::kFlagStartup));
+  }
+  ASSERT_TRUE(AddClass(&saved_info, dex1, dex::TypeIndex(0)));
+  uint64_t file_size = 0u;
+  ASSERT_TRUE(saved_info.Save(profile.GetFilename(), &file_size));
+
+  // Collect new data, some of which is already saved.
+  ProfileCompilationInfo delta;
+  std::vector<ProfileInlineCache> inline_caches = GetTestInlineCaches();
+  for (uint16_t i = 5; i < 20; i++) {
+    ASSERT_TRUE(AddMethod(&delta, dex1, /*method_idx=*/ i));
+    ASSERT_TRUE(AddMethod(&delta, dex2, /*method_idx=*/ i, Hotness::kFlagStartup));
+    ASSERT_TRUE(AddMethod(&delta, dex3, /*method_idx=*/ i, inline_caches));
+  }
+  ASSERT_TRUE(AddClass(&delta, dex1, dex::TypeIndex(0)));
+  ASSERT_TRUE(AddClass(&delta, dex1, dex::TypeIndex(1)));
+  ProfileCompilationInfo expected_info;
+  ASSERT_TRUE(expected_info.MergeWith(saved_info));
+  ASSERT_TRUE(expected_info.MergeWith(delta));
+
+  // Only the new data remains.
+  ASSERT_TRUE(delta.RemoveDataContainedIn(saved_info));
+  ASSERT_FALSE(GetMethod(delta, dex1, /*method_idx=*/ 5).IsInProfile());
+  ASSERT_TRUE(GetMethod(delta, dex1, /*method_idx=*/ 10).IsHot());
+  ASSERT_FALSE(GetMethod(delta, dex2, /*method_idx=*/ 5).IsInProfile());
+  ASSERT_TRUE(GetMethod(delta, dex2, /*method_idx=*/ 10).IsStartup());
+  ASSERT_EQ(delta.GetNumberOfMethods(), 10u + 15u);
+  ASSERT_EQ(delta.GetNumberOfResolvedClasses(), 1u);
+
+  // Appending fails if the file changed since it was saved.
+  uint64_t bytes_written = 0u;
+  ASSERT_FALSE(delta.Append(profile.GetFilename(), file_size + 1u, &bytes_written));
+  ASSERT_TRUE(delta.Append(profile.GetFilename(), file_size, &bytes_written));
+  ASSERT_EQ(file_size + bytes_written, static_cast<uint64_t>(profile.GetFile()->GetLength()));
+
+  // Loading the file merges the appended data.
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(expected_info));
+
+  // An incomplete append is ignored.
+  uint8_t zeros[64] = {};
+  ASSERT_TRUE(profile.GetFile()->PwriteFully(zeros, sizeof(zeros), file_size + bytes_written));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+  ProfileCompilationInfo loaded_info2;
+  ASSERT_TRUE(loaded_info2.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info2.Equals(expected_info));
+}
+
+TEST_F(ProfileCompilationInfoTest, RemoveDataContainedInFail) {
+  ProfileCompilationInfo info1;
+  ASSERT_TRUE(AddMethod(&info1, dex1, /*method_idx=*/ 1));
+  ProfileCompilationInfo info2;
+  ASSERT_TRUE(AddMethod(&info2, dex1_checksum_missmatch, /*method_idx=*/ 1));
+
+  // The profiles cannot be merged, nothing is removed.
+  ASSERT_FALSE(info1.RemoveDataContainedIn(info2));
+  ASSERT_TRUE(GetMethod(info1, dex1, /*method_idx=*/ 1).IsHot());
+}
+
+TEST_F(ProfileCompilationInfoTest, RemoveDataContainedInCompactData) {
+  // Build the saved data in two steps, like a save followed by an append.
+  std::vector<ProfileInlineCache> inline_caches = GetTestInlineCaches();
+  ProfileCompilationInfo saved_info;
+  ProfileCompilationInfo appended_info;
+  for (uint16_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(AddMethod(&saved_info, dex1, /*method_idx=*/ i));
+    ASSERT_TRUE(AddMethod(&saved_info, dex2, /*method_idx=*/ i, Hotness::kFlagStartup));
+    ASSERT_TRUE(AddMethod(&appended_info, dex3, /*method_idx=*/ i, inline_caches));
+  }
+  ASSERT_TRUE(AddClass(&saved_info, dex1, dex::TypeIndex(0)));
+  ProfileCompilationInfo::CompactData compact_data(/*for_boot_image=*/ false);
+  ASSERT_TRUE(compact_data.MergeWith(saved_info));
+  ASSERT_TRUE(compact_data.MergeWith(appended_info));
+  ProfileCompilationInfo full_info;
+  ASSERT_TRUE(full_info.MergeWith(saved_info));
+  ASSERT_TRUE(full_info.MergeWith(appended_info));
+
+  // Collect new data, some of which is already saved, including inline caches which
+  // become megamorphic.
+  std::vector<ProfileInlineCache> megamorphic_inline_caches = GetTestInlineCaches();
+  MakeMegamorphic(&megamorphic_inline_caches);
+  auto add_delta = [&](ProfileCompilationInfo* info) {
+    for (uint16_t i = 5; i < 20; i++) {
+      ASSERT_TRUE(AddMethod(info, dex1, /*method_idx=*/ i));
+      ASSERT_TRUE(AddMethod(info, dex2, /*method_idx=*/ i, Hotness::kFlagStartup));
+      ASSERT_TRUE(AddMethod(
+          info, dex3, /*method_idx=*/ i, (i < 8) ? inline_caches : megamorphic_inline_caches));
+    }
+    ASSERT_TRUE(AddClass(info, dex1, dex::TypeIndex(0)));
+    ASSERT_TRUE(AddClass(info, dex1, dex::TypeIndex(1)));
+  };
+  ProfileCompilationInfo delta;
+  add_delta(&delta);
+  ProfileCompilationInfo expected_delta;
+  add_delta(&expected_delta);
+
+  // The compact data removes the same data as the profile it was built from.
+  ASSERT_TRUE(expected_delta.RemoveDataContainedIn(full_info));
+  ASSERT_TRUE(delta.RemoveDataContainedIn(compact_data));
+  ASSERT_TRUE(delta.Equals(expected_delta));
+  ASSERT_FALSE(GetMethod(delta, dex1, /*method_idx=*/ 5).IsInProfile());
+  ASSERT_TRUE(GetMethod(delta, dex1, /*method_idx=*/ 10).IsHot());
+  ASSERT_TRUE(GetMethod(delta, dex3, /*method_idx=*/ 8).IsHot());
+  ASSERT_EQ(delta.GetNumberOfResolvedClasses(), 1u);
+}
+
+TEST_F(ProfileCompilationInfoTest, RemoveDataContainedInCompactDataFail) {
+  ProfileCompilationInfo info1;
+  ASSERT_TRUE(AddMethod(&info1, dex1, /*method_idx=*/ 1));
+  ProfileCompilationInfo info2;
+  ASSERT_TRUE(AddMethod(&info2, dex1_checksum_missmatch, /*method_idx=*/ 1));
+  ProfileCompilationInfo::CompactData compact_data(/*for_boot_image=*/ false);
+  ASSERT_TRUE(compact_data.MergeWith(info2));
+
+  // The profiles cannot be merged, nothing is added or removed.
+  ASSERT_FALSE(compact_data.MergeWith(info1));
+  ASSERT_FALSE(info1.RemoveDataContainedIn(compact_data));
+  ASSERT_TRUE(GetMethod(info1, dex1, /*method_idx=*/ 1).IsHot());
+}
+
+TEST_F(ProfileCompilationInfoTest, MappedProfile) {
+  ScratchFile profile;
+
+  ProfileCompilationInfo saved_info;
+  for (uint16_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(AddMethod(&saved_info, dex1, /*method_idx=*/ 2 * i));
+    ASSERT_TRUE(AddMethod(&saved_info, dex2, /*method_idx=*/ i, Hotness::kFlagStartup));
+    ASSERT_TRUE(AddMethod(&saved_info, dex2, /*method_idx=*/ i + 5, Hotness::kFlagPostStartup));
+    if (i % 2 == 0) {
+      ASSERT_TRUE(AddClass(&saved_info, dex1, dex::TypeIndex(i)));
+    }
+  }
+  ASSERT_TRUE(saved_info.Save(GetFd(profile), /*add_mappable_section=*/ true));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  // The mappable section does not change the loaded profile.
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(saved_info));
+
+  std::string error;
+  std::unique_ptr<MappedProfileCompilationInfo> mapped_info =
+      MappedProfileCompilationInfo::Create(GetFd(profile), &error);
+  ASSERT_TRUE(mapped_info != nullptr) << error;
+  ASSERT_FALSE(mapped_info->IsForBootImage());
+  ASSERT_EQ(mapped_info->GetNumberOfDexFiles(), 2u);
+  for (const DexFile* dex : {dex1, dex2, dex3}) {
+    for (uint16_t method_idx = 0; method_idx < 30; method_idx++) {
+      MethodReference ref(dex, method_idx);
+      ASSERT_EQ(saved_info.GetMethodHotness(ref).GetFlags(),
+                mapped_info->GetMethodHotness(ref).GetFlags());
+      ASSERT_EQ(saved_info.GetMethodHotness(ref).IsHot(), mapped_info->IsHotMethod(ref));
+    }
+    for (uint16_t type_idx = 0; type_idx < dex->NumTypeIds(); type_idx++) {
+      ASSERT_EQ(saved_info.ContainsClass(*dex, dex::TypeIndex(type_idx)),
+                mapped_info->ContainsClass(*dex, dex::TypeIndex(type_idx)));
+    }
+    std::vector<dex::TypeIndex> mapped_classes;
+    const ArenaSet<dex::TypeIndex>* classes = saved_info.GetClasses(*dex);
+    ASSERT_EQ(classes != nullptr, mapped_info->GetClasses(*dex, &mapped_classes));
+    if (classes != nullptr) {
+      ASSERT_EQ(std::vector<dex::TypeIndex>(classes->begin(), classes->end()), mapped_classes);
+    }
+  }
+  // Dex files with a different checksum are not found.
+  ASSERT_FALSE(mapped_info->IsHotMethod(MethodReference(dex1_checksum_missmatch, 0)));
+
+  // The counts match the loaded profile, also when filtering out dex files.
+  ASSERT_EQ(saved_info.GetNumberOfMethods(), mapped_info->GetNumberOfMethods());
+  ASSERT_EQ(saved_info.GetNumberOfResolvedClasses(), mapped_info->GetNumberOfResolvedClasses());
+  ProfileCompilationInfo::ProfileLoadFilterFn filter_fn =
+      [](const std::string& profile_key, uint32_t checksum) {
+        return profile_key == "location2" && checksum == 2u;
+      };
+  ProfileCompilationInfo filtered_info;
+  ASSERT_TRUE(filtered_info.Load(GetFd(profile), /*merge_classes=*/ true, filter_fn));
+  ASSERT_EQ(filtered_info.GetNumberOfMethods(), mapped_info->GetNumberOfMethods(filter_fn));
+  ASSERT_EQ(filtered_info.GetNumberOfResolvedClasses(),
+            mapped_info->GetNumberOfResolvedClasses(filter_fn));
+}
+
+TEST_F(ProfileCompilationInfoTest, MappedProfileFail) {
+  ScratchFile profile;
+
+  // A profile without the mappable section cannot be mapped.
+  ProfileCompilationInfo saved_info;
+  ASSERT_TRUE(AddMethod(&saved_info, dex1, /*method_idx=*/ 1));
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+  std::string error;
+  ASSERT_TRUE(MappedProfileCompilationInfo::Create(GetFd(profile), &error) == nullptr);
+  ASSERT_FALSE(error.empty());
+}
+
 TEST_F(ProfileCompilationInfoTest, AddMethodsAndClassesFail) {
   ScratchFile profile;
 
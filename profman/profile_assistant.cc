@@ -16,6 +16,9 @@
 
 #include "profile_assistant.h"
 
+#include <memory>
+#include <string>
+
 #include "base/os.h"
 #include "base/unix_file/fd_file.h"
 #include "profman/profman_result.h"
@@ -32,6 +35,23 @@ ProfmanResult::ProcessingResult ProfileAssistant::ProcessProfilesInternal(
     const ScopedFlock& reference_profile_file,
     const ProfileCompilationInfo::ProfileLoadFilterFn& filter_fn,
     const Options& options) {
+  // Without current profiles, we only need to know whether the reference profile is empty.
+  // If it has the mappable section, answer that from the section instead of loading it.
+  if (profile_files.empty() && !options.IsForceMerge()) {
+    std::string error;
+    std::unique_ptr<MappedProfileCompilationInfo> mapped_info =
+        MappedProfileCompilationInfo::Create(reference_profile_file->Fd(), &error);
+    if (mapped_info != nullptr && mapped_info->IsForBootImage() == options.IsBootImageMerge()) {
+      // With no new methods or classes, the delta is always too small for compilation.
+      return (mapped_info->GetNumberOfMethods(filter_fn) == 0u &&
+              mapped_info->GetNumberOfResolvedClasses(filter_fn) == 0u)
+          ? ProfmanResult::kSkipCompilationEmptyProfiles
+          : ProfmanResult::kSkipCompilationSmallDelta;
+    }
+    // Otherwise, fall back to loading the profile, which reports any error.
+    VLOG(profiler) << "Cannot map reference profile: " << error;
+  }
+
   ProfileCompilationInfo info(options.IsBootImageMerge());
 
   // Load the reference profile.
@@ -98,7 +118,7 @@ ProfmanResult::ProcessingResult ProfileAssistant::ProcessProfilesInternal(
     PLOG(WARNING) << "Could not clear reference profile file";
     return ProfmanResult::kErrorIO;
   }
-  if (!info.Save(reference_profile_file->Fd())) {
+  if (!info.Save(reference_profile_file->Fd(), options.IsWriteMappableProfile())) {
     LOG(WARNING) << "Could not save reference profile file";
     return ProfmanResult::kErrorIO;
   }
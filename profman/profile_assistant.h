@@ -32,12 +32,14 @@ class ProfileAssistant {
    public:
     static constexpr bool kForceMergeDefault = false;
     static constexpr bool kBootImageMergeDefault = false;
+    static constexpr bool kWriteMappableProfileDefault = false;
     static constexpr uint32_t kMinNewMethodsPercentChangeForCompilation = 20;
     static constexpr uint32_t kMinNewClassesPercentChangeForCompilation = 20;
 
     Options()
         : force_merge_(kForceMergeDefault),
           boot_image_merge_(kBootImageMergeDefault),
+          write_mappable_profile_(kWriteMappableProfileDefault),
           min_new_methods_percent_change_for_compilation_(
               kMinNewMethodsPercentChangeForCompilation),
           min_new_classes_percent_change_for_compilation_(
@@ -46,6 +48,7 @@ class ProfileAssistant {
 
     bool IsForceMerge() const { return force_merge_; }
     bool IsBootImageMerge() const { return boot_image_merge_; }
+    bool IsWriteMappableProfile() const { return write_mappable_profile_; }
     uint32_t GetMinNewMethodsPercentChangeForCompilation() const {
         return min_new_methods_percent_change_for_compilation_;
     }
@@ -55,6 +58,7 @@ class ProfileAssistant {
 
     void SetForceMerge(bool value) { force_merge_ = value; }
     void SetBootImageMerge(bool value) { boot_image_merge_ = value; }
+    void SetWriteMappableProfile(bool value) { write_mappable_profile_ = value; }
     void SetMinNewMethodsPercentChangeForCompilation(uint32_t value) {
       min_new_methods_percent_change_for_compilation_ = value;
     }
@@ -70,6 +74,9 @@ class ProfileAssistant {
     // Signals that the merge is for boot image profiles. It will ignore differences
     // in profile versions (instead of aborting).
     bool boot_image_merge_;
+    // If true, the reference profile is saved with the section used by
+    // MappedProfileCompilationInfo to answer queries without loading the profile.
+    bool write_mappable_profile_;
     uint32_t min_new_methods_percent_change_for_compilation_;
     uint32_t min_new_classes_percent_change_for_compilation_;
   };
@@ -1981,6 +1981,122 @@ TEST_F(ProfileAssistantTest, MergeProfilesNoProfileEmptyReferenceProfileAfterFil
   EXPECT_EQ(content_before, content_after);
 }
 
+TEST_F(ProfileAssistantTest, MergeProfilesWriteMappableProfile) {
+  ScratchFile profile1;
+  ScratchFile reference_profile;
+
+  std::vector<int> profile_fds({GetFd(profile1)});
+  int reference_profile_fd = GetFd(reference_profile);
+
+  const uint16_t kNumberOfMethodsToEnableCompilation = 100;
+  ProfileCompilationInfo info1;
+  SetupProfile(dex1,
+               dex2,
+               kNumberOfMethodsToEnableCompilation,
+               /*number_of_classes=*/ 10,
+               profile1,
+               &info1);
+
+  // Merge the profile into the reference profile and write the mappable section.
+  std::vector<const std::string> extra_args({"--write-mappable-profile"});
+  ASSERT_EQ(ProfmanResult::kCompile,
+            ProcessProfiles(profile_fds, reference_profile_fd, extra_args));
+
+  // The reference profile can be loaded as usual and mapped.
+  ProfileCompilationInfo result;
+  ASSERT_TRUE(result.Load(reference_profile_fd));
+  ASSERT_TRUE(result.Equals(info1));
+  std::string error;
+  std::unique_ptr<MappedProfileCompilationInfo> mapped_result =
+      MappedProfileCompilationInfo::Create(reference_profile_fd, &error);
+  ASSERT_TRUE(mapped_result != nullptr) << error;
+  ASSERT_EQ(result.GetNumberOfMethods(), mapped_result->GetNumberOfMethods());
+  ASSERT_EQ(result.GetNumberOfResolvedClasses(), mapped_result->GetNumberOfResolvedClasses());
+  for (const DexFile* dex : {dex1, dex2}) {
+    for (uint16_t i = 0; i < 2 * kNumberOfMethodsToEnableCompilation; i++) {
+      MethodReference ref(dex, i);
+      ASSERT_EQ(result.GetMethodHotness(ref).GetFlags(),
+                mapped_result->GetMethodHotness(ref).GetFlags()) << i;
+    }
+  }
+
+  std::string content_before;
+  ASSERT_TRUE(android::base::ReadFileToString(reference_profile.GetFilename(), &content_before));
+
+  // Without current profiles, profman answers from the mappable section. The reference profile
+  // is not empty, but there is no new data.
+  ASSERT_EQ(ProfmanResult::kSkipCompilationSmallDelta,
+            ProcessProfiles(/*profiles_fd=*/ {}, reference_profile_fd));
+
+  // All the data is filtered out by the real dex file.
+  android::base::unique_fd apk_fd(
+      // NOLINTNEXTLINE - Profman needs file to be opened after fork() and exec()
+      open(GetTestDexFileName("ProfileTestMultiDex").c_str(), O_RDONLY));
+  ASSERT_GE(apk_fd.get(), 0);
+  std::vector<const std::string> apk_args({"--apk-fd=" + std::to_string(apk_fd.get())});
+  ASSERT_EQ(ProfmanResult::kSkipCompilationEmptyProfiles,
+            ProcessProfiles(/*profiles_fd=*/ {}, reference_profile_fd, apk_args));
+
+  // A boot image query still fails on the regular profile.
+  std::vector<const std::string> boot_image_args({"--boot-image-merge"});
+  ASSERT_EQ(ProfmanResult::kErrorBadProfiles,
+            ProcessProfiles(/*profiles_fd=*/ {}, reference_profile_fd, boot_image_args));
+
+  // Verify that the content has not changed.
+  std::string content_after;
+  ASSERT_TRUE(android::base::ReadFileToString(reference_profile.GetFilename(), &content_after));
+  EXPECT_EQ(content_before, content_after);
+}
+
+TEST_F(ProfileAssistantTest, CopyAndUpdateProfileKeyWriteMappableProfile) {
+  ScratchFile profile1;
+  ScratchFile reference_profile;
+
+  std::vector<std::unique_ptr<const DexFile>> dex_files = OpenTestDexFiles("ProfileTestMultiDex");
+  const DexFile& d1 = *dex_files[0];
+  const DexFile& d2 = *dex_files[1];
+
+  ProfileCompilationInfo info1;
+  uint16_t num_methods_to_add = std::min(d1.NumMethodIds(), d2.NumMethodIds());
+
+  const DexFile* dex_to_be_updated1 = BuildDex(
+      "fake-location1", d1.GetLocationChecksum(), "LC;", d1.NumMethodIds(), d1.NumTypeIds());
+  const DexFile* dex_to_be_updated2 = BuildDex(
+      "fake-location2", d2.GetLocationChecksum(), "LC;", d2.NumMethodIds(), d2.NumTypeIds());
+  SetupProfile(dex_to_be_updated1,
+               dex_to_be_updated2,
+               num_methods_to_add,
+               /*number_of_classes=*/ 0,
+               profile1,
+               &info1);
+
+  android::base::unique_fd apk_fd(
+      // NOLINTNEXTLINE - Profman needs file to be opened after fork() and exec()
+      open(GetTestDexFileName("ProfileTestMultiDex").c_str(), O_RDONLY));
+  ASSERT_GE(apk_fd.get(), 0);
+
+  std::string profman_cmd = GetProfmanCmd();
+  std::vector<std::string> argv_str;
+  argv_str.push_back(profman_cmd);
+  argv_str.push_back("--profile-file-fd=" + std::to_string(profile1.GetFd()));
+  argv_str.push_back("--reference-profile-file-fd=" + std::to_string(reference_profile.GetFd()));
+  argv_str.push_back("--apk-fd=" + std::to_string(apk_fd.get()));
+  argv_str.push_back("--copy-and-update-profile-key");
+  argv_str.push_back("--write-mappable-profile");
+  std::string error;
+
+  ASSERT_EQ(ExecAndReturnCode(argv_str, &error), ProfmanResult::kCopyAndUpdateSuccess) << error;
+
+  // The copy can be mapped and has the updated profile keys.
+  std::unique_ptr<MappedProfileCompilationInfo> mapped_result =
+      MappedProfileCompilationInfo::Create(reference_profile.GetFd(), &error);
+  ASSERT_TRUE(mapped_result != nullptr) << error;
+  for (uint16_t i = 0; i < num_methods_to_add; i ++) {
+    ASSERT_TRUE(mapped_result->IsHotMethod(MethodReference(&d1, i))) << i;
+    ASSERT_TRUE(mapped_result->IsHotMethod(MethodReference(&d2, i))) << i;
+  }
+}
+
 TEST_F(ProfileAssistantTest, CopyAndUpdateProfileKey) {
   ScratchFile profile1;
   ScratchFile reference_profile;
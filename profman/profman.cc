@@ -191,6 +191,9 @@ NO_RETURN static void Usage(const char *fmt, ...) {
   UsageError("      In this case, the reference profile must have a boot profile version.");
   UsageError("  --force-merge: performs a forced merge, without analyzing if there is a");
   UsageError("      significant difference between the current profile and the reference profile.");
+  UsageError("  --write-mappable-profile: also write the merged or copied reference profile in");
+  UsageError("      a format that can be queried without loading it (see");
+  UsageError("      MappedProfileCompilationInfo).");
   UsageError("  --min-new-methods-percent-change=percentage between 0 and 100 (default 20)");
   UsageError("      the min percent of new methods to trigger a compilation.");
   UsageError("  --min-new-classes-percent-change=percentage between 0 and 100 (default 20)");
@@ -470,6 +473,8 @@ class ProfMan final {
         profile_assistant_options_.SetBootImageMerge(true);
       } else if (option == "--force-merge") {
         profile_assistant_options_.SetForceMerge(true);
+      } else if (option == "--write-mappable-profile") {
+        profile_assistant_options_.SetWriteMappableProfile(true);
       } else {
         Usage("Unknown argument '%s'", raw_option);
       }
@@ -1904,8 +1909,11 @@ class ProfMan final {
         return ProfmanResult::kCopyAndUpdateErrorFailedToUpdateProfile;
       }
       bool result = use_fds
-          ? profile.Save(reference_profile_file_fd_)
-          : profile.Save(reference_profile_file_, /*bytes_written=*/ nullptr);
+          ? profile.Save(reference_profile_file_fd_,
+                         profile_assistant_options_.IsWriteMappableProfile())
+          : profile.Save(reference_profile_file_,
+                         /*bytes_written=*/ nullptr,
+                         profile_assistant_options_.IsWriteMappableProfile());
       if (!result) {
         return ProfmanResult::kCopyAndUpdateErrorFailedToSaveProfile;
       }
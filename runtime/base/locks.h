@@ -77,6 +77,7 @@ enum LockLevel : uint8_t {
   kTransactionLogLock,
   kCustomTlsLock,
   kJniFunctionTableLock,
+  kJniGlobalsShardLock,
   kJniWeakGlobalsLock,
   kJniGlobalsLock,
   kReferenceQueueSoftReferencesLock,
@@ -22,29 +22,35 @@
 #include <cstddef>
 #include <iomanip>
 #include <numeric>
+#include <ostream>
 
 #include <android-base/logging.h>
 
 #include "base/arena_allocator-inl.h"
 #include "base/mem_map.h"
 #include "base/systrace.h"
+#include "base/utils.h"
 
 namespace art {
 
 class MemMapArena final : public Arena {
  public:
-  MemMapArena(size_t size, bool low_4gb, const char* name);
+  MemMapArena(size_t size, bool low_4gb, bool use_huge_pages, const char* name);
   virtual ~MemMapArena();
   void Release() override;
 
+  // Size of a transparent huge page, i.e. the memory mapped by one last-level page directory
+  // entry: 2MiB with 4KiB pages, 32MiB with 16KiB pages.
+  static constexpr size_t kHugePageSize = kPageSize * (kPageSize / sizeof(uint64_t));
+
  private:
-  static MemMap Allocate(size_t size, bool low_4gb, const char* name);
+  static MemMap Allocate(size_t size, bool low_4gb, bool use_huge_pages, const char* name);
 
   MemMap map_;
 };
 
-MemMapArena::MemMapArena(size_t size, bool low_4gb, const char* name)
-    : map_(Allocate(size, low_4gb, name)) {
+MemMapArena::MemMapArena(size_t size, bool low_4gb, bool use_huge_pages, const char* name)
+    : map_(Allocate(size, low_4gb, use_huge_pages, name)) {
   memory_ = map_.Begin();
   static_assert(ArenaAllocator::kArenaAlignment <= kPageSize,
                 "Arena should not need stronger alignment than kPageSize.");
@@ -52,17 +58,25 @@ MemMapArena::MemMapArena(size_t size, bool low_4gb, const char* name)
   size_ = map_.Size();
 }
 
-MemMap MemMapArena::Allocate(size_t size, bool low_4gb, const char* name) {
+MemMap MemMapArena::Allocate(size_t size, bool low_4gb, bool use_huge_pages, const char* name) {
   // Round up to a full page as that's the smallest unit of allocation for mmap()
   // and we want to be able to use all memory that we actually allocate.
-  size = RoundUp(size, kPageSize);
+  size = RoundUp(size, use_huge_pages ? kHugePageSize : kPageSize);
   std::string error_msg;
   // TODO(b/278665389): remove this retry logic if the root cause is found.
   constexpr int MAX_RETRY_CNT = 3;
   int retry_cnt = 0;
   while (true) {
-    MemMap map = MemMap::MapAnonymous(name, size, PROT_READ | PROT_WRITE, low_4gb, &error_msg);
+    MemMap map = use_huge_pages
+        ? MemMap::MapAnonymousAligned(
+              name, size, PROT_READ | PROT_WRITE, low_4gb, kHugePageSize, &error_msg)
+        : MemMap::MapAnonymous(name, size, PROT_READ | PROT_WRITE, low_4gb, &error_msg);
     if (map.IsValid()) {
+#ifdef MADV_HUGEPAGE
+      if (use_huge_pages && madvise(map.Begin(), map.Size(), MADV_HUGEPAGE) != 0) {
+        PLOG(WARNING) << "madvise(MADV_HUGEPAGE) failed for " << name;
+      }
+#endif
       if (retry_cnt > 0) {
         LOG(WARNING) << "Succeed with retry(cnt=" << retry_cnt << ")";
       }
@@ -88,10 +102,31 @@ void MemMapArena::Release() {
   }
 }
 
-MemMapArenaPool::MemMapArenaPool(bool low_4gb, const char* name)
+// Huge page arenas are never smaller than a huge page, so a non-zero retained capacity below
+// that would never retain any arena and silently cancel out the warm set.
+static size_t GetRetainedCapacity(size_t retained_capacity, bool use_huge_pages, const char* name) {
+  if (use_huge_pages && retained_capacity != 0u && retained_capacity < MemMapArena::kHugePageSize) {
+    LOG(WARNING) << "Raising the retained capacity of " << name << " arenas from "
+                 << PrettySize(retained_capacity) << " to one huge page ("
+                 << PrettySize(MemMapArena::kHugePageSize) << ")";
+    return MemMapArena::kHugePageSize;
+  }
+  return retained_capacity;
+}
+
+MemMapArenaPool::MemMapArenaPool(bool low_4gb,
+                                 const char* name,
+                                 size_t retained_capacity,
+                                 bool use_huge_pages)
     : low_4gb_(low_4gb),
       name_(name),
-      free_arenas_(nullptr) {
+      retained_capacity_(GetRetainedCapacity(retained_capacity, use_huge_pages, name)),
+      use_huge_pages_(use_huge_pages),
+      free_arenas_(nullptr),
+      num_arenas_mapped_(0u),
+      num_arenas_reused_(0u),
+      num_arenas_trimmed_(0u),
+      bytes_trimmed_(0u) {
   MemMap::Init();
 }
 
@@ -119,10 +154,13 @@ Arena* MemMapArenaPool::AllocArena(size_t size) {
     if (free_arenas_ != nullptr && LIKELY(free_arenas_->Size() >= size)) {
       ret = free_arenas_;
       free_arenas_ = free_arenas_->next_;
+      ++num_arenas_reused_;
+    } else {
+      ++num_arenas_mapped_;
     }
   }
   if (ret == nullptr) {
-    ret = new MemMapArena(size, low_4gb_, name_);
+    ret = new MemMapArena(size, low_4gb_, use_huge_pages_, name_);
   }
   ret->Reset();
   return ret;
@@ -131,11 +169,38 @@ Arena* MemMapArenaPool::AllocArena(size_t size) {
 void MemMapArenaPool::TrimMaps() {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   std::lock_guard<std::mutex> lock(lock_);
+  size_t retained = 0u;
   for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
+    // The free list is LIFO, so the arenas kept warm are the most recently used ones.
+    if (retained + arena->Size() <= retained_capacity_) {
+      retained += arena->Size();
+      continue;
+    }
+    size_t bytes_allocated = arena->GetBytesAllocated();
+    if (bytes_allocated != 0u) {
+      ++num_arenas_trimmed_;
+      bytes_trimmed_ += bytes_allocated;
+    }
     arena->Release();
   }
 }
 
+void MemMapArenaPool::DumpStats(std::ostream& os) const {
+  std::lock_guard<std::mutex> lock(lock_);
+  size_t num_free_arenas = 0u;
+  size_t free_bytes = 0u;
+  for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
+    ++num_free_arenas;
+    free_bytes += arena->Size();
+  }
+  os << name_ << " arenas: mapped=" << num_arenas_mapped_
+     << " reused=" << num_arenas_reused_
+     << " trimmed=" << num_arenas_trimmed_ << " (" << PrettySize(bytes_trimmed_) << ")"
+     << " free=" << num_free_arenas << " (" << PrettySize(free_bytes) << ")"
+     << " retained capacity=" << PrettySize(retained_capacity_)
+     << (use_huge_pages_ ? " huge pages" : "") << "\n";
+}
+
 size_t MemMapArenaPool::GetBytesAllocated() const {
   size_t total = 0;
   std::lock_guard<std::mutex> lock(lock_);
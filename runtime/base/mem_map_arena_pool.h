@@ -17,13 +17,23 @@
 #ifndef ART_RUNTIME_BASE_MEM_MAP_ARENA_POOL_H_
 #define ART_RUNTIME_BASE_MEM_MAP_ARENA_POOL_H_
 
+#include <iosfwd>
+
 #include "base/arena_allocator.h"
 
 namespace art {
 
 class MemMapArenaPool final : public ArenaPool {
  public:
-  explicit MemMapArenaPool(bool low_4gb = false, const char* name = "LinearAlloc");
+  // `retained_capacity` is the number of bytes of free arenas that TrimMaps() keeps resident,
+  // so that bursts of allocations (such as JIT compilations) do not re-fault the same memory.
+  // With `use_huge_pages`, arenas are rounded up to and aligned on the transparent huge page
+  // size and advised as MADV_HUGEPAGE, and a non-zero `retained_capacity` is raised to at least
+  // one huge page.
+  explicit MemMapArenaPool(bool low_4gb = false,
+                           const char* name = "LinearAlloc",
+                           size_t retained_capacity = 0u,
+                           bool use_huge_pages = false);
   virtual ~MemMapArenaPool();
   Arena* AllocArena(size_t size) override;
   void FreeArenaChain(Arena* first) override;
@@ -31,12 +41,22 @@ class MemMapArenaPool final : public ArenaPool {
   void ReclaimMemory() override;
   void LockReclaimMemory() override;
   // Trim the maps in arenas by madvising, used by JIT to reduce memory usage.
+  // The most recently freed arenas up to `retained_capacity_` bytes are left untouched.
   void TrimMaps() override;
 
+  // Dump arena churn counters: arenas mapped, reused from the free list and trimmed.
+  void DumpStats(std::ostream& os) const;
+
  private:
   const bool low_4gb_;
   const char* name_;
+  const size_t retained_capacity_;
+  const bool use_huge_pages_;
   Arena* free_arenas_;
+  size_t num_arenas_mapped_;
+  size_t num_arenas_reused_;
+  size_t num_arenas_trimmed_;
+  size_t bytes_trimmed_;
   // Use a std::mutex here as Arenas are second-from-the-bottom when using MemMaps, and MemMap
   // itself uses std::mutex scoped to within an allocate/free only.
   mutable std::mutex lock_;
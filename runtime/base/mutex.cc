@@ -630,6 +630,29 @@ bool Mutex::ExclusiveTryLockWithSpinning(Thread* self) {
   return ExclusiveTryLock(self);
 }
 
+bool Mutex::ExclusiveTryLockWithSpinning(Thread* self,
+                                         uint32_t max_spins,
+                                         /*out*/ uint32_t* spins) {
+  for (uint32_t i = 0; i < max_spins; ++i) {
+    if (ExclusiveTryLock(self)) {
+      *spins = i;
+      return true;
+    }
+#if ART_USE_FUTEXES
+    // Threads that are already blocked have given up on spinning; the owner is likely to hold
+    // the mutex for longer than we are willing to spin, and will wake one of them first.
+    if (get_contenders() != 0 ||
+        !WaitBrieflyFor(&state_and_contenders_, self,
+            [](int32_t v) { return (v & kHeldMask) == 0; })) {
+      *spins = i + 1;
+      return false;
+    }
+#endif
+  }
+  *spins = max_spins;
+  return ExclusiveTryLock(self);
+}
+
 #if ART_USE_FUTEXES
 void Mutex::ExclusiveLockUncontendedFor(Thread* new_owner) {
   DCHECK_EQ(level_, kMonitorLock);
@@ -188,6 +188,10 @@ class LOCKABLE Mutex : public BaseMutex {
   bool TryLock(Thread* self) TRY_ACQUIRE(true) { return ExclusiveTryLock(self); }
   // Equivalent to ExclusiveTryLock, but retry for a short period before giving up.
   bool ExclusiveTryLockWithSpinning(Thread* self) TRY_ACQUIRE(true);
+  // The same, but spin at most `max_spins` times and report in `spins` how many spins were
+  // used. Gives up early if other threads are already blocked on the mutex.
+  bool ExclusiveTryLockWithSpinning(Thread* self, uint32_t max_spins, /*out*/ uint32_t* spins)
+      TRY_ACQUIRE(true);
 
   // Release exclusive access.
   void ExclusiveUnlock(Thread* self) RELEASE();
@@ -142,6 +142,7 @@
 #include "oat_file_manager.h"
 #include "object_lock.h"
 #include "profile/profile_compilation_info.h"
+#include "reflective_access_cache.h"
 #include "runtime.h"
 #include "runtime_callbacks.h"
 #include "scoped_thread_state_change-inl.h"
@@ -2646,6 +2647,8 @@ void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data, b
     }
   }
 
+  // The methods of the class loader are freed with its allocator.
+  ReflectiveAccessCache::InvalidateAll();
   delete data.allocator;
   delete data.class_table;
 }
@@ -4610,7 +4613,10 @@ ObjPtr<mirror::Class> ClassLinker::LookupClass(Thread* self,
                                                const char* descriptor,
                                                size_t hash,
                                                ObjPtr<mirror::ClassLoader> class_loader) {
-  ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
+  // No need for the `Locks::classlinker_classes_lock_`. The class table of a class loader is
+  // published after it is constructed, see `RegisterClassLoader()`, and it is only deleted
+  // once the class loader is unreachable. The class table lookup itself does not take the
+  // class table lock unless the class is not found.
   ClassTable* const class_table = ClassTableForClassLoader(class_loader);
   if (class_table != nullptr) {
     ObjPtr<mirror::Class> result = class_table->Lookup(descriptor, hash);
@@ -6102,8 +6108,10 @@ void ClassLinker::RegisterClassLoader(ObjPtr<mirror::ClassLoader> class_loader)
   Thread* const self = Thread::Current();
   ClassLoaderData data;
   data.weak_root = self->GetJniEnv()->GetVm()->AddWeakGlobalRef(self, class_loader);
-  // Create and set the class table.
+  // Create and set the class table. Make it visible to `LookupClass()`, which does not take
+  // the `Locks::classlinker_classes_lock_`, before it can find it.
   data.class_table = new ClassTable;
+  std::atomic_thread_fence(std::memory_order_release);
   class_loader->SetClassTable(data.class_table);
   // Create and set the linear allocator.
   data.allocator = Runtime::Current()->CreateLinearAlloc();
@@ -10802,8 +10810,11 @@ void ClassLinker::CleanupClassLoaders() {
       if (class_loader == nullptr) {
         VLOG(class_linker) << "Freeing class loader";
         to_delete.splice(to_delete.end(), class_loaders_, this_it);
+      } else if (data.class_table != nullptr) {
+        data.class_table->FreeRetiredStorage();
       }
     }
+    boot_class_table_->FreeRetiredStorage();
   }
   if (to_delete.empty()) {
     return;
@@ -16,19 +16,30 @@
 
 #include "class_table-inl.h"
 
+#include <algorithm>
+
 #include "base/stl_util.h"
+#include "gc/heap.h"
 #include "mirror/class-inl.h"
 #include "mirror/string-inl.h"
 #include "oat_file.h"
 
 namespace art {
 
+// `classes_` holds the sets for `HashSetSnapshots<>` directly.
+static const ClassTable::ClassSet& GetClassSet(const ClassTable::ClassSet& set) {
+  return set;
+}
+
 ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
   Runtime* const runtime = Runtime::Current();
   classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
                               runtime->GetHashTableMaxLoadFactor()));
+  PublishSnapshot();
 }
 
+ClassTable::~ClassTable() {}
+
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
   // Propagate the min/max load factor from the old active set.
@@ -36,6 +47,7 @@ void ClassTable::FreezeSnapshot() {
   const ClassSet& last_set = classes_.back();
   ClassSet new_set(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
   classes_.push_back(std::move(new_set));
+  PublishSnapshot();
 }
 
 ObjPtr<mirror::Class> ClassTable::UpdateClass(const char* descriptor,
@@ -60,7 +72,8 @@ ObjPtr<mirror::Class> ClassTable::UpdateClass(const char* descriptor,
   CHECK(!klass->IsTemp()) << descriptor;
   VerifyObject(klass);
   // Update the element in the hash set with the new class. This is safe to do since the descriptor
-  // doesn't change.
+  // doesn't change. Make the new class visible to lookups without the lock before they can find it.
+  std::atomic_thread_fence(std::memory_order_release);
   *existing_it = TableSlot(klass, hash);
   return existing;
 }
@@ -106,13 +119,21 @@ size_t ClassTable::NumReferencedNonZygoteClasses() const {
 
 ObjPtr<mirror::Class> ClassTable::Lookup(const char* descriptor, size_t hash) {
   DescriptorHashPair pair(descriptor, hash);
+  size_t num_searched_frozen_tables;
+  ObjPtr<mirror::Class> klass = LookupWithoutLock(pair, hash, &num_searched_frozen_tables);
+  if (klass != nullptr) {
+    return klass;
+  }
   ReaderMutexLock mu(Thread::Current(), lock_);
   // Search from the last table, assuming that apps shall search for their own classes
   // more often than for boot image classes. For prebuilt boot images, this also helps
   // by searching the large table from the framework boot image extension compiled as
   // single-image before the individual small tables from the primary boot image
-  // compiled as multi-image.
-  for (ClassSet& class_set : ReverseRange(classes_)) {
+  // compiled as multi-image. Frozen tables keep their positions when tables are added,
+  // so skip the ones searched without the lock.
+  DCHECK_LT(num_searched_frozen_tables, classes_.size());
+  auto mid = classes_.begin() + num_searched_frozen_tables;
+  for (ClassSet& class_set : ReverseRange(MakeIterationRange(mid, classes_.end()))) {
     auto it = class_set.FindWithHash(pair, hash);
     if (it != class_set.end()) {
       return it->Read();
@@ -121,13 +142,60 @@ ObjPtr<mirror::Class> ClassTable::Lookup(const char* descriptor, size_t hash) {
   return nullptr;
 }
 
+ObjPtr<mirror::Class> ClassTable::LookupWithoutLock(const DescriptorHashPair& pair,
+                                                    uint32_t hash,
+                                                    size_t* num_searched_frozen_tables) {
+  const Snapshots::Snapshot* snapshot = snapshots_.Get();
+  DCHECK(!snapshot->tables.empty());
+  *num_searched_frozen_tables = snapshot->tables.size() - 1u;
+  ClassDescriptorEquals equals;
+  // Search from the last table, see `Lookup()`.
+  for (const Snapshots::Snapshot::Buckets& buckets : ReverseRange(snapshot->tables)) {
+    if (buckets.num_buckets == 0u) {
+      continue;
+    }
+    // Probe like `HashSet<>` does. Elements may be moved by a concurrent erase, so bound
+    // the number of probes rather than rely on finding an empty slot.
+    size_t index = hash % buckets.num_buckets;
+    for (size_t i = 0; i != buckets.num_buckets; ++i) {
+      const TableSlot& slot = buckets.data[index];
+      if (slot.IsNull()) {
+        break;
+      }
+      if (equals(slot, pair)) {
+        return slot.Read();
+      }
+      index = (index + 1u == buckets.num_buckets) ? 0u : index + 1u;
+    }
+  }
+  return nullptr;
+}
+
 void ClassTable::Insert(ObjPtr<mirror::Class> klass) {
   InsertWithHash(klass, klass->DescriptorHash());
 }
 
 void ClassTable::InsertWithHash(ObjPtr<mirror::Class> klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  ClassSet& set = classes_.back();
+  if (set.size() >= set.ElementsUntilExpand()) {
+    snapshots_.Grow(&set, classes_, GetClassSet, [](ClassSet* new_set, const TableSlot& slot) {
+      new_set->insert(slot);
+    });
+  }
+  // Make the class visible to lookups without the lock before they can find it.
+  std::atomic_thread_fence(std::memory_order_release);
+  set.InsertWithHash(TableSlot(klass, hash), hash);
+  DCHECK_EQ(set.GetBuckets(), snapshots_.Get()->tables.back().data);
+}
+
+void ClassTable::PublishSnapshot() {
+  snapshots_.Publish(classes_, GetClassSet);
+}
+
+void ClassTable::FreeRetiredStorage() {
+  WriterMutexLock mu(Thread::Current(), lock_);
+  snapshots_.FreeRetiredStorage();
 }
 
 bool ClassTable::InsertStrongRoot(ObjPtr<mirror::Object> obj) {
@@ -179,6 +247,7 @@ void ClassTable::AddClassSet(ClassSet&& set) {
   // TODO: Make use of this in `ClassLinker::FindClass()`.
   DCHECK(!classes_.empty());
   classes_.insert(classes_.end() - 1, std::move(set));
+  PublishSnapshot();
 }
 
 void ClassTable::ClearStrongRoots() {
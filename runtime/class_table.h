@@ -17,15 +17,19 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/allocator.h"
+#include "base/dchecked_vector.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "gc_root.h"
+#include "hash_set_snapshots.h"
 #include "obj_ptr.h"
 
 namespace art {
@@ -47,6 +51,12 @@ class Object;
 }  // namespace mirror
 
 // Each loader has a ClassTable
+//
+// Lookups of classes already in the table do not take the `lock_`. The table publishes a snapshot
+// of its bucket arrays, and a bucket array is never freed or resized in place while such lookups
+// may still use it. Instead, it is replaced by a larger copy and freed once a GC has started and
+// completed since, as every GC waits for runnable threads at least once. A lookup without the lock
+// may miss a class inserted concurrently, so a miss is confirmed with the lock held.
 class ClassTable {
  public:
   class TableSlot {
@@ -154,6 +164,7 @@ class ClassTable {
                            TrackingAllocator<TableSlot, kAllocatorTagClassTable>>;
 
   ClassTable();
+  ~ClassTable();
 
   // Freeze the current class tables by allocating a new table and never updating or modifying the
   // existing table. This helps prevents dirty pages after caused by inserting after zygote fork.
@@ -276,7 +287,26 @@ class ClassTable {
     return lock_;
   }
 
+  // Free bucket arrays replaced by larger ones once no lookup without the lock can use them.
+  void FreeRetiredStorage()
+      REQUIRES(!lock_);
+
  private:
+  using Snapshots = HashSetSnapshots<ClassSet>;
+
+  // Find without holding the lock, searching the tables from the current snapshot. A null
+  // result is not definitive. `num_searched_frozen_tables` receives the number of frozen
+  // tables searched, which a subsequent lookup with the lock held does not search again.
+  ObjPtr<mirror::Class> LookupWithoutLock(const DescriptorHashPair& pair,
+                                          uint32_t hash,
+                                          /*out*/ size_t* num_searched_frozen_tables)
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Publish a new snapshot of the bucket arrays for `LookupWithoutLock()`, see
+  // `HashSetSnapshots<>::Publish()`.
+  void PublishSnapshot() REQUIRES(lock_);
+
   size_t CountDefiningLoaderClasses(ObjPtr<mirror::ClassLoader> defining_loader,
                                     const ClassSet& set) const
       REQUIRES(lock_)
@@ -291,6 +321,9 @@ class ClassTable {
   mutable ReaderWriterMutex lock_;
   // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
   std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // The bucket arrays of `classes_`, for lookups without the lock. Only `Get()` may be called
+  // without holding `lock_`.
+  Snapshots snapshots_;
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
@@ -18,6 +18,7 @@
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
+#include "base/bit_utils.h"
 #include "class_linker-inl.h"
 #include "common_runtime_test.h"
 #include "dex/dex_file.h"
@@ -161,5 +162,37 @@ TEST_F(ClassTableTest, ClassTable) {
   // TODO: Add tests for UpdateClass, InsertOatFile.
 }
 
+TEST_F(ClassTableTest, LookupAfterGrow) {
+  ScopedObjectAccess soa(Thread::Current());
+  VariableSizedHandleScope hs(soa.Self());
+  std::vector<Handle<mirror::Class>> classes;
+  // Use boot image classes, which do not move, as nothing visits the roots in `table`.
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  class_linker_->ClassTableForClassLoader(nullptr)->Visit(
+      [&](ObjPtr<mirror::Class> klass) REQUIRES_SHARED(Locks::mutator_lock_) {
+        if (heap->ObjectIsInBootImageSpace(klass)) {
+          classes.push_back(hs.NewHandle(klass));
+        }
+        return true;
+      });
+  ASSERT_GT(classes.size(), 1000u);
+
+  // Insert enough classes for the table to grow several times, checking that
+  // lookups find every class inserted so far after each growth.
+  ClassTable table;
+  for (size_t i = 0; i != classes.size(); ++i) {
+    table.Insert(classes[i].Get());
+    if (IsPowerOfTwo(i + 1u)) {
+      for (size_t j = 0; j <= i; ++j) {
+        EXPECT_OBJ_PTR_EQ(table.LookupByDescriptor(classes[j].Get()), classes[j].Get());
+      }
+    }
+  }
+  for (Handle<mirror::Class> klass : classes) {
+    EXPECT_OBJ_PTR_EQ(table.LookupByDescriptor(klass.Get()), klass.Get());
+  }
+  EXPECT_TRUE(table.Lookup("LNotThere;", ComputeModifiedUtf8Hash("LNotThere;")) == nullptr);
+}
+
 }  // namespace mirror
 }  // namespace art
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "code_info_cache.h"
+
+#include "oat_quick_method_header.h"
+
+namespace art {
+
+std::atomic<uint32_t> CodeInfoCache::generation_(0u);
+
+void CodeInfoCache::ClearIfStale() {
+  uint32_t generation = generation_.load(std::memory_order_acquire);
+  if (LIKELY(generation == generation_seen_)) {
+    return;
+  }
+  for (CodeInfoEntry& entry : code_infos_) {
+    entry.header = nullptr;
+  }
+  for (StackMapEntry& entry : stack_maps_) {
+    entry.header = nullptr;
+  }
+  generation_seen_ = generation;
+}
+
+CodeInfo CodeInfoCache::Decode(const OatQuickMethodHeader* header, DecodeKind kind) {
+  switch (kind) {
+    case DecodeKind::kInlineInfoOnly:
+      return CodeInfo::DecodeInlineInfoOnly(header);
+    case DecodeKind::kGcMasksOnly:
+      return CodeInfo::DecodeGcMasksOnly(header);
+    case DecodeKind::kFull:
+      return CodeInfo(header);
+  }
+  UNREACHABLE();
+}
+
+void CodeInfoCache::GetCodeInfo(const OatQuickMethodHeader* header,
+                                DecodeKind kind,
+                                /* out */ CodeInfo* code_info) {
+  DCHECK(header->IsOptimized());
+  ClearIfStale();
+  CodeInfoEntry* entry = nullptr;
+  for (CodeInfoEntry& candidate : code_infos_) {
+    if (candidate.header == header) {
+      if (candidate.kind == kind || candidate.kind == DecodeKind::kFull) {
+        *code_info = candidate.code_info;
+        return;
+      }
+      // The other partial decoding is cached. Replace it with a full decoding so that
+      // callers alternating between the two do not keep missing.
+      kind = DecodeKind::kFull;
+      entry = &candidate;
+      break;
+    }
+  }
+  if (entry == nullptr) {
+    entry = &code_infos_[next_code_info_];
+    next_code_info_ = (next_code_info_ + 1u) % kCodeInfoSize;
+  }
+  entry->header = header;
+  entry->kind = kind;
+  entry->code_info = Decode(header, kind);
+  *code_info = entry->code_info;
+}
+
+StackMap CodeInfoCache::GetStackMapForNativePcOffset(const OatQuickMethodHeader* header,
+                                                     const CodeInfo& code_info,
+                                                     uint32_t native_pc_offset) {
+  ClearIfStale();
+  StackMapEntry& entry = stack_maps_[StackMapIndexOf(header, native_pc_offset)];
+  if (entry.header == header && entry.native_pc_offset == native_pc_offset) {
+    StackMap stack_map = code_info.GetStackMapAt(entry.row);
+    DCHECK_EQ(stack_map.Row(), code_info.GetStackMapForNativePcOffset(native_pc_offset).Row());
+    return stack_map;
+  }
+  StackMap stack_map = code_info.GetStackMapForNativePcOffset(native_pc_offset);
+  if (stack_map.IsValid()) {
+    entry.header = header;
+    entry.native_pc_offset = native_pc_offset;
+    entry.row = stack_map.Row();
+  }
+  return stack_map;
+}
+
+}  // namespace art
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CODE_INFO_CACHE_H_
+#define ART_RUNTIME_CODE_INFO_CACHE_H_
+
+#include <array>
+#include <atomic>
+
+#include "base/bit_utils.h"
+#include "base/macros.h"
+#include "stack_map.h"
+
+namespace art {
+
+class OatQuickMethodHeader;
+
+// Small thread-local cache of decoded CodeInfo, and of the stack maps found for native pcs.
+// Without it, every stack walk (exception stack traces, GC root visiting, checkpoints)
+// decodes the CodeInfo of each compiled frame and searches its stack maps again.
+//
+// The cache belongs to the thread walking the stack, not to the thread being walked,
+// and must only be used from its owning thread.
+//
+// Entries are keyed by method header, so they must not outlive the compiled code.
+// We ensure this with a global generation counter which is incremented whenever
+// compiled code is freed (JIT code collection, oat file unloading); each cache
+// clears itself the next time it is used after the generation changed.
+class CodeInfoCache {
+ public:
+  // The parts of the CodeInfo needed by a caller. Misses only decode these parts,
+  // as CodeInfo::DecodeInlineInfoOnly() and CodeInfo::DecodeGcMasksOnly() do.
+  enum class DecodeKind : uint8_t {
+    kInlineInfoOnly,  // Stack walks: stack maps, inline infos and method infos.
+    kGcMasksOnly,     // Imprecise GC root visiting: stack maps and register/stack masks.
+    kFull,            // Dex register maps, e.g. for reading vregs. Serves all requests.
+  };
+
+  // Number of decoded CodeInfo kept. Entries are replaced in FIFO order, so repeated
+  // walks of the same stack only hit when it has at most this many distinct compiled
+  // methods; recursion hits regardless of depth. Each entry is a few hundred bytes.
+  // benchmark/stack-walk measures the walk time against the number of distinct methods.
+  static constexpr size_t kCodeInfoSize = 4;
+  // Number of (method header, native pc) to stack map row entries.
+  static constexpr size_t kStackMapSize = 64;
+
+  CodeInfoCache() {}
+
+  // Copy the CodeInfo of `header` into `code_info`, with at least the parts of `kind`
+  // decoded.
+  void GetCodeInfo(const OatQuickMethodHeader* header,
+                   DecodeKind kind,
+                   /* out */ CodeInfo* code_info);
+
+  // Decode the parts of `kind` of the CodeInfo of `header`, without caching.
+  static CodeInfo Decode(const OatQuickMethodHeader* header, DecodeKind kind);
+
+  // Return the stack map for `native_pc_offset` in `code_info`, which must be the
+  // CodeInfo of `header`. The returned stack map refers to `code_info`.
+  StackMap GetStackMapForNativePcOffset(const OatQuickMethodHeader* header,
+                                        const CodeInfo& code_info,
+                                        uint32_t native_pc_offset);
+
+  // Invalidate the caches of all threads. Must be called before the memory of
+  // compiled code can be reused.
+  static void InvalidateAll() {
+    generation_.fetch_add(1u, std::memory_order_release);
+  }
+
+ private:
+  struct CodeInfoEntry {
+    const OatQuickMethodHeader* header = nullptr;
+    DecodeKind kind = DecodeKind::kFull;
+    CodeInfo code_info;
+  };
+
+  struct StackMapEntry {
+    const OatQuickMethodHeader* header = nullptr;
+    uint32_t native_pc_offset = 0u;
+    uint32_t row = 0u;
+  };
+
+  static ALWAYS_INLINE size_t StackMapIndexOf(const OatQuickMethodHeader* header,
+                                              uint32_t native_pc_offset) {
+    static_assert(IsPowerOfTwo(kStackMapSize), "Size must be power of two");
+    uintptr_t hash = (reinterpret_cast<uintptr_t>(header) >> 4) ^ (native_pc_offset >> 1);
+    return hash & (kStackMapSize - 1);
+  }
+
+  // Clear the cache if compiled code was freed since it was last used.
+  void ClearIfStale();
+
+  static std::atomic<uint32_t> generation_;
+
+  uint32_t generation_seen_ = 0u;
+  size_t next_code_info_ = 0u;
+  std::array<CodeInfoEntry, kCodeInfoSize> code_infos_;
+  std::array<StackMapEntry, kStackMapSize> stack_maps_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeInfoCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CODE_INFO_CACHE_H_
@@ -766,7 +766,7 @@ void ThrowStackOverflowError(Thread* self) {
     // stackState is set as result of fillInStackTrace. fillInStackTrace calls
     // nativeFillInStackTrace.
     ObjPtr<mirror::Object> stack_state_val =
-        soa.Decode<mirror::Object>(self->CreateInternalStackTrace(soa));
+        soa.Decode<mirror::Object>(self->CreateThrowableStackTrace(soa));
     if (stack_state_val != nullptr) {
       WellKnownClasses::java_lang_Throwable_stackState
           ->SetObject</*kTransactionActive=*/ false>(exc.Get(), stack_state_val);
@@ -25,6 +25,7 @@ enum class DeoptimizationKind {
   kAotInlineCache = 0,
   kJitInlineCache,
   kJitSameTarget,
+  kJitArgumentType,
   kLoopBoundsBCE,
   kLoopNullBCE,
   kBlockBCE,
@@ -39,6 +40,7 @@ inline const char* GetDeoptimizationKindName(DeoptimizationKind kind) {
     case DeoptimizationKind::kAotInlineCache: return "AOT inline cache";
     case DeoptimizationKind::kJitInlineCache: return "JIT inline cache";
     case DeoptimizationKind::kJitSameTarget: return "JIT same target";
+    case DeoptimizationKind::kJitArgumentType: return "JIT argument type";
     case DeoptimizationKind::kLoopBoundsBCE: return "loop bounds check elimination";
     case DeoptimizationKind::kLoopNullBCE: return "loop bounds check elimination on null";
     case DeoptimizationKind::kBlockBCE: return "block bounds check elimination";
@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hash_set_snapshots.h"
+
+#include "gc/heap.h"
+#include "runtime.h"
+
+namespace art {
+
+uint32_t HashSetSnapshotsBase::GetGcNum() {
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  // The boot class table and the image intern tables are filled while the heap is created.
+  return (heap != nullptr) ? heap->GetCurrentGcNum() : 0u;
+}
+
+}  // namespace art
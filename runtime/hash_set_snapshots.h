@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_HASH_SET_SNAPSHOTS_H_
+#define ART_RUNTIME_HASH_SET_SNAPSHOTS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <android-base/logging.h>
+
+#include "base/dchecked_vector.h"
+#include "base/macros.h"
+
+namespace art {
+
+class HashSetSnapshotsBase {
+ protected:
+  // The number of completed GCs, used to tell when retired storage can be freed.
+  static uint32_t GetGcNum();
+};
+
+// Snapshots of the bucket arrays of a sequence of `HashSet<>`s, for lookups that do not take
+// the lock guarding the sets. A bucket array is never freed or resized in place while such
+// lookups may still use it. Instead, it is replaced by a larger copy and retired, together
+// with the snapshots that refer to it, until two more GCs have completed. At least one of them
+// started after the replacement, and every GC waits for runnable threads at least once, at a
+// point where they are not in a lookup.
+//
+// Except for `Get()`, all functions must be called with the lock guarding the sets held.
+template <typename Set>
+class HashSetSnapshots : private HashSetSnapshotsBase {
+ public:
+  using Element = typename Set::value_type;
+
+  struct Snapshot {
+    struct Buckets {
+      const Element* data;
+      size_t num_buckets;
+    };
+    dchecked_vector<Buckets> tables;
+  };
+
+  HashSetSnapshots() : snapshot_(nullptr) {}
+
+  ~HashSetSnapshots() {
+    delete snapshot_.load(std::memory_order_relaxed);
+  }
+
+  // Return the current snapshot. Lookups without the lock may use it until they reach a
+  // point where a GC can wait for them.
+  const Snapshot* Get() const {
+    return snapshot_.load(std::memory_order_acquire);
+  }
+
+  // Publish a snapshot of the sets that `get_set` returns for the elements of `tables`. Must be
+  // called after a bucket array is replaced or a set is added, before the lock is released.
+  // The old snapshot and `retired_set` are freed once no lookup can use them.
+  template <typename Tables, typename GetSet>
+  void Publish(const Tables& tables, const GetSet& get_set, Set&& retired_set = Set()) {
+    std::unique_ptr<Snapshot> snapshot(new Snapshot());
+    snapshot->tables.reserve(tables.size());
+    for (const auto& table : tables) {
+      const Set& set = get_set(table);
+      snapshot->tables.push_back({set.GetBuckets(), set.NumBuckets()});
+    }
+    const Snapshot* old_snapshot =
+        snapshot_.exchange(snapshot.release(), std::memory_order_release);
+    if (old_snapshot != nullptr) {
+      retired_storage_.push_back(RetiredStorage{GetGcNum(),
+                                                std::unique_ptr<const Snapshot>(old_snapshot),
+                                                std::move(retired_set)});
+    }
+  }
+
+  // Replace the bucket array of `set`, the last set of `tables`, with a larger one, sized like
+  // `HashSet<>::Expand()` would. `insert` adds an element of `set` to the new set. The old
+  // bucket array is retired, and the new one published.
+  template <typename Tables, typename GetSet, typename Insert>
+  void Grow(Set* set, const Tables& tables, const GetSet& get_set, const Insert& insert) {
+    DCHECK_EQ(set, &get_set(tables.back()));
+    Set new_set(set->GetMinLoadFactor(), set->GetMaxLoadFactor());
+    new_set.reserve(
+        static_cast<size_t>(set->size() / set->GetMinLoadFactor() * set->GetMaxLoadFactor()));
+    for (const Element& element : *set) {
+      insert(&new_set, element);
+    }
+    set->swap(new_set);
+    FreeRetiredStorage();
+    // `new_set` now holds the old bucket array.
+    Publish(tables, get_set, std::move(new_set));
+  }
+
+  // Free the retired snapshots and bucket arrays that no lookup can still use.
+  void FreeRetiredStorage() {
+    if (retired_storage_.empty()) {
+      return;
+    }
+    uint32_t gc_num = GetGcNum();
+    auto it = std::remove_if(retired_storage_.begin(),
+                             retired_storage_.end(),
+                             [gc_num](const RetiredStorage& storage) {
+                               return gc_num - storage.gc_num >= 2u;
+                             });
+    retired_storage_.erase(it, retired_storage_.end());
+  }
+
+  // The number of retired snapshots and bucket arrays not freed yet.
+  size_t NumRetiredStorage() const {
+    return retired_storage_.size();
+  }
+
+ private:
+  // A snapshot and bucket array replaced while lookups without the lock may still use them,
+  // with the number of completed GCs when they were replaced.
+  struct RetiredStorage {
+    uint32_t gc_num;
+    std::unique_ptr<const Snapshot> snapshot;
+    Set set;
+  };
+
+  // The current snapshot, published with release semantics.
+  std::atomic<const Snapshot*> snapshot_;
+  std::vector<RetiredStorage> retired_storage_;
+
+  DISALLOW_COPY_AND_ASSIGN(HashSetSnapshots);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_HASH_SET_SNAPSHOTS_H_
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hash_set_snapshots.h"
+
+#include <string>
+#include <vector>
+
+#include "base/hash_set.h"
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+class HashSetSnapshotsTest : public CommonRuntimeTest {};
+
+using StringSet = HashSet<std::string>;
+
+static const StringSet& GetStringSet(const StringSet& set) {
+  return set;
+}
+
+static void InsertString(StringSet* set, const std::string& s) {
+  set->insert(s);
+}
+
+TEST_F(HashSetSnapshotsTest, GrowAndFreeRetiredStorage) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<StringSet> sets(2u);
+  HashSetSnapshots<StringSet> snapshots;
+  snapshots.Publish(sets, GetStringSet);
+  EXPECT_EQ(0u, snapshots.NumRetiredStorage());
+
+  StringSet& set = sets.back();
+  for (size_t i = 0; i != 100u; ++i) {
+    set.insert(std::to_string(i));
+  }
+  snapshots.Publish(sets, GetStringSet);
+  const HashSetSnapshots<StringSet>::Snapshot* old_snapshot = snapshots.Get();
+  const std::string* old_buckets = set.GetBuckets();
+  size_t old_num_buckets = set.NumBuckets();
+  ASSERT_EQ(2u, old_snapshot->tables.size());
+  EXPECT_EQ(old_buckets, old_snapshot->tables.back().data);
+
+  // The new bucket array is published, and the old one stays readable.
+  snapshots.Grow(&set, sets, GetStringSet, InsertString);
+  const HashSetSnapshots<StringSet>::Snapshot* snapshot = snapshots.Get();
+  EXPECT_NE(old_snapshot, snapshot);
+  EXPECT_GT(set.NumBuckets(), old_num_buckets);
+  EXPECT_EQ(set.GetBuckets(), snapshot->tables.back().data);
+  EXPECT_EQ(set.NumBuckets(), snapshot->tables.back().num_buckets);
+  EXPECT_EQ(100u, set.size());
+  size_t old_size = 0u;
+  for (size_t i = 0; i != old_num_buckets; ++i) {
+    if (!old_buckets[i].empty()) {
+      ++old_size;
+    }
+  }
+  EXPECT_EQ(100u, old_size);
+  snapshots.FreeRetiredStorage();
+  EXPECT_EQ(2u, snapshots.NumRetiredStorage());
+
+  // The retired storage is freed once two more GCs have completed.
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  heap->CollectGarbage(/* clear_soft_references= */ false);
+  heap->CollectGarbage(/* clear_soft_references= */ false);
+  snapshots.FreeRetiredStorage();
+  EXPECT_EQ(0u, snapshots.NumRetiredStorage());
+  EXPECT_EQ(snapshot, snapshots.Get());
+}
+
+}  // namespace art
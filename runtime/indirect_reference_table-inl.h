@@ -37,6 +37,7 @@ inline bool IndirectReferenceTable::IsValidReference(IndirectRef iref,
                                                      /*out*/std::string* error_msg) const {
   DCHECK(iref != nullptr);
   DCHECK_EQ(GetIndirectRefKind(iref), kind_);
+  DCHECK_EQ(GetShardIndex(iref), shard_index_);
   const uint32_t top_index = top_index_;
   uint32_t idx = ExtractIndex(iref);
   if (UNLIKELY(idx >= top_index)) {
@@ -81,6 +82,7 @@ inline bool IndirectReferenceTable::CheckEntry(const char* what,
 template<ReadBarrierOption kReadBarrierOption>
 inline ObjPtr<mirror::Object> IndirectReferenceTable::Get(IndirectRef iref) const {
   DCHECK_EQ(GetIndirectRefKind(iref), kind_);
+  DCHECK_EQ(GetShardIndex(iref), shard_index_);
   uint32_t idx = ExtractIndex(iref);
   DCHECK_LT(idx, top_index_);
   DCHECK_EQ(DecodeSerial(reinterpret_cast<uintptr_t>(iref)), table_[idx].GetSerial());
@@ -92,6 +94,7 @@ inline ObjPtr<mirror::Object> IndirectReferenceTable::Get(IndirectRef iref) cons
 
 inline void IndirectReferenceTable::Update(IndirectRef iref, ObjPtr<mirror::Object> obj) {
   DCHECK_EQ(GetIndirectRefKind(iref), kind_);
+  DCHECK_EQ(GetShardIndex(iref), shard_index_);
   uint32_t idx = ExtractIndex(iref);
   DCHECK_LT(idx, top_index_);
   DCHECK_EQ(DecodeSerial(reinterpret_cast<uintptr_t>(iref)), table_[idx].GetSerial());
@@ -79,15 +79,17 @@ static inline MemMap NewIRTMap(size_t table_bytes, std::string* error_msg) {
   return result;
 }
 
-IndirectReferenceTable::IndirectReferenceTable(IndirectRefKind kind)
+IndirectReferenceTable::IndirectReferenceTable(IndirectRefKind kind, uint32_t shard_index)
     : table_mem_map_(),
       table_(nullptr),
       kind_(kind),
+      shard_index_(shard_index),
       top_index_(0u),
       max_entries_(0u),
       current_num_holes_(0) {
   CHECK_NE(kind, kJniTransition);
   CHECK_NE(kind, kLocal);
+  CHECK_LT(shard_index, kIRTMaxShards);
 }
 
 bool IndirectReferenceTable::Initialize(size_t max_count, std::string* error_msg) {
@@ -139,6 +141,16 @@ void IndirectReferenceTable::ConstexprChecks() {
   static_assert(DecodeIndex(EncodeIndex(2u)) == 2u, "Index encoding error");
   static_assert(DecodeIndex(EncodeIndex(3u)) == 3u, "Index encoding error");
 
+  // Check shard.
+  static_assert(DecodeShard(EncodeShard(0u)) == 0u, "Shard encoding error");
+  static_assert(DecodeShard(EncodeShard(1u)) == 1u, "Shard encoding error");
+  static_assert(DecodeShard(EncodeShard(kIRTMaxShards - 1u)) == kIRTMaxShards - 1u,
+                "Shard encoding error");
+  static_assert(DecodeSerial(EncodeShard(kIRTMaxShards - 1u)) == 0u, "Shard encoding error");
+  static_assert(DecodeIndex(EncodeShard(kIRTMaxShards - 1u)) == 0u, "Shard encoding error");
+  static_assert(DecodeShard(EncodeSerial(kIRTMaxSerial) | EncodeIndex(3u)) == 0u,
+                "Shard encoding error");
+
   // Distinguishing between local and (weak) global references.
   static_assert((GetGlobalOrWeakGlobalMask() & EncodeIndirectRefKind(kJniTransition)) == 0u);
   static_assert((GetGlobalOrWeakGlobalMask() & EncodeIndirectRefKind(kLocal)) == 0u);
@@ -337,7 +349,6 @@ void IndirectReferenceTable::VisitRoots(RootVisitor* visitor, const RootInfo& ro
 
 void IndirectReferenceTable::SweepJniWeakGlobals(IsMarkedVisitor* visitor) {
   CHECK_EQ(kind_, kWeakGlobal);
-  MutexLock mu(Thread::Current(), *Locks::jni_weak_globals_lock_);
   Runtime* const runtime = Runtime::Current();
   for (size_t i = 0, capacity = Capacity(); i != capacity; ++i) {
     GcRoot<mirror::Object>* entry = table_[i].GetReference();
@@ -354,15 +365,25 @@ void IndirectReferenceTable::SweepJniWeakGlobals(IsMarkedVisitor* visitor) {
 }
 
 void IndirectReferenceTable::Dump(std::ostream& os) const {
-  os << kind_ << " table dump:\n";
   ReferenceTable::Table entries;
+  AppendEntries(&entries);
+  DumpEntries(os, kind_, entries);
+}
+
+void IndirectReferenceTable::AppendEntries(/*inout*/ ReferenceTable::Table* entries) const {
   for (size_t i = 0; i < Capacity(); ++i) {
     ObjPtr<mirror::Object> obj = table_[i].GetReference()->Read<kWithoutReadBarrier>();
     if (obj != nullptr) {
       obj = table_[i].GetReference()->Read();
-      entries.push_back(GcRoot<mirror::Object>(obj));
+      entries->push_back(GcRoot<mirror::Object>(obj));
     }
   }
+}
+
+void IndirectReferenceTable::DumpEntries(std::ostream& os,
+                                         IndirectRefKind kind,
+                                         ReferenceTable::Table& entries) {
+  os << kind << " table dump:\n";
   ReferenceTable::Dump(os, entries);
 }
 
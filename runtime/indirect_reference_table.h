@@ -34,6 +34,7 @@
 #include "obj_ptr.h"
 #include "offsets.h"
 #include "read_barrier_option.h"
+#include "reference_table.h"
 
 namespace art {
 
@@ -119,6 +120,12 @@ const char* GetIndirectRefKindString(IndirectRefKind kind);
 static constexpr unsigned int kIRTSerialBits = 3;
 static constexpr uint32_t kIRTMaxSerial = ((1 << kIRTSerialBits) - 1);
 
+// Global and weak global references can be spread over several tables, each guarded by its own
+// lock, to reduce contention between threads adding and removing references. The index of the
+// table (shard) is encoded in the reference, after the serial number.
+static constexpr unsigned int kIRTShardBits = 3;
+static constexpr uint32_t kIRTMaxShards = 1u << kIRTShardBits;
+
 class IrtEntry {
  public:
   void Add(ObjPtr<mirror::Object> obj) REQUIRES_SHARED(Locks::mutator_lock_);
@@ -149,7 +156,8 @@ static_assert(IsPowerOfTwo(sizeof(IrtEntry)), "Unexpected sizeof(IrtEntry)");
 class IndirectReferenceTable {
  public:
   // Constructs an uninitialized indirect reference table. Use `Initialize()` to initialize it.
-  explicit IndirectReferenceTable(IndirectRefKind kind);
+  // The `shard_index` is encoded in all references added to this table.
+  explicit IndirectReferenceTable(IndirectRefKind kind, uint32_t shard_index = 0u);
 
   // Initialize the indirect reference table.
   //
@@ -187,10 +195,22 @@ class IndirectReferenceTable {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::alloc_tracker_lock_);
 
+  // Append the references in the table to `entries`, to dump the references of several
+  // tables of the same kind together with `DumpEntries()`.
+  void AppendEntries(/*inout*/ ReferenceTable::Table* entries) const
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  static void DumpEntries(std::ostream& os, IndirectRefKind kind, ReferenceTable::Table& entries)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::alloc_tracker_lock_);
+
   IndirectRefKind GetKind() const {
     return kind_;
   }
 
+  uint32_t GetShardIndex() const {
+    return shard_index_;
+  }
+
   // Return the #of entries in the entire table.  This includes holes, and
   // so may be larger than the actual number of "live" entries.
   size_t Capacity() const {
@@ -228,6 +248,12 @@ class IndirectReferenceTable {
     return mask;
   }
 
+  // Determine the shard of a global or weak global reference, i.e. the index of the table
+  // it was added to.
+  ALWAYS_INLINE static inline uint32_t GetShardIndex(IndirectRef iref) {
+    return DecodeShard(reinterpret_cast<uintptr_t>(iref));
+  }
+
   static bool IsGlobalOrWeakGlobalReference(IndirectRef iref) {
     return (reinterpret_cast<uintptr_t>(iref) & GetGlobalOrWeakGlobalMask()) != 0u;
   }
@@ -251,12 +277,13 @@ class IndirectReferenceTable {
   bool IsValidReference(IndirectRef, /*out*/std::string* error_msg) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // The caller must prevent concurrent modification of the table.
   void SweepJniWeakGlobals(IsMarkedVisitor* visitor)
-      REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_);
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
  private:
   static constexpr uint32_t kShiftedSerialMask = (1u << kIRTSerialBits) - 1;
+  static constexpr uint32_t kShiftedShardMask = (1u << kIRTShardBits) - 1;
 
   static constexpr size_t kKindBits = MinimumBitsToStore(
       static_cast<uint32_t>(IndirectRefKind::kLastKind));
@@ -264,11 +291,12 @@ class IndirectReferenceTable {
 
   static constexpr uintptr_t EncodeIndex(uint32_t table_index) {
     static_assert(sizeof(IndirectRef) == sizeof(uintptr_t), "Unexpected IndirectRef size");
-    DCHECK_LE(MinimumBitsToStore(table_index), BitSizeOf<uintptr_t>() - kIRTSerialBits - kKindBits);
-    return (static_cast<uintptr_t>(table_index) << kKindBits << kIRTSerialBits);
+    DCHECK_LE(MinimumBitsToStore(table_index),
+              BitSizeOf<uintptr_t>() - kIRTShardBits - kIRTSerialBits - kKindBits);
+    return (static_cast<uintptr_t>(table_index) << kKindBits << kIRTSerialBits << kIRTShardBits);
   }
   static constexpr uint32_t DecodeIndex(uintptr_t uref) {
-    return static_cast<uint32_t>((uref >> kKindBits) >> kIRTSerialBits);
+    return static_cast<uint32_t>(((uref >> kKindBits) >> kIRTSerialBits) >> kIRTShardBits);
   }
 
   static constexpr uintptr_t EncodeIndirectRefKind(IndirectRefKind kind) {
@@ -286,9 +314,20 @@ class IndirectReferenceTable {
     return static_cast<uint32_t>(uref >> kKindBits) & kShiftedSerialMask;
   }
 
+  static constexpr uintptr_t EncodeShard(uint32_t shard_index) {
+    DCHECK_LT(shard_index, kIRTMaxShards);
+    return static_cast<uintptr_t>(shard_index) << kKindBits << kIRTSerialBits;
+  }
+  static constexpr uint32_t DecodeShard(uintptr_t uref) {
+    return static_cast<uint32_t>((uref >> kKindBits) >> kIRTSerialBits) & kShiftedShardMask;
+  }
+
   constexpr uintptr_t EncodeIndirectRef(uint32_t table_index, uint32_t serial) const {
     DCHECK_LT(table_index, max_entries_);
-    return EncodeIndex(table_index) | EncodeSerial(serial) | EncodeIndirectRefKind(kind_);
+    return EncodeIndex(table_index) |
+           EncodeShard(shard_index_) |
+           EncodeSerial(serial) |
+           EncodeIndirectRefKind(kind_);
   }
 
   static void ConstexprChecks();
@@ -318,6 +357,9 @@ class IndirectReferenceTable {
   // Bit mask, ORed into all irefs.
   const IndirectRefKind kind_;
 
+  // Index of this table among the tables of the same kind, encoded in all irefs.
+  const uint32_t shard_index_;
+
   // The "top of stack" index where new references are added.
   size_t top_index_;
 
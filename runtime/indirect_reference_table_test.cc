@@ -265,4 +265,41 @@ TEST_F(IndirectReferenceTableTest, BasicTest) {
   CheckDump(&irt, 0, 0);
 }
 
+TEST_F(IndirectReferenceTableTest, ShardIndex) {
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kTableMax = 20;
+  IndirectReferenceTable irt0(kWeakGlobal, /*shard_index=*/ 0u);
+  IndirectReferenceTable irt1(kWeakGlobal, /*shard_index=*/ kIRTMaxShards - 1u);
+  std::string error_msg;
+  ASSERT_TRUE(irt0.Initialize(kTableMax, &error_msg)) << error_msg;
+  ASSERT_TRUE(irt1.Initialize(kTableMax, &error_msg)) << error_msg;
+
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::Class> c =
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;"));
+  ASSERT_TRUE(c != nullptr);
+  Handle<mirror::Object> obj0 = hs.NewHandle(c->AllocObject(soa.Self()));
+  ASSERT_TRUE(obj0 != nullptr);
+
+  // The same slot in different shards gives different references.
+  IndirectRef iref0 = irt0.Add(obj0.Get(), &error_msg);
+  IndirectRef iref1 = irt1.Add(obj0.Get(), &error_msg);
+  ASSERT_TRUE(iref0 != nullptr);
+  ASSERT_TRUE(iref1 != nullptr);
+  EXPECT_NE(iref0, iref1);
+  EXPECT_EQ(kWeakGlobal, IndirectReferenceTable::GetIndirectRefKind(iref0));
+  EXPECT_EQ(kWeakGlobal, IndirectReferenceTable::GetIndirectRefKind(iref1));
+  EXPECT_EQ(0u, IndirectReferenceTable::GetShardIndex(iref0));
+  EXPECT_EQ(kIRTMaxShards - 1u, IndirectReferenceTable::GetShardIndex(iref1));
+  EXPECT_TRUE(irt0.IsValidReference(iref0, &error_msg)) << error_msg;
+  EXPECT_TRUE(irt1.IsValidReference(iref1, &error_msg)) << error_msg;
+  EXPECT_OBJ_PTR_EQ(obj0.Get(), irt0.Get(iref0));
+  EXPECT_OBJ_PTR_EQ(obj0.Get(), irt1.Get(iref1));
+
+  EXPECT_TRUE(irt1.Remove(iref1));
+  EXPECT_TRUE(irt0.Remove(iref0));
+  EXPECT_EQ(0U, irt0.Capacity());
+  EXPECT_EQ(0U, irt1.Capacity());
+}
+
 }  // namespace art
@@ -16,10 +16,13 @@
 
 #include "intern_table-inl.h"
 
+#include <algorithm>
 #include <memory>
 
+#include "base/atomic.h"
 #include "dex/utf.h"
 #include "gc/collector/garbage_collector.h"
+#include "gc/heap.h"
 #include "gc/space/image_space.h"
 #include "gc/weak_root_state.h"
 #include "gc_root-inl.h"
@@ -106,6 +109,12 @@ ObjPtr<mirror::String> InternTable::LookupWeak(Thread* self, ObjPtr<mirror::Stri
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
+  if (CanReadWeakInternsWithoutLock(self)) {
+    ObjPtr<mirror::String> weak = weak_interns_.FindWithoutLock(GcRoot<mirror::String>(s), hash);
+    if (weak != nullptr) {
+      return weak;
+    }
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
   return weak_interns_.Find(s, hash);
 }
@@ -114,16 +123,27 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self, ObjPtr<mirror::St
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
+  size_t num_searched_frozen_tables;
+  ObjPtr<mirror::String> strong = strong_interns_.FindWithoutLock(
+      GcRoot<mirror::String>(s), hash, &num_searched_frozen_tables);
+  if (strong != nullptr) {
+    return strong;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(s, hash);
+  return strong_interns_.Find(s, hash, num_searched_frozen_tables);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
                                                  uint32_t utf16_length,
                                                  const char* utf8_data) {
   uint32_t hash = Utf8String::Hash(utf16_length, utf8_data);
+  Utf8String string(utf16_length, utf8_data);
+  ObjPtr<mirror::String> strong = strong_interns_.FindWithoutLock(string, hash);
+  if (strong != nullptr) {
+    return strong;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(Utf8String(utf16_length, utf8_data), hash);
+  return strong_interns_.Find(string, hash);
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeakLocked(ObjPtr<mirror::String> s) {
@@ -185,6 +205,14 @@ void InternTable::BroadcastForNewInterns() {
   weak_intern_condition_.Broadcast(self);
 }
 
+// NO_THREAD_SAFETY_ANALYSIS: `weak_root_state_` is read without the lock. It only changes
+// to `gc::kWeakRootStateNoReadsOrWrites` in a GC pause, which cannot start while this thread
+// is runnable, so the state read here holds until the caller's lookup is done.
+bool InternTable::CanReadWeakInternsWithoutLock(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+  return gUseReadBarrier ? self->GetWeakRefAccessEnabled()
+                         : weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites;
+}
+
 void InternTable::WaitUntilAccessible(Thread* self) {
   Locks::intern_table_lock_->ExclusiveUnlock(self);
   {
@@ -253,15 +281,11 @@ ObjPtr<mirror::String> InternTable::InternStrong(uint32_t utf16_length, const ch
   DCHECK(utf8_data != nullptr);
   uint32_t hash = Utf8String::Hash(utf16_length, utf8_data);
   Thread* self = Thread::Current();
-  ObjPtr<mirror::String> s;
+  // Try to avoid allocation. The lookup does not take the lock, so a miss is confirmed in
+  // `Insert()`, which only searches the frozen tables that were not searched here.
   size_t num_searched_strong_frozen_tables;
-  {
-    // Try to avoid allocation. If we need to allocate, release the mutex before the allocation.
-    MutexLock mu(self, *Locks::intern_table_lock_);
-    DCHECK(!strong_interns_.tables_.empty());
-    num_searched_strong_frozen_tables = strong_interns_.tables_.size() - 1u;
-    s = strong_interns_.Find(Utf8String(utf16_length, utf8_data), hash);
-  }
+  ObjPtr<mirror::String> s = strong_interns_.FindWithoutLock(
+      Utf8String(utf16_length, utf8_data), hash, &num_searched_strong_frozen_tables);
   if (s != nullptr) {
     return s;
   }
@@ -292,7 +316,13 @@ ObjPtr<mirror::String> InternTable::InternStrong(ObjPtr<mirror::String> s) {
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
-  return Insert(s, hash, /*is_strong=*/ true);
+  size_t num_searched_strong_frozen_tables;
+  ObjPtr<mirror::String> strong = strong_interns_.FindWithoutLock(
+      GcRoot<mirror::String>(s), hash, &num_searched_strong_frozen_tables);
+  if (strong != nullptr) {
+    return strong;
+  }
+  return Insert(s, hash, /*is_strong=*/ true, num_searched_strong_frozen_tables);
 }
 
 ObjPtr<mirror::String> InternTable::InternWeak(const char* utf8_data) {
@@ -310,12 +340,27 @@ ObjPtr<mirror::String> InternTable::InternWeak(ObjPtr<mirror::String> s) {
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
-  return Insert(s, hash, /*is_strong=*/ false);
+  size_t num_searched_strong_frozen_tables;
+  ObjPtr<mirror::String> strong = strong_interns_.FindWithoutLock(
+      GcRoot<mirror::String>(s), hash, &num_searched_strong_frozen_tables);
+  if (strong != nullptr) {
+    return strong;
+  }
+  Thread* self = Thread::Current();
+  if (CanReadWeakInternsWithoutLock(self)) {
+    ObjPtr<mirror::String> weak = weak_interns_.FindWithoutLock(GcRoot<mirror::String>(s), hash);
+    if (weak != nullptr) {
+      return weak;
+    }
+  }
+  return Insert(s, hash, /*is_strong=*/ false, num_searched_strong_frozen_tables);
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
   MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
   weak_interns_.SweepWeaks(visitor);
+  weak_interns_.FreeRetiredStorage();
+  strong_interns_.FreeRetiredStorage();
 }
 
 void InternTable::Table::Remove(ObjPtr<mirror::String> s, uint32_t hash) {
@@ -351,6 +396,41 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s,
   return nullptr;
 }
 
+template <typename Key>
+FLATTEN
+ObjPtr<mirror::String> InternTable::Table::FindWithoutLock(const Key& key,
+                                                           uint32_t hash,
+                                                           size_t* num_searched_frozen_tables) {
+  const Snapshots::Snapshot* snapshot = snapshots_.Get();
+  DCHECK(!snapshot->tables.empty());
+  if (num_searched_frozen_tables != nullptr) {
+    *num_searched_frozen_tables = snapshot->tables.size() - 1u;
+  }
+  StringEquals equals;
+  // Search from the last table, assuming that apps shall search for their own
+  // strings more often than for boot image strings.
+  for (const Snapshots::Snapshot::Buckets& buckets : ReverseRange(snapshot->tables)) {
+    if (buckets.num_buckets == 0u) {
+      continue;
+    }
+    // Probe like `HashSet<>` does. Elements may be moved by a concurrent erase, so bound
+    // the number of probes rather than rely on finding an empty slot.
+    size_t index = hash % buckets.num_buckets;
+    for (size_t i = 0; i != buckets.num_buckets; ++i) {
+      auto* slot = reinterpret_cast<const Atomic<GcRoot<mirror::String>>*>(&buckets.data[index]);
+      GcRoot<mirror::String> root = slot->load(std::memory_order_relaxed);
+      if (root.IsNull()) {
+        break;
+      }
+      if (equals(root, key)) {
+        return root.Read();
+      }
+      index = (index + 1u == buckets.num_buckets) ? 0u : index + 1u;
+    }
+  }
+  return nullptr;
+}
+
 FLATTEN
 ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string, uint32_t hash) {
   Locks::intern_table_lock_->AssertHeld(Thread::Current());
@@ -372,13 +452,31 @@ void InternTable::Table::AddNewTable() {
   InternalTable new_table;
   new_table.set_.SetLoadFactor(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
   tables_.push_back(std::move(new_table));
+  PublishSnapshot();
 }
 
 void InternTable::Table::Insert(ObjPtr<mirror::String> s, uint32_t hash) {
   // Always insert the last table, the image tables are before and we avoid inserting into these
   // to prevent dirty pages.
   DCHECK(!tables_.empty());
-  tables_.back().set_.PutWithHash(GcRoot<mirror::String>(s), hash);
+  UnorderedSet& set = tables_.back().set_;
+  if (set.size() >= set.ElementsUntilExpand()) {
+    // NO_THREAD_SAFETY_ANALYSIS: We hold the mutator lock, but `Grow()` is not annotated.
+    auto insert = [](UnorderedSet* new_set, const GcRoot<mirror::String>& root)
+        NO_THREAD_SAFETY_ANALYSIS {
+      ObjPtr<mirror::String> str = root.Read<kWithoutReadBarrier>();
+      new_set->PutWithHash(root, static_cast<uint32_t>(str->GetStoredHashCode()));
+    };
+    snapshots_.Grow(&set, tables_, GetSet, insert);
+  }
+  // Make the string visible to lookups without the lock before they can find it.
+  std::atomic_thread_fence(std::memory_order_release);
+  set.PutWithHash(GcRoot<mirror::String>(s), hash);
+  DCHECK_EQ(set.GetBuckets(), snapshots_.Get()->tables.back().data);
+}
+
+void InternTable::Table::PublishSnapshot() {
+  snapshots_.Publish(tables_, GetSet);
 }
 
 void InternTable::Table::VisitRoots(RootVisitor* visitor) {
@@ -442,6 +540,9 @@ InternTable::Table::Table() {
   initial_table.set_.SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
                                    runtime->GetHashTableMaxLoadFactor());
   tables_.push_back(std::move(initial_table));
+  PublishSnapshot();
 }
 
+InternTable::Table::~Table() {}
+
 }  // namespace art
@@ -17,12 +17,17 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "base/allocator.h"
 #include "base/dchecked_vector.h"
 #include "base/hash_set.h"
 #include "base/mutex.h"
 #include "gc/weak_root_state.h"
 #include "gc_root.h"
+#include "hash_set_snapshots.h"
 
 namespace art {
 
@@ -54,6 +59,14 @@ class Transaction;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * Lookups of existing interns do not take the `Locks::intern_table_lock_`. Each table publishes
+ * a snapshot of its bucket arrays, and a bucket array is never freed or resized in place while
+ * such lookups may still use it. Instead, it is replaced by a larger copy and freed once two
+ * more GCs have completed, so that at least one of them started after the replacement. Every
+ * GC waits for runnable threads at least once, at a point where they are not in a lookup.
+ * A lookup without the lock may miss a string inserted or moved concurrently, so a miss is
+ * confirmed with the lock held.
  */
 class InternTable {
  public:
@@ -236,12 +249,21 @@ class InternTable {
     };
 
     Table();
+    ~Table();
     ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s,
                                 uint32_t hash,
                                 size_t num_searched_frozen_tables = 0u)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
     ObjPtr<mirror::String> Find(const Utf8String& string, uint32_t hash)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    // Find without holding the lock, searching the tables from the current snapshot. A null
+    // result is not definitive. If `num_searched_frozen_tables` is not null, it receives the
+    // number of frozen tables searched, for a subsequent `Find()` with the lock held.
+    template <typename Key>
+    ObjPtr<mirror::String> FindWithoutLock(const Key& key,
+                                           uint32_t hash,
+                                           /*out*/ size_t* num_searched_frozen_tables = nullptr)
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!Locks::intern_table_lock_);
     void Insert(ObjPtr<mirror::String> s, uint32_t hash)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
     void Remove(ObjPtr<mirror::String> s, uint32_t hash)
@@ -253,6 +275,13 @@ class InternTable {
     // Add a new intern table that will only be inserted into from now on.
     void AddNewTable() REQUIRES(Locks::intern_table_lock_);
     size_t Size() const REQUIRES(Locks::intern_table_lock_);
+    // Publish a new snapshot of the bucket arrays for `FindWithoutLock()`, see
+    // `HashSetSnapshots<>::Publish()`.
+    void PublishSnapshot() REQUIRES(Locks::intern_table_lock_);
+    // Free retired storage that no lookup without the lock can still use.
+    void FreeRetiredStorage() REQUIRES(Locks::intern_table_lock_) {
+      snapshots_.FreeRetiredStorage();
+    }
     // Read and add an intern table from ptr.
     // Tables read are inserted at the front of the table array. Only checks for conflicts in
     // debug builds. Returns how many bytes were read.
@@ -262,9 +291,15 @@ class InternTable {
         REQUIRES(!Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
    private:
+    using Snapshots = HashSetSnapshots<UnorderedSet>;
+
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
 
+    static const UnorderedSet& GetSet(const InternalTable& table) {
+      return table.set_;
+    }
+
     // Add a table to the front of the tables vector.
     void AddInternStrings(UnorderedSet&& intern_strings, bool is_boot_image)
         REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
@@ -273,6 +308,10 @@ class InternTable {
     // modifying the zygote intern table. The back of table is modified when strings are interned.
     dchecked_vector<InternalTable> tables_;
 
+    // The bucket arrays of `tables_`, for lookups without the lock. Only `Get()` may be
+    // called without holding `Locks::intern_table_lock_`.
+    Snapshots snapshots_;
+
     friend class InternTable;
     friend class linker::ImageWriter;
     ART_FRIEND_TEST(InternTableTest, CrossHash);
@@ -308,6 +347,9 @@ class InternTable {
   void WaitUntilAccessible(Thread* self)
       REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Whether weak interns can be read without holding the lock.
+  bool CanReadWeakInternsWithoutLock(Thread* self) REQUIRES_SHARED(Locks::mutator_lock_);
+
   bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
   ConditionVariable weak_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
   // Since this contains (strong) roots, they need a read barrier to
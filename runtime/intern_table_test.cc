@@ -247,6 +247,35 @@ TEST_F(InternTableTest, LookupStrong) {
   EXPECT_TRUE(lookup_foobbS == nullptr);
 }
 
+TEST_F(InternTableTest, LookupAfterGrow) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable intern_table;
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::String> first(hs.NewHandle(intern_table.InternStrong(5, "first")));
+  ASSERT_TRUE(first != nullptr);
+  // Intern enough strings to grow the table several times.
+  static constexpr size_t kNumStrings = 5000u;
+  for (size_t i = 0; i != kNumStrings; ++i) {
+    std::string s = "string" + std::to_string(i);
+    ASSERT_TRUE(intern_table.InternStrong(s.length(), s.c_str()) != nullptr);
+  }
+  EXPECT_EQ(kNumStrings + 1u, intern_table.Size());
+  Handle<mirror::String> last(
+      hs.NewHandle(intern_table.LookupStrong(soa.Self(), 10, "string4999")));
+  ASSERT_TRUE(last != nullptr);
+  EXPECT_TRUE(last->Equals("string4999"));
+  EXPECT_OBJ_PTR_EQ(intern_table.LookupStrong(soa.Self(), 5, "first"), first.Get());
+  EXPECT_OBJ_PTR_EQ(intern_table.InternStrong(5, "first"), first.Get());
+  EXPECT_OBJ_PTR_EQ(intern_table.InternStrong(last.Get()), last.Get());
+  for (size_t i = 0; i != kNumStrings; ++i) {
+    std::string s = "string" + std::to_string(i);
+    ObjPtr<mirror::String> lookup = intern_table.LookupStrong(soa.Self(), s.length(), s.c_str());
+    ASSERT_TRUE(lookup != nullptr);
+    EXPECT_TRUE(lookup->Equals(s.c_str()));
+  }
+  EXPECT_TRUE(intern_table.LookupStrong(soa.Self(), 10, "string5000") == nullptr);
+}
+
 TEST_F(InternTableTest, InternStrongFrozenWeak) {
   ScopedObjectAccess soa(Thread::Current());
   InternTable intern_table;
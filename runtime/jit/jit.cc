@@ -22,6 +22,7 @@
 #include "base/enums.h"
 #include "base/file_utils.h"
 #include "base/logging.h"  // For VLOG.
+#include "base/mem_map_arena_pool.h"
 #include "base/memfd.h"
 #include "base/memory_tool.h"
 #include "base/runtime_debug.h"
@@ -97,12 +98,17 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
       options.GetOrDefault(RuntimeArgumentMap::JITCodeCacheMaxCapacity);
   jit_options->dump_info_on_shutdown_ =
       options.Exists(RuntimeArgumentMap::DumpJITInfoOnShutdown);
+  jit_options->perf_map_ = options.Exists(RuntimeArgumentMap::JITPerfMap);
   jit_options->profile_saver_options_ =
       options.GetOrDefault(RuntimeArgumentMap::ProfileSaverOpts);
   jit_options->thread_pool_pthread_priority_ =
       options.GetOrDefault(RuntimeArgumentMap::JITPoolThreadPthreadPriority);
   jit_options->zygote_thread_pool_pthread_priority_ =
       options.GetOrDefault(RuntimeArgumentMap::JITZygotePoolThreadPthreadPriority);
+  jit_options->arena_retained_capacity_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITArenaRetainedCapacity);
+  jit_options->use_arena_huge_pages_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITArenaHugePages);
 
   // Set default optimize threshold to aid with checking defaults.
   jit_options->optimize_threshold_ =
@@ -163,6 +169,11 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
 void Jit::DumpInfo(std::ostream& os) {
   code_cache_->Dump(os);
   cumulative_timings_.Dump(os);
+  Runtime* runtime = Runtime::Current();
+  if (!runtime->IsAotCompiler()) {
+    // Outside of dex2oat the JIT arena pool is always a MemMapArenaPool, see Runtime::Init().
+    down_cast<MemMapArenaPool*>(runtime->GetJitArenaPool())->DumpStats(os);
+  }
   MutexLock mu(Thread::Current(), lock_);
   memory_use_.PrintMemoryUse(os);
 }
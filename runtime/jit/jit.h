@@ -19,6 +19,7 @@
 
 #include <android-base/unique_fd.h>
 
+#include "base/globals.h"
 #include "base/histogram-inl.h"
 #include "base/macros.h"
 #include "base/mutex.h"
@@ -66,6 +67,10 @@ static constexpr int kJitPoolThreadPthreadDefaultPriority = 9;
 // 19 is the lowest background priority on device.
 // See android/os/Process.java.
 static constexpr int kJitZygotePoolThreadPthreadDefaultPriority = 19;
+// How much free arena memory the JIT arena pool keeps resident between compilations, so that
+// warm-up bursts do not re-fault the arenas that were trimmed after the previous compilation.
+// The JIT thread pool has a single thread, so this is the warm set of that thread.
+static constexpr size_t kJitDefaultArenaRetainedCapacity = 512 * KB;
 
 class JitOptions {
  public:
@@ -99,6 +104,11 @@ class JitOptions {
     return dump_info_on_shutdown_;
   }
 
+  // Whether to describe JIT compiled code for Linux perf, see JitLogger.
+  bool WritePerfMap() const {
+    return perf_map_;
+  }
+
   const ProfileSaverOptions& GetProfileSaverOptions() const {
     return profile_saver_options_;
   }
@@ -115,6 +125,14 @@ class JitOptions {
     return zygote_thread_pool_pthread_priority_;
   }
 
+  size_t GetArenaRetainedCapacity() const {
+    return arena_retained_capacity_;
+  }
+
+  bool UseArenaHugePages() const {
+    return use_arena_huge_pages_;
+  }
+
   bool UseJitCompilation() const {
     return use_jit_compilation_;
   }
@@ -163,8 +181,11 @@ class JitOptions {
   uint16_t priority_thread_weight_;
   uint16_t invoke_transition_weight_;
   bool dump_info_on_shutdown_;
+  bool perf_map_;
   int thread_pool_pthread_priority_;
   int zygote_thread_pool_pthread_priority_;
+  size_t arena_retained_capacity_;
+  bool use_arena_huge_pages_;
   ProfileSaverOptions profile_saver_options_;
 
   JitOptions()
@@ -178,8 +199,11 @@ class JitOptions {
         priority_thread_weight_(0),
         invoke_transition_weight_(0),
         dump_info_on_shutdown_(false),
+        perf_map_(false),
         thread_pool_pthread_priority_(kJitPoolThreadPthreadDefaultPriority),
-        zygote_thread_pool_pthread_priority_(kJitZygotePoolThreadPthreadDefaultPriority) {}
+        zygote_thread_pool_pthread_priority_(kJitZygotePoolThreadPthreadDefaultPriority),
+        arena_retained_capacity_(kJitDefaultArenaRetainedCapacity),
+        use_arena_huge_pages_(false) {}
 
   DISALLOW_COPY_AND_ASSIGN(JitOptions);
 };
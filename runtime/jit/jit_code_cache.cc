@@ -34,6 +34,7 @@
 #include "base/time_utils.h"
 #include "base/utils.h"
 #include "cha.h"
+#include "code_info_cache.h"
 #include "debugger_interface.h"
 #include "dex/dex_file_loader.h"
 #include "dex/method_reference.h"
@@ -467,6 +468,8 @@ void JitCodeCache::FreeCodeAndData(const void* code_ptr) {
     // No need to free, this is shared memory.
     return;
   }
+  // Stack walks cache decoded CodeInfo by method header, drop them before the memory is reused.
+  CodeInfoCache::InvalidateAll();
   uintptr_t allocation = FromCodeToAllocation(code_ptr);
   const uint8_t* data = nullptr;
   if (OatQuickMethodHeader::FromCodePointer(code_ptr)->IsOptimized()) {
@@ -1325,6 +1328,15 @@ void JitCodeCache::ResetHotnessCounter(ArtMethod* method, Thread* self) {
   it->second->ResetCounter();
 }
 
+void JitCodeCache::NotifyArgumentSpeculationFailed(ArtMethod* method, Thread* self) {
+  ScopedDebugDisallowReadBarriers sddrb(self);
+  MutexLock mu(self, *Locks::jit_lock_);
+  auto it = profiling_infos_.find(method);
+  if (it != profiling_infos_.end()) {
+    it->second->SetArgumentSpeculationFailed();
+  }
+}
+
 
 void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
   ScopedTrace trace(__FUNCTION__);
@@ -1571,6 +1583,10 @@ void JitCodeCache::GetProfiledMethods(const std::set<std::string>& dex_base_loca
       std::vector<TypeReference> profile_classes;
       const InlineCache& cache = info->cache_[i];
       ArtMethod* caller = info->GetMethod();
+      if (info->has_argument_caches_ && ProfilingInfo::IsArgumentDexPc(cache.dex_pc_)) {
+        // Argument caches are only used by the JIT.
+        continue;
+      }
       bool is_missing_types = false;
       for (size_t k = 0; k < InlineCache::kIndividualCacheSize; k++) {
         mirror::Class* cls = cache.classes_[k].Read();
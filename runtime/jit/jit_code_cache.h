@@ -405,6 +405,11 @@ class JitCodeCache {
   ProfilingInfo* GetProfilingInfo(ArtMethod* method, Thread* self);
   void ResetHotnessCounter(ArtMethod* method, Thread* self);
 
+  // Record that the compiled code of `method` deoptimized because of a failed argument
+  // type speculation, so that the next compilation does not speculate again.
+  void NotifyArgumentSpeculationFailed(ArtMethod* method, Thread* self)
+      REQUIRES(!Locks::jit_lock_);
+
   void VisitRoots(RootVisitor* visitor);
 
   // Return whether `method` is being compiled with the given mode.
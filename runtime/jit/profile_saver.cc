@@ -57,6 +57,11 @@ static_assert(ProfileCompilationInfo::kIndividualInlineCacheSize ==
 // At what priority to schedule the saver threads. 9 is the lowest foreground priority on device.
 static constexpr int kProfileSaverPthreadPriority = 9;
 
+// How many times we append new data to a profile file before we rewrite it with all its
+// data merged. This bounds the size overhead of the appended segments and the time it
+// takes to load the file.
+static constexpr uint32_t kMaxNumberOfProfileAppends = 16;
+
 static void SetProfileSaverThreadPriority(pthread_t thread, int priority) {
 #if defined(ART_TARGET_ANDROID)
   int result = setpriority(PRIO_PROCESS, pthread_gettid_np(thread), priority);
@@ -869,33 +874,12 @@ bool ProfileSaver::ProcessProfilingInfo(
     {
       ProfileCompilationInfo info(Runtime::Current()->GetArenaPool(),
                                   /*for_boot_image=*/options_.GetProfileBootClassPath());
-      // Load the existing profile before saving.
-      // If the file is updated between `Load` and `Save`, the update will be lost. This is
-      // acceptable. The main reason is that the lost entries will eventually come back if the user
-      // keeps using the same methods, or they won't be needed if the user doesn't use the same
-      // methods again.
-      if (!info.Load(filename, /*clear_if_invalid=*/true)) {
-        LOG(WARNING) << "Could not forcefully load profile " << filename;
-        continue;
-      }
-
-      uint64_t last_save_number_of_methods = info.GetNumberOfMethods();
-      uint64_t last_save_number_of_classes = info.GetNumberOfResolvedClasses();
-      VLOG(profiler) << "last_save_number_of_methods=" << last_save_number_of_methods
-                     << " last_save_number_of_classes=" << last_save_number_of_classes
-                     << " number of profiled methods=" << profile_methods.size();
-
-      // Try to add the method data. Note this may fail is the profile loaded from disk contains
-      // outdated data (e.g. the previous profiled dex files might have been updated).
-      // If this happens we clear the profile data and for the save to ensure the file is cleared.
       if (!info.AddMethods(
               profile_methods,
               AnnotateSampleFlags(Hotness::kFlagHot | Hotness::kFlagPostStartup),
               GetProfileSampleAnnotation())) {
-        LOG(WARNING) << "Could not add methods to the existing profiler. "
-            << "Clearing the profile data.";
-        info.ClearData();
-        force_save = true;
+        LOG(WARNING) << "Could not add methods to the profile " << filename;
+        continue;
       }
 
       {
@@ -903,9 +887,8 @@ bool ProfileSaver::ProcessProfilingInfo(
         auto profile_cache_it = profile_cache_.find(filename);
         if (profile_cache_it != profile_cache_.end()) {
           if (!info.MergeWith(*(profile_cache_it->second))) {
-            LOG(WARNING) << "Could not merge the profile. Clearing the profile data.";
-            info.ClearData();
-            force_save = true;
+            LOG(WARNING) << "Could not merge the cached profile for " << filename;
+            continue;
           }
         } else if (VLOG_IS_ON(profiler)) {
           LOG(INFO) << "Failed to find cached profile for " << filename;
@@ -914,10 +897,45 @@ bool ProfileSaver::ProcessProfilingInfo(
           }
         }
 
-        int64_t delta_number_of_methods =
-            info.GetNumberOfMethods() - last_save_number_of_methods;
-        int64_t delta_number_of_classes =
-            info.GetNumberOfResolvedClasses() - last_save_number_of_classes;
+        // Keep only the data which is not saved yet. If we saved the profile before, append
+        // this data to the file, otherwise (or once in a while, to compact the file) load the
+        // existing profile and save it with the new data.
+        auto saved_it = saved_profiles_.find(filename);
+        if (saved_it != saved_profiles_.end() &&
+            (saved_it->second.number_of_appends >= kMaxNumberOfProfileAppends ||
+             !info.RemoveDataContainedIn(*saved_it->second.data))) {
+          saved_profiles_.erase(saved_it);
+          saved_it = saved_profiles_.end();
+        }
+        std::unique_ptr<ProfileCompilationInfo> loaded_info;
+        if (saved_it == saved_profiles_.end()) {
+          loaded_info.reset(new ProfileCompilationInfo(
+              Runtime::Current()->GetArenaPool(),
+              /*for_boot_image=*/options_.GetProfileBootClassPath()));
+          // If the file is updated between `Load` and `Save`, the update will be lost. This is
+          // acceptable. The main reason is that the lost entries will eventually come back if
+          // the user keeps using the same methods, or they won't be needed if the user doesn't
+          // use the same methods again.
+          if (!loaded_info->Load(filename, /*clear_if_invalid=*/true)) {
+            LOG(WARNING) << "Could not forcefully load profile " << filename;
+            continue;
+          }
+          // This may fail if the profile loaded from disk contains outdated data (e.g. the
+          // previous profiled dex files might have been updated). If this happens we clear
+          // the profile data and force the save to ensure the file is cleared.
+          if (!info.RemoveDataContainedIn(*loaded_info)) {
+            LOG(WARNING) << "Could not add methods to the existing profiler. "
+                << "Clearing the profile data.";
+            loaded_info->ClearData();
+            force_save = true;
+          }
+        }
+
+        int64_t delta_number_of_methods = info.GetNumberOfMethods();
+        int64_t delta_number_of_classes = info.GetNumberOfResolvedClasses();
+        VLOG(profiler) << "delta_number_of_methods=" << delta_number_of_methods
+                       << " delta_number_of_classes=" << delta_number_of_classes
+                       << " number of profiled methods=" << profile_methods.size();
 
         if (!force_save &&
             delta_number_of_methods < options_.GetMinMethodsToSave() &&
@@ -934,10 +952,33 @@ bool ProfileSaver::ProcessProfilingInfo(
               std::max(static_cast<uint16_t>(delta_number_of_methods),
                       *number_of_new_methods);
         }
-        uint64_t bytes_written;
-        // Force the save. In case the profile data is corrupted or the profile
-        // has the wrong version this will "fix" the file to the correct format.
-        if (info.Save(filename, &bytes_written)) {
+        uint64_t bytes_written = 0u;
+        bool success;
+        if (saved_it != saved_profiles_.end()) {
+          SavedProfile& saved_profile = saved_it->second;
+          success = info.Append(filename, saved_profile.file_size, &bytes_written);
+          if (success && saved_profile.data->MergeWith(info)) {
+            saved_profile.file_size += bytes_written;
+            saved_profile.number_of_appends++;
+          } else {
+            // The file was modified by someone else, load and save it again next time.
+            saved_profiles_.erase(saved_it);
+          }
+        } else {
+          // Force the save. In case the profile data is corrupted or the profile
+          // has the wrong version this will "fix" the file to the correct format.
+          success = loaded_info->MergeWith(info) && loaded_info->Save(filename, &bytes_written);
+          if (success) {
+            std::unique_ptr<ProfileCompilationInfo::CompactData> saved_data(
+                new ProfileCompilationInfo::CompactData(
+                    /*for_boot_image=*/options_.GetProfileBootClassPath()));
+            if (saved_data->MergeWith(*loaded_info)) {
+              saved_profiles_.Put(filename,
+                                  SavedProfile{std::move(saved_data), bytes_written, 0u});
+            }
+          }
+        }
+        if (success) {
           // We managed to save the profile. Clear the cache stored during startup.
           if (profile_cache_it != profile_cache_.end()) {
             ProfileCompilationInfo *cached_info = profile_cache_it->second;
@@ -154,6 +154,21 @@ class ProfileSaver {
   // to just a few hundreds entries in the ProfileCompilationInfo objects.
   SafeMap<std::string, ProfileCompilationInfo*> profile_cache_ GUARDED_BY(Locks::profiler_lock_);
 
+  // The profile data last saved to a tracked file and the size of the file after that save.
+  // New data is appended to the file as long as its size did not change, so that we do not
+  // need to load and rewrite the whole profile at every save.
+  // The saved data is what lets us compute the delta to append, so it cannot be reduced to
+  // the file size. It is kept as ProfileCompilationInfo::CompactData, which takes a fraction
+  // of the memory of a ProfileCompilationInfo and no arena. The entry is dropped when an
+  // append fails and rebuilt from the file when the profile is compacted after
+  // kMaxNumberOfProfileAppends appends.
+  struct SavedProfile {
+    std::unique_ptr<ProfileCompilationInfo::CompactData> data;
+    uint64_t file_size;
+    uint32_t number_of_appends;
+  };
+  SafeMap<std::string, SavedProfile> saved_profiles_ GUARDED_BY(Locks::profiler_lock_);
+
   // Whether or not this is the first ever profile save.
   // Note this is an approximation and is not 100% precise. It relies on checking
   // whether or not the profiles are empty which is not a precise indication
@@ -29,7 +29,11 @@ ProfilingInfo::ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& ent
       : baseline_hotness_count_(GetOptimizeThreshold()),
         method_(method),
         number_of_inline_caches_(entries.size()),
-        current_inline_uses_(0) {
+        current_inline_uses_(0),
+        has_argument_caches_(
+            CanProfileArguments(method->DexInstructions().InsnsSizeInCodeUnits())),
+        argument_speculation_failed_(false),
+        null_arguments_() {
   memset(&cache_, 0, number_of_inline_caches_ * sizeof(InlineCache));
   for (size_t i = 0; i < number_of_inline_caches_; ++i) {
     cache_[i].dex_pc_ = entries[i];
@@ -60,6 +64,19 @@ ProfilingInfo* ProfilingInfo::Create(Thread* self, ArtMethod* method) {
     }
   }
 
+  // Add the inline caches of the reference arguments.
+  if (CanProfileArguments(method->DexInstructions().InsnsSizeInCodeUnits())) {
+    const char* shorty = method->GetShorty();
+    size_t ordinal = 0u;
+    // Skip the return type.
+    for (const char* c = shorty + 1; *c != '\0' && ordinal < kMaxProfiledArguments; ++c) {
+      if (*c == 'L') {
+        entries.push_back(GetArgumentDexPc(ordinal));
+        ++ordinal;
+      }
+    }
+  }
+
   // We always create a `ProfilingInfo` object, even if there is no instruction we are
   // interested in. The JIT code cache internally uses it.
 
@@ -80,6 +97,25 @@ InlineCache* ProfilingInfo::GetInlineCache(uint32_t dex_pc) {
   UNREACHABLE();
 }
 
+InlineCache* ProfilingInfo::GetArgumentCache(size_t ordinal) {
+  DCHECK_LT(ordinal, kMaxProfiledArguments);
+  if (!has_argument_caches_) {
+    // INVOKE instructions may use the pseudo dex pcs.
+    return nullptr;
+  }
+  uint32_t dex_pc = GetArgumentDexPc(ordinal);
+  // Argument caches are at the end, after the caches of INVOKE instructions.
+  for (size_t i = number_of_inline_caches_; i != 0u; --i) {
+    if (cache_[i - 1].dex_pc_ == dex_pc) {
+      return &cache_[i - 1];
+    }
+    if (!IsArgumentDexPc(cache_[i - 1].dex_pc_)) {
+      break;
+    }
+  }
+  return nullptr;
+}
+
 void ProfilingInfo::AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls) {
   InlineCache* cache = GetInlineCache(dex_pc);
   for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
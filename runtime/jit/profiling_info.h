@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_JIT_PROFILING_INFO_H_
 #define ART_RUNTIME_JIT_PROFILING_INFO_H_
 
+#include <limits>
 #include <vector>
 
 #include "base/macros.h"
@@ -70,6 +71,29 @@ class ProfilingInfo {
   static ProfilingInfo* Create(Thread* self, ArtMethod* method)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Reference arguments (other than `this`) get an inline cache of their own, recording the
+  // classes of the objects passed in. These caches are keyed by pseudo dex pcs at the very end
+  // of the 16-bit dex pc space, after the inline caches of INVOKE instructions. They are only
+  // read by the JIT and are not saved in the AOT profile. Only the first `kMaxProfiledArguments`
+  // reference arguments are profiled, and only for methods whose code does not reach the
+  // pseudo dex pcs.
+  static constexpr size_t kMaxProfiledArguments = 4;
+  static constexpr uint32_t kFirstArgumentDexPc =
+      std::numeric_limits<uint16_t>::max() + 1u - kMaxProfiledArguments;
+
+  // Return the pseudo dex pc of the inline cache for the `ordinal`-th reference argument.
+  static constexpr uint32_t GetArgumentDexPc(size_t ordinal) {
+    return kFirstArgumentDexPc + ordinal;
+  }
+
+  static constexpr bool IsArgumentDexPc(uint32_t dex_pc) {
+    return dex_pc >= kFirstArgumentDexPc && dex_pc <= std::numeric_limits<uint16_t>::max();
+  }
+
+  static constexpr bool CanProfileArguments(uint32_t insns_size_in_code_units) {
+    return insns_size_in_code_units <= kFirstArgumentDexPc;
+  }
+
   // Add information from an executed INVOKE instruction to the profile.
   void AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls)
       // Method should not be interruptible, as it manipulates the ProfilingInfo
@@ -83,6 +107,32 @@ class ProfilingInfo {
 
   InlineCache* GetInlineCache(uint32_t dex_pc);
 
+  // Return the inline cache of the `ordinal`-th reference argument, or null if the
+  // argument is not profiled.
+  InlineCache* GetArgumentCache(size_t ordinal);
+
+  // Whether the `ordinal`-th reference argument has been seen null. Baseline compiled
+  // code stores a non-zero byte at `NullArgumentOffset(ordinal)` when it sees one.
+  bool HasSeenNullArgument(size_t ordinal) const {
+    DCHECK_LT(ordinal, kMaxProfiledArguments);
+    return null_arguments_[ordinal] != 0u;
+  }
+
+  static constexpr MemberOffset NullArgumentOffset(size_t ordinal) {
+    return MemberOffset(OFFSETOF_MEMBER(ProfilingInfo, null_arguments_) + ordinal);
+  }
+
+  // Called when optimized code deoptimized because an argument did not match the types
+  // speculated from the argument caches. The compiler no longer speculates on the arguments
+  // of the method afterwards.
+  void SetArgumentSpeculationFailed() {
+    argument_speculation_failed_ = true;
+  }
+
+  bool HasArgumentSpeculationFailed() const {
+    return argument_speculation_failed_;
+  }
+
   // Increments the number of times this method is currently being inlined.
   // Returns whether it was successful, that is it could increment without
   // overflowing.
@@ -120,7 +170,8 @@ class ProfilingInfo {
   }
 
  private:
-  ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries);
+  ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries)
+      REQUIRES_SHARED(Locks::mutator_lock_);
 
   static uint16_t GetOptimizeThreshold();
 
@@ -141,6 +192,16 @@ class ProfilingInfo {
   // it updates this counter so that the GC does not try to clear the inline caches.
   uint16_t current_inline_uses_;
 
+  // Whether the last entries of `cache_` are the inline caches of reference arguments.
+  const bool has_argument_caches_;
+
+  // Whether code speculating on the argument caches has deoptimized.
+  bool argument_speculation_failed_;
+
+  // One flag per profiled reference argument, set when the argument was seen null.
+  // Bytes rather than bits so that compiled code can set them with a plain store.
+  uint8_t null_arguments_[kMaxProfiledArguments];
+
   // Dynamically allocated array of size `number_of_inline_caches_`.
   InlineCache cache_[0];
 
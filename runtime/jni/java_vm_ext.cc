@@ -59,10 +59,10 @@ namespace art {
 using android::base::StringAppendF;
 using android::base::StringAppendV;
 
-// Maximum number of global references (must fit in 16 bits).
+// Maximum number of global references in each shard (must fit in 16 bits).
 static constexpr size_t kGlobalsMax = 51200;
 
-// Maximum number of weak global references (must fit in 16 bits).
+// Maximum number of weak global references in each shard (must fit in 16 bits).
 static constexpr size_t kWeakGlobalsMax = 51200;
 
 bool JavaVMExt::IsBadJniVersion(int version) {
@@ -504,10 +504,10 @@ JavaVMExt::JavaVMExt(Runtime* runtime, const RuntimeArgumentMap& runtime_options
       tracing_enabled_(runtime_options.Exists(RuntimeArgumentMap::JniTrace)
                        || VLOG_IS_ON(third_party_jni)),
       trace_(runtime_options.GetOrDefault(RuntimeArgumentMap::JniTrace)),
-      globals_(kGlobal),
+      globals_(),
       libraries_(new Libraries),
       unchecked_functions_(&gJniInvokeInterface),
-      weak_globals_(kWeakGlobal),
+      weak_globals_(),
       allow_accessing_weak_globals_(true),
       weak_globals_add_condition_("weak globals add condition",
                                   (CHECK(Locks::jni_weak_globals_lock_ != nullptr),
@@ -519,12 +519,28 @@ JavaVMExt::JavaVMExt(Runtime* runtime, const RuntimeArgumentMap& runtime_options
       allocation_tracking_enabled_(false),
       old_allocation_tracking_state_(false) {
   functions = unchecked_functions_;
+  for (uint32_t i = 0; i != kNumGlobalsShards; ++i) {
+    globals_[i].reset(new GlobalsShard(kGlobal, i));
+    weak_globals_[i].reset(new GlobalsShard(kWeakGlobal, i));
+  }
   SetCheckJniEnabled(runtime_options.Exists(RuntimeArgumentMap::CheckJni) || kIsDebugBuild);
 }
 
+JavaVMExt::GlobalsShard::GlobalsShard(IndirectRefKind kind, uint32_t shard_index)
+    : lock(kind == kGlobal ? "JNI global reference table shard lock"
+                           : "JNI weak global reference table shard lock",
+           kJniGlobalsShardLock),
+      table(kind, shard_index),
+      report_counter(kGlobalRefReportInterval) {}
+
 bool JavaVMExt::Initialize(std::string* error_msg) {
-  return globals_.Initialize(kGlobalsMax, error_msg) &&
-         weak_globals_.Initialize(kWeakGlobalsMax, error_msg);
+  for (size_t i = 0; i != kNumGlobalsShards; ++i) {
+    if (!globals_[i]->table.Initialize(kGlobalsMax, error_msg) ||
+        !weak_globals_[i]->table.Initialize(kWeakGlobalsMax, error_msg)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 JavaVMExt::~JavaVMExt() {
@@ -639,12 +655,11 @@ bool JavaVMExt::ShouldTrace(ArtMethod* method) {
   return true;
 }
 
-void JavaVMExt::CheckGlobalRefAllocationTracking() {
+void JavaVMExt::CheckGlobalRefAllocationTracking(size_t free_capacity) {
   if (LIKELY(enable_allocation_tracking_delta_ == 0)) {
     return;
   }
-  size_t simple_free_capacity = globals_.FreeCapacity();
-  if (UNLIKELY(simple_free_capacity <= enable_allocation_tracking_delta_)) {
+  if (UNLIKELY(free_capacity <= enable_allocation_tracking_delta_)) {
     if (!allocation_tracking_enabled_) {
       LOG(WARNING) << "Global reference storage appears close to exhaustion, program termination "
                    << "may be imminent. Enabling allocation tracking to improve abort diagnostics. "
@@ -672,17 +687,27 @@ void JavaVMExt::CheckGlobalRefAllocationTracking() {
   }
 }
 
-void JavaVMExt::MaybeTraceGlobals() {
-  if (global_ref_report_counter_++ == kGlobalRefReportInterval) {
-    global_ref_report_counter_ = 1;
-    ATraceIntegerValue("JNI Global Refs", globals_.NEntriesForGlobal());
+JavaVMExt::GlobalsShard* JavaVMExt::GetGlobalsShard(const GlobalsShards& shards, Thread* self) {
+  return shards[self->GetThreadId() % kNumGlobalsShards].get();
+}
+
+template <typename Visitor>
+void JavaVMExt::VisitGlobalsShards(Thread* self,
+                                   const GlobalsShards& shards,
+                                   const Visitor& visitor) {
+  for (const std::unique_ptr<GlobalsShard>& shard : shards) {
+    MutexLock mu(self, shard->lock);
+    visitor(shard->table);
   }
 }
 
-void JavaVMExt::MaybeTraceWeakGlobals() {
-  if (weak_global_ref_report_counter_++ == kGlobalRefReportInterval) {
-    weak_global_ref_report_counter_ = 1;
-    ATraceIntegerValue("JNI Weak Global Refs", weak_globals_.NEntriesForGlobal());
+void JavaVMExt::TraceGlobals(Thread* self, const char* name, const GlobalsShards& shards) {
+  if (ATraceEnabled()) {
+    int32_t count = 0;
+    VisitGlobalsShards(self, shards, [&](IndirectReferenceTable& table) {
+      count += table.NEntriesForGlobal();
+    });
+    ATraceIntegerValue(name, count);
   }
 }
 
@@ -692,17 +717,24 @@ jobject JavaVMExt::AddGlobalRef(Thread* self, ObjPtr<mirror::Object> obj) {
     return nullptr;
   }
   IndirectRef ref;
+  size_t free_capacity;
+  bool report;
   std::string error_msg;
+  GlobalsShard* shard = GetGlobalsShard(globals_, self);
   {
-    WriterMutexLock mu(self, *Locks::jni_globals_lock_);
-    ref = globals_.Add(obj, &error_msg);
-    MaybeTraceGlobals();
+    MutexLock mu(self, shard->lock);
+    ref = shard->table.Add(obj, &error_msg);
+    free_capacity = shard->table.FreeCapacity();
+    report = CountGlobalsChange(shard);
   }
   if (UNLIKELY(ref == nullptr)) {
     LOG(FATAL) << error_msg;
     UNREACHABLE();
   }
-  CheckGlobalRefAllocationTracking();
+  if (UNLIKELY(report)) {
+    TraceGlobals(self, "JNI Global Refs", globals_);
+  }
+  CheckGlobalRefAllocationTracking(free_capacity);
   return reinterpret_cast<jobject>(ref);
 }
 
@@ -723,20 +755,33 @@ jweak JavaVMExt::AddWeakGlobalRef(Thread* self, ObjPtr<mirror::Object> obj) {
   if (obj == nullptr) {
     return nullptr;
   }
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
+  IndirectRef ref;
+  bool report;
+  std::string error_msg;
+  GlobalsShard* shard = GetGlobalsShard(weak_globals_, self);
   // CMS needs this to block for concurrent reference processing because an object allocated during
   // the GC won't be marked and concurrent reference processing would incorrectly clear the JNI weak
   // ref. But CC (gUseReadBarrier == true) doesn't because of the to-space invariant.
-  if (!gUseReadBarrier) {
+  // Other collectors only disallow access to weak globals when the mutators are paused, so if
+  // access is allowed here, it remains allowed until the reference is added.
+  if (!gUseReadBarrier && UNLIKELY(!MayAccessWeakGlobals(self))) {
+    MutexLock mu(self, *Locks::jni_weak_globals_lock_);
     WaitForWeakGlobalsAccess(self);
+    MutexLock shard_mu(self, shard->lock);
+    ref = shard->table.Add(obj, &error_msg);
+    report = CountGlobalsChange(shard);
+  } else {
+    MutexLock shard_mu(self, shard->lock);
+    ref = shard->table.Add(obj, &error_msg);
+    report = CountGlobalsChange(shard);
   }
-  std::string error_msg;
-  IndirectRef ref = weak_globals_.Add(obj, &error_msg);
-  MaybeTraceWeakGlobals();
   if (UNLIKELY(ref == nullptr)) {
     LOG(FATAL) << error_msg;
     UNREACHABLE();
   }
+  if (UNLIKELY(report)) {
+    TraceGlobals(self, "JNI Weak Global Refs", weak_globals_);
+  }
   return reinterpret_cast<jweak>(ref);
 }
 
@@ -744,27 +789,41 @@ void JavaVMExt::DeleteGlobalRef(Thread* self, jobject obj) {
   if (obj == nullptr) {
     return;
   }
+  size_t free_capacity;
+  bool report;
+  GlobalsShard* shard = GetGlobalsShard(globals_, obj);
   {
-    WriterMutexLock mu(self, *Locks::jni_globals_lock_);
-    if (!globals_.Remove(obj)) {
+    MutexLock mu(self, shard->lock);
+    if (!shard->table.Remove(obj)) {
       LOG(WARNING) << "JNI WARNING: DeleteGlobalRef(" << obj << ") "
                    << "failed to find entry";
     }
-    MaybeTraceGlobals();
+    free_capacity = shard->table.FreeCapacity();
+    report = CountGlobalsChange(shard);
   }
-  CheckGlobalRefAllocationTracking();
+  if (UNLIKELY(report)) {
+    TraceGlobals(self, "JNI Global Refs", globals_);
+  }
+  CheckGlobalRefAllocationTracking(free_capacity);
 }
 
 void JavaVMExt::DeleteWeakGlobalRef(Thread* self, jweak obj) {
   if (obj == nullptr) {
     return;
   }
-  MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  if (!weak_globals_.Remove(obj)) {
-    LOG(WARNING) << "JNI WARNING: DeleteWeakGlobalRef(" << obj << ") "
-                 << "failed to find entry";
+  bool report;
+  GlobalsShard* shard = GetGlobalsShard(weak_globals_, obj);
+  {
+    MutexLock mu(self, shard->lock);
+    if (!shard->table.Remove(obj)) {
+      LOG(WARNING) << "JNI WARNING: DeleteWeakGlobalRef(" << obj << ") "
+                   << "failed to find entry";
+    }
+    report = CountGlobalsChange(shard);
+  }
+  if (UNLIKELY(report)) {
+    TraceGlobals(self, "JNI Weak Global Refs", weak_globals_);
   }
-  MaybeTraceWeakGlobals();
 }
 
 static void ThreadEnableCheckJni(Thread* thread, void* arg) {
@@ -788,13 +847,21 @@ void JavaVMExt::DumpForSigQuit(std::ostream& os) {
   }
   Thread* self = Thread::Current();
   {
+    size_t capacity = 0u;
     ReaderMutexLock mu(self, *Locks::jni_globals_lock_);
-    os << "; globals=" << globals_.Capacity();
+    VisitGlobalsShards(self, globals_, [&capacity](IndirectReferenceTable& table) {
+      capacity += table.Capacity();
+    });
+    os << "; globals=" << capacity;
   }
   {
+    size_t capacity = 0u;
     MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-    if (weak_globals_.Capacity() > 0) {
-      os << " (plus " << weak_globals_.Capacity() << " weak)";
+    VisitGlobalsShards(self, weak_globals_, [&capacity](IndirectReferenceTable& table) {
+      capacity += table.Capacity();
+    });
+    if (capacity > 0) {
+      os << " (plus " << capacity << " weak)";
     }
   }
   os << '\n';
@@ -831,12 +898,13 @@ void JavaVMExt::BroadcastForNewWeakGlobals() {
 }
 
 ObjPtr<mirror::Object> JavaVMExt::DecodeGlobal(IndirectRef ref) {
-  return globals_.Get(ref);
+  return GetGlobalsShard(globals_, ref)->table.Get(ref);
 }
 
 void JavaVMExt::UpdateGlobal(Thread* self, IndirectRef ref, ObjPtr<mirror::Object> result) {
-  WriterMutexLock mu(self, *Locks::jni_globals_lock_);
-  globals_.Update(ref, result);
+  GlobalsShard* shard = GetGlobalsShard(globals_, ref);
+  MutexLock mu(self, shard->lock);
+  shard->table.Update(ref, result);
 }
 
 ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobal(Thread* self, IndirectRef ref) {
@@ -848,7 +916,7 @@ ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobal(Thread* self, IndirectRef ref
   // if MayAccessWeakGlobals is false.
   DCHECK_EQ(IndirectReferenceTable::GetIndirectRefKind(ref), kWeakGlobal);
   if (LIKELY(MayAccessWeakGlobals(self))) {
-    return weak_globals_.Get(ref);
+    return GetGlobalsShard(weak_globals_, ref)->table.Get(ref);
   }
   MutexLock mu(self, *Locks::jni_weak_globals_lock_);
   return DecodeWeakGlobalLocked(self, ref);
@@ -863,12 +931,12 @@ ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobalLocked(Thread* self, IndirectR
   // marked at that point. We would only need one mark bit per entry in the weak_globals_ table,
   // and a quick pass over that early on during reference processing.
   WaitForWeakGlobalsAccess(self);
-  return weak_globals_.Get(ref);
+  return GetGlobalsShard(weak_globals_, ref)->table.Get(ref);
 }
 
 ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobalAsStrong(IndirectRef ref) {
   // The target is known to be alive. Simple `Get()` with read barrier is enough.
-  return weak_globals_.Get(ref);
+  return GetGlobalsShard(weak_globals_, ref)->table.Get(ref);
 }
 
 ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobalDuringShutdown(Thread* self, IndirectRef ref) {
@@ -881,7 +949,7 @@ ObjPtr<mirror::Object> JavaVMExt::DecodeWeakGlobalDuringShutdown(Thread* self, I
   if (!gUseReadBarrier) {
     DCHECK(allow_accessing_weak_globals_.load(std::memory_order_seq_cst));
   }
-  return weak_globals_.Get(ref);
+  return GetGlobalsShard(weak_globals_, ref)->table.Get(ref);
 }
 
 bool JavaVMExt::IsWeakGlobalCleared(Thread* self, IndirectRef ref) {
@@ -892,23 +960,43 @@ bool JavaVMExt::IsWeakGlobalCleared(Thread* self, IndirectRef ref) {
   // (DecodeWeakGlobal) so that we won't accidentally mark the object alive. Since the cleared
   // sentinel is a non-moving object, we can compare the ref to it without the read barrier and
   // decide if it's cleared.
-  return Runtime::Current()->IsClearedJniWeakGlobal(weak_globals_.Get<kWithoutReadBarrier>(ref));
+  return Runtime::Current()->IsClearedJniWeakGlobal(
+      GetGlobalsShard(weak_globals_, ref)->table.Get<kWithoutReadBarrier>(ref));
 }
 
 void JavaVMExt::UpdateWeakGlobal(Thread* self, IndirectRef ref, ObjPtr<mirror::Object> result) {
+  GlobalsShard* shard = GetGlobalsShard(weak_globals_, ref);
+  MutexLock mu(self, shard->lock);
+  shard->table.Update(ref, result);
+}
+
+void JavaVMExt::SweepJniWeakGlobals(IsMarkedVisitor* visitor) {
+  Thread* self = Thread::Current();
   MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-  weak_globals_.Update(ref, result);
+  VisitGlobalsShards(self, weak_globals_, [visitor](IndirectReferenceTable& table)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    table.SweepJniWeakGlobals(visitor);
+  });
 }
 
 void JavaVMExt::DumpReferenceTables(std::ostream& os) {
   Thread* self = Thread::Current();
+  // Dump the references of all shards together.
+  ReferenceTable::Table entries;
+  auto append_entries = [&entries](IndirectReferenceTable& table)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    table.AppendEntries(&entries);
+  };
   {
     ReaderMutexLock mu(self, *Locks::jni_globals_lock_);
-    globals_.Dump(os);
+    VisitGlobalsShards(self, globals_, append_entries);
+    IndirectReferenceTable::DumpEntries(os, kGlobal, entries);
   }
+  entries.clear();
   {
     MutexLock mu(self, *Locks::jni_weak_globals_lock_);
-    weak_globals_.Dump(os);
+    VisitGlobalsShards(self, weak_globals_, append_entries);
+    IndirectReferenceTable::DumpEntries(os, kWeakGlobal, entries);
   }
 }
 
@@ -1175,14 +1263,21 @@ void* JavaVMExt::FindCodeForNativeMethod(ArtMethod* m, std::string* error_msg, b
 }
 
 void JavaVMExt::TrimGlobals() {
-  WriterMutexLock mu(Thread::Current(), *Locks::jni_globals_lock_);
-  globals_.Trim();
+  Thread* self = Thread::Current();
+  WriterMutexLock mu(self, *Locks::jni_globals_lock_);
+  VisitGlobalsShards(self, globals_, [](IndirectReferenceTable& table)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    table.Trim();
+  });
 }
 
 void JavaVMExt::VisitRoots(RootVisitor* visitor) {
   Thread* self = Thread::Current();
   ReaderMutexLock mu(self, *Locks::jni_globals_lock_);
-  globals_.VisitRoots(visitor, RootInfo(kRootJNIGlobal));
+  VisitGlobalsShards(self, globals_, [visitor](IndirectReferenceTable& table)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    table.VisitRoots(visitor, RootInfo(kRootJNIGlobal));
+  });
   // The weak_globals table is visited by the GC itself (because it mutates the table).
 }
 
@@ -19,6 +19,9 @@
 
 #include "jni.h"
 
+#include <array>
+#include <memory>
+
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "indirect_reference_table.h"
@@ -165,9 +168,7 @@ class JavaVMExt : public JavaVM {
 
   void SweepJniWeakGlobals(IsMarkedVisitor* visitor)
       REQUIRES_SHARED(Locks::mutator_lock_)
-      REQUIRES(!Locks::jni_weak_globals_lock_) {
-    weak_globals_.SweepJniWeakGlobals(visitor);
-  }
+      REQUIRES(!Locks::jni_weak_globals_lock_);
 
   ObjPtr<mirror::Object> DecodeGlobal(IndirectRef ref)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -225,6 +226,21 @@ class JavaVMExt : public JavaVM {
   static jstring GetLibrarySearchPath(JNIEnv* env, jobject class_loader);
 
  private:
+  // Global and weak global references are spread over several tables (shards), each guarded by
+  // its own lock, so that threads adding and deleting references do not contend on one lock.
+  // A thread adds references to the shard selected by its thread id, and the shard of a
+  // reference is encoded in it, see `IndirectReferenceTable::GetShardIndex()`. Operations on
+  // all shards visit them one at a time and, for strong globals, hold `jni_globals_lock_`.
+  struct GlobalsShard {
+    GlobalsShard(IndirectRefKind kind, uint32_t shard_index);
+
+    Mutex lock;
+    IndirectReferenceTable table;
+    uint32_t report_counter GUARDED_BY(lock);
+  };
+  static constexpr size_t kNumGlobalsShards = kIRTMaxShards;
+  using GlobalsShards = std::array<std::unique_ptr<GlobalsShard>, kNumGlobalsShards>;
+
   // The constructor should not be called directly. Use `Create()` that initializes
   // the new `JavaVMExt` object by calling `Initialize()`.
   JavaVMExt(Runtime* runtime, const RuntimeArgumentMap& runtime_options);
@@ -239,10 +255,39 @@ class JavaVMExt : public JavaVM {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(Locks::jni_weak_globals_lock_);
 
-  void CheckGlobalRefAllocationTracking();
+  void CheckGlobalRefAllocationTracking(size_t free_capacity);
+
+  // The shard to add references of `self` to.
+  static GlobalsShard* GetGlobalsShard(const GlobalsShards& shards, Thread* self);
+
+  // The shard that holds `ref`.
+  static GlobalsShard* GetGlobalsShard(const GlobalsShards& shards, IndirectRef ref) {
+    return shards[IndirectReferenceTable::GetShardIndex(ref)].get();
+  }
+
+  // The table that holds the global or weak global `ref`.
+  IndirectReferenceTable* GetGlobalsTable(IndirectRef ref) {
+    IndirectRefKind kind = IndirectReferenceTable::GetIndirectRefKind(ref);
+    DCHECK(kind == kGlobal || kind == kWeakGlobal) << kind;
+    return &GetGlobalsShard(kind == kGlobal ? globals_ : weak_globals_, ref)->table;
+  }
+
+  // Call `visitor` with the table of each shard in turn, holding the lock of that shard.
+  template <typename Visitor>
+  static void VisitGlobalsShards(Thread* self, const GlobalsShards& shards, const Visitor& visitor);
+
+  // Count a change of `shard`. Returns true after every kGlobalRefReportInterval changes, when
+  // the number of references should be reported with `TraceGlobals()`.
+  static bool CountGlobalsChange(GlobalsShard* shard) REQUIRES(shard->lock) {
+    if (shard->report_counter++ != kGlobalRefReportInterval) {
+      return false;
+    }
+    shard->report_counter = 1;
+    return true;
+  }
 
-  inline void MaybeTraceGlobals() REQUIRES(Locks::jni_globals_lock_);
-  inline void MaybeTraceWeakGlobals() REQUIRES(Locks::jni_weak_globals_lock_);
+  // Report the number of references in `shards`. Must be called without holding any shard lock.
+  static void TraceGlobals(Thread* self, const char* name, const GlobalsShards& shards);
 
   Runtime* const runtime_;
 
@@ -258,7 +303,7 @@ class JavaVMExt : public JavaVM {
   // Extra diagnostics.
   const std::string trace_;
 
-  IndirectReferenceTable globals_;
+  GlobalsShards globals_;
 
   // No lock annotation since UnloadNativeLibraries is called on libraries_ but locks the
   // jni_libraries_lock_ internally.
@@ -270,7 +315,7 @@ class JavaVMExt : public JavaVM {
   // Since weak_globals_ contain weak roots, be careful not to
   // directly access the object references in it. Use Get() with the
   // read barrier enabled or disabled based on the use case.
-  IndirectReferenceTable weak_globals_;
+  GlobalsShards weak_globals_;
   Atomic<bool> allow_accessing_weak_globals_;
   ConditionVariable weak_globals_add_condition_ GUARDED_BY(Locks::jni_weak_globals_lock_);
 
@@ -284,14 +329,10 @@ class JavaVMExt : public JavaVM {
 
   // We report the number of global references after every kGlobalRefReportInterval changes.
   static constexpr uint32_t kGlobalRefReportInterval = 17;
-  uint32_t weak_global_ref_report_counter_ GUARDED_BY(Locks::jni_weak_globals_lock_)
-      = kGlobalRefReportInterval;
-  uint32_t global_ref_report_counter_ GUARDED_BY(Locks::jni_globals_lock_)
-      = kGlobalRefReportInterval;
 
   friend class linker::ImageWriter;  // Uses `globals_` and `weak_globals_` without read barrier.
   friend IndirectReferenceTable* GetIndirectReferenceTable(ScopedObjectAccess& soa,
-                                                           IndirectRefKind kind);
+                                                           IndirectRef ref);
 
   DISALLOW_COPY_AND_ASSIGN(JavaVMExt);
 };
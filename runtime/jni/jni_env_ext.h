@@ -207,7 +207,7 @@ class JNIEnvExt : public JNIEnv {
   friend class ScopedJniEnvLocalRefState;
   friend class Thread;
   friend IndirectReferenceTable* GetIndirectReferenceTable(ScopedObjectAccess& soa,
-                                                           IndirectRefKind kind);
+                                                           IndirectRef ref);
   friend jni::LocalReferenceTable* GetLocalReferenceTable(ScopedObjectAccess& soa);
   friend void ThreadResetFunctionTable(Thread* thread, void* arg);
   ART_FRIEND_TEST(JniInternalTest, JNIEnvExtOffsets);
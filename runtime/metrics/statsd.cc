@@ -192,6 +192,9 @@ constexpr std::optional<int32_t> EncodeDatumId(DatumId datum_id) {
       return std::make_optional(
           statsd::
               ART_DATUM_DELTA_REPORTED__KIND__ART_DATUM_DELTA_GC_FULL_HEAP_COLLECTION_DURATION_MS);
+    case DatumId::kTimeToSafepoint:
+      // There is no atom for it yet, it is only available through the other backends.
+      return std::nullopt;
   }
 }
 
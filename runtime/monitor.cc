@@ -16,6 +16,8 @@
 
 #include "monitor-inl.h"
 
+#include <algorithm>
+#include <set>
 #include <vector>
 
 #include "android-base/stringprintf.h"
@@ -83,6 +85,7 @@ static constexpr uint64_t kLongWaitMs = 100 * kDebugThresholdFudgeFactor;
 
 uint32_t Monitor::lock_profiling_threshold_ = 0;
 uint32_t Monitor::stack_dump_lock_profiling_threshold_ = 0;
+std::atomic<uint32_t> Monitor::thin_lock_yield_limit_(0u);
 
 void Monitor::Init(uint32_t lock_profiling_threshold,
                    uint32_t stack_dump_lock_profiling_threshold) {
@@ -103,6 +106,7 @@ Monitor::Monitor(Thread* self, Thread* owner, ObjPtr<mirror::Object> obj, int32_
       wait_set_(nullptr),
       wake_set_(nullptr),
       hash_code_(hash_code),
+      spin_limit_(kInitialSpinLimit),
       lock_owner_(nullptr),
       lock_owner_method_(nullptr),
       lock_owner_dex_pc_(0),
@@ -137,6 +141,7 @@ Monitor::Monitor(Thread* self,
       wait_set_(nullptr),
       wake_set_(nullptr),
       hash_code_(hash_code),
+      spin_limit_(kInitialSpinLimit),
       lock_owner_(nullptr),
       lock_owner_method_(nullptr),
       lock_owner_dex_pc_(0),
@@ -426,8 +431,7 @@ bool Monitor::TryLock(Thread* self, bool spin) {
     lock_count_++;
     CHECK_NE(lock_count_, 0u);  // Abort on overflow.
   } else {
-    bool success = spin ? monitor_lock_.ExclusiveTryLockWithSpinning(self)
-        : monitor_lock_.ExclusiveTryLock(self);
+    bool success = spin ? TryLockWithAdaptiveSpinning(self) : monitor_lock_.ExclusiveTryLock(self);
     if (!success) {
       return false;
     }
@@ -443,6 +447,50 @@ bool Monitor::TryLock(Thread* self, bool spin) {
   return true;
 }
 
+bool Monitor::TryLockWithAdaptiveSpinning(Thread* self) {
+  uint8_t spin_limit = spin_limit_.load(std::memory_order_relaxed);
+  uint32_t spins;
+  bool success = monitor_lock_.ExclusiveTryLockWithSpinning(self, spin_limit, &spins);
+  // Only write the limit when it changes, to keep the cache line shared between contenders.
+  uint8_t new_spin_limit = spin_limit;
+  if (!success) {
+    new_spin_limit = std::max<uint8_t>(spin_limit / 2u, kMinSpinLimit);
+  } else if (spins != 0u) {
+    new_spin_limit = std::min<uint8_t>(spin_limit + 1u, kMaxSpinLimit);
+  }
+  if (new_spin_limit != spin_limit) {
+    spin_limit_.store(new_spin_limit, std::memory_order_relaxed);
+  }
+  return success;
+}
+
+uint32_t Monitor::GetThinLockYieldLimit(Runtime* runtime) {
+  uint32_t max_limit = runtime->GetMaxSpinsBeforeThinLockInflation();
+  uint32_t limit = thin_lock_yield_limit_.load(std::memory_order_relaxed);
+  return (limit == 0u || limit > max_limit) ? max_limit : limit;
+}
+
+void Monitor::ThinLockYieldsSucceeded(Runtime* runtime, uint32_t yields) {
+  // Leave room for the lock to be held a bit longer next time.
+  uint32_t limit = GetThinLockYieldLimit(runtime);
+  uint32_t new_limit = std::min<uint32_t>(std::max(limit, 2u * yields),
+                                          runtime->GetMaxSpinsBeforeThinLockInflation());
+  if (new_limit != limit) {
+    thin_lock_yield_limit_.store(new_limit, std::memory_order_relaxed);
+  }
+}
+
+void Monitor::ThinLockYieldsFailed(Runtime* runtime) {
+  uint32_t limit = GetThinLockYieldLimit(runtime);
+  uint32_t min_limit =
+      std::min<uint32_t>(kMinThinLockYields, runtime->GetMaxSpinsBeforeThinLockInflation());
+  uint32_t new_limit = std::max(limit / 2u, min_limit);
+  if (new_limit != limit) {
+    // Zero would mean the maximum.
+    thin_lock_yield_limit_.store(std::max(new_limit, 1u), std::memory_order_relaxed);
+  }
+}
+
 template <LockReason reason>
 void Monitor::Lock(Thread* self) {
   bool called_monitors_callback = false;
@@ -455,12 +503,12 @@ void Monitor::Lock(Thread* self) {
     return;
   }
   // Contended; not reentrant. We hold no locks, so tread carefully.
-  const bool log_contention = (lock_profiling_threshold_ != 0);
-  uint64_t wait_start_ms = log_contention ? MilliTime() : 0;
+  uint64_t wait_start_ns = NanoTime();
+  uint64_t blocked_ns = 0u;
 
   Thread *orig_owner = nullptr;
-  ArtMethod* owners_method;
-  uint32_t owners_dex_pc;
+  ArtMethod* owners_method = nullptr;
+  uint32_t owners_dex_pc = 0u;
 
   // Do this before releasing the mutator lock so that we don't get deflated.
   size_t num_waiters = num_waiters_.fetch_add(1, std::memory_order_relaxed);
@@ -498,15 +546,22 @@ void Monitor::Lock(Thread* self) {
       Locks::thread_list_lock_->ExclusiveUnlock(self);
     }
   }
+  const bool log_contention = (lock_profiling_threshold_ != 0);
+  orig_owner = owner_.load(std::memory_order_relaxed);
   if (log_contention) {
     // Request the current holder to set lock_owner_info.
     // Do this even if tracing is enabled, so we semi-consistently get the information
     // corresponding to MonitorExit.
     // TODO: Consider optionally obtaining a stack trace here via a checkpoint.  That would allow
     // us to see what the other thread is doing while we're waiting.
-    orig_owner = owner_.load(std::memory_order_relaxed);
     lock_owner_request_.store(orig_owner, std::memory_order_relaxed);
   }
+  // Find out where we block for the contention profile now, rather than once we hold the
+  // monitor and other threads may be waiting for us. Like the owner's method, the waiting
+  // method costs a stack walk and is only recorded when contention reporting is enabled.
+  MonitorContentionProfile* contention_profile = Runtime::Current()->GetMonitorContentionProfile();
+  MonitorContentionProfile::Site contention_site = contention_profile->GetSite(
+      self, GetObject()->GetClass(), log_contention ? self->GetCurrentMethod(nullptr) : nullptr);
   // Call the contended locking cb once and only once. Also only call it if we are locking for
   // the first time, not during a Wait wakeup.
   if (reason == LockReason::kForLock && !called_monitors_callback) {
@@ -523,21 +578,20 @@ void Monitor::Lock(Thread* self) {
     // touching monitors shortly after we suspend, so don't spin again here.
     monitor_lock_.ExclusiveLock(self);
 
-    if (log_contention && orig_owner != nullptr) {
+    if (orig_owner != nullptr) {
       // Woken from contention.
-      uint64_t wait_ms = MilliTime() - wait_start_ms;
-      uint32_t sample_percent;
-      if (wait_ms >= lock_profiling_threshold_) {
-        sample_percent = 100;
-      } else {
-        sample_percent = 100 * wait_ms / lock_profiling_threshold_;
-      }
-      if (sample_percent != 0 && (static_cast<uint32_t>(rand() % 100) < sample_percent)) {
+      blocked_ns = NanoTime() - wait_start_ns;
+      if (log_contention) {
         // Do this unconditionally for consistency. It's possible another thread
         // snuck in in the middle, and tracing was enabled. In that case, we may get its
         // MonitorEnter information. We can live with that.
         GetLockOwnerInfo(&owners_method, &owners_dex_pc, orig_owner);
+      }
 
+      // All contention goes to the contention profile. Report individual acquisitions that
+      // blocked for longer than the profiling threshold.
+      uint64_t wait_ms = NsToMs(blocked_ns);
+      if (log_contention && wait_ms >= lock_profiling_threshold_) {
         // Reacquire mutator_lock_ for logging.
         ScopedObjectAccess soa(self);
 
@@ -612,10 +666,10 @@ void Monitor::Lock(Thread* self) {
                 << PrettyDuration(MsToNs(wait_ms));
           }
           LogContentionEvent(self,
-                            wait_ms,
-                            sample_percent,
-                            owners_method,
-                            owners_dex_pc);
+                             wait_ms,
+                             /*sample_percent=*/ 100,
+                             owners_method,
+                             owners_dex_pc);
         } else {
           Locks::thread_list_lock_->ExclusiveUnlock(self);
         }
@@ -628,6 +682,14 @@ void Monitor::Lock(Thread* self) {
   owner_.store(self, std::memory_order_relaxed);
   DCHECK_EQ(lock_count_, 0u);
 
+  if (orig_owner != nullptr) {
+    // The owner method is only known if we requested it, see above.
+    uint64_t owner_key = (owners_method != nullptr)
+        ? contention_profile->GetMethodKey(self, owners_method)
+        : MonitorContentionProfile::kUnknownMethod;
+    contention_profile->Record(self, contention_site, owner_key, blocked_ns);
+  }
+
   if (ATraceEnabled()) {
     SetLockingMethodNoProxy(self);
   }
@@ -1122,6 +1184,9 @@ ObjPtr<mirror::Object> Monitor::MonitorEnter(Thread* self,
         // No ordering required for preceding lockword read, since we retest.
         LockWord thin_locked(LockWord::FromThinLockId(thread_id, 0, lock_word.GCState()));
         if (h_obj->CasLockWord(lock_word, thin_locked, CASMode::kWeak, std::memory_order_acquire)) {
+          if (UNLIKELY(contention_count > kExtraSpinIters)) {
+            ThinLockYieldsSucceeded(Runtime::Current(), contention_count - kExtraSpinIters);
+          }
           AtraceMonitorLock(self, h_obj.Get(), /* is_wait= */ false);
           return h_obj.Get();  // Success!
         }
@@ -1165,8 +1230,7 @@ ObjPtr<mirror::Object> Monitor::MonitorEnter(Thread* self,
           // Contention.
           contention_count++;
           Runtime* runtime = Runtime::Current();
-          if (contention_count
-              <= kExtraSpinIters + runtime->GetMaxSpinsBeforeThinLockInflation()) {
+          if (contention_count <= kExtraSpinIters + GetThinLockYieldLimit(runtime)) {
             // TODO: Consider switching the thread state to kWaitingForLockInflation when we are
             // yielding.  Use sched_yield instead of NanoSleep since NanoSleep can wait much longer
             // than the parameter you pass in. This can cause thread suspension to take excessively
@@ -1175,6 +1239,7 @@ ObjPtr<mirror::Object> Monitor::MonitorEnter(Thread* self,
               sched_yield();
             }
           } else {
+            ThinLockYieldsFailed(runtime);
             contention_count = 0;
             // No ordering required for initial lockword read. Install rereads it anyway.
             InflateThinLocked(self, h_obj, lock_word, 0);
@@ -1700,6 +1765,152 @@ size_t MonitorList::DeflateMonitors() {
   return visitor.deflate_count_;
 }
 
+MonitorContentionProfile::Shard::Shard()
+    : lock("monitor contention profile shard lock", kGenericBottomLock),
+      total_count(0u),
+      total_ns(0u) {}
+
+MonitorContentionProfile::MonitorContentionProfile()
+    : names_lock_("monitor contention profile names lock", kGenericBottomLock) {}
+
+void MonitorContentionProfile::Update(Entry* entry, const Entry& other) {
+  entry->count += other.count;
+  entry->total_ns += other.total_ns;
+  entry->max_ns = std::max(entry->max_ns, other.max_ns);
+}
+
+uint64_t MonitorContentionProfile::GetMethodKey(Thread* self, ArtMethod* method) {
+  if (method == nullptr || method->IsRuntimeMethod()) {
+    return kUnknownMethod;
+  }
+  method = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
+  uint64_t key = (static_cast<uint64_t>(method->GetDexFile()->GetLocationChecksum()) << 32) |
+                 method->GetDexMethodIndex();
+  {
+    MutexLock mu(self, names_lock_);
+    if (method_names_.find(key) != method_names_.end()) {
+      return key;
+    }
+  }
+  // Pretty-print outside the lock; another thread may have added the name meanwhile.
+  std::string name = method->PrettyMethod();
+  MutexLock mu(self, names_lock_);
+  method_names_.FindOrAdd(key, std::move(name));
+  return key;
+}
+
+MonitorContentionProfile::Site MonitorContentionProfile::GetSite(Thread* self,
+                                                                 ObjPtr<mirror::Class> lock_class,
+                                                                 ArtMethod* waiter_method) {
+  Site site;
+  site.lock_class = lock_class->DescriptorHash();
+  site.waiter_method = GetMethodKey(self, waiter_method);
+  {
+    MutexLock mu(self, names_lock_);
+    if (class_names_.find(site.lock_class) != class_names_.end()) {
+      return site;
+    }
+  }
+  std::string name = lock_class->PrettyDescriptor();
+  MutexLock mu(self, names_lock_);
+  class_names_.FindOrAdd(site.lock_class, std::move(name));
+  return site;
+}
+
+void MonitorContentionProfile::Record(Thread* self,
+                                      const Site& site,
+                                      uint64_t owner_method,
+                                      uint64_t blocked_ns) {
+  Shard& shard = shards_[self->GetThreadId() % kNumShards];
+  Key key(site.lock_class, site.waiter_method, owner_method);
+  MutexLock mu(self, shard.lock);
+  shard.total_count++;
+  shard.total_ns += blocked_ns;
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) {
+    if (shard.entries.size() == kMaxEntriesPerShard) {
+      return;
+    }
+    it = shard.entries.Put(key, Entry());
+  }
+  Update(&it->second, Entry{1u, blocked_ns, blocked_ns});
+}
+
+std::string MonitorContentionProfile::GetMethodName(uint64_t key) {
+  if (key == kUnknownMethod) {
+    return "<unknown>";
+  }
+  auto it = method_names_.find(key);
+  return (it != method_names_.end()) ? it->second : "<unknown>";
+}
+
+void MonitorContentionProfile::Dump(std::ostream& os) {
+  Thread* self = Thread::Current();
+  SafeMap<Key, Entry> merged;
+  uint64_t total_count = 0u;
+  uint64_t total_ns = 0u;
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock);
+    total_count += shard.total_count;
+    total_ns += shard.total_ns;
+    for (const auto& [key, entry] : shard.entries) {
+      Update(&merged.GetOrCreate(key, []() { return Entry(); }), entry);
+    }
+  }
+  os << "Monitor contention: " << total_count << " contended acquisitions blocked for "
+     << PrettyDuration(total_ns) << "\n";
+  std::vector<std::pair<Key, Entry>> entries(merged.begin(), merged.end());
+  size_t num_dumped = std::min(entries.size(), kMaxDumpedEntries);
+  std::partial_sort(entries.begin(),
+                    entries.begin() + num_dumped,
+                    entries.end(),
+                    [](const auto& lhs, const auto& rhs) {
+                      return lhs.second.total_ns > rhs.second.total_ns;
+                    });
+  MutexLock mu(self, names_lock_);
+  for (size_t i = 0; i != num_dumped; ++i) {
+    const auto& [key, entry] = entries[i];
+    auto class_it = class_names_.find(std::get<0>(key));
+    os << "  " << PrettyDuration(entry.total_ns) << " in " << entry.count << " acquisitions"
+       << " (max " << PrettyDuration(entry.max_ns) << ") on "
+       << ((class_it != class_names_.end()) ? class_it->second : "<unknown>")
+       << " blocking " << GetMethodName(std::get<1>(key))
+       << " held by " << GetMethodName(std::get<2>(key)) << "\n";
+  }
+}
+
+size_t MonitorContentionProfile::NumEntries() {
+  Thread* self = Thread::Current();
+  std::set<Key> keys;
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock);
+    for (const auto& [key, entry] : shard.entries) {
+      keys.insert(key);
+    }
+  }
+  return keys.size();
+}
+
+uint64_t MonitorContentionProfile::GetTotalCount() {
+  Thread* self = Thread::Current();
+  uint64_t total_count = 0u;
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock);
+    total_count += shard.total_count;
+  }
+  return total_count;
+}
+
+uint64_t MonitorContentionProfile::GetTotalBlockedNs() {
+  Thread* self = Thread::Current();
+  uint64_t total_ns = 0u;
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock);
+    total_ns += shard.total_ns;
+  }
+  return total_ns;
+}
+
 MonitorInfo::MonitorInfo(ObjPtr<mirror::Object> obj) : owner_(nullptr), entry_count_(0) {
   DCHECK(obj != nullptr);
   LockWord lock_word = obj->GetLockWord(true);
@@ -23,12 +23,16 @@
 
 #include <atomic>
 #include <iosfwd>
+#include <limits>
 #include <list>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include "base/allocator.h"
 #include "base/atomic.h"
 #include "base/mutex.h"
+#include "base/safe_map.h"
 #include "gc_root.h"
 #include "lock_word.h"
 #include "obj_ptr.h"
@@ -42,11 +46,13 @@ class ArtMethod;
 class IsMarkedVisitor;
 class LockWord;
 template<class T> class Handle;
+class Runtime;
 class StackVisitor;
 class Thread;
 using MonitorId = uint32_t;
 
 namespace mirror {
+class Class;
 class Object;
 }  // namespace mirror
 
@@ -310,10 +316,33 @@ class Monitor {
       REQUIRES_SHARED(Locks::mutator_lock_);
   ALWAYS_INLINE static void AtraceMonitorUnlock();
 
+  // Bounds and initial value of spin_limit_. The initial value is the number of spins
+  // Mutex::ExclusiveTryLockWithSpinning() does.
+  static constexpr uint8_t kMinSpinLimit = 1u;
+  static constexpr uint8_t kMaxSpinLimit = 16u;
+  static constexpr uint8_t kInitialSpinLimit = 5u;
+
+  // Minimum number of times a thread contending for a thin lock yields before inflating it.
+  static constexpr uint32_t kMinThinLockYields = 5u;
+
+  // Try to acquire monitor_lock_, spinning for at most spin_limit_ times, and adapt
+  // spin_limit_ to whether spinning paid off.
+  bool TryLockWithAdaptiveSpinning(Thread* self) TRY_ACQUIRE(true, monitor_lock_);
+
+  // Number of times a thread contending for a thin lock yields before inflating it, and its
+  // adaptation to whether yielding got the lock or we had to inflate anyway.
+  static uint32_t GetThinLockYieldLimit(Runtime* runtime);
+  static void ThinLockYieldsSucceeded(Runtime* runtime, uint32_t yields);
+  static void ThinLockYieldsFailed(Runtime* runtime);
+
   static uint32_t lock_profiling_threshold_;
   static uint32_t stack_dump_lock_profiling_threshold_;
   static bool capture_method_eagerly_;
 
+  // Runtime-wide thin lock yield limit, see GetThinLockYieldLimit(). Thin locks have no room
+  // for per-lock history. Zero means the runtime's max_spins_before_thin_lock_inflation_.
+  static std::atomic<uint32_t> thin_lock_yield_limit_;
+
   // Holding the monitor N times is represented by holding monitor_lock_ N times.
   Mutex monitor_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
@@ -348,6 +377,11 @@ class Monitor {
   // Stored object hash code, generated lazily by GetHashCode.
   AtomicInteger hash_code_;
 
+  // How many times a contending thread spins before blocking on monitor_lock_. Grows when
+  // spinning gets the lock, and shrinks when threads block anyway, so that we stop spinning
+  // on monitors that are usually held for long. Racy updates are harmless.
+  std::atomic<uint8_t> spin_limit_;
+
   // Data structure used to remember the method and dex pc of a recent holder of the
   // lock. Used for tracing and contention reporting. Setting these is expensive, since it
   // involves a partial stack walk. We set them only as follows, to minimize the cost:
@@ -468,6 +502,93 @@ class MonitorList {
   DISALLOW_COPY_AND_ASSIGN(MonitorList);
 };
 
+// Always-on profile of monitor contention. Threads that had to block to acquire a monitor
+// record the time they were blocked, aggregated by the class of the locked object, the method
+// that was waiting and the method the owner acquired the monitor in. The methods are only
+// known when contention reporting (-Xlockprofthreshold) is enabled, since getting them costs
+// stack walks, for the owner while it holds the monitor. Otherwise contention is only
+// aggregated by lock class. Dumped on SIGQUIT.
+//
+// Classes and methods are identified by their descriptor hash, and by the location checksum of
+// their dex file and their method index, so that entries stay valid after class unloading.
+// Their names are kept on the side, and are computed before blocking the first time a class or
+// method is seen. Counters are sharded by thread, so that recording after acquiring the monitor
+// only takes a lock that is usually uncontended.
+class MonitorContentionProfile {
+ public:
+  // Maximum number of distinct (lock class, waiter method, owner method) entries per shard.
+  // Contention beyond that is only counted in the totals.
+  static constexpr size_t kMaxEntriesPerShard = 128u;
+
+  // Number of entries shown by Dump().
+  static constexpr size_t kMaxDumpedEntries = 20u;
+
+  // Key of an unknown method.
+  static constexpr uint64_t kUnknownMethod = std::numeric_limits<uint64_t>::max();
+
+  // Where a thread blocks, computed before it blocks.
+  struct Site {
+    uint32_t lock_class;
+    uint64_t waiter_method;
+  };
+
+  MonitorContentionProfile();
+
+  // Compute the site of a thread about to block on a monitor of an instance of `lock_class`
+  // in `waiter_method`, and remember their names if not known yet.
+  Site GetSite(Thread* self, ObjPtr<mirror::Class> lock_class, ArtMethod* waiter_method)
+      REQUIRES(!names_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Return the key of `method`, and remember its name if not known yet. Returns
+  // kUnknownMethod for a null or runtime method.
+  uint64_t GetMethodKey(Thread* self, ArtMethod* method)
+      REQUIRES(!names_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Record that `self` blocked for `blocked_ns` at `site`, on a monitor acquired by the owner
+  // in the method with key `owner_method`.
+  void Record(Thread* self, const Site& site, uint64_t owner_method, uint64_t blocked_ns);
+
+  // Dump the totals and the entries with the longest total blocked time.
+  void Dump(std::ostream& os) REQUIRES(!names_lock_);
+
+  size_t NumEntries();
+  uint64_t GetTotalCount();
+  uint64_t GetTotalBlockedNs();
+
+ private:
+  static constexpr size_t kNumShards = 16u;
+
+  struct Entry {
+    uint64_t count = 0u;
+    uint64_t total_ns = 0u;
+    uint64_t max_ns = 0u;
+  };
+
+  // Lock class descriptor hash, waiter method key and owner method key.
+  using Key = std::tuple<uint32_t, uint64_t, uint64_t>;
+
+  struct Shard {
+    Shard();
+
+    Mutex lock;
+    SafeMap<Key, Entry> entries GUARDED_BY(lock);
+    uint64_t total_count GUARDED_BY(lock);
+    uint64_t total_ns GUARDED_BY(lock);
+  };
+
+  static void Update(Entry* entry, const Entry& other);
+
+  std::string GetMethodName(uint64_t key) REQUIRES(names_lock_);
+
+  Shard shards_[kNumShards];
+
+  Mutex names_lock_ BOTTOM_MUTEX_ACQUIRED_AFTER;
+  SafeMap<uint32_t, std::string> class_names_ GUARDED_BY(names_lock_);
+  SafeMap<uint64_t, std::string> method_names_ GUARDED_BY(names_lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(MonitorContentionProfile);
+};
+
 // Collects information about the current state of an object's monitor.
 // This is very unsafe, and must only be called when all threads are suspended.
 // For use only by the JDWP implementation.
@@ -23,6 +23,7 @@
 #include "barrier.h"
 #include "base/time_utils.h"
 #include "class_linker-inl.h"
+#include "class_root-inl.h"
 #include "common_runtime_test.h"
 #include "handle_scope-inl.h"
 #include "jni/java_vm_ext.h"
@@ -391,5 +392,81 @@ TEST_F(MonitorTest, TestTryLock) {
   thread_pool.StopWorkers(self);
 }
 
+TEST_F(MonitorTest, ContentionProfile) {
+  Thread* const self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  ObjPtr<mirror::Class> string_class = GetClassRoot<mirror::String>(class_linker);
+  ObjPtr<mirror::Class> object_class = GetClassRoot<mirror::Object>(class_linker);
+  ArtMethod* waiter = string_class->FindClassMethod("length", "()I", kRuntimePointerSize);
+  ArtMethod* owner = string_class->FindClassMethod("isEmpty", "()Z", kRuntimePointerSize);
+  ASSERT_TRUE(waiter != nullptr);
+  ASSERT_TRUE(owner != nullptr);
+
+  MonitorContentionProfile profile;
+  MonitorContentionProfile::Site string_site = profile.GetSite(self, string_class, waiter);
+  MonitorContentionProfile::Site object_site = profile.GetSite(self, object_class, waiter);
+  uint64_t owner_key = profile.GetMethodKey(self, owner);
+  EXPECT_EQ(owner_key, profile.GetMethodKey(self, owner));
+  EXPECT_NE(owner_key, profile.GetMethodKey(self, waiter));
+  EXPECT_EQ(MonitorContentionProfile::kUnknownMethod, profile.GetMethodKey(self, nullptr));
+  profile.Record(self, string_site, owner_key, MsToNs(1));
+  profile.Record(self, string_site, owner_key, MsToNs(3));
+  profile.Record(self, object_site, owner_key, MsToNs(2));
+  profile.Record(self, object_site, MonitorContentionProfile::kUnknownMethod, MsToNs(5));
+  EXPECT_EQ(3u, profile.NumEntries());
+  EXPECT_EQ(4u, profile.GetTotalCount());
+  EXPECT_EQ(MsToNs(11), profile.GetTotalBlockedNs());
+
+  std::ostringstream oss;
+  profile.Dump(oss);
+  std::string dump = oss.str();
+  EXPECT_NE(dump.find("4 contended acquisitions"), std::string::npos) << dump;
+  EXPECT_NE(dump.find("in 2 acquisitions (max 3ms) on java.lang.String"), std::string::npos)
+      << dump;
+  EXPECT_NE(dump.find(waiter->PrettyMethod()), std::string::npos) << dump;
+  EXPECT_NE(dump.find(owner->PrettyMethod()), std::string::npos) << dump;
+  // Entries are sorted by total blocked time.
+  EXPECT_LT(dump.find("5ms"), dump.find("4ms")) << dump;
+  EXPECT_LT(dump.find("4ms"), dump.find("2ms")) << dump;
+  EXPECT_NE(dump.find("held by <unknown>"), std::string::npos) << dump;
+}
+
+// Entries recorded by different threads go to different shards, and are merged when dumped.
+TEST_F(MonitorTest, ContentionProfileShards) {
+  Thread* const self = Thread::Current();
+  MonitorContentionProfile profile;
+  MonitorContentionProfile::Site site;
+  {
+    ScopedObjectAccess soa(self);
+    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+    ObjPtr<mirror::Class> string_class = GetClassRoot<mirror::String>(class_linker);
+    ArtMethod* waiter = string_class->FindClassMethod("length", "()I", kRuntimePointerSize);
+    ASSERT_TRUE(waiter != nullptr);
+    site = profile.GetSite(self, string_class, waiter);
+  }
+
+  static constexpr size_t kNumThreads = 4u;
+  static constexpr size_t kNumRecords = 100u;
+  ThreadPool thread_pool("the pool", kNumThreads);
+  for (size_t i = 0; i != kNumThreads; ++i) {
+    thread_pool.AddTask(self, new FunctionTask([&](Thread* worker) {
+      for (size_t j = 0; j != kNumRecords; ++j) {
+        profile.Record(worker, site, MonitorContentionProfile::kUnknownMethod, MsToNs(1));
+      }
+    }));
+  }
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+  thread_pool.StopWorkers(self);
+
+  EXPECT_EQ(kNumThreads * kNumRecords, profile.GetTotalCount());
+  EXPECT_EQ(1u, profile.NumEntries());
+  std::ostringstream oss;
+  profile.Dump(oss);
+  std::string dump = oss.str();
+  EXPECT_NE(dump.find("in " + std::to_string(kNumThreads * kNumRecords) + " acquisitions"),
+            std::string::npos) << dump;
+}
 
 }  // namespace art
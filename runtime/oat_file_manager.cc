@@ -16,8 +16,11 @@
 
 #include "oat_file_manager.h"
 
+#include <algorithm>
 #include <memory>
 #include <queue>
+#include <set>
+#include <thread>
 #include <vector>
 #include <sys/stat.h>
 
@@ -33,8 +36,10 @@
 #include "base/sdk_version.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
+#include "base/unix_file/fd_file.h"
 #include "class_linker.h"
 #include "class_loader_context.h"
+#include "code_info_cache.h"
 #include "dex/art_dex_file_loader.h"
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_loader.h"
@@ -45,11 +50,14 @@
 #include "jit/jit.h"
 #include "jni/java_vm_ext.h"
 #include "jni/jni_internal.h"
+#include "mirror/class-inl.h"
 #include "mirror/class_loader.h"
+#include "mirror/dex_cache.h"
 #include "mirror/object-inl.h"
 #include "oat_file.h"
 #include "oat_file_assistant.h"
 #include "obj_ptr-inl.h"
+#include "profile/profile_compilation_info.h"
 #include "runtime_image.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
@@ -103,6 +111,8 @@ void OatFileManager::UnRegisterAndDeleteOatFile(const OatFile* oat_file) {
   std::unique_ptr<const OatFile> compare(oat_file);
   auto it = oat_files_.find(compare);
   CHECK(it != oat_files_.end());
+  // Stack walks cache decoded CodeInfo by method header, drop them before the memory is reused.
+  CodeInfoCache::InvalidateAll();
   oat_files_.erase(it);
   compare.release();  // NOLINT b/117926937
 }
@@ -848,16 +858,291 @@ void OatFileManager::RunBackgroundVerification(const std::vector<const DexFile*>
       GetVdexFilename(odex_filename)));
 }
 
+// Loads, links and verifies a share of the startup classes of a class loader. The classes are
+// not initialized, so that static initializers keep running on the thread first using the class.
+class StartupPrelinkTask final : public Task {
+ public:
+  StartupPrelinkTask(jobject class_loader, std::vector<std::string>&& descriptors)
+      : descriptors_(std::move(descriptors)) {
+    Thread* const self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    class_loader_ = soa.Vm()->AddGlobalRef(self, soa.Decode<mirror::ClassLoader>(class_loader));
+    CHECK(class_loader_ != nullptr);
+  }
+
+  ~StartupPrelinkTask() {
+    Thread* const self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    soa.Vm()->DeleteGlobalRef(self, class_loader_);
+  }
+
+  void Run(Thread* self) override {
+    ScopedTrace trace("StartupPrelinkTask");
+    Runtime* const runtime = Runtime::Current();
+    ClassLinker* const class_linker = runtime->GetClassLinker();
+    size_t num_linked = 0u;
+    for (const std::string& descriptor : descriptors_) {
+      if (runtime->GetStartupCompleted()) {
+        // The main thread is past the point where this could help.
+        break;
+      }
+
+      // Take handles inside the loop, so that we do not hold the mutator lock for
+      // long and do not hold up the main thread or the GC.
+      ScopedObjectAccess soa(self);
+      StackHandleScope<2> hs(self);
+      Handle<mirror::ClassLoader> h_loader(hs.NewHandle(
+          soa.Decode<mirror::ClassLoader>(class_loader_)));
+      Handle<mirror::Class> h_class(hs.NewHandle<mirror::Class>(
+          class_linker->FindClass(self, descriptor.c_str(), h_loader)));
+      if (h_class == nullptr) {
+        DCHECK(self->IsExceptionPending());
+        self->ClearException();
+        continue;
+      }
+      ++num_linked;
+
+      if (!h_class->IsVerified() && !h_class->IsErroneous()) {
+        class_linker->VerifyClass(self, /* verifier_deps= */ nullptr, h_class);
+        if (self->IsExceptionPending()) {
+          // ClassLinker::VerifyClass can throw, but the exception isn't useful here. The
+          // main thread will get its own when it uses the class.
+          self->ClearException();
+        }
+      }
+    }
+    VLOG(startup) << "Prelinked " << num_linked << " of " << descriptors_.size()
+                  << " startup classes";
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  const std::vector<std::string> descriptors_;
+  jobject class_loader_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupPrelinkTask);
+};
+
+// Reads the startup classes of a class loader's dex files from the profiles, and spreads them
+// over StartupPrelinkTasks for all workers of the pool.
+class StartupProfileTask final : public Task {
+ public:
+  StartupProfileTask(ThreadPool* thread_pool,
+                     jobject class_loader,
+                     std::vector<const DexFile*>&& dex_files,
+                     const std::vector<std::string>& profile_files)
+      : thread_pool_(thread_pool),
+        class_loader_(class_loader),
+        dex_files_(std::move(dex_files)),
+        profile_files_(profile_files) {}
+
+  ~StartupProfileTask() {
+    Thread* const self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    soa.Vm()->DeleteGlobalRef(self, class_loader_);
+  }
+
+  void Run(Thread* self) override {
+    ScopedTrace trace("StartupProfileTask");
+    if (Runtime::Current()->GetStartupCompleted()) {
+      return;
+    }
+    ProfileCompilationInfo profile_info;
+    for (const std::string& profile_file : profile_files_) {
+      if (profile_file.empty()) {
+        continue;
+      }
+      // The profile saver may be writing the current profile, but it replaces it atomically.
+      unix_file::FdFile profile(profile_file, O_RDONLY, /* check_usage= */ false);
+      if (profile.Fd() == -1) {
+        continue;
+      }
+      if (!profile_info.Load(profile.Fd())) {
+        VLOG(startup) << "Could not load profile " << profile_file << " for prelinking";
+      }
+    }
+
+    // Distribute the classes round-robin, so that all workers get a similar share of
+    // the classes the main thread will need first.
+    const size_t num_tasks = thread_pool_->GetThreadCount();
+    std::vector<std::vector<std::string>> descriptors(num_tasks);
+    size_t num_classes = 0u;
+    for (const DexFile* dex_file : dex_files_) {
+      std::set<dex::TypeIndex> class_types;
+      std::set<uint16_t> unused_methods;
+      if (!profile_info.GetClassesAndMethods(*dex_file,
+                                             &class_types,
+                                             &unused_methods,
+                                             &unused_methods,
+                                             &unused_methods)) {
+        continue;
+      }
+      for (dex::TypeIndex type_index : class_types) {
+        const char* descriptor = profile_info.GetTypeDescriptor(dex_file, type_index);
+        if (descriptor[0] != 'L') {
+          // Array classes do not need linking.
+          continue;
+        }
+        descriptors[num_classes % num_tasks].push_back(descriptor);
+        ++num_classes;
+      }
+    }
+    VLOG(startup) << "Prelinking " << num_classes << " startup classes on " << num_tasks
+                  << " threads";
+    for (std::vector<std::string>& task_descriptors : descriptors) {
+      if (!task_descriptors.empty()) {
+        thread_pool_->AddTask(
+            self, new StartupPrelinkTask(class_loader_, std::move(task_descriptors)));
+      }
+    }
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  ThreadPool* const thread_pool_;
+  // Global reference, owned by the task.
+  const jobject class_loader_;
+  const std::vector<const DexFile*> dex_files_;
+  const std::vector<std::string> profile_files_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupProfileTask);
+};
+
+// Collects the dex files opened from the given code paths, with their class loaders.
+class AppDexCacheVisitor : public DexCacheVisitor {
+ public:
+  explicit AppDexCacheVisitor(const std::set<std::string>& code_paths) : code_paths_(code_paths) {}
+
+  void Visit(ObjPtr<mirror::DexCache> dex_cache)
+      REQUIRES_SHARED(Locks::dex_lock_, Locks::mutator_lock_) override {
+    ObjPtr<mirror::ClassLoader> class_loader = dex_cache->GetClassLoader();
+    const DexFile* dex_file = dex_cache->GetDexFile();
+    if (class_loader != nullptr &&
+        code_paths_.count(DexFileLoader::GetBaseLocation(dex_file->GetLocation())) != 0) {
+      app_dex_files_.emplace_back(class_loader, dex_file);
+    }
+  }
+
+  const std::vector<std::pair<ObjPtr<mirror::ClassLoader>, const DexFile*>>& GetAppDexFiles()
+      const {
+    return app_dex_files_;
+  }
+
+ private:
+  const std::set<std::string>& code_paths_;
+  std::vector<std::pair<ObjPtr<mirror::ClassLoader>, const DexFile*>> app_dex_files_;
+};
+
+void OatFileManager::RunStartupPrelinking(const std::vector<std::string>& code_paths,
+                                          const std::vector<std::string>& profile_files) {
+  Runtime* const runtime = Runtime::Current();
+  Thread* const self = Thread::Current();
+
+  if (!runtime->IsStartupPrelinkEnabled() ||
+      runtime->IsJavaDebuggable() ||
+      runtime->IsSystemServer() ||
+      runtime->GetStartupCompleted()) {
+    // Runtime threads are not allowed to load classes when debuggable, see
+    // RunBackgroundVerification. The system server does not benefit from this,
+    // as its startup is not user-visible.
+    return;
+  }
+
+  if (runtime->IsShuttingDown(self)) {
+    // Not allowed to create new threads during runtime shutdown.
+    return;
+  }
+
+  // Find the dex files of the code paths and the class loaders they were opened in.
+  std::vector<std::pair<jobject, std::vector<const DexFile*>>> loaders;
+  {
+    std::set<std::string> code_path_set(code_paths.begin(), code_paths.end());
+    ScopedObjectAccess soa(self);
+    AppDexCacheVisitor visitor(code_path_set);
+    {
+      ReaderMutexLock mu(self, *Locks::dex_lock_);
+      runtime->GetClassLinker()->VisitDexCaches(&visitor);
+    }
+    for (const auto& [class_loader, dex_file] : visitor.GetAppDexFiles()) {
+      auto it = std::find_if(loaders.begin(), loaders.end(), [&](const auto& entry) {
+        return soa.Decode<mirror::ClassLoader>(entry.first) == class_loader;
+      });
+      if (it == loaders.end()) {
+        loaders.emplace_back(soa.Vm()->AddGlobalRef(self, class_loader),
+                             std::vector<const DexFile*>());
+        it = loaders.end() - 1;
+      }
+      it->second.push_back(dex_file);
+    }
+  }
+
+  for (auto& [class_loader, dex_files] : loaders) {
+    // As for background verification, only link classes of class loaders whose lookup
+    // chain we know, as runtime threads cannot call into Java to load classes.
+    std::unique_ptr<ClassLoaderContext> context(
+        ClassLoaderContext::CreateContextForClassLoader(class_loader, nullptr));
+    bool added_task = false;
+    if (context != nullptr) {
+      WriterMutexLock mu(self, *Locks::oat_file_manager_lock_);
+      // Check again under the lock, as the pool is deleted once startup has completed.
+      if (!runtime->GetStartupCompleted()) {
+        if (startup_prelink_thread_pool_ == nullptr) {
+          static constexpr size_t kMaxStartupPrelinkWorkers = 4u;
+          const size_t num_workers = std::min(
+              static_cast<size_t>(std::thread::hardware_concurrency()), kMaxStartupPrelinkWorkers);
+          startup_prelink_thread_pool_.reset(
+              new ThreadPool("Startup prelink thread pool", std::max(num_workers, size_t{1})));
+          startup_prelink_thread_pool_->StartWorkers(self);
+        }
+        // The task takes ownership of the global reference.
+        startup_prelink_thread_pool_->AddTask(
+            self,
+            new StartupProfileTask(startup_prelink_thread_pool_.get(),
+                                   class_loader,
+                                   std::move(dex_files),
+                                   profile_files));
+        added_task = true;
+      }
+    }
+    if (!added_task) {
+      ScopedObjectAccess soa(self);
+      soa.Vm()->DeleteGlobalRef(self, class_loader);
+    }
+  }
+}
+
+void OatFileManager::DeleteStartupPrelinkThreadPool() {
+  std::unique_ptr<ThreadPool> thread_pool;
+  {
+    WriterMutexLock mu(Thread::Current(), *Locks::oat_file_manager_lock_);
+    thread_pool = std::move(startup_prelink_thread_pool_);
+  }
+  if (thread_pool != nullptr) {
+    // Workers stop at the next class, as startup has completed.
+    thread_pool->WaitForWorkersToBeCreated();
+  }
+}
+
 void OatFileManager::WaitForWorkersToBeCreated() {
   DCHECK(!Runtime::Current()->IsShuttingDown(Thread::Current()))
       << "Cannot create new threads during runtime shutdown";
   if (verification_thread_pool_ != nullptr) {
     verification_thread_pool_->WaitForWorkersToBeCreated();
   }
+  if (startup_prelink_thread_pool_ != nullptr) {
+    startup_prelink_thread_pool_->WaitForWorkersToBeCreated();
+  }
 }
 
 void OatFileManager::DeleteThreadPool() {
   verification_thread_pool_.reset(nullptr);
+  startup_prelink_thread_pool_.reset(nullptr);
 }
 
 void OatFileManager::WaitForBackgroundVerificationTasksToFinish() {
@@ -877,6 +1162,15 @@ void OatFileManager::WaitForBackgroundVerificationTasks() {
   }
 }
 
+void OatFileManager::WaitForStartupPrelinkTasks() {
+  if (startup_prelink_thread_pool_ != nullptr) {
+    Thread* const self = Thread::Current();
+    startup_prelink_thread_pool_->WaitForWorkersToBeCreated();
+    // Leave the tasks to the workers, which the profile task spreads the classes over.
+    startup_prelink_thread_pool_->Wait(self, /* do_work= */ false, /* may_hold_locks= */ false);
+  }
+}
+
 void OatFileManager::ClearOnlyUseTrustedOatFiles() {
   only_use_system_oat_files_ = false;
 }
@@ -127,11 +127,22 @@ class OatFileManager {
   void RunBackgroundVerification(const std::vector<const DexFile*>& dex_files,
                                  jobject class_loader);
 
+  // Spawn background threads which load, link and verify the classes that the given profiles
+  // list for the dex files of `code_paths`, so that the main thread finds them ready during
+  // startup. Class initializers are not run: they stay with the thread first using the class.
+  void RunStartupPrelinking(const std::vector<std::string>& code_paths,
+                            const std::vector<std::string>& profile_files)
+      REQUIRES(!Locks::oat_file_manager_lock_, !Locks::mutator_lock_);
+
+  // If allocated, delete the thread pool used for startup prelinking. Called once startup
+  // has completed, at which point the remaining prelinking work is not useful anymore.
+  void DeleteStartupPrelinkThreadPool() REQUIRES(!Locks::oat_file_manager_lock_);
+
   // Wait for thread pool workers to be created. This is used during shutdown as
   // threads are not allowed to attach while runtime is in shutdown lock.
   void WaitForWorkersToBeCreated();
 
-  // If allocated, delete a thread pool of background verification threads.
+  // If allocated, delete the thread pools of background verification and prelinking threads.
   void DeleteThreadPool();
 
   // Wait for any ongoing background verification tasks to finish.
@@ -140,6 +151,9 @@ class OatFileManager {
   // Wait for all background verification tasks to finish. This is only used by tests.
   void WaitForBackgroundVerificationTasks();
 
+  // Wait for all startup prelinking tasks to finish. This is only used by tests.
+  void WaitForStartupPrelinkTasks();
+
   // Maximum number of anonymous vdex files kept in the process' data folder.
   static constexpr size_t kAnonymousVdexCacheSize = 8u;
 
@@ -169,6 +183,9 @@ class OatFileManager {
   // Single-thread pool used to run the verifier in the background.
   std::unique_ptr<ThreadPool> verification_thread_pool_;
 
+  // Pool used to link and verify the startup classes of the app, see RunStartupPrelinking.
+  std::unique_ptr<ThreadPool> startup_prelink_thread_pool_;
+
   DISALLOW_COPY_AND_ASSIGN(OatFileManager);
 };
 
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "oat_file_manager.h"
+
+#include <string>
+#include <vector>
+
+#include "android-base/strings.h"
+#include "class_linker.h"
+#include "common_runtime_test.h"
+#include "dex/dex_file.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "profile/profile_compilation_info.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-inl.h"
+#include "thread_list.h"
+
+namespace art {
+
+class OatFileManagerStartupPrelinkTest : public CommonRuntimeTest {
+ public:
+  void SetUpRuntimeOptions(RuntimeOptions* options) override {
+    // Reset the callbacks so that the runtime doesn't think it's for AOT.
+    callbacks_ = nullptr;
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-Xstartup-prelink:true", nullptr));
+  }
+
+ protected:
+  // Load the "Interfaces" dex file in a PathClassLoader, and write a profile listing
+  // `kPrelinkedClasses` as its startup classes.
+  void SetUpApp() {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader_ = LoadDex("Interfaces");
+    std::vector<const DexFile*> dex_files = GetDexFiles(class_loader_);
+    ASSERT_EQ(1u, dex_files.size());
+    code_path_ = dex_files[0]->GetLocation();
+
+    // The dex cache of an app's dex file is registered by the time the app registers its
+    // code paths, as the main thread has used its classes. Do the same here.
+    StackHandleScope<1> hs(soa.Self());
+    Handle<mirror::ClassLoader> loader(hs.NewHandle(
+        soa.Decode<mirror::ClassLoader>(class_loader_)));
+    ASSERT_TRUE(class_linker_->FindClass(soa.Self(), "LInterfaces;", loader) != nullptr);
+    for (const char* descriptor : kPrelinkedClasses) {
+      ASSERT_TRUE(LookupClass(soa, descriptor) == nullptr) << descriptor;
+    }
+
+    ProfileCompilationInfo info;
+    for (const char* descriptor : kPrelinkedClasses) {
+      ASSERT_TRUE(info.AddClass(*dex_files[0], descriptor));
+    }
+    ASSERT_TRUE(info.Save(profile_.GetFd()));
+    ASSERT_EQ(0, profile_.GetFile()->Flush());
+  }
+
+  // Look up a class without loading it.
+  ObjPtr<mirror::Class> LookupClass(ScopedObjectAccess& soa, const char* descriptor)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    return class_linker_->LookupClass(
+        soa.Self(), descriptor, soa.Decode<mirror::ClassLoader>(class_loader_));
+  }
+
+  void RunStartupPrelinking() {
+    Runtime::Current()->GetOatFileManager().RunStartupPrelinking(
+        {code_path_}, {profile_.GetFilename()});
+  }
+
+  static size_t CountPrelinkWorkers() {
+    Thread* self = Thread::Current();
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    size_t count = 0u;
+    Runtime::Current()->GetThreadList()->ForEach([&count](Thread* thread) {
+      std::string name;
+      thread->GetThreadName(name);
+      if (android::base::StartsWith(name, "Startup prelink thread pool")) {
+        ++count;
+      }
+    });
+    return count;
+  }
+
+  static constexpr const char* kPrelinkedClasses[] = {
+      "LInterfaces$A;",
+      "LInterfaces$B;",
+  };
+
+  ScratchFile profile_;
+  jobject class_loader_ = nullptr;
+  std::string code_path_;
+};
+
+TEST_F(OatFileManagerStartupPrelinkTest, PrelinksStartupClasses) {
+  SetUpApp();
+  RunStartupPrelinking();
+  OatFileManager& oat_file_manager = Runtime::Current()->GetOatFileManager();
+  oat_file_manager.WaitForStartupPrelinkTasks();
+
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    for (const char* descriptor : kPrelinkedClasses) {
+      ObjPtr<mirror::Class> klass = LookupClass(soa, descriptor);
+      ASSERT_TRUE(klass != nullptr) << descriptor;
+      EXPECT_TRUE(klass->IsVerified()) << descriptor;
+      // Class initializers are left to the thread first using the class.
+      EXPECT_FALSE(klass->IsInitialized()) << descriptor;
+    }
+  }
+
+  ASSERT_NE(0u, CountPrelinkWorkers());
+  ASSERT_TRUE(Runtime::Current()->NotifyStartupCompleted());
+  oat_file_manager.DeleteStartupPrelinkThreadPool();
+  EXPECT_EQ(0u, CountPrelinkWorkers());
+}
+
+TEST_F(OatFileManagerStartupPrelinkTest, DeleteThreadPoolWaitsForWorkers) {
+  SetUpApp();
+  // Delete the pool like runtime shutdown does, while the workers may still be linking
+  // classes. This must not return before they are done and detached from the runtime.
+  RunStartupPrelinking();
+  OatFileManager& oat_file_manager = Runtime::Current()->GetOatFileManager();
+  oat_file_manager.WaitForWorkersToBeCreated();
+  ASSERT_NE(0u, CountPrelinkWorkers());
+  oat_file_manager.DeleteThreadPool();
+  EXPECT_EQ(0u, CountPrelinkWorkers());
+}
+
+TEST_F(OatFileManagerStartupPrelinkTest, NoPrelinkingAfterStartup) {
+  SetUpApp();
+  ASSERT_TRUE(Runtime::Current()->NotifyStartupCompleted());
+  RunStartupPrelinking();
+  EXPECT_EQ(0u, CountPrelinkWorkers());
+
+  ScopedObjectAccess soa(Thread::Current());
+  for (const char* descriptor : kPrelinkedClasses) {
+    EXPECT_TRUE(LookupClass(soa, descriptor) == nullptr) << descriptor;
+  }
+}
+
+}  // namespace art
@@ -232,6 +232,10 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .IntoKey(M::DumpRegionInfoAfterGC)
       .Define("-XX:DumpJITInfoOnShutdown")
           .IntoKey(M::DumpJITInfoOnShutdown)
+      .Define("-XX:JITPerfMap")
+          .WithHelp("Write the perf-PID.map and jit-PID.dump files describing JIT compiled code"
+                    " for Linux perf, without generating native debug info.")
+          .IntoKey(M::JITPerfMap)
       .Define("-XX:IgnoreMaxFootprint")
           .IntoKey(M::IgnoreMaxFootprint)
       .Define("-XX:AlwaysLogExplicitGcs:_")
@@ -292,6 +296,13 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xjitzygotepthreadpriority:_")
           .WithType<int>()
           .IntoKey(M::JITZygotePoolThreadPthreadPriority)
+      .Define("-Xjitarenaretainedsize:_")
+          .WithType<MemoryKiB>()
+          .IntoKey(M::JITArenaRetainedCapacity)
+      .Define("-Xjitarenahugepages:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITArenaHugePages)
       .Define("-Xjitsaveprofilinginfo")
           .WithType<ProfileSaverOptions>()
           .AppendValues()
@@ -363,6 +374,8 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
                          {"wallclock",      TraceClockSource::kWall},
                          {"dualclock",      TraceClockSource::kDual}})
           .IntoKey(M::MethodTraceClock)
+      .Define("-Xmethod-trace-compact")
+          .IntoKey(M::MethodTraceCompact)
       .Define("-Xcompiler:_")
           .WithType<std::string>()
           .IntoKey(M::Compiler)
@@ -468,6 +481,26 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::ForceJavaZygoteForkLoop)
+      .Define("-Xstartup-prelink:_")
+          .WithHelp("Link and verify the classes of the app's profile in the background during "
+                    "startup.")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::StartupPrelink)
+      .Define("-Xthrowable-stack-trace-depth:_")
+          .WithHelp("Maximum number of frames in the stack trace of a Throwable, 0 for no limit.")
+          .WithType<unsigned int>()
+          .IntoKey(M::ThrowableStackTraceDepth)
+      .Define("-Xthrowable-stack-trace-reuse:_")
+          .WithHelp("Share the stack trace of Throwables thrown from identical stacks.")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::ThrowableStackTraceReuse)
+      .Define("-Xparallel-checkpoint-threads:_")
+          .WithHelp("Number of threads running the checkpoints of suspended threads, 0 to run "
+                    "them on the requesting thread.")
+          .WithType<unsigned int>()
+          .IntoKey(M::ParallelCheckpointThreads)
       .Define("-XX:PerfettoHprof=_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
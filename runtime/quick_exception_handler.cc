@@ -708,6 +708,10 @@ void QuickExceptionHandler::DeoptimizeSingleFrame(DeoptimizationKind kind) {
   // can be reused when debugging support (like breakpoints) are no longer
   // needed fot this method.
   if (Runtime::Current()->UseJitCompilation() && (kind != DeoptimizationKind::kDebugging)) {
+    if (kind == DeoptimizationKind::kJitArgumentType) {
+      Runtime::Current()->GetJit()->GetCodeCache()->NotifyArgumentSpeculationFailed(
+          deopt_method, self_);
+    }
     Runtime::Current()->GetJit()->GetCodeCache()->InvalidateCompiledCodeFor(
         deopt_method, visitor.GetSingleFrameDeoptQuickMethodHeader());
   } else {
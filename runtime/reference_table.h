@@ -57,9 +57,10 @@ class ReferenceTable {
   void VisitRoots(RootVisitor* visitor, const RootInfo& root_info)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
- private:
   using Table = std::vector<GcRoot<mirror::Object>,
                             TrackingAllocator<GcRoot<mirror::Object>, kAllocatorTagReferenceTable>>;
+
+ private:
   static void Dump(std::ostream& os, Table& entries)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::alloc_tracker_lock_);
@@ -31,6 +31,7 @@
 #include "mirror/object_array-inl.h"
 #include "nativehelper/scoped_local_ref.h"
 #include "nth_caller_visitor.h"
+#include "reflective_access_cache.h"
 #include "scoped_thread_state_change-inl.h"
 #include "stack_reference.h"
 #include "thread-inl.h"
@@ -41,6 +42,87 @@ namespace {
 
 using android::base::StringPrintf;
 
+// Returns the primitive type boxed by instances of `klass`, or `kPrimNot` if `klass` is not
+// one of the box classes. This avoids comparing the descriptor of `klass` against the
+// descriptor of each box class in turn: the only field of a box class gives the candidate
+// type, and a pointer comparison with the declaring class of its `valueOf` confirms it.
+ALWAYS_INLINE
+Primitive::Type GetBoxedPrimitiveType(ObjPtr<mirror::Class> klass)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  if (!klass->IsFinal() || klass->NumInstanceFields() != 1u) {
+    return Primitive::kPrimNot;
+  }
+  Primitive::Type type = klass->GetIFieldsPtr()->At(0).GetTypeAsPrimitiveType();
+  ArtMethod* value_of;
+  switch (type) {
+    case Primitive::kPrimBoolean:
+      value_of = WellKnownClasses::java_lang_Boolean_valueOf;
+      break;
+    case Primitive::kPrimByte:
+      value_of = WellKnownClasses::java_lang_Byte_valueOf;
+      break;
+    case Primitive::kPrimChar:
+      value_of = WellKnownClasses::java_lang_Character_valueOf;
+      break;
+    case Primitive::kPrimDouble:
+      value_of = WellKnownClasses::java_lang_Double_valueOf;
+      break;
+    case Primitive::kPrimFloat:
+      value_of = WellKnownClasses::java_lang_Float_valueOf;
+      break;
+    case Primitive::kPrimInt:
+      value_of = WellKnownClasses::java_lang_Integer_valueOf;
+      break;
+    case Primitive::kPrimLong:
+      value_of = WellKnownClasses::java_lang_Long_valueOf;
+      break;
+    case Primitive::kPrimShort:
+      value_of = WellKnownClasses::java_lang_Short_valueOf;
+      break;
+    default:
+      return Primitive::kPrimNot;
+  }
+  return (value_of->GetDeclaringClass() == klass) ? type : Primitive::kPrimNot;
+}
+
+// Reads the value of `boxed`, an instance of a box class for `type`.
+ALWAYS_INLINE
+JValue GetBoxedValue(ObjPtr<mirror::Object> boxed, Primitive::Type type)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ArtField* primitive_field = &boxed->GetClass()->GetIFieldsPtr()->At(0);
+  JValue value;
+  switch (type) {
+    case Primitive::kPrimBoolean:
+      value.SetZ(primitive_field->GetBoolean(boxed));
+      break;
+    case Primitive::kPrimByte:
+      value.SetB(primitive_field->GetByte(boxed));
+      break;
+    case Primitive::kPrimChar:
+      value.SetC(primitive_field->GetChar(boxed));
+      break;
+    case Primitive::kPrimDouble:
+      value.SetD(primitive_field->GetDouble(boxed));
+      break;
+    case Primitive::kPrimFloat:
+      value.SetF(primitive_field->GetFloat(boxed));
+      break;
+    case Primitive::kPrimInt:
+      value.SetI(primitive_field->GetInt(boxed));
+      break;
+    case Primitive::kPrimLong:
+      value.SetJ(primitive_field->GetLong(boxed));
+      break;
+    case Primitive::kPrimShort:
+      value.SetS(primitive_field->GetShort(boxed));
+      break;
+    default:
+      LOG(FATAL) << "Unexpected boxed type: " << type;
+      UNREACHABLE();
+  }
+  return value;
+}
+
 class ArgArray {
  public:
   ArgArray(const char* shorty, uint32_t shorty_len)
@@ -214,14 +296,6 @@ class ArgArray {
     }
   }
 
-  static void ThrowIllegalPrimitiveArgumentException(const char* expected,
-                                                     const char* found_descriptor)
-      REQUIRES_SHARED(Locks::mutator_lock_) {
-    ThrowIllegalArgumentException(
-        StringPrintf("Invalid primitive conversion from %s to %s", expected,
-                     PrettyDescriptor(found_descriptor).c_str()).c_str());
-  }
-
   bool BuildArgArrayFromObjectArray(ObjPtr<mirror::Object> receiver,
                                     ObjPtr<mirror::ObjectArray<mirror::Object>> raw_args,
                                     ArtMethod* m,
@@ -259,89 +333,43 @@ class ArgArray {
         }
       }
 
-#define DO_FIRST_ARG(match_descriptor, get_fn, append) { \
-          if (LIKELY(arg != nullptr && \
-              arg->GetClass()->DescriptorEquals(match_descriptor))) { \
-            ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
-            append(primitive_field-> get_fn(arg.Get()));
-
-#define DO_ARG(match_descriptor, get_fn, append) \
-          } else if (LIKELY(arg != nullptr && \
-                            arg->GetClass<>()->DescriptorEquals(match_descriptor))) { \
-            ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
-            append(primitive_field-> get_fn(arg.Get()));
-
-#define DO_FAIL(expected) \
-          } else { \
-            if (arg->GetClass<>()->IsPrimitive()) { \
-              std::string temp; \
-              ThrowIllegalPrimitiveArgumentException(expected, \
-                                                     arg->GetClass<>()->GetDescriptor(&temp)); \
-            } else { \
-              ThrowIllegalArgumentException(\
-                  StringPrintf("method %s argument %zd has type %s, got %s", \
-                      ArtMethod::PrettyMethod(m, false).c_str(), \
-                      args_offset + 1, \
-                      expected, \
-                      mirror::Object::PrettyTypeOf(arg.Get()).c_str()).c_str()); \
-            } \
-            return false; \
-          } }
+      if (shorty_[i] == 'L') {
+        Append(arg.Get());
+        continue;
+      }
 
-      switch (shorty_[i]) {
-        case 'L':
-          Append(arg.Get());
-          break;
-        case 'Z':
-          DO_FIRST_ARG("Ljava/lang/Boolean;", GetBoolean, Append)
-          DO_FAIL("boolean")
-          break;
-        case 'B':
-          DO_FIRST_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("byte")
-          break;
-        case 'C':
-          DO_FIRST_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_FAIL("char")
-          break;
-        case 'S':
-          DO_FIRST_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("short")
+      // Unbox the argument and widen it to the parameter type.
+      DCHECK(arg != nullptr);
+      Primitive::Type dst_type = Primitive::GetType(shorty_[i]);
+      Primitive::Type src_type = GetBoxedPrimitiveType(arg->GetClass());
+      JValue value;
+      if (UNLIKELY(src_type == Primitive::kPrimNot ||
+                   !ConvertPrimitiveValueNoThrow(
+                       src_type, dst_type, GetBoxedValue(arg.Get(), src_type), &value))) {
+        ThrowIllegalArgumentException(
+            StringPrintf("method %s argument %zd has type %s, got %s",
+                         ArtMethod::PrettyMethod(m, false).c_str(),
+                         args_offset + 1,
+                         Primitive::PrettyDescriptor(dst_type),
+                         mirror::Object::PrettyTypeOf(arg.Get()).c_str()).c_str());
+        return false;
+      }
+      switch (dst_type) {
+        case Primitive::kPrimBoolean:
+        case Primitive::kPrimByte:
+        case Primitive::kPrimChar:
+        case Primitive::kPrimShort:
+        case Primitive::kPrimInt:
+          Append(value.GetI());
           break;
-        case 'I':
-          DO_FIRST_ARG("Ljava/lang/Integer;", GetInt, Append)
-          DO_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("int")
+        case Primitive::kPrimLong:
+          AppendWide(value.GetJ());
           break;
-        case 'J':
-          DO_FIRST_ARG("Ljava/lang/Long;", GetLong, AppendWide)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendWide)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendWide)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendWide)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendWide)
-          DO_FAIL("long")
+        case Primitive::kPrimFloat:
+          AppendFloat(value.GetF());
           break;
-        case 'F':
-          DO_FIRST_ARG("Ljava/lang/Float;", GetFloat, AppendFloat)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendFloat)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendFloat)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendFloat)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendFloat)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendFloat)
-          DO_FAIL("float")
-          break;
-        case 'D':
-          DO_FIRST_ARG("Ljava/lang/Double;", GetDouble, AppendDouble)
-          DO_ARG("Ljava/lang/Float;", GetFloat, AppendDouble)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendDouble)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendDouble)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendDouble)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendDouble)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendDouble)
-          DO_FAIL("double")
+        case Primitive::kPrimDouble:
+          AppendDouble(value.GetD());
           break;
 #ifndef NDEBUG
         default:
@@ -349,9 +377,6 @@ class ArgArray {
           UNREACHABLE();
 #endif
       }
-#undef DO_FIRST_ARG
-#undef DO_ARG
-#undef DO_FAIL
     }
     return true;
   }
@@ -693,6 +718,44 @@ JValue InvokeVirtualOrInterfaceWithVarArgs(const ScopedObjectAccessAlreadyRunnab
   return InvokeVirtualOrInterfaceWithVarArgs(soa, obj, jni::DecodeArtMethod(mid), args);
 }
 
+// Like VerifyAccess(), for invoking `m`. Checks that do not depend on the receiver are
+// cached per thread, keyed by the calling method.
+static bool VerifyInvokeAccess(Thread* self,
+                               ObjPtr<mirror::Object> receiver,
+                               ObjPtr<mirror::Class> declaring_class,
+                               ArtMethod* m,
+                               ObjPtr<mirror::Class>* calling_class,
+                               size_t num_frames) REQUIRES_SHARED(Locks::mutator_lock_) {
+  uint32_t access_flags = m->GetAccessFlags();
+  if ((access_flags & kAccPublic) != 0) {
+    return true;
+  }
+  NthCallerVisitor visitor(self, num_frames);
+  visitor.WalkStack();
+  ArtMethod* caller = visitor.caller;
+  if (UNLIKELY(caller == nullptr)) {
+    // The caller is an attached native thread.
+    return false;
+  }
+  *calling_class = caller->GetDeclaringClass();
+  // The result of the check for a protected method depends on the receiver, and the
+  // declaring class of a method overridden by `m` is not a property of `m`.
+  bool cacheable =
+      (access_flags & kAccProtected) == 0 && m->GetDeclaringClass() == declaring_class;
+  ReflectiveAccessCache* cache = self->GetReflectiveAccessCache();
+  if (cacheable && cache->Contains(caller, m)) {
+    DCHECK(VerifyAccess(receiver, declaring_class, access_flags, *calling_class));
+    return true;
+  }
+  if (!VerifyAccess(receiver, declaring_class, access_flags, *calling_class)) {
+    return false;
+  }
+  if (cacheable) {
+    cache->Add(caller, m);
+  }
+  return true;
+}
+
 template <PointerSize kPointerSize>
 jobject InvokeMethod(const ScopedObjectAccessAlreadyRunnable& soa, jobject javaMethod,
                      jobject javaReceiver, jobject javaArgs, size_t num_frames) {
@@ -750,12 +813,12 @@ jobject InvokeMethod(const ScopedObjectAccessAlreadyRunnable& soa, jobject javaM
 
   // If method is not set to be accessible, verify it can be accessed by the caller.
   ObjPtr<mirror::Class> calling_class;
-  if (!accessible && !VerifyAccess(soa.Self(),
-                                   receiver,
-                                   declaring_class,
-                                   m->GetAccessFlags(),
-                                   &calling_class,
-                                   num_frames)) {
+  if (!accessible && !VerifyInvokeAccess(soa.Self(),
+                                         receiver,
+                                         declaring_class,
+                                         m,
+                                         &calling_class,
+                                         num_frames)) {
     ThrowIllegalAccessException(
         StringPrintf("Class %s cannot access %s method %s of class %s",
             calling_class == nullptr ? "null" : calling_class->PrettyClass().c_str(),
@@ -948,35 +1011,8 @@ static bool UnboxPrimitive(ObjPtr<mirror::Object> o,
     return false;
   }
 
-  JValue boxed_value;
-  ObjPtr<mirror::Class> klass = o->GetClass();
-  Primitive::Type primitive_type;
-  ArtField* primitive_field = &klass->GetIFieldsPtr()->At(0);
-  if (klass->DescriptorEquals("Ljava/lang/Boolean;")) {
-    primitive_type = Primitive::kPrimBoolean;
-    boxed_value.SetZ(primitive_field->GetBoolean(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Byte;")) {
-    primitive_type = Primitive::kPrimByte;
-    boxed_value.SetB(primitive_field->GetByte(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Character;")) {
-    primitive_type = Primitive::kPrimChar;
-    boxed_value.SetC(primitive_field->GetChar(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Float;")) {
-    primitive_type = Primitive::kPrimFloat;
-    boxed_value.SetF(primitive_field->GetFloat(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Double;")) {
-    primitive_type = Primitive::kPrimDouble;
-    boxed_value.SetD(primitive_field->GetDouble(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Integer;")) {
-    primitive_type = Primitive::kPrimInt;
-    boxed_value.SetI(primitive_field->GetInt(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Long;")) {
-    primitive_type = Primitive::kPrimLong;
-    boxed_value.SetJ(primitive_field->GetLong(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Short;")) {
-    primitive_type = Primitive::kPrimShort;
-    boxed_value.SetS(primitive_field->GetShort(o));
-  } else {
+  Primitive::Type primitive_type = GetBoxedPrimitiveType(o->GetClass());
+  if (UNLIKELY(primitive_type == Primitive::kPrimNot)) {
     std::string temp;
     ThrowIllegalArgumentException(
         StringPrintf("%s has type %s, got %s", UnboxingFailureKind(f).c_str(),
@@ -984,6 +1020,7 @@ static bool UnboxPrimitive(ObjPtr<mirror::Object> o,
             PrettyDescriptor(o->GetClass()->GetDescriptor(&temp)).c_str()).c_str());
     return false;
   }
+  JValue boxed_value = GetBoxedValue(o, primitive_type);
 
   return ConvertPrimitiveValue(unbox_for_result,
                                primitive_type,
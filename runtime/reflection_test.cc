@@ -21,12 +21,16 @@
 
 #include "art_method-inl.h"
 #include "base/enums.h"
+#include "class_root-inl.h"
 #include "common_runtime_test.h"
 #include "dex/descriptors_names.h"
 #include "jni/java_vm_ext.h"
 #include "jni/jni_internal.h"
 #include "mirror/class-alloc-inl.h"
+#include "mirror/method.h"
+#include "mirror/object_array-alloc-inl.h"
 #include "nativehelper/scoped_local_ref.h"
+#include "reflective_access_cache.h"
 #include "scoped_thread_state_change-inl.h"
 
 namespace art {
@@ -606,4 +610,72 @@ TEST_F(ReflectionTest, NonStaticSumDoubleDoubleDoubleDoubleDoubleMethod) {
   InvokeSumDoubleDoubleDoubleDoubleDoubleMethod(false);
 }
 
+TEST_F(ReflectionTest, InvokeMethodUnboxesAndWidensArguments) {
+  ScopedObjectAccess soa(env_);
+  Thread* self = soa.Self();
+  ArtMethod* method;
+  ObjPtr<mirror::Object> receiver;
+  ReflectionTestMakeInterpreted(&method, &receiver, /*is_static=*/ true, "sum", "(DD)D");
+
+  StackHandleScope<2> hs(self);
+  Handle<mirror::Method> method_object =
+      hs.NewHandle(mirror::Method::CreateFromArtMethod<kRuntimePointerSize>(self, method));
+  ASSERT_TRUE(method_object != nullptr);
+  // The method is package-private, bypass the access check.
+  method_object->SetFieldBoolean<false>(mirror::AccessibleObject::FlagOffset(), 1u);
+  Handle<mirror::ObjectArray<mirror::Object>> args =
+      hs.NewHandle(mirror::ObjectArray<mirror::Object>::Alloc(
+          self, GetClassRoot<mirror::ObjectArray<mirror::Object>>(), 2));
+  ASSERT_TRUE(args != nullptr);
+  ScopedLocalRef<jobject> method_ref(soa.Env(),
+                                     soa.AddLocalReference<jobject>(method_object.Get()));
+  ScopedLocalRef<jobject> args_ref(soa.Env(), soa.AddLocalReference<jobject>(args.Get()));
+
+  // Both an int and a float widen to double.
+  JValue value;
+  value.SetI(-3);
+  args->Set(0, BoxPrimitive(Primitive::kPrimInt, value));
+  value.SetF(0.5f);
+  args->Set(1, BoxPrimitive(Primitive::kPrimFloat, value));
+  jobject result = InvokeMethod<kRuntimePointerSize>(
+      soa, method_ref.get(), /*receiver=*/ nullptr, args_ref.get());
+  ASSERT_FALSE(self->IsExceptionPending());
+  ASSERT_TRUE(result != nullptr);
+  JValue unboxed;
+  ASSERT_TRUE(UnboxPrimitiveForResult(
+      soa.Decode<mirror::Object>(result), class_linker_->FindPrimitiveClass('D'), &unboxed));
+  EXPECT_DOUBLE_EQ(-2.5, unboxed.GetD());
+
+  // A boxed object that is not a number does not unbox to double.
+  value.SetZ(1u);
+  args->Set(1, BoxPrimitive(Primitive::kPrimBoolean, value));
+  result = InvokeMethod<kRuntimePointerSize>(
+      soa, method_ref.get(), /*receiver=*/ nullptr, args_ref.get());
+  EXPECT_TRUE(result == nullptr);
+  ASSERT_TRUE(self->IsExceptionPending());
+  EXPECT_TRUE(self->GetException()->GetClass()->DescriptorEquals(
+      "Ljava/lang/IllegalArgumentException;"));
+  self->ClearException();
+}
+
+TEST_F(ReflectionTest, ReflectiveAccessCache) {
+  ScopedObjectAccess soa(Thread::Current());
+  ObjPtr<mirror::Class> string_class = GetClassRoot<mirror::String>(class_linker_);
+  ArtMethod* caller = string_class->FindClassMethod("length", "()I", kRuntimePointerSize);
+  ArtMethod* callee = string_class->FindClassMethod("isEmpty", "()Z", kRuntimePointerSize);
+  ASSERT_TRUE(caller != nullptr);
+  ASSERT_TRUE(callee != nullptr);
+
+  ReflectiveAccessCache cache;
+  EXPECT_FALSE(cache.Contains(caller, callee));
+  cache.Add(caller, callee);
+  EXPECT_TRUE(cache.Contains(caller, callee));
+  // Access is not symmetric.
+  EXPECT_FALSE(cache.Contains(callee, caller));
+
+  // Deleting a class loader invalidates the caches of all threads.
+  ReflectiveAccessCache::InvalidateAll();
+  EXPECT_FALSE(cache.Contains(caller, callee));
+}
+
 }  // namespace art
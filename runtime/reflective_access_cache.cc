@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "reflective_access_cache.h"
+
+namespace art {
+
+std::atomic<uint32_t> ReflectiveAccessCache::generation_(0u);
+
+void ReflectiveAccessCache::ClearIfStale() {
+  uint32_t generation = generation_.load(std::memory_order_acquire);
+  if (LIKELY(generation == generation_seen_)) {
+    return;
+  }
+  for (Entry& entry : entries_) {
+    entry.caller = nullptr;
+    entry.callee = nullptr;
+  }
+  generation_seen_ = generation;
+}
+
+bool ReflectiveAccessCache::Contains(ArtMethod* caller, ArtMethod* callee) {
+  ClearIfStale();
+  const Entry& entry = entries_[IndexOf(caller, callee)];
+  return entry.caller == caller && entry.callee == callee;
+}
+
+void ReflectiveAccessCache::Add(ArtMethod* caller, ArtMethod* callee) {
+  ClearIfStale();
+  Entry& entry = entries_[IndexOf(caller, callee)];
+  entry.caller = caller;
+  entry.callee = callee;
+}
+
+}  // namespace art
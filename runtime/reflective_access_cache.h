@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_REFLECTIVE_ACCESS_CACHE_H_
+#define ART_RUNTIME_REFLECTIVE_ACCESS_CACHE_H_
+
+#include <array>
+#include <atomic>
+
+#include "base/bit_utils.h"
+#include "base/macros.h"
+
+namespace art {
+
+class ArtMethod;
+
+// Small thread-local cache of the methods that a calling method was allowed to invoke
+// through reflection. Method.invoke and Constructor.newInstance on a non-public, non
+// accessible method otherwise redo the access check on every call, comparing the
+// packages of the caller and callee by descriptor. Finding the caller still needs a
+// stack walk.
+//
+// Only checks whose result does not depend on the receiver are cached, that is not
+// for protected methods. Only successful checks are cached.
+//
+// Entries are keyed by ArtMethod, so they must not outlive the methods. We ensure this
+// with a global generation counter which is incremented whenever a class loader is
+// deleted; each cache clears itself the next time it is used after the generation changed.
+class ReflectiveAccessCache {
+ public:
+  static constexpr size_t kSize = 16;
+
+  ReflectiveAccessCache() {}
+
+  // Whether `caller` has been allowed to invoke `callee`.
+  bool Contains(ArtMethod* caller, ArtMethod* callee);
+
+  // Record that `caller` is allowed to invoke `callee`.
+  void Add(ArtMethod* caller, ArtMethod* callee);
+
+  // Invalidate the caches of all threads. Must be called before the memory of
+  // methods can be reused.
+  static void InvalidateAll() {
+    generation_.fetch_add(1u, std::memory_order_release);
+  }
+
+ private:
+  struct Entry {
+    ArtMethod* caller = nullptr;
+    ArtMethod* callee = nullptr;
+  };
+
+  static ALWAYS_INLINE size_t IndexOf(ArtMethod* caller, ArtMethod* callee) {
+    static_assert(IsPowerOfTwo(kSize), "Size must be power of two");
+    uintptr_t hash =
+        (reinterpret_cast<uintptr_t>(caller) ^ reinterpret_cast<uintptr_t>(callee)) >> 3;
+    return hash & (kSize - 1);
+  }
+
+  // Clear the cache if methods were freed since it was last used.
+  void ClearIfStale();
+
+  static std::atomic<uint32_t> generation_;
+
+  uint32_t generation_seen_ = 0u;
+  std::array<Entry, kSize> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReflectiveAccessCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_REFLECTIVE_ACCESS_CACHE_H_
@@ -214,6 +214,7 @@ struct TraceConfig {
   std::string trace_file;
   size_t trace_file_size;
   TraceClockSource clock_source;
+  bool compact_format;
 };
 
 namespace {
@@ -316,6 +317,10 @@ Runtime::Runtime()
       verifier_missing_kthrow_fatal_(false),
       perfetto_hprof_enabled_(false),
       perfetto_javaheapprof_enabled_(false),
+      startup_prelink_(false),
+      throwable_stack_trace_depth_(0u),
+      throwable_stack_trace_reuse_(false),
+      parallel_checkpoint_threads_(0u),
       out_of_memory_error_hook_(nullptr) {
   static_assert(Runtime::kCalleeSaveSize ==
                     static_cast<uint32_t>(CalleeSaveType::kLastCalleeSaveType), "Unexpected size");
@@ -416,6 +421,7 @@ Runtime::~Runtime() {
   if (oat_file_manager_ != nullptr) {
     oat_file_manager_->WaitForWorkersToBeCreated();
   }
+  thread_list_->WaitForCheckpointWorkersToBeCreated();
   // Disable GC before deleting the thread-pool and shutting down runtime as it
   // restricts attaching new threads.
   heap_->DisableGCForShutdown();
@@ -457,6 +463,7 @@ Runtime::~Runtime() {
   if (oat_file_manager_ != nullptr) {
     oat_file_manager_->DeleteThreadPool();
   }
+  thread_list_->DeleteCheckpointThreadPool();
   DeleteThreadPool();
   CHECK(thread_pool_ == nullptr);
 
@@ -794,6 +801,7 @@ void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor) {
   GetMonitorList()->SweepMonitorList(visitor);
   GetJavaVM()->SweepJniWeakGlobals(visitor);
   GetHeap()->SweepAllocationRecords(visitor);
+  GetThreadList()->SweepThrowableStackTraces(visitor);
   // Sweep JIT tables only if the GC is moving as in other cases the entries are
   // not updated.
   if (GetJit() != nullptr && GetHeap()->IsMovingGc()) {
@@ -1060,6 +1068,9 @@ bool Runtime::Start() {
     } else {
       LOG(ERROR) << "Unexpected clock source";
     }
+    if (trace_config_->compact_format) {
+      flags |= Trace::TraceFlag::kTraceCompactFormat;
+    }
     Trace::Start(trace_config_->trace_file.c_str(),
                  static_cast<int>(trace_config_->trace_file_size),
                  flags,
@@ -1176,6 +1187,9 @@ void Runtime::InitNonZygoteOrPostFork(
     thread_pool_.reset(new ThreadPool("Runtime", num_workers, /*create_peers=*/false, kStackSize));
     thread_pool_->StartWorkers(Thread::Current());
   }
+  if (parallel_checkpoint_threads_ != 0u) {
+    thread_list_->CreateCheckpointThreadPool(parallel_checkpoint_threads_);
+  }
 
   // Reset the gc performance data and metrics at zygote fork so that the events from
   // before fork aren't attributed to an app.
@@ -1429,6 +1443,10 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   force_java_zygote_fork_loop_ = runtime_options.GetOrDefault(Opt::ForceJavaZygoteForkLoop);
   perfetto_hprof_enabled_ = runtime_options.GetOrDefault(Opt::PerfettoHprof);
   perfetto_javaheapprof_enabled_ = runtime_options.GetOrDefault(Opt::PerfettoJavaHeapStackProf);
+  startup_prelink_ = runtime_options.GetOrDefault(Opt::StartupPrelink);
+  throwable_stack_trace_depth_ = runtime_options.GetOrDefault(Opt::ThrowableStackTraceDepth);
+  throwable_stack_trace_reuse_ = runtime_options.GetOrDefault(Opt::ThrowableStackTraceReuse);
+  parallel_checkpoint_threads_ = runtime_options.GetOrDefault(Opt::ParallelCheckpointThreads);
 
   // Try to reserve a dedicated fault page. This is allocated for clobbered registers and sentinels.
   // If we cannot reserve it, log a warning.
@@ -1534,6 +1552,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   monitor_list_ = new MonitorList;
   monitor_pool_ = MonitorPool::Create();
+  monitor_contention_profile_.reset(new MonitorContentionProfile());
   thread_list_ = new ThreadList(runtime_options.GetOrDefault(Opt::ThreadSuspendTimeout));
   intern_table_ = new InternTable;
 
@@ -1721,7 +1740,10 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
     jit_arena_pool_.reset(new MallocArenaPool());
   } else {
     arena_pool_.reset(new MemMapArenaPool(/* low_4gb= */ false));
-    jit_arena_pool_.reset(new MemMapArenaPool(/* low_4gb= */ false, "CompilerMetadata"));
+    jit_arena_pool_.reset(new MemMapArenaPool(/* low_4gb= */ false,
+                                              "CompilerMetadata",
+                                              jit_options_->GetArenaRetainedCapacity(),
+                                              jit_options_->UseArenaHugePages()));
   }
 
   // For 64 bit compilers, it needs to be in low 4GB in the case where we are cross compiling for a
@@ -1919,6 +1941,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
         Trace::TraceOutputMode::kStreaming :
         Trace::TraceOutputMode::kFile;
     trace_config_->clock_source = runtime_options.GetOrDefault(Opt::MethodTraceClock);
+    trace_config_->compact_format = runtime_options.Exists(Opt::MethodTraceCompact);
   }
 
   // TODO: Remove this in a follow up CL. This isn't used anywhere.
@@ -2332,6 +2355,7 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
   DumpDeoptimizations(os);
   TrackedAllocators::Dump(os);
   GetMetrics()->DumpForSigQuit(os);
+  monitor_contention_profile_->Dump(os);
   os << "\n";
 
   BaseMutex::DumpAll(os);
@@ -2742,6 +2766,11 @@ void Runtime::RegisterAppInfo(const std::string& package_name,
     metrics_reporter_->NotifyAppInfoUpdated(&app_info_);
   }
 
+  // The classes in the reference profile are the ones the app loaded during startup in
+  // earlier runs. Also use the current profile, for apps that were not compiled with one yet.
+  oat_file_manager_->RunStartupPrelinking(code_paths,
+                                          {ref_profile_filename, profile_output_filename});
+
   if (jit_.get() == nullptr) {
     // We are not JITing. Nothing to do.
     return;
@@ -102,6 +102,7 @@ class InternTable;
 class IsMarkedVisitor;
 class JavaVMExt;
 class LinearAlloc;
+class MonitorContentionProfile;
 class MonitorList;
 class MonitorPool;
 class NullPointerHandler;
@@ -414,6 +415,10 @@ class Runtime {
     return monitor_pool_;
   }
 
+  MonitorContentionProfile* GetMonitorContentionProfile() const {
+    return monitor_contention_profile_.get();
+  }
+
   // Is the given object the special object used to mark a cleared JNI weak global?
   bool IsClearedJniWeakGlobal(ObjPtr<mirror::Object> obj) REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -1093,6 +1098,18 @@ class Runtime {
     return verifier_missing_kthrow_fatal_;
   }
 
+  bool IsStartupPrelinkEnabled() const {
+    return startup_prelink_;
+  }
+
+  uint32_t GetThrowableStackTraceDepth() const {
+    return throwable_stack_trace_depth_;
+  }
+
+  bool IsThrowableStackTraceReuseEnabled() const {
+    return throwable_stack_trace_reuse_;
+  }
+
   bool IsJavaZygoteForkLoopRequired() const {
     return force_java_zygote_fork_loop_;
   }
@@ -1310,6 +1327,7 @@ class Runtime {
   size_t max_spins_before_thin_lock_inflation_;
   MonitorList* monitor_list_;
   MonitorPool* monitor_pool_;
+  std::unique_ptr<MonitorContentionProfile> monitor_contention_profile_;
 
   ThreadList* thread_list_;
 
@@ -1577,6 +1595,19 @@ class Runtime {
   bool perfetto_hprof_enabled_;
   bool perfetto_javaheapprof_enabled_;
 
+  // Whether to link and verify the startup classes of the app in the background.
+  bool startup_prelink_;
+
+  // Maximum number of frames in the stack trace of a Throwable, 0 for no limit.
+  uint32_t throwable_stack_trace_depth_;
+
+  // Whether Throwables with identical stacks share their stack trace.
+  bool throwable_stack_trace_reuse_;
+
+  // Number of workers running the checkpoints of suspended threads, 0 to run them on the thread
+  // requesting the checkpoint.
+  uint32_t parallel_checkpoint_threads_;
+
   // Called on out of memory error
   void (*out_of_memory_error_hook_)();
 
@@ -1005,28 +1005,48 @@ class RuntimeImageHelper {
       return;
     }
 
-    ProfileCompilationInfo profile_info(/* for_boot_image= */ false);
-
-    if (!profile_info.Load(profile->Fd())) {
-      LOG(DEBUG) << "Could not load profile file";
+    // Query the profile from a memory map if it has the mappable section, so that we do not
+    // decompress and parse the whole profile just for its classes.
+    std::unique_ptr<MappedProfileCompilationInfo> mapped_profile_info =
+        MappedProfileCompilationInfo::Create(profile->Fd(), &error);
+    if (mapped_profile_info != nullptr && mapped_profile_info->IsForBootImage()) {
+      LOG(DEBUG) << "Unexpected boot image profile " << profile_file;
       return;
     }
+    ProfileCompilationInfo profile_info(/* for_boot_image= */ false);
+    if (mapped_profile_info == nullptr) {
+      LOG(DEBUG) << "Could not map profile " << profile_file << ": " << error;
+      if (!profile_info.Load(profile->Fd())) {
+        LOG(DEBUG) << "Could not load profile file";
+        return;
+      }
+    }
 
     StackHandleScope<1> hs(self);
     Handle<mirror::ClassLoader> class_loader =
         hs.NewHandle<mirror::ClassLoader>(dex_caches[0]->GetClassLoader());
     ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
     ScopedTrace loading_classes("Loading classes from profile");
+    std::vector<dex::TypeIndex> class_types;
     for (auto dex_cache : dex_caches) {
       const DexFile* dex_file = dex_cache->GetDexFile();
-      const ArenaSet<dex::TypeIndex>* class_types = profile_info.GetClasses(*dex_file);
-      if (class_types == nullptr) {
-        // This means the profile file did not reference the dex file, which is the case
-        // if there's no classes and methods of that dex file in the profile.
-        continue;
+      class_types.clear();
+      if (mapped_profile_info != nullptr) {
+        if (!mapped_profile_info->GetClasses(*dex_file, &class_types)) {
+          // The profile file did not reference the dex file.
+          continue;
+        }
+      } else {
+        const ArenaSet<dex::TypeIndex>* profile_class_types = profile_info.GetClasses(*dex_file);
+        if (profile_class_types == nullptr) {
+          // This means the profile file did not reference the dex file, which is the case
+          // if there's no classes and methods of that dex file in the profile.
+          continue;
+        }
+        class_types.assign(profile_class_types->begin(), profile_class_types->end());
       }
 
-      for (dex::TypeIndex idx : *class_types) {
+      for (dex::TypeIndex idx : class_types) {
         // The index is greater or equal to NumTypeIds if the type is an extra
         // descriptor, not referenced by the dex file.
         if (idx.index_ < dex_file->NumTypeIds()) {
@@ -24,6 +24,7 @@
 #include "base/callee_save_type.h"
 #include "base/enums.h"
 #include "base/hex_dump.h"
+#include "code_info_cache.h"
 #include "dex/dex_file_types.h"
 #include "entrypoints/entrypoint_utils-inl.h"
 #include "entrypoints/quick/callee_save_frame.h"
@@ -81,11 +82,24 @@ StackVisitor::StackVisitor(Thread* thread,
   }
 }
 
+static void DecodeCodeInfo(const OatQuickMethodHeader* header,
+                           CodeInfoCache::DecodeKind kind,
+                           /* out */ CodeInfo* code_info) {
+  Thread* self = Thread::Current();
+  if (LIKELY(self != nullptr)) {
+    self->GetCodeInfoCache()->GetCodeInfo(header, kind, code_info);
+  } else {
+    // Stacks can be dumped from threads which are not attached to the runtime.
+    *code_info = CodeInfoCache::Decode(header, kind);
+  }
+}
+
 CodeInfo* StackVisitor::GetCurrentInlineInfo() const {
   DCHECK(!(*cur_quick_frame_)->IsNative());
   const OatQuickMethodHeader* header = GetCurrentOatQuickMethodHeader();
   if (cur_inline_info_.first != header) {
-    cur_inline_info_ = std::make_pair(header, CodeInfo::DecodeInlineInfoOnly(header));
+    DecodeCodeInfo(header, CodeInfoCache::DecodeKind::kInlineInfoOnly, &cur_inline_info_.second);
+    cur_inline_info_.first = header;
   }
   return &cur_inline_info_.second;
 }
@@ -95,8 +109,13 @@ StackMap* StackVisitor::GetCurrentStackMap() const {
   const OatQuickMethodHeader* header = GetCurrentOatQuickMethodHeader();
   if (cur_stack_map_.first != cur_quick_frame_pc_) {
     uint32_t pc = header->NativeQuickPcOffset(cur_quick_frame_pc_);
-    cur_stack_map_ = std::make_pair(cur_quick_frame_pc_,
-                                    GetCurrentInlineInfo()->GetStackMapForNativePcOffset(pc));
+    const CodeInfo& code_info = *GetCurrentInlineInfo();
+    Thread* self = Thread::Current();
+    cur_stack_map_ = std::make_pair(
+        cur_quick_frame_pc_,
+        LIKELY(self != nullptr)
+            ? self->GetCodeInfoCache()->GetStackMapForNativePcOffset(header, code_info, pc)
+            : code_info.GetStackMapForNativePcOffset(pc));
   }
   return &cur_stack_map_.second;
 }
@@ -299,12 +318,11 @@ bool StackVisitor::GetVRegFromOptimizedCode(ArtMethod* m,
   DCHECK_EQ(m, GetMethod());
   // Can't be null or how would we compile its instructions?
   DCHECK(m->GetCodeItem() != nullptr) << m->PrettyMethod();
-  const OatQuickMethodHeader* method_header = GetCurrentOatQuickMethodHeader();
-  CodeInfo code_info(method_header);
-
-  uint32_t native_pc_offset = method_header->NativeQuickPcOffset(cur_quick_frame_pc_);
-  StackMap stack_map = code_info.GetStackMapForNativePcOffset(native_pc_offset);
-  DCHECK(stack_map.IsValid());
+  // Unlike the current inline info, this needs the dex register maps.
+  CodeInfo code_info;
+  DecodeCodeInfo(GetCurrentOatQuickMethodHeader(), CodeInfoCache::DecodeKind::kFull, &code_info);
+  DCHECK(GetCurrentStackMap()->IsValid());
+  StackMap stack_map = code_info.GetStackMapAt(GetCurrentStackMap()->Row());
 
   DexRegisterMap dex_register_map = (IsInInlinedFrame() && !need_full_register_list)
     ? code_info.GetInlineDexRegisterMapOf(stack_map, current_inline_frames_.back())
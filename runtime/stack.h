@@ -396,8 +396,9 @@ class StackVisitor {
   // We keep poping frames from the end as we visit the frames.
   BitTableRange<InlineInfo> current_inline_frames_;
 
-  // Cache the most recently decoded inline info data.
-  // The 'current_inline_frames_' refers to this data, so we need to keep it alive anyway.
+  // Cache the most recently decoded code info, copied from the CodeInfoCache of the
+  // walking thread. The 'current_inline_frames_' refers to this copy, so it stays valid
+  // even if a nested stack walk evicts the entry from the thread's cache.
   // Marked mutable since the cache fields are updated from const getters.
   mutable std::pair<const OatQuickMethodHeader*, CodeInfo> cur_inline_info_;
   mutable std::pair<uintptr_t, StackMap> cur_stack_map_;
@@ -26,6 +26,7 @@
 #include "linear_alloc-inl.h"
 #include "mirror/dex_cache.h"
 #include "mirror/object-inl.h"
+#include "oat_file_manager.h"
 #include "obj_ptr.h"
 #include "runtime_image.h"
 #include "scoped_thread_state_change-inl.h"
@@ -71,6 +72,7 @@ void StartupCompletedTask::Run(Thread* self) {
   // Delete the thread pool used for app image loading since startup is assumed to be completed.
   ScopedTrace trace2("Delete thread pool");
   Runtime::Current()->DeleteThreadPool();
+  Runtime::Current()->GetOatFileManager().DeleteStartupPrelinkThreadPool();
 }
 
 void StartupCompletedTask::DeleteStartupDexCaches(Thread* self, bool called_by_gc) {
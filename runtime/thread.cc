@@ -28,6 +28,7 @@
 #include <bitset>
 #include <cerrno>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <sstream>
 
@@ -55,6 +56,7 @@
 #include "base/utils.h"
 #include "class_linker-inl.h"
 #include "class_root-inl.h"
+#include "code_info_cache.h"
 #include "debugger.h"
 #include "dex/descriptors_names.h"
 #include "dex/dex_file-inl.h"
@@ -75,6 +77,7 @@
 #include "interpreter/interpreter.h"
 #include "interpreter/shadow_frame-inl.h"
 #include "java_frame_root_info.h"
+#include "jni/java_vm_ext-inl.h"
 #include "jni/java_vm_ext.h"
 #include "jni/jni_internal.h"
 #include "mirror/class-alloc-inl.h"
@@ -98,6 +101,7 @@
 #include "quick_exception_handler.h"
 #include "read_barrier-inl.h"
 #include "reflection.h"
+#include "reflective_access_cache.h"
 #include "reflective_handle_scope-inl.h"
 #include "runtime-inl.h"
 #include "runtime.h"
@@ -1573,6 +1577,12 @@ bool Thread::PassActiveSuspendBarriers(Thread* self) {
       do {
         int32_t cur_val = pending_threads->load(std::memory_order_relaxed);
         CHECK_GT(cur_val, 0) << "Unexpected value for PassActiveSuspendBarriers(): " << cur_val;
+        if (cur_val == 1) {
+          // We are the last thread the suspender waits for, record it for the time to
+          // safepoint statistics.
+          Runtime::Current()->GetThreadList()->last_suspend_barrier_tid_.store(
+              GetTid(), std::memory_order_relaxed);
+        }
         // Reduce value by 1.
         done = pending_threads->CompareAndSetWeakRelaxed(cur_val, cur_val - 1);
 #if ART_USE_FUTEXES
@@ -2863,11 +2873,13 @@ class FetchStackTraceVisitor : public StackVisitor {
  public:
   explicit FetchStackTraceVisitor(Thread* thread,
                                   ArtMethodDexPcPair* saved_frames = nullptr,
-                                  size_t max_saved_frames = 0)
+                                  size_t max_saved_frames = 0,
+                                  uint32_t max_depth = std::numeric_limits<uint32_t>::max())
       REQUIRES_SHARED(Locks::mutator_lock_)
       : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
         saved_frames_(saved_frames),
-        max_saved_frames_(max_saved_frames) {}
+        max_saved_frames_(max_saved_frames),
+        max_depth_(max_depth) {}
 
   bool VisitFrame() override REQUIRES_SHARED(Locks::mutator_lock_) {
     // We want to skip frames up to and including the exception's constructor.
@@ -2885,6 +2897,9 @@ class FetchStackTraceVisitor : public StackVisitor {
           saved_frames_[depth_].second = m->IsProxyMethod() ? dex::kDexNoIndex : GetDexPc();
         }
         ++depth_;
+        if (depth_ == max_depth_) {
+          return false;
+        }
       }
     } else {
       ++skip_depth_;
@@ -2906,6 +2921,7 @@ class FetchStackTraceVisitor : public StackVisitor {
   bool skipping_ = true;
   ArtMethodDexPcPair* saved_frames_;
   const size_t max_saved_frames_;
+  const uint32_t max_depth_;
 
   DISALLOW_COPY_AND_ASSIGN(FetchStackTraceVisitor);
 };
@@ -2947,6 +2963,7 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
     }
     trace->Set</*kTransactionActive=*/ false, /*kCheckTransaction=*/ false>(0, methods_and_pcs);
     trace_ = trace.Get();
+    depth_ = depth;
     // If We are called from native, use non-transactional mode.
     CHECK(last_no_suspend_cause == nullptr) << last_no_suspend_cause;
     return true;
@@ -2969,7 +2986,7 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
       return true;  // Ignore runtime frames (in particular callee save).
     }
     AddFrame(m, m->IsProxyMethod() ? dex::kDexNoIndex : GetDexPc());
-    return true;
+    return count_ != depth_;  // Stop at the depth the trace was truncated to, if any.
   }
 
   void AddFrame(ArtMethod* method, uint32_t dex_pc) REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -3009,6 +3026,8 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
   uint32_t skip_depth_;
   // Current position down stack trace.
   uint32_t count_ = 0;
+  // Number of frames in the stack trace.
+  uint32_t depth_ = 0;
   // An object array where the first element is a pointer array that contains the `ArtMethod`
   // pointers on the stack and dex PCs. The rest of the elements are referencing objects
   // that shall keep the methods alive, namely the declaring class of the `ArtMethod` for
@@ -3024,20 +3043,45 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
   DISALLOW_COPY_AND_ASSIGN(BuildInternalStackTraceVisitor);
 };
 
-jobject Thread::CreateInternalStackTrace(const ScopedObjectAccessAlreadyRunnable& soa) const {
+// Creates the internal stack trace of `thread`, with at most `max_depth` frames. If
+// `last_trace` is not null, it holds a trace that is returned instead of a new one if
+// it has the same frames, and it is updated with the returned trace.
+static jobject CreateInternalStackTraceImpl(
+    const ScopedObjectAccessAlreadyRunnable& soa,
+    Thread* thread,
+    uint32_t max_depth,
+    GcRoot<mirror::ObjectArray<mirror::Object>>* last_trace)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
   // Compute depth of stack, save frames if possible to avoid needing to recompute many.
   constexpr size_t kMaxSavedFrames = 256;
   std::unique_ptr<ArtMethodDexPcPair[]> saved_frames(new ArtMethodDexPcPair[kMaxSavedFrames]);
-  FetchStackTraceVisitor count_visitor(const_cast<Thread*>(this),
-                                       &saved_frames[0],
-                                       kMaxSavedFrames);
+  FetchStackTraceVisitor count_visitor(thread, &saved_frames[0], kMaxSavedFrames, max_depth);
   count_visitor.WalkStack();
   const uint32_t depth = count_visitor.GetDepth();
   const uint32_t skip_depth = count_visitor.GetSkipDepth();
 
+  // Reuse the last trace if it has exactly the frames we saved. Internal stack traces are
+  // never modified once created, so several Throwables can share one.
+  ObjPtr<mirror::ObjectArray<mirror::Object>> reusable_trace =
+      (last_trace != nullptr) ? last_trace->Read() : nullptr;
+  if (reusable_trace != nullptr && depth < kMaxSavedFrames) {
+    ObjPtr<mirror::PointerArray> methods_and_pcs =
+        ObjPtr<mirror::PointerArray>::DownCast(reusable_trace->Get(0));
+    bool same_frames = static_cast<uint32_t>(methods_and_pcs->GetLength()) == depth * 2;
+    for (size_t i = 0; same_frames && i < depth; ++i) {
+      same_frames =
+          methods_and_pcs->GetElementPtrSize<ArtMethod*>(i, kRuntimePointerSize) ==
+              saved_frames[i].first &&
+          methods_and_pcs->GetElementPtrSize<uint32_t>(depth + i, kRuntimePointerSize) ==
+              saved_frames[i].second;
+    }
+    if (same_frames) {
+      return soa.AddLocalReference<jobject>(reusable_trace);
+    }
+  }
+
   // Build internal stack trace.
-  BuildInternalStackTraceVisitor build_trace_visitor(
-      soa.Self(), const_cast<Thread*>(this), skip_depth);
+  BuildInternalStackTraceVisitor build_trace_visitor(soa.Self(), thread, skip_depth);
   if (!build_trace_visitor.Init(depth)) {
     return nullptr;  // Allocation failed.
   }
@@ -3061,9 +3105,41 @@ jobject Thread::CreateInternalStackTrace(const ScopedObjectAccessAlreadyRunnable
       CHECK(method != nullptr);
     }
   }
+  // Allocating the trace may have suspended us while a GC disabled access to weak references.
+  if (last_trace != nullptr &&
+      depth < kMaxSavedFrames &&
+      Runtime::Current()->GetJavaVM()->MayAccessWeakGlobals(soa.Self())) {
+    *last_trace = GcRoot<mirror::ObjectArray<mirror::Object>>(trace);
+  }
   return soa.AddLocalReference<jobject>(trace);
 }
 
+jobject Thread::CreateInternalStackTrace(const ScopedObjectAccessAlreadyRunnable& soa) const {
+  return CreateInternalStackTraceImpl(soa,
+                                      const_cast<Thread*>(this),
+                                      std::numeric_limits<uint32_t>::max(),
+                                      /* last_trace= */ nullptr);
+}
+
+jobject Thread::CreateThrowableStackTrace(const ScopedObjectAccessAlreadyRunnable& soa) {
+  DCHECK(this == soa.Self());
+  Runtime* runtime = Runtime::Current();
+  uint32_t max_depth = runtime->GetThrowableStackTraceDepth();
+  // Debuggers compare the depth of the stack trace with the current depth of the stack to find
+  // where an exception was thrown, see IsExceptionThrownByCurrentMethod.
+  if (max_depth == 0u ||
+      runtime->IsJavaDebuggable() ||
+      runtime->GetInstrumentation()->HasExceptionThrownListeners()) {
+    max_depth = std::numeric_limits<uint32_t>::max();
+  }
+  // The last trace is a weak reference, which must not be read or written while the
+  // GC sweeps weak references, see SweepThrowableStackTrace().
+  bool reuse = runtime->IsThrowableStackTraceReuseEnabled() &&
+               runtime->GetJavaVM()->MayAccessWeakGlobals(this);
+  return CreateInternalStackTraceImpl(
+      soa, this, max_depth, reuse ? &last_throwable_stack_trace_ : nullptr);
+}
+
 bool Thread::IsExceptionThrownByCurrentMethod(ObjPtr<mirror::Throwable> exception) const {
   // Only count the depth since we do not pass a stack frame array as an argument.
   FetchStackTraceVisitor count_visitor(const_cast<Thread*>(this));
@@ -4195,10 +4271,14 @@ class ReferenceMapVisitor : public StackVisitor {
       StackReference<mirror::Object>* vreg_base =
           reinterpret_cast<StackReference<mirror::Object>*>(cur_quick_frame);
       uintptr_t native_pc_offset = method_header->NativeQuickPcOffset(GetCurrentQuickFramePc());
-      CodeInfo code_info = kPrecise
-          ? CodeInfo(method_header)  // We will need dex register maps.
-          : CodeInfo::DecodeGcMasksOnly(method_header);
-      StackMap map = code_info.GetStackMapForNativePcOffset(native_pc_offset);
+      CodeInfoCache* cache = Thread::Current()->GetCodeInfoCache();
+      CodeInfo code_info;
+      cache->GetCodeInfo(method_header,
+                         kPrecise ? CodeInfoCache::DecodeKind::kFull  // Needs dex register maps.
+                                  : CodeInfoCache::DecodeKind::kGcMasksOnly,
+                         &code_info);
+      StackMap map =
+          cache->GetStackMapForNativePcOffset(method_header, code_info, native_pc_offset);
       DCHECK(map.IsValid());
 
       T vreg_info(m, code_info, map, visitor_);
@@ -4379,6 +4459,17 @@ void Thread::VisitReflectiveTargets(ReflectiveValueVisitor* visitor) {
   }
 }
 
+void Thread::SweepThrowableStackTrace(IsMarkedVisitor* visitor) {
+  mirror::Object* trace = last_throwable_stack_trace_.Read<kWithoutReadBarrier>();
+  if (trace != nullptr) {
+    mirror::Object* new_trace = visitor->IsMarked(trace);
+    if (new_trace != trace) {
+      last_throwable_stack_trace_ = GcRoot<mirror::ObjectArray<mirror::Object>>(
+          down_cast<mirror::ObjectArray<mirror::Object>*>(new_trace));
+    }
+  }
+}
+
 // FIXME: clang-r433403 reports the below function exceeds frame size limit.
 // http://b/197647048
 #pragma GCC diagnostic push
@@ -4728,6 +4819,22 @@ void Thread::SetReadBarrierEntrypoints() {
   UpdateReadBarrierEntrypoints(&tlsPtr_.quick_entrypoints, /* is_active=*/ true);
 }
 
+CodeInfoCache* Thread::GetCodeInfoCache() {
+  DCHECK(this == Thread::Current());
+  if (UNLIKELY(code_info_cache_ == nullptr)) {
+    code_info_cache_ = std::make_unique<CodeInfoCache>();
+  }
+  return code_info_cache_.get();
+}
+
+ReflectiveAccessCache* Thread::GetReflectiveAccessCache() {
+  DCHECK(this == Thread::Current());
+  if (UNLIKELY(reflective_access_cache_ == nullptr)) {
+    reflective_access_cache_ = std::make_unique<ReflectiveAccessCache>();
+  }
+  return reflective_access_cache_.get();
+}
+
 void Thread::ClearAllInterpreterCaches() {
   static struct ClearInterpreterCacheClosure : Closure {
     void Run(Thread* thread) override {
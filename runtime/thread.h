@@ -35,6 +35,7 @@
 #include "base/value_object.h"
 #include "entrypoints/jni/jni_entrypoints.h"
 #include "entrypoints/quick/quick_entrypoints.h"
+#include "gc_root.h"
 #include "handle.h"
 #include "handle_scope.h"
 #include "interpreter/interpreter_cache.h"
@@ -89,6 +90,7 @@ class ArtMethod;
 class BaseMutex;
 class ClassLinker;
 class Closure;
+class CodeInfoCache;
 class Context;
 class DeoptimizationContextRecord;
 class DexFile;
@@ -97,6 +99,7 @@ class IsMarkedVisitor;
 class JavaVMExt;
 class JNIEnvExt;
 class Monitor;
+class ReflectiveAccessCache;
 class RootVisitor;
 class ScopedObjectAccessAlreadyRunnable;
 class ShadowFrame;
@@ -732,6 +735,13 @@ class Thread {
   jobject CreateInternalStackTrace(const ScopedObjectAccessAlreadyRunnable& soa) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Create the internal stack trace of a Throwable for fillInStackTrace. Unlike
+  // CreateInternalStackTrace(), this stops after -Xthrowable-stack-trace-depth frames and,
+  // with -Xthrowable-stack-trace-reuse, returns the previous Throwable trace created by this
+  // thread if it has the same frames. Must be called on the current thread.
+  jobject CreateThrowableStackTrace(const ScopedObjectAccessAlreadyRunnable& soa)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Convert an internal stack trace representation (returned by CreateInternalStackTrace) to a
   // StackTraceElement[]. If output_array is null, a new array is created, otherwise as many
   // frames as will fit are written into the given array. If stack_depth is non-null, it's updated
@@ -761,6 +771,10 @@ class Thread {
   // This is done by GC using a checkpoint (or in a stop-the-world pause).
   void SweepInterpreterCache(IsMarkedVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Clear or update the stack trace kept for CreateThrowableStackTrace(). Called while
+  // sweeping system weaks, when this thread does not access it.
+  void SweepThrowableStackTrace(IsMarkedVisitor* visitor) REQUIRES_SHARED(Locks::mutator_lock_);
+
   void VisitRoots(RootVisitor* visitor, VisitRootFlags flags)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -1436,6 +1450,14 @@ class Thread {
     return &interpreter_cache_;
   }
 
+  // Returns the cache of decoded CodeInfo used when this thread walks stacks,
+  // allocating it on first use.
+  CodeInfoCache* GetCodeInfoCache();
+
+  // Returns the cache of reflective method access checks that succeeded on this thread,
+  // allocating it on first use.
+  ReflectiveAccessCache* GetReflectiveAccessCache();
+
   // Clear all thread-local interpreter caches.
   //
   // Since the caches are keyed by memory pointer to dex instructions, this must be
@@ -2150,6 +2172,17 @@ class Thread {
   // Pending extra checkpoints if checkpoint_function_ is already used.
   std::list<Closure*> checkpoint_overflow_ GUARDED_BY(Locks::thread_suspend_count_lock_);
 
+  // Cache of decoded CodeInfo for the stack walks done by this thread, see GetCodeInfoCache().
+  std::unique_ptr<CodeInfoCache> code_info_cache_;
+
+  // Cache of reflective method access checks, see GetReflectiveAccessCache().
+  std::unique_ptr<ReflectiveAccessCache> reflective_access_cache_;
+
+  // The last internal stack trace returned by CreateThrowableStackTrace(), for reuse by the
+  // next Throwable with the same frames. It is a weak root swept with the system weaks, so
+  // that it never keeps the classes of the trace alive.
+  GcRoot<mirror::ObjectArray<mirror::Object>> last_throwable_stack_trace_;
+
   // Custom TLS field that can be used by plugins or the runtime. Should not be accessed directly by
   // compiled code or entrypoints.
   SafeMap<std::string, std::unique_ptr<TLSData>, std::less<>> custom_tls_
@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <map>
 #include <sstream>
 #include <tuple>
@@ -32,6 +33,8 @@
 
 #include "art_field-inl.h"
 #include "base/aborting.h"
+#include "base/array_ref.h"
+#include "base/bit_utils.h"
 #include "base/histogram-inl.h"
 #include "base/mutex-inl.h"
 #include "base/systrace.h"
@@ -51,6 +54,7 @@
 #include "obj_ptr-inl.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "well_known_classes.h"
 
@@ -67,6 +71,8 @@ namespace art {
 using android::base::StringPrintf;
 
 static constexpr uint64_t kLongThreadSuspendThreshold = MsToNs(5);
+// Minimum number of suspended threads for RunCheckpoint to run their checkpoints in parallel.
+static constexpr size_t kMinParallelSuspendedCheckpoints = 32;
 // Use 0 since we want to yield to prevent blocking for an unpredictable amount of time.
 static constexpr useconds_t kThreadSuspendInitialSleepUs = 0;
 static constexpr useconds_t kThreadSuspendMaxYieldUs = 3000;
@@ -80,6 +86,13 @@ ThreadList::ThreadList(uint64_t thread_suspend_timeout_ns)
     : suspend_all_count_(0),
       unregistering_count_(0),
       suspend_all_historam_("suspend all histogram", 16, 64),
+      suspend_all_request_histogram_("suspend all request histogram", 16, 64),
+      time_to_safepoint_histogram_("time to safepoint histogram", 16, 64),
+      suspend_all_lock_histogram_("suspend all mutator lock histogram", 16, 64),
+      max_time_to_safepoint_ns_(0u),
+      max_time_to_safepoint_tid_(0),
+      last_suspend_barrier_tid_(0),
+      suspended_checkpoint_histogram_("suspended thread checkpoint histogram", 16, 64),
       long_suspend_(false),
       shut_down_(false),
       thread_suspend_timeout_ns_(thread_suspend_timeout_ns),
@@ -144,6 +157,25 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
       Histogram<uint64_t>::CumulativeData data;
       suspend_all_historam_.CreateHistogram(&data);
       suspend_all_historam_.PrintConfidenceIntervals(os, 0.99, data);  // Dump time to suspend.
+      // Dump the phases of the suspension.
+      for (Histogram<uint64_t>* histogram : {&suspend_all_request_histogram_,
+                                             &time_to_safepoint_histogram_,
+                                             &suspend_all_lock_histogram_}) {
+        histogram->CreateHistogram(&data);
+        histogram->PrintConfidenceIntervals(os, 0.99, data);
+      }
+      if (max_time_to_safepoint_tid_ != 0) {
+        os << "Longest time to safepoint " << PrettyDuration(max_time_to_safepoint_ns_)
+           << ", last thread to suspend tid=" << max_time_to_safepoint_tid_ << "\n";
+      }
+    }
+  }
+  {
+    MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
+    if (suspended_checkpoint_histogram_.SampleSize() > 0) {
+      Histogram<uint64_t>::CumulativeData data;
+      suspended_checkpoint_histogram_.CreateHistogram(&data);
+      suspended_checkpoint_histogram_.PrintConfidenceIntervals(os, 0.99, data);
     }
   }
   bool dump_native_stack = Runtime::Current()->GetDumpNativeStackOnSigQuit();
@@ -323,6 +355,113 @@ static void ThreadSuspendSleep(useconds_t delay_us) {
   }
 }
 
+// Run the checkpoint of a thread we keep suspended, then let it resume.
+static void RunSuspendedCheckpoint(Thread* self, Closure* checkpoint_function, Thread* thread)
+    REQUIRES(!Locks::thread_suspend_count_lock_) {
+  // We know for sure that the thread is suspended at this point.
+  DCHECK(thread->IsSuspended());
+  checkpoint_function->Run(thread);
+  {
+    MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
+    bool updated = thread->ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
+    DCHECK(updated);
+  }
+}
+
+class SuspendedCheckpointTask final : public Task {
+ public:
+  SuspendedCheckpointTask(Closure* checkpoint_function,
+                          ArrayRef<Thread* const> threads,
+                          bool caller_holds_mutator_lock)
+      : checkpoint_function_(checkpoint_function),
+        threads_(threads),
+        caller_holds_mutator_lock_(caller_holds_mutator_lock) {}
+
+  void Run(Thread* self) override {
+    // A checkpoint function run by a caller holding the mutator lock, such as the GC marking
+    // thread roots, expects the lock to be held. The caller holds it shared until all tasks
+    // have run, so no thread can hold it exclusively and taking it shared here does not block.
+    if (caller_holds_mutator_lock_ && !Locks::mutator_lock_->IsSharedHeld(self)) {
+      ReaderMutexLock mu(self, *Locks::mutator_lock_);
+      RunCheckpoints(self);
+    } else {
+      RunCheckpoints(self);
+    }
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  void RunCheckpoints(Thread* self) {
+    for (Thread* thread : threads_) {
+      RunSuspendedCheckpoint(self, checkpoint_function_, thread);
+    }
+  }
+
+  Closure* const checkpoint_function_;
+  const ArrayRef<Thread* const> threads_;
+  const bool caller_holds_mutator_lock_;
+
+  DISALLOW_COPY_AND_ASSIGN(SuspendedCheckpointTask);
+};
+
+void ThreadList::RunSuspendedCheckpointsInParallel(Thread* self,
+                                                   Closure* checkpoint_function,
+                                                   const std::vector<Thread*>& threads) {
+  ThreadPool* pool = checkpoint_thread_pool_.get();
+  // The workers themselves were suspended if they were idle, and could not run any task, nor
+  // become runnable, until their suspend count is lowered. So run their checkpoints first.
+  const std::vector<ThreadPoolWorker*>& workers = pool->GetWorkers();
+  std::vector<Thread*> other_threads;
+  other_threads.reserve(threads.size());
+  for (Thread* thread : threads) {
+    auto is_worker = [thread](ThreadPoolWorker* worker) { return worker->GetThread() == thread; };
+    if (std::any_of(workers.begin(), workers.end(), is_worker)) {
+      RunSuspendedCheckpoint(self, checkpoint_function, thread);
+    } else {
+      other_threads.push_back(thread);
+    }
+  }
+  if (other_threads.size() != threads.size()) {
+    // Like ResumeAll, wake up workers waiting for their suspend count to be lowered.
+    MutexLock mu(self, *Locks::thread_suspend_count_lock_);
+    Thread::resume_cond_->Broadcast(self);
+  }
+
+  // One chunk per worker and one for ourselves. Checkpoints of runnable threads already run
+  // concurrently on those threads, so checkpoint functions are safe to run in parallel.
+  const bool caller_holds_mutator_lock = Locks::mutator_lock_->IsSharedHeld(self);
+  const size_t num_chunks = pool->GetThreadCount() + 1u;
+  const size_t chunk_size = RoundUp(other_threads.size(), num_chunks) / num_chunks;
+  ArrayRef<Thread* const> all_threads(other_threads);
+  for (size_t start = 0; start < other_threads.size(); start += chunk_size) {
+    size_t end = std::min(other_threads.size(), start + chunk_size);
+    pool->AddTask(self,
+                  new SuspendedCheckpointTask(checkpoint_function,
+                                              all_threads.SubArray(start, end - start),
+                                              caller_holds_mutator_lock));
+  }
+  pool->Wait(self, /* do_work= */ true, /* may_hold_locks= */ true);
+}
+
+void ThreadList::CreateCheckpointThreadPool(size_t num_threads) {
+  DCHECK(checkpoint_thread_pool_ == nullptr);
+  checkpoint_thread_pool_.reset(new ThreadPool("Checkpoint thread pool", num_threads));
+  checkpoint_thread_pool_->StartWorkers(Thread::Current());
+}
+
+void ThreadList::WaitForCheckpointWorkersToBeCreated() {
+  if (checkpoint_thread_pool_ != nullptr) {
+    checkpoint_thread_pool_->WaitForWorkersToBeCreated();
+  }
+}
+
+void ThreadList::DeleteCheckpointThreadPool() {
+  checkpoint_thread_pool_.reset();
+}
+
 size_t ThreadList::RunCheckpoint(Closure* checkpoint_function, Closure* callback) {
   Thread* self = Thread::Current();
   Locks::mutator_lock_->AssertNotExclusiveHeld(self);
@@ -389,16 +528,19 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function, Closure* callback
   checkpoint_function->Run(self);
 
   // Run the checkpoint on the suspended threads.
-  for (const auto& thread : suspended_count_modified_threads) {
-    // We know for sure that the thread is suspended at this point.
-    DCHECK(thread->IsSuspended());
-    checkpoint_function->Run(thread);
-    {
-      MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
-      bool updated = thread->ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
-      DCHECK(updated);
+  const uint64_t start_time = NanoTime();
+  if (checkpoint_thread_pool_ != nullptr &&
+      suspended_count_modified_threads.size() >= kMinParallelSuspendedCheckpoints) {
+    RunSuspendedCheckpointsInParallel(self, checkpoint_function, suspended_count_modified_threads);
+  } else {
+    for (const auto& thread : suspended_count_modified_threads) {
+      RunSuspendedCheckpoint(self, checkpoint_function, thread);
     }
   }
+  if (!suspended_count_modified_threads.empty()) {
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    suspended_checkpoint_histogram_.AdjustAndAddValue(NanoTime() - start_time);
+  }
 
   {
     // Imitate ResumeAll, threads may be waiting on Thread::resume_cond_ since we raised their
@@ -636,7 +778,9 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     ScopedTrace trace("Suspending mutator threads");
     const uint64_t start_time = NanoTime();
 
-    SuspendAllInternal(self, self);
+    SuspendAllTimings timings;
+    SuspendAllInternal(self, self, nullptr, SuspendReason::kInternal, &timings);
+    const uint64_t lock_start_time = NanoTime();
     // All threads are known to have suspended (but a thread may still own the mutator lock)
     // Make sure this thread grabs exclusive access to the mutator lock and its protected data.
 #if HAVE_TIMED_RWLOCK
@@ -661,6 +805,14 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     const uint64_t end_time = NanoTime();
     const uint64_t suspend_time = end_time - start_time;
     suspend_all_historam_.AdjustAndAddValue(suspend_time);
+    suspend_all_request_histogram_.AdjustAndAddValue(timings.request_ns);
+    time_to_safepoint_histogram_.AdjustAndAddValue(timings.wait_ns);
+    suspend_all_lock_histogram_.AdjustAndAddValue(end_time - lock_start_time);
+    if (timings.wait_ns > max_time_to_safepoint_ns_ && timings.last_tid != 0) {
+      max_time_to_safepoint_ns_ = timings.wait_ns;
+      max_time_to_safepoint_tid_ = timings.last_tid;
+    }
+    GetMetrics()->TimeToSafepoint()->Add(NsToUs(timings.wait_ns));
     if (suspend_time > kLongThreadSuspendThreshold) {
       LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time);
     }
@@ -683,7 +835,8 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
 void ThreadList::SuspendAllInternal(Thread* self,
                                     Thread* ignore1,
                                     Thread* ignore2,
-                                    SuspendReason reason) {
+                                    SuspendReason reason,
+                                    SuspendAllTimings* timings) {
   Locks::mutator_lock_->AssertNotExclusiveHeld(self);
   Locks::thread_list_lock_->AssertNotHeld(self);
   Locks::thread_suspend_count_lock_->AssertNotHeld(self);
@@ -699,6 +852,8 @@ void ThreadList::SuspendAllInternal(Thread* self,
   //    kNative) and will never begin executing Java code without first checking
   //    the suspend-request flag.
 
+  const uint64_t request_start_time = NanoTime();
+  last_suspend_barrier_tid_.store(0, std::memory_order_relaxed);
   // The atomic counter for number of threads that need to pass the barrier.
   AtomicInteger pending_threads;
   uint32_t num_ignored = 0;
@@ -741,6 +896,7 @@ void ThreadList::SuspendAllInternal(Thread* self,
   InitTimeSpec(false, CLOCK_MONOTONIC, NsToMs(thread_suspend_timeout_ns_), 0, &wait_timeout);
 #endif
   const uint64_t start_time = NanoTime();
+  const bool had_pending_threads = pending_threads.load(std::memory_order_relaxed) > 0;
   while (true) {
     int32_t cur_val = pending_threads.load(std::memory_order_relaxed);
     if (LIKELY(cur_val > 0)) {
@@ -781,6 +937,12 @@ void ThreadList::SuspendAllInternal(Thread* self,
       break;
     }
   }
+  if (timings != nullptr) {
+    timings->request_ns = start_time - request_start_time;
+    timings->wait_ns = NanoTime() - start_time;
+    timings->last_tid =
+        had_pending_threads ? last_suspend_barrier_tid_.load(std::memory_order_relaxed) : 0;
+  }
 }
 
 void ThreadList::ResumeAll() {
@@ -1447,6 +1609,13 @@ void ThreadList::SweepInterpreterCaches(IsMarkedVisitor* visitor) const {
   }
 }
 
+void ThreadList::SweepThrowableStackTraces(IsMarkedVisitor* visitor) const {
+  MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
+  for (const auto& thread : list_) {
+    thread->SweepThrowableStackTrace(visitor);
+  }
+}
+
 uint32_t ThreadList::AllocThreadId(Thread* self) {
   MutexLock mu(self, *Locks::allocated_thread_ids_lock_);
   for (size_t i = 0; i < allocated_ids_.size(); ++i) {
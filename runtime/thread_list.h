@@ -25,8 +25,10 @@
 #include "reflective_handle_scope.h"
 #include "suspend_reason.h"
 
+#include <atomic>
 #include <bitset>
 #include <list>
+#include <memory>
 #include <vector>
 
 namespace art {
@@ -40,6 +42,7 @@ class Closure;
 class IsMarkedVisitor;
 class RootVisitor;
 class Thread;
+class ThreadPool;
 class TimingLogger;
 enum VisitRootFlags : uint8_t;
 
@@ -118,6 +121,12 @@ class ThreadList {
   size_t RunCheckpoint(Closure* checkpoint_function, Closure* callback = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Create the pool used by RunCheckpoint to run the checkpoints of suspended threads in
+  // parallel. Without it, the caller of RunCheckpoint runs all of them.
+  void CreateCheckpointThreadPool(size_t num_threads);
+  void DeleteCheckpointThreadPool();
+  void WaitForCheckpointWorkersToBeCreated();
+
   // Run an empty checkpoint on threads. Wait until threads pass the next suspend point or are
   // suspended. This is used to ensure that the threads finish or aren't in the middle of an
   // in-flight mutator heap access (eg. a read barrier.) Runnable threads will respond by
@@ -170,6 +179,9 @@ class ThreadList {
   void SweepInterpreterCaches(IsMarkedVisitor* visitor) const
       REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_);
 
+  void SweepThrowableStackTraces(IsMarkedVisitor* visitor) const
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!Locks::thread_list_lock_);
+
   // Return a copy of the thread list.
   std::list<Thread*> GetList() REQUIRES(Locks::thread_list_lock_) {
     return list_;
@@ -199,10 +211,28 @@ class ThreadList {
   void SuspendAllDaemonThreadsForShutdown()
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Durations of the phases of SuspendAllInternal.
+  struct SuspendAllTimings {
+    // Requesting all threads to suspend.
+    uint64_t request_ns = 0u;
+    // Waiting for the runnable threads to reach a suspend point (time to safepoint).
+    uint64_t wait_ns = 0u;
+    // The last thread to reach a suspend point, or 0 if no thread had to be waited for.
+    pid_t last_tid = 0;
+  };
+
   void SuspendAllInternal(Thread* self,
                           Thread* ignore1,
                           Thread* ignore2 = nullptr,
-                          SuspendReason reason = SuspendReason::kInternal)
+                          SuspendReason reason = SuspendReason::kInternal,
+                          SuspendAllTimings* timings = nullptr)
+      REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
+
+  // Run `checkpoint_function` for the given suspended threads on the checkpoint thread pool
+  // and the calling thread, and lower their suspend count.
+  void RunSuspendedCheckpointsInParallel(Thread* self,
+                                         Closure* checkpoint_function,
+                                         const std::vector<Thread*>& threads)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
   void AssertThreadsAreSuspended(Thread* self, Thread* ignore1, Thread* ignore2 = nullptr)
@@ -223,6 +253,26 @@ class ThreadList {
   // by mutator lock ensures no thread can read when another thread is modifying it.
   Histogram<uint64_t> suspend_all_historam_ GUARDED_BY(Locks::mutator_lock_);
 
+  // Histograms of the phases of SuspendAll: requesting the threads to suspend, waiting for them
+  // to reach a suspend point (time to safepoint), and acquiring the mutator lock exclusively.
+  Histogram<uint64_t> suspend_all_request_histogram_ GUARDED_BY(Locks::mutator_lock_);
+  Histogram<uint64_t> time_to_safepoint_histogram_ GUARDED_BY(Locks::mutator_lock_);
+  Histogram<uint64_t> suspend_all_lock_histogram_ GUARDED_BY(Locks::mutator_lock_);
+
+  // The longest time to safepoint seen by SuspendAll, and the last thread to suspend then.
+  uint64_t max_time_to_safepoint_ns_ GUARDED_BY(Locks::mutator_lock_);
+  pid_t max_time_to_safepoint_tid_ GUARDED_BY(Locks::mutator_lock_);
+
+  // The last thread to pass a suspend barrier, set in Thread::PassActiveSuspendBarriers.
+  // Only used for diagnostics, so concurrent suspensions may report a thread of another one.
+  std::atomic<pid_t> last_suspend_barrier_tid_;
+
+  // Time spent by RunCheckpoint running the checkpoints of suspended threads.
+  Histogram<uint64_t> suspended_checkpoint_histogram_ GUARDED_BY(Locks::thread_list_lock_);
+
+  // Workers running the checkpoints of suspended threads, or null if disabled.
+  std::unique_ptr<ThreadPool> checkpoint_thread_pool_;
+
   // Whether or not the current thread suspension is long.
   bool long_suspend_;
 
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "thread_list.h"
+
+#include "barrier.h"
+#include "base/atomic.h"
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "handle_scope-inl.h"
+#include "mirror/string-inl.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-inl.h"
+#include "thread_pool.h"
+
+namespace art {
+
+class ThreadListTest : public CommonRuntimeTest {};
+
+// Counts the threads it runs for. Like most checkpoints, it needs the mutator lock.
+class CountingCheckpoint : public Closure {
+ public:
+  explicit CountingCheckpoint(Barrier* barrier) : barrier_(barrier), count_(0) {}
+
+  void Run(Thread* thread) override {
+    Thread* self = Thread::Current();
+    {
+      ScopedObjectAccess soa(self);
+      EXPECT_TRUE(thread == self || thread->IsSuspended());
+      ++count_;
+    }
+    barrier_->Pass(self);
+  }
+
+  int32_t GetCount() const {
+    return count_.load(std::memory_order_seq_cst);
+  }
+
+ private:
+  Barrier* const barrier_;
+  AtomicInteger count_;
+};
+
+// Counts the threads it runs for, like a GC thread roots checkpoint: it expects the mutator lock
+// to be held shared by the thread running it, but does not take it.
+class SharedHeldCheckpoint : public Closure {
+ public:
+  explicit SharedHeldCheckpoint(Barrier* barrier) : barrier_(barrier), count_(0) {}
+
+  void Run(Thread* thread) override {
+    Thread* self = Thread::Current();
+    Locks::mutator_lock_->AssertSharedHeld(self);
+    EXPECT_TRUE(thread == self || thread->IsSuspended());
+    ++count_;
+    barrier_->Pass(self);
+  }
+
+  int32_t GetCount() const {
+    return count_.load(std::memory_order_seq_cst);
+  }
+
+ private:
+  Barrier* const barrier_;
+  AtomicInteger count_;
+};
+
+// The checkpoint workers are suspended with the other idle threads, and must still be able
+// to run the checkpoints of the suspended threads.
+TEST_F(ThreadListTest, ParallelSuspendedCheckpoints) {
+  Thread* self = Thread::Current();
+  ThreadList* thread_list = Runtime::Current()->GetThreadList();
+  thread_list->CreateCheckpointThreadPool(/* num_threads= */ 2);
+  thread_list->WaitForCheckpointWorkersToBeCreated();
+  // Idle pool workers are attached but not runnable, so RunCheckpoint suspends them. The
+  // pool is only used for at least 32 suspended threads.
+  constexpr size_t kNumSuspendedThreads = 64;
+  ThreadPool idle_pool("Idle thread pool", kNumSuspendedThreads);
+  idle_pool.WaitForWorkersToBeCreated();
+
+  for (size_t i = 0; i != 3u; ++i) {
+    Barrier barrier(0);
+    CountingCheckpoint checkpoint(&barrier);
+    size_t count = thread_list->RunCheckpoint(&checkpoint);
+    EXPECT_GT(count, kNumSuspendedThreads);
+    {
+      ScopedThreadStateChange tsc(self, ThreadState::kWaitingForCheckPointsToRun);
+      barrier.Increment(self, count);
+    }
+    EXPECT_EQ(count, static_cast<size_t>(checkpoint.GetCount()));
+  }
+
+  thread_list->DeleteCheckpointThreadPool();
+}
+
+// Like the GC marking thread roots, the caller holds the mutator lock shared while the pool
+// runs the checkpoints of the suspended threads.
+TEST_F(ThreadListTest, ParallelSuspendedCheckpointsHoldingMutatorLock) {
+  Thread* self = Thread::Current();
+  ThreadList* thread_list = Runtime::Current()->GetThreadList();
+  thread_list->CreateCheckpointThreadPool(/* num_threads= */ 2);
+  thread_list->WaitForCheckpointWorkersToBeCreated();
+  constexpr size_t kNumSuspendedThreads = 64;
+  ThreadPool idle_pool("Idle thread pool", kNumSuspendedThreads);
+  idle_pool.WaitForWorkersToBeCreated();
+
+  for (size_t i = 0; i != 3u; ++i) {
+    Barrier barrier(0);
+    SharedHeldCheckpoint checkpoint(&barrier);
+    size_t count;
+    {
+      ScopedObjectAccess soa(self);
+      count = thread_list->RunCheckpoint(&checkpoint);
+    }
+    EXPECT_GT(count, kNumSuspendedThreads);
+    {
+      ScopedThreadStateChange tsc(self, ThreadState::kWaitingForCheckPointsToRun);
+      barrier.Increment(self, count);
+    }
+    EXPECT_EQ(count, static_cast<size_t>(checkpoint.GetCount()));
+  }
+
+  thread_list->DeleteCheckpointThreadPool();
+}
+
+// The GC marks the roots of the suspended threads with a checkpoint run from its own thread,
+// while it holds the mutator lock shared.
+TEST_F(ThreadListTest, ParallelSuspendedCheckpointsInGc) {
+  Thread* self = Thread::Current();
+  Runtime* runtime = Runtime::Current();
+  ThreadList* thread_list = runtime->GetThreadList();
+  thread_list->CreateCheckpointThreadPool(/* num_threads= */ 2);
+  thread_list->WaitForCheckpointWorkersToBeCreated();
+  constexpr size_t kNumSuspendedThreads = 64;
+  ThreadPool idle_pool("Idle thread pool", kNumSuspendedThreads);
+  idle_pool.WaitForWorkersToBeCreated();
+
+  {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::String> string(
+        hs.NewHandle(mirror::String::AllocFromModifiedUtf8(self, "checkpoint")));
+    ASSERT_TRUE(string != nullptr);
+    gc::Heap* heap = runtime->GetHeap();
+    uint32_t gc_num = heap->GetCurrentGcNum();
+    {
+      ScopedThreadSuspension sts(self, ThreadState::kNative);
+      heap->CollectGarbage(/* clear_soft_references= */ false);
+    }
+    EXPECT_GT(heap->GetCurrentGcNum(), gc_num);
+    EXPECT_TRUE(string->Equals("checkpoint"));
+  }
+
+  thread_list->DeleteCheckpointThreadPool();
+}
+
+}  // namespace art
@@ -23,8 +23,10 @@
 #include "android-base/stringprintf.h"
 
 #include "art_method-inl.h"
+#include "barrier.h"
 #include "base/casts.h"
 #include "base/enums.h"
+#include "base/leb128.h"
 #include "base/os.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
@@ -50,6 +52,7 @@
 #include "stack.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -60,12 +63,15 @@ static constexpr size_t TraceActionBits = MinimumBitsToStore(
 static constexpr uint8_t kOpNewMethod = 1U;
 static constexpr uint8_t kOpNewThread = 2U;
 static constexpr uint8_t kOpTraceSummary = 3U;
+static constexpr uint8_t kOpCompactEvents = 4U;
 
 static const char     kTraceTokenChar             = '*';
 static const uint16_t kTraceHeaderLength          = 32;
 static const uint32_t kTraceMagicValue            = 0x574f4c53;
 static const uint16_t kTraceVersionSingleClock    = 2;
 static const uint16_t kTraceVersionDualClock      = 3;
+static const uint16_t kTraceVersionStreaming      = 0xF0;
+static const uint16_t kTraceVersionCompact        = 0xE0;
 static const uint16_t kTraceRecordSizeSingleClock = 10;  // using v2
 static const uint16_t kTraceRecordSizeDualClock   = 14;  // using v3 with two timestamps
 
@@ -73,7 +79,6 @@ TraceClockSource Trace::default_clock_source_ = kDefaultTraceClockSource;
 
 Trace* volatile Trace::the_trace_ = nullptr;
 pthread_t Trace::sampling_pthread_ = 0U;
-std::unique_ptr<std::vector<ArtMethod*>> Trace::temp_stack_trace_;
 
 // The key identifying the tracer to update instrumentation.
 static constexpr const char* kTracerInstrumentationKey = "Tracer";
@@ -236,16 +241,6 @@ uint16_t Trace::GetThreadEncoding(pid_t thread_id) {
   return idx;
 }
 
-std::vector<ArtMethod*>* Trace::AllocStackTrace() {
-  return (temp_stack_trace_.get() != nullptr)  ? temp_stack_trace_.release() :
-      new std::vector<ArtMethod*>();
-}
-
-void Trace::FreeStackTrace(std::vector<ArtMethod*>* stack_trace) {
-  stack_trace->clear();
-  temp_stack_trace_.reset(stack_trace);
-}
-
 void Trace::SetDefaultClockSource(TraceClockSource clock_source) {
 #if defined(__linux__)
   default_clock_source_ = clock_source;
@@ -331,8 +326,14 @@ static void Append8LE(uint8_t* buf, uint64_t val) {
   *buf++ = static_cast<uint8_t>(val >> 56);
 }
 
-static void GetSample(Thread* thread, void* arg) REQUIRES_SHARED(Locks::mutator_lock_) {
-  std::vector<ArtMethod*>* const stack_trace = Trace::AllocStackTrace();
+// Record a sample of the stack of `thread`. This runs as a checkpoint, either on `thread`
+// itself or, if it is suspended, on a thread running the checkpoint on its behalf.
+static void GetSample(Thread* thread, Trace* the_trace) REQUIRES_SHARED(Locks::mutator_lock_) {
+  std::vector<ArtMethod*>* const stack_trace = new std::vector<ArtMethod*>();
+  std::vector<ArtMethod*>* const old_stack_trace = thread->GetStackTraceSample();
+  if (old_stack_trace != nullptr) {
+    stack_trace->reserve(old_stack_trace->size());
+  }
   StackVisitor::WalkStack(
       [&](const art::StackVisitor* stack_visitor) REQUIRES_SHARED(Locks::mutator_lock_) {
         ArtMethod* m = stack_visitor->GetMethod();
@@ -345,7 +346,6 @@ static void GetSample(Thread* thread, void* arg) REQUIRES_SHARED(Locks::mutator_
       thread,
       /* context= */ nullptr,
       art::StackVisitor::StackWalkKind::kIncludeInlinedFrames);
-  Trace* the_trace = reinterpret_cast<Trace*>(arg);
   the_trace->CompareAndUpdateStackTrace(thread, stack_trace);
 }
 
@@ -358,7 +358,8 @@ static void ClearThreadStackTraceAndClockBase(Thread* thread, [[maybe_unused]] v
 
 void Trace::CompareAndUpdateStackTrace(Thread* thread,
                                        std::vector<ArtMethod*>* stack_trace) {
-  CHECK_EQ(pthread_self(), sampling_pthread_);
+  // Samples of different threads are recorded concurrently, but the sample of a given
+  // thread is only updated by the checkpoint run for it.
   std::vector<ArtMethod*>* old_stack_trace = thread->GetStackTraceSample();
   // Update the thread's stack trace sample.
   thread->SetStackTraceSample(stack_trace);
@@ -390,7 +391,7 @@ void Trace::CompareAndUpdateStackTrace(Thread* thread,
     for (; rit != stack_trace->rend(); ++rit) {
       LogMethodTraceEvent(thread, *rit, kTraceMethodEnter, thread_clock_diff, timestamp_counter);
     }
-    FreeStackTrace(old_stack_trace);
+    delete old_stack_trace;
   }
 }
 
@@ -414,15 +415,19 @@ void* Trace::RunSamplingThread(void* arg) {
       }
     }
     {
-      // Avoid a deadlock between a thread doing garbage collection
-      // and the profile sampling thread, by blocking GC when sampling
-      // thread stacks (see b/73624630).
-      gc::ScopedGCCriticalSection gcs(self,
-                                      art::gc::kGcCauseInstrumentation,
-                                      art::gc::kCollectorTypeInstrumentation);
-      ScopedSuspendAll ssa(__FUNCTION__);
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(GetSample, the_trace);
+      // Sample the threads with a checkpoint rather than suspending all of them: running
+      // threads record their own stack at their next suspend point, and only the threads
+      // which are already suspended get sampled by this thread.
+      ScopedObjectAccess soa(self);
+      Barrier barrier(0);
+      FunctionClosure sample([&](Thread* thread) REQUIRES_SHARED(Locks::mutator_lock_) {
+        GetSample(thread, the_trace);
+        barrier.Pass(Thread::Current());
+      });
+      size_t threads_running_checkpoint = runtime->GetThreadList()->RunCheckpoint(&sample);
+      // Wait for all the samples so that the trace outlives them; see StopTracing.
+      ScopedThreadSuspension sts(self, ThreadState::kWaitingForCheckPointsToRun);
+      barrier.Increment(self, threads_running_checkpoint);
     }
   }
 
@@ -521,6 +526,16 @@ void Trace::Start(std::unique_ptr<File>&& trace_file_in,
   // Enable count of allocs if specified in the flags.
   bool enable_stats = false;
 
+  // In streaming mode, write the flushed per-thread buffers on a separate thread, so that threads
+  // flushing their buffer do not wait for the file system. Create it before suspending all
+  // threads, as the worker needs to attach.
+  std::unique_ptr<ThreadPool> trace_writer_pool;
+  if (output_mode == TraceOutputMode::kStreaming) {
+    trace_writer_pool.reset(new ThreadPool("Trace writer thread pool", 1));
+    trace_writer_pool->StartWorkers(self);
+    trace_writer_pool->WaitForWorkersToBeCreated();
+  }
+
   // Create Trace object.
   {
     // Suspend JIT here since we are switching runtime to debuggable. Debuggable runtimes cannot use
@@ -538,6 +553,7 @@ void Trace::Start(std::unique_ptr<File>&& trace_file_in,
     } else {
       enable_stats = (flags & kTraceCountAllocs) != 0;
       the_trace_ = new Trace(trace_file.release(), buffer_size, flags, output_mode, trace_mode);
+      the_trace_->trace_writer_pool_ = std::move(trace_writer_pool);
       if (trace_mode == TraceMode::kSampling) {
         CHECK_PTHREAD_CALL(pthread_create, (&sampling_pthread_, nullptr, &RunSamplingThread,
                                             reinterpret_cast<void*>(interval_us)),
@@ -674,7 +690,9 @@ void Trace::StopTracing(bool finish_tracing, bool flush_file) {
 
   // At this point, code may read buf_ as its writers are shutdown
   // and the ScopedSuspendAll above has ensured all stores to buf_
-  // are now visible.
+  // are now visible. In streaming mode, wait for the data flushed
+  // above to be written before writing the summary or closing the file.
+  the_trace->WaitForPendingWrites();
   if (finish_tracing) {
     the_trace->FinishTracing();
   }
@@ -741,9 +759,32 @@ static constexpr size_t kMinBufSize = 18U;  // Trace header is up to 18B.
 // should be greater than kMinBufSize.
 static constexpr size_t kPerThreadBufSize = 512 * 1024;
 static_assert(kPerThreadBufSize > kMinBufSize);
+// Maximum number of flushed buffers waiting for the trace writer thread. Threads flushing their
+// buffer wait for the writer when it falls behind, which bounds the memory used for tracing.
+static constexpr size_t kMaxPendingTraceWrites = 16;
+// Maximum size of an event in the compact format: three 32-bit LEB128 values.
+static constexpr size_t kMaxCompactRecordSize = 3 * 5;
 
 namespace {
 
+// Writes data flushed from the per-thread buffers to the trace file on the trace writer thread.
+class TraceWriteTask final : public SelfDeletingTask {
+ public:
+  TraceWriteTask(File* trace_file, std::unique_ptr<uint8_t[]>&& data, size_t size)
+      : trace_file_(trace_file), data_(std::move(data)), size_(size) {}
+
+  void Run([[maybe_unused]] Thread* self) override {
+    if (!trace_file_->WriteFully(data_.get(), size_)) {
+      PLOG(WARNING) << "Failed streaming a tracing event.";
+    }
+  }
+
+ private:
+  File* const trace_file_;
+  const std::unique_ptr<uint8_t[]> data_;
+  const size_t size_;
+};
+
 TraceClockSource GetClockSourceFromFlags(int flags) {
   bool need_wall = flags & Trace::TraceFlag::kTraceClockSourceWallClock;
   bool need_thread_cpu = flags & Trace::TraceFlag::kTraceClockSourceThreadCpu;
@@ -770,6 +811,8 @@ Trace::Trace(File* trace_file,
       flags_(flags),
       trace_output_mode_(output_mode),
       trace_mode_(trace_mode),
+      compact_format_(output_mode == TraceOutputMode::kStreaming &&
+                      (flags & kTraceCompactFormat) != 0),
       clock_source_(GetClockSourceFromFlags(flags)),
       buffer_size_(std::max(kMinBufSize, buffer_size)),
       start_time_(GetMicroTime(GetTimestamp())),
@@ -782,7 +825,7 @@ Trace::Trace(File* trace_file,
 
   uint16_t trace_version = GetTraceVersion(clock_source_);
   if (output_mode == TraceOutputMode::kStreaming) {
-    trace_version |= 0xF0U;
+    trace_version |= compact_format_ ? kTraceVersionCompact : kTraceVersionStreaming;
   }
   // Set up the beginning of the trace.
   memset(buf_.get(), 0, kTraceHeaderLength);
@@ -1056,11 +1099,9 @@ void Trace::RecordStreamingMethodEvent(Thread* thread,
       DCHECK(thread_name.length() < (1 << 16));
       Append2LE(header + 5, static_cast<uint16_t>(thread_name.length()));
 
-      if (!trace_file_->WriteFully(header, kThreadNameHeaderSize) ||
-          !trace_file_->WriteFully(reinterpret_cast<const uint8_t*>(thread_name.c_str()),
-                                   thread_name.length())) {
-        PLOG(WARNING) << "Failed streaming a tracing event.";
-      }
+      WriteStreamingData(header, kThreadNameHeaderSize);
+      WriteStreamingData(reinterpret_cast<const uint8_t*>(thread_name.c_str()),
+                         thread_name.length());
     }
   }
 
@@ -1111,10 +1152,90 @@ void Trace::WriteToBuf(uint8_t* header,
     // The data is larger than buffer, so write directly to the file. EnsureSpace should have
     // flushed any data in the buffer.
     DCHECK_EQ(*current_index, 0U);
-    if (!trace_file_->WriteFully(reinterpret_cast<const uint8_t*>(data.c_str()), data.length())) {
-      PLOG(WARNING) << "Failed streaming a tracing event.";
+    WriteStreamingData(reinterpret_cast<const uint8_t*>(data.c_str()), data.length());
+  }
+}
+
+void Trace::WriteStreamingData(const uint8_t* data, size_t size) {
+  std::unique_ptr<uint8_t[]> copy(new uint8_t[size]);
+  memcpy(copy.get(), data, size);
+  WriteStreamingData(std::move(copy), size);
+}
+
+void Trace::WriteStreamingData(std::unique_ptr<uint8_t[]>&& data, size_t size) {
+  if (size == 0u) {
+    return;
+  }
+  // Writes are queued while holding the tracing_lock_, so they reach the file in the order
+  // the data was encoded.
+  Thread* self = Thread::Current();
+  if (trace_writer_pool_->GetTaskCount(self) >= kMaxPendingTraceWrites) {
+    // The writer does not need any lock held by the callers, so we can wait for it here.
+    trace_writer_pool_->Wait(self, /* do_work= */ false, /* may_hold_locks= */ true);
+  }
+  trace_writer_pool_->AddTask(self, new TraceWriteTask(trace_file_.get(), std::move(data), size));
+}
+
+void Trace::WaitForPendingWrites() {
+  if (trace_writer_pool_ != nullptr) {
+    trace_writer_pool_->Wait(Thread::Current(), /* do_work= */ false, /* may_hold_locks= */ true);
+  }
+}
+
+void Trace::ReadStreamingEntry(uintptr_t* method_trace_buffer,
+                               size_t* entry_index,
+                               /* out */ ArtMethod** method,
+                               /* out */ TraceAction* action,
+                               /* out */ uint32_t* thread_time,
+                               /* out */ uint32_t* wall_time) {
+  size_t index = *entry_index;
+  uintptr_t method_and_action = method_trace_buffer[index--];
+  *method = reinterpret_cast<ArtMethod*>(method_and_action & kMaskTraceAction);
+  *action = DecodeTraceAction(method_and_action);
+  *thread_time = 0;
+  *wall_time = 0;
+  if (UseThreadCpuClock()) {
+    *thread_time = method_trace_buffer[index--];
+  }
+  if (UseWallClock()) {
+    uint64_t timestamp = method_trace_buffer[index--];
+    if (art::kRuntimePointerSize == PointerSize::k32) {
+      // On 32-bit architectures timestamp is stored as two 32-bit values.
+      timestamp = (timestamp << 32 | method_trace_buffer[index--]);
     }
+    *wall_time = GetMicroTime(timestamp) - start_time_;
   }
+  *entry_index = index;
+}
+
+uint32_t Trace::EncodeStreamingMethod(ArtMethod* method,
+                                      size_t* current_index,
+                                      uint8_t* buffer,
+                                      size_t buffer_size) {
+  auto it = art_method_id_map_.find(method);
+  if (it != art_method_id_map_.end()) {
+    return it->second;
+  }
+  // If we haven't seen this method before record information about the method.
+  uint32_t method_index = current_method_index_;
+  art_method_id_map_.emplace(method, current_method_index_);
+  current_method_index_++;
+  // Write a special block with the name.
+  std::string method_line(GetMethodLine(method, method_index));
+  static constexpr size_t kMethodNameHeaderSize = 5;
+  uint8_t method_header[kMethodNameHeaderSize];
+  DCHECK_LT(kMethodNameHeaderSize, kPerThreadBufSize);
+  Append2LE(method_header, 0);
+  method_header[2] = kOpNewMethod;
+  DCHECK(method_line.length() < (1 << 16));
+  Append2LE(method_header + 3, static_cast<uint16_t>(method_line.length()));
+  WriteToBuf(method_header,
+             kMethodNameHeaderSize,
+             method_line,
+             current_index,
+             buffer,
+             buffer_size);
+  return method_index;
 }
 
 void Trace::FlushStreamingBuffer(Thread* thread) {
@@ -1124,69 +1245,72 @@ void Trace::FlushStreamingBuffer(Thread* thread) {
   MutexLock mu(Thread::Current(), tracing_lock_);
   uintptr_t* method_trace_buffer = thread->GetMethodTraceBuffer();
   CHECK(method_trace_buffer != nullptr);
-  // Create a temporary buffer to encode the trace events from the specified thread.
+  // Create a temporary buffer to encode the trace events from the specified thread. It is handed
+  // over to the trace writer thread once filled.
   size_t buffer_size = kPerThreadBufSize;
   size_t current_index = 0;
   std::unique_ptr<uint8_t[]> buffer(new uint8_t[std::max(kMinBufSize, buffer_size)]);
 
   size_t num_entries = *(thread->GetMethodTraceIndexPtr());
   uint16_t thread_id = GetThreadEncoding(thread->GetTid());
-  for (size_t entry_index = kPerThreadBufSize - 1; entry_index > num_entries;) {
-    uintptr_t method_and_action = method_trace_buffer[entry_index--];
-    ArtMethod* method = reinterpret_cast<ArtMethod*>(method_and_action & kMaskTraceAction);
-    TraceAction action = DecodeTraceAction(method_and_action);
-    uint32_t thread_time = 0;
-    uint32_t wall_time = 0;
-    if (UseThreadCpuClock()) {
-      thread_time = method_trace_buffer[entry_index--];
+  ArtMethod* method;
+  TraceAction action;
+  uint32_t thread_time;
+  uint32_t wall_time;
+  if (compact_format_) {
+    // Emit the names of the methods first, so that the events of the thread can be written as
+    // a single block.
+    size_t num_records = 0;
+    for (size_t entry_index = kPerThreadBufSize - 1; entry_index > num_entries; ++num_records) {
+      ReadStreamingEntry(
+          method_trace_buffer, &entry_index, &method, &action, &thread_time, &wall_time);
+      EncodeStreamingMethod(method, &current_index, buffer.get(), buffer_size);
     }
-    if (UseWallClock()) {
-      uint64_t timestamp = method_trace_buffer[entry_index--];
-      if (art::kRuntimePointerSize == PointerSize::k32) {
-        // On 32-bit architectures timestamp is stored as two 32-bit values.
-        timestamp = (timestamp << 32 | method_trace_buffer[entry_index--]);
+    static constexpr size_t kCompactEventsHeaderSize = 9;
+    EnsureSpace(buffer.get(), &current_index, buffer_size, kCompactEventsHeaderSize);
+    uint8_t* header = buffer.get() + current_index;
+    Append2LE(header, 0);
+    header[2] = kOpCompactEvents;
+    Append2LE(header + 3, thread_id);
+    Append4LE(header + 5, num_records);
+    current_index += kCompactEventsHeaderSize;
+    // Times are encoded as deltas from the previous event of the block.
+    uint32_t previous_thread_time = 0;
+    uint32_t previous_wall_time = 0;
+    for (size_t entry_index = kPerThreadBufSize - 1; entry_index > num_entries;) {
+      ReadStreamingEntry(
+          method_trace_buffer, &entry_index, &method, &action, &thread_time, &wall_time);
+      EnsureSpace(buffer.get(), &current_index, buffer_size, kMaxCompactRecordSize);
+      uint32_t method_index = art_method_id_map_.find(method)->second;
+      uint8_t* ptr = buffer.get() + current_index;
+      ptr = EncodeUnsignedLeb128(ptr, (method_index << TraceActionBits) | action);
+      if (UseThreadCpuClock()) {
+        ptr = EncodeSignedLeb128(ptr, static_cast<int32_t>(thread_time - previous_thread_time));
+        previous_thread_time = thread_time;
       }
-      wall_time = GetMicroTime(timestamp) - start_time_;
-    }
-
-    auto it = art_method_id_map_.find(method);
-    uint32_t method_index = 0;
-    // If we haven't seen this method before record information about the method.
-    if (it == art_method_id_map_.end()) {
-      art_method_id_map_.emplace(method, current_method_index_);
-      method_index = current_method_index_;
-      current_method_index_++;
-      // Write a special block with the name.
-      std::string method_line(GetMethodLine(method, method_index));
-      static constexpr size_t kMethodNameHeaderSize = 5;
-      uint8_t method_header[kMethodNameHeaderSize];
-      DCHECK_LT(kMethodNameHeaderSize, kPerThreadBufSize);
-      Append2LE(method_header, 0);
-      method_header[2] = kOpNewMethod;
-      DCHECK(method_line.length() < (1 << 16));
-      Append2LE(method_header + 3, static_cast<uint16_t>(method_line.length()));
-      WriteToBuf(method_header,
-                 kMethodNameHeaderSize,
-                 method_line,
-                 &current_index,
-                 buffer.get(),
-                 buffer_size);
-    } else {
-      method_index = it->second;
+      if (UseWallClock()) {
+        ptr = EncodeSignedLeb128(ptr, static_cast<int32_t>(wall_time - previous_wall_time));
+        previous_wall_time = wall_time;
+      }
+      current_index = ptr - buffer.get();
     }
-
+  } else {
     const size_t record_size = GetRecordSize(clock_source_);
     DCHECK_LT(record_size, kPerThreadBufSize);
-    EnsureSpace(buffer.get(), &current_index, buffer_size, record_size);
-    EncodeEventEntry(
-        buffer.get() + current_index, thread_id, method_index, action, thread_time, wall_time);
-    current_index += record_size;
+    for (size_t entry_index = kPerThreadBufSize - 1; entry_index > num_entries;) {
+      ReadStreamingEntry(
+          method_trace_buffer, &entry_index, &method, &action, &thread_time, &wall_time);
+      uint32_t method_index =
+          EncodeStreamingMethod(method, &current_index, buffer.get(), buffer_size);
+      EnsureSpace(buffer.get(), &current_index, buffer_size, record_size);
+      EncodeEventEntry(
+          buffer.get() + current_index, thread_id, method_index, action, thread_time, wall_time);
+      current_index += record_size;
+    }
   }
 
-  // Flush the contents of buffer to file.
-  if (!trace_file_->WriteFully(buffer.get(), current_index)) {
-    PLOG(WARNING) << "Failed streaming a tracing event.";
-  }
+  // Hand the contents of buffer over to the trace writer.
+  WriteStreamingData(std::move(buffer), current_index);
 }
 
 void Trace::RecordMethodEvent(Thread* thread,
@@ -1239,9 +1363,8 @@ void Trace::LogMethodTraceEvent(Thread* thread,
                                 TraceAction action,
                                 uint32_t thread_clock_diff,
                                 uint64_t timestamp_counter) {
-  // This method is called in both tracing modes (method and sampling). In sampling mode, this
-  // method is only called by the sampling thread. In method tracing mode, it can be called
-  // concurrently.
+  // This method is called in both tracing modes (method and sampling). In both modes, it can be
+  // called concurrently: in sampling mode, from the checkpoints recording the samples.
 
   // Ensure we always use the non-obsolete version of the method so that entry/exit events have the
   // same pointer value.
@@ -1285,9 +1408,7 @@ void Trace::EnsureSpace(uint8_t* buffer,
     return;
   }
 
-  if (!trace_file_->WriteFully(buffer, *current_index)) {
-    PLOG(WARNING) << "Failed streaming a tracing event.";
-  }
+  WriteStreamingData(buffer, *current_index);
   *current_index = 0;
 }
 
@@ -46,6 +46,7 @@ class ArtMethod;
 class DexFile;
 class ShadowFrame;
 class Thread;
+class ThreadPool;
 
 using DexIndexBitSet = std::bitset<65536>;
 
@@ -89,6 +90,20 @@ std::ostream& operator<<(std::ostream& os, TracingMode rhs);
 // 32 bits of microseconds is 70 minutes.
 //
 // All values are stored in little-endian order.
+//
+// In streaming mode, the version is or-ed with 0xF0 and method and thread names are written
+// inline as special records with a thread ID of 0. The compact streaming format (version or-ed
+// with 0xE0) writes the events of each flushed per-thread buffer as one special record:
+//     u2  0
+//     u1  op (4)
+//     u2  thread ID
+//     u4  number of events
+// followed by the events, each of which is:
+//     uleb128  method ID | method action
+//     sleb128  thread time delta from the previous event of the record (when using thread cpu)
+//     sleb128  wall time delta from the previous event of the record (when using wall clock)
+// The first event of a record is relative to zero. tools/stream-trace-converter.py converts
+// both streaming formats to the non-streaming format.
 
 enum TraceAction {
     kTraceMethodEnter = 0x00,       // method entry
@@ -122,6 +137,8 @@ class Trace final : public instrumentation::InstrumentationListener {
     kTraceCountAllocs = 0x001,
     kTraceClockSourceWallClock = 0x010,
     kTraceClockSourceThreadCpu = 0x100,
+    // Use the compact streaming format, see kOpCompactEvents. Only used in streaming mode.
+    kTraceCompactFormat = 0x1000,
   };
 
   enum class TraceOutputMode {
@@ -235,10 +252,6 @@ class Trace final : public instrumentation::InstrumentationListener {
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!tracing_lock_) override;
   void WatchedFramePop(Thread* thread, const ShadowFrame& frame)
       REQUIRES_SHARED(Locks::mutator_lock_) override;
-  // Reuse an old stack trace if it exists, otherwise allocate a new one.
-  static std::vector<ArtMethod*>* AllocStackTrace();
-  // Clear and store an old stack trace for later use.
-  static void FreeStackTrace(std::vector<ArtMethod*>* stack_trace);
   // Save id and name of a thread before it exits.
   static void StoreExitingThreadInfo(Thread* thread);
 
@@ -312,7 +325,23 @@ class Trace final : public instrumentation::InstrumentationListener {
                                   uint32_t thread_clock_diff,
                                   uint64_t timestamp) REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!tracing_lock_);
-  // This encodes all the events in the per-thread trace buffer and writes it to the trace file.
+  // Reads the entry of the per-thread trace buffer at entry_index, and moves entry_index to the
+  // next entry.
+  void ReadStreamingEntry(uintptr_t* method_trace_buffer,
+                          size_t* entry_index,
+                          /* out */ ArtMethod** method,
+                          /* out */ TraceAction* action,
+                          /* out */ uint32_t* thread_time,
+                          /* out */ uint32_t* wall_time);
+  // Returns the id of the method, and writes a record with its name to the buffer if it was not
+  // seen before.
+  uint32_t EncodeStreamingMethod(ArtMethod* method,
+                                 size_t* current_index,
+                                 uint8_t* buffer,
+                                 size_t buffer_size)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(tracing_lock_);
+  // This encodes all the events in the per-thread trace buffer and queues them for the trace
+  // writer thread.
   // This acquires streaming lock to prevent any other threads writing concurrently. It is required
   // to serialize these since each method is encoded with a unique id which is assigned when the
   // method is seen for the first time in the recoreded events. So we need to serialize these
@@ -326,7 +355,14 @@ class Trace final : public instrumentation::InstrumentationListener {
   void EnsureSpace(uint8_t* buffer,
                    size_t* current_index,
                    size_t buffer_size,
-                   size_t required_size);
+                   size_t required_size) REQUIRES(tracing_lock_);
+  // Queues data for the trace writer thread, which writes it to the trace file. If the writer
+  // falls behind, this waits for it to catch up.
+  void WriteStreamingData(const uint8_t* data, size_t size) REQUIRES(tracing_lock_);
+  void WriteStreamingData(std::unique_ptr<uint8_t[]>&& data, size_t size)
+      REQUIRES(tracing_lock_);
+  // Waits for the trace writer thread to write all the data queued so far.
+  void WaitForPendingWrites() REQUIRES(!tracing_lock_);
   // Writes header followed by data to the buffer at the current_index. This also updates the
   // current_index to point to the next entry.
   void WriteToBuf(uint8_t* header,
@@ -334,7 +370,7 @@ class Trace final : public instrumentation::InstrumentationListener {
                   const std::string& data,
                   size_t* current_index,
                   uint8_t* buffer,
-                  size_t buffer_size);
+                  size_t buffer_size) REQUIRES(tracing_lock_);
 
   uint32_t EncodeTraceMethod(ArtMethod* method) REQUIRES(tracing_lock_);
   ArtMethod* DecodeTraceMethod(uint32_t tmid) REQUIRES(tracing_lock_);
@@ -357,9 +393,6 @@ class Trace final : public instrumentation::InstrumentationListener {
   // Sampling thread, non-zero when sampling.
   static pthread_t sampling_pthread_;
 
-  // Used to remember an unused stack trace to avoid re-allocation during sampling.
-  static std::unique_ptr<std::vector<ArtMethod*>> temp_stack_trace_;
-
   // File to write trace data out to, null if direct to ddms.
   std::unique_ptr<File> trace_file_;
 
@@ -378,6 +411,9 @@ class Trace final : public instrumentation::InstrumentationListener {
   // The tracing method.
   const TraceMode trace_mode_;
 
+  // Whether the streaming output uses the compact format.
+  const bool compact_format_;
+
   const TraceClockSource clock_source_;
 
   // Size of buf_.
@@ -402,9 +438,9 @@ class Trace final : public instrumentation::InstrumentationListener {
   // so cur_offset_ can move forwards and backwards.
   //
   // When not in streaming mode, the buf_ writes can come from
-  // multiple threads when the trace mode is kMethodTracing. When
-  // trace mode is kSampling, writes only come from the sampling
-  // thread.
+  // multiple threads in both trace modes. When trace mode is
+  // kSampling, they come from the checkpoints recording the samples,
+  // which the sampling thread waits for.
   //
   // Reads to the buffer happen after the event sources writing to the
   // buffer have been shutdown and all stores have completed. The
@@ -428,6 +464,9 @@ class Trace final : public instrumentation::InstrumentationListener {
   // Streaming mode data.
   Mutex tracing_lock_;
 
+  // Thread writing the flushed per-thread buffers to trace_file_ in streaming mode.
+  std::unique_ptr<ThreadPool> trace_writer_pool_;
+
   // Map from ArtMethod* to index.
   std::unordered_map<ArtMethod*, uint32_t> art_method_id_map_ GUARDED_BY(tracing_lock_);
   uint32_t current_method_index_ = 0;
@@ -706,36 +706,75 @@ bool VerifierDeps::VerifyAssignability(Handle<mirror::ClassLoader> class_loader,
                                        const std::vector<std::set<TypeAssignability>>& assignables,
                                        Thread* self,
                                        /* out */ std::string* error_msg) const {
+  for (const auto& vec : assignables) {
+    if (!VerifyClassAssignability(class_loader, dex_file, vec, self, error_msg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool VerifierDeps::VerifyClassAssignability(Handle<mirror::ClassLoader> class_loader,
+                                            const DexFile& dex_file,
+                                            const std::set<TypeAssignability>& assignables,
+                                            Thread* self,
+                                            /* out */ std::string* error_msg) const {
   StackHandleScope<2> hs(self);
   ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   MutableHandle<mirror::Class> source(hs.NewHandle<mirror::Class>(nullptr));
   MutableHandle<mirror::Class> destination(hs.NewHandle<mirror::Class>(nullptr));
 
-  for (const auto& vec : assignables) {
-    for (const auto& entry : vec) {
-      const std::string& destination_desc = GetStringFromId(dex_file, entry.GetDestination());
-      destination.Assign(
-          FindClassAndClearException(class_linker, self, destination_desc, class_loader));
-      const std::string& source_desc = GetStringFromId(dex_file, entry.GetSource());
-      source.Assign(FindClassAndClearException(class_linker, self, source_desc, class_loader));
-
-      if (destination == nullptr || source == nullptr) {
-        // We currently don't use assignability information for unresolved
-        // types, as the status of the class using unresolved types will be soft
-        // fail in the vdex.
-        continue;
-      }
+  for (const auto& entry : assignables) {
+    const std::string& destination_desc = GetStringFromId(dex_file, entry.GetDestination());
+    destination.Assign(
+        FindClassAndClearException(class_linker, self, destination_desc, class_loader));
+    const std::string& source_desc = GetStringFromId(dex_file, entry.GetSource());
+    source.Assign(FindClassAndClearException(class_linker, self, source_desc, class_loader));
+
+    if (destination == nullptr || source == nullptr) {
+      // We currently don't use assignability information for unresolved
+      // types, as the status of the class using unresolved types will be soft
+      // fail in the vdex.
+      continue;
+    }
 
-      DCHECK(destination->IsResolved() && source->IsResolved());
-      if (!destination->IsAssignableFrom(source.Get())) {
-        *error_msg = "Class " + destination_desc + " not assignable from " + source_desc;
-        return false;
-      }
+    DCHECK(destination->IsResolved() && source->IsResolved());
+    if (!destination->IsAssignableFrom(source.Get())) {
+      *error_msg = "Class " + destination_desc + " not assignable from " + source_desc;
+      return false;
     }
   }
   return true;
 }
 
+size_t VerifierDeps::ValidateDependenciesPerClass(
+    Thread* self,
+    Handle<mirror::ClassLoader> class_loader,
+    const std::vector<const DexFile*>& dex_files,
+    /* out */ std::vector<std::vector<bool>>* invalid_classes,
+    /* out */ std::string* error_msg) const {
+  size_t num_invalid_classes = 0u;
+  invalid_classes->clear();
+  invalid_classes->reserve(dex_files.size());
+  for (const DexFile* dex_file : dex_files) {
+    const DexFileDeps* my_deps = GetDexFileDeps(*dex_file);
+    invalid_classes->emplace_back(dex_file->NumClassDefs(), false);
+    std::vector<bool>& invalid = invalid_classes->back();
+    for (size_t i = 0, size = my_deps->assignable_types_.size(); i != size; ++i) {
+      std::string class_error_msg;
+      if (!VerifyClassAssignability(
+              class_loader, *dex_file, my_deps->assignable_types_[i], self, &class_error_msg)) {
+        if (num_invalid_classes == 0u) {
+          *error_msg = class_error_msg;
+        }
+        invalid[i] = true;
+        ++num_invalid_classes;
+      }
+    }
+  }
+  return num_invalid_classes;
+}
+
 void VerifierDeps::ClearData(const std::vector<const DexFile*>& dex_files) {
   for (const DexFile* dex_file : dex_files) {
     auto it = dex_deps_.find(dex_file);
@@ -747,6 +786,18 @@ void VerifierDeps::ClearData(const std::vector<const DexFile*>& dex_files) {
   }
 }
 
+void VerifierDeps::ClearClassData(const DexFile& dex_file, const std::vector<bool>& classes) {
+  DexFileDeps* deps = GetDexFileDeps(dex_file);
+  DCHECK(deps != nullptr);
+  DCHECK_EQ(classes.size(), deps->verified_classes_.size());
+  for (size_t i = 0, size = classes.size(); i != size; ++i) {
+    if (classes[i]) {
+      deps->assignable_types_[i].clear();
+      deps->verified_classes_[i] = false;
+    }
+  }
+}
+
 bool VerifierDeps::VerifyDexFile(Handle<mirror::ClassLoader> class_loader,
                                  const DexFile& dex_file,
                                  const DexFileDeps& deps,
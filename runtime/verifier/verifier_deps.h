@@ -121,6 +121,16 @@ class VerifierDeps {
                             /* out */ std::string* error_msg) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Verify the encoded dependencies class by class. For each dex file, `invalid_classes` is
+  // set to the class def indices whose dependencies no longer hold. Returns the number of such
+  // classes. `error_msg` receives the reason of the first failure.
+  size_t ValidateDependenciesPerClass(Thread* self,
+                                      Handle<mirror::ClassLoader> class_loader,
+                                      const std::vector<const DexFile*>& dex_files,
+                                      /* out */ std::vector<std::vector<bool>>* invalid_classes,
+                                      /* out */ std::string* error_msg) const
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   const std::vector<bool>& GetVerifiedClasses(const DexFile& dex_file) const {
     return GetDexFileDeps(dex_file)->verified_classes_;
   }
@@ -140,6 +150,10 @@ class VerifierDeps {
   // Resets the data related to the given dex files.
   void ClearData(const std::vector<const DexFile*>& dex_files);
 
+  // Resets the data related to the classes of `dex_file` set in `classes`, so that they can be
+  // verified again.
+  void ClearClassData(const DexFile& dex_file, const std::vector<bool>& classes);
+
   // Parses raw VerifierDeps data to extract bitvectors of which class def indices
   // were verified or not. The given `dex_files` must match the order and count of
   // dex files used to create the VerifierDeps.
@@ -250,6 +264,14 @@ class VerifierDeps {
                            /* out */ std::string* error_msg) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Verify the assignability dependencies recorded for a single class def.
+  bool VerifyClassAssignability(Handle<mirror::ClassLoader> class_loader,
+                                const DexFile& dex_file,
+                                const std::set<TypeAssignability>& assignables,
+                                Thread* self,
+                                /* out */ std::string* error_msg) const
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Map from DexFiles into dependencies collected from verification of their methods.
   std::map<const DexFile*, std::unique_ptr<DexFileDeps>> dex_deps_;
 
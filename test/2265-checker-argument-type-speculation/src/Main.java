@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+abstract class Base {
+  int field = 42;
+  abstract int get();
+}
+
+class A extends Base {
+  int get() { return 1; }
+}
+
+class B extends Base {
+  int get() { return 2; }
+}
+
+public class Main {
+
+  // Arguments are only profiled by the arm64 and x86_64 baseline code generators.
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.$noinline$monomorphic(Base) argument_type_speculation (before)
+  /// CHECK-NOT:   Deoptimize
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.$noinline$monomorphic(Base) argument_type_speculation (after)
+  /// CHECK:       Deoptimize
+  /// CHECK:       Deoptimize
+  /// CHECK:       BoundType klass:A can_be_null:false exact:true
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.$noinline$monomorphic(Base) inliner (after)
+  /// CHECK-NOT:   InvokeVirtual
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.$noinline$monomorphic(Base) instruction_simplifier$after_inlining (after)
+  /// CHECK-NOT:   NullCheck
+
+  public static int $noinline$monomorphic(Base b) {
+    return b.get();
+  }
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.$noinline$polymorphic(Base) argument_type_speculation (after)
+  /// CHECK:       Deoptimize
+  /// CHECK-NOT:   Deoptimize
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.$noinline$polymorphic(Base) argument_type_speculation (after)
+  /// CHECK:       BoundType klass:Base can_be_null:false exact:false
+
+  public static int $noinline$polymorphic(Base b) {
+    return b.field;
+  }
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.$noinline$seenNull(Base) argument_type_speculation (after)
+  /// CHECK-NOT:   Deoptimize
+
+  public static int $noinline$seenNull(Base b) {
+    return (b == null) ? -1 : b.field;
+  }
+
+  public static int $noinline$deoptimize(Base b) {
+    return (b == null) ? -1 : b.field;
+  }
+
+  public static void testSpeculation() {
+    ensureJitBaselineCompiled(Main.class, "$noinline$monomorphic");
+    ensureJitBaselineCompiled(Main.class, "$noinline$polymorphic");
+    ensureJitBaselineCompiled(Main.class, "$noinline$seenNull");
+    for (int i = 0; i < 1000; i++) {
+      $noinline$monomorphic(a);
+      $noinline$polymorphic(a);
+      $noinline$polymorphic(b);
+      $noinline$seenNull(null);
+      $noinline$seenNull(a);
+    }
+    ensureJitCompiled(Main.class, "$noinline$monomorphic");
+    ensureJitCompiled(Main.class, "$noinline$polymorphic");
+    ensureJitCompiled(Main.class, "$noinline$seenNull");
+
+    expectEquals(1, $noinline$monomorphic(a));
+    expectEquals(42, $noinline$polymorphic(b));
+    expectEquals(-1, $noinline$seenNull(null));
+  }
+
+  public static void testNoSpeculationAfterDeoptimization() {
+    if (!hasJit() || !profilesArguments()) {
+      return;
+    }
+    ensureJitBaselineCompiled(Main.class, "$noinline$deoptimize");
+    for (int i = 0; i < 1000; i++) {
+      $noinline$deoptimize(a);
+    }
+    ensureJitCompiled(Main.class, "$noinline$deoptimize");
+
+    // The argument was never null, so the optimized code deoptimizes on null.
+    int deoptimizations = numberOfDeoptimizations();
+    expectEquals(-1, $noinline$deoptimize(null));
+    expectEquals(deoptimizations + 1, numberOfDeoptimizations());
+    if (hasJitCompiledEntrypoint(Main.class, "$noinline$deoptimize")) {
+      throw new Error("Expected the optimized code to be invalidated");
+    }
+
+    // The recompiled code must not speculate on the argument again.
+    ensureJitCompiled(Main.class, "$noinline$deoptimize");
+    deoptimizations = numberOfDeoptimizations();
+    expectEquals(-1, $noinline$deoptimize(null));
+    expectEquals(42, $noinline$deoptimize(a));
+    expectEquals(deoptimizations, numberOfDeoptimizations());
+    if (!hasJitCompiledEntrypoint(Main.class, "$noinline$deoptimize")) {
+      throw new Error("Expected the recompiled code to be used");
+    }
+  }
+
+  private static boolean profilesArguments() {
+    String arch = System.getProperty("os.arch");
+    return arch.equals("aarch64") || arch.equals("x86_64") || arch.equals("amd64");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  public static void main(String[] args) {
+    System.loadLibrary(args[0]);
+    testSpeculation();
+    testNoSpeculationAfterDeoptimization();
+  }
+
+  static A a = new A();
+  static B b = new B();
+
+  private static native boolean hasJit();
+  private static native boolean hasJitCompiledEntrypoint(Class<?> cls, String methodName);
+  private static native int numberOfDeoptimizations();
+  private static native void ensureJitBaselineCompiled(Class<?> cls, String methodName);
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
@@ -0,0 +1,26 @@
+#!/bin/bash
+#
+# Copyright (C) 2023 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+def run(ctx, args):
+  # Method handle targets are only inlined by the JIT, so the Checker stanzas are checked
+  # against the JIT compilation. Use a high threshold so that the method is only compiled
+  # when the test asks for it, and pass --verbose-methods to only generate its CFG.
+  ctx.default_run(
+      args,
+      jit=True,
+      runtime_option=["-Xjitinitialsize:32M", "-Xjitthreshold:10000"],
+      Xcompiler_option=["--verbose-methods=$noinline$invokeExact"])
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.invoke.MethodHandle;
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.MethodType;
+import java.lang.reflect.Field;
+import java.lang.reflect.Method;
+import sun.misc.Unsafe;
+
+public class Main {
+
+  static final MethodHandle HANDLE;
+
+  static {
+    try {
+      HANDLE = MethodHandles.lookup().findStatic(
+          Main.class, "add", MethodType.methodType(int.class, int.class, int.class));
+    } catch (ReflectiveOperationException e) {
+      throw new Error(e);
+    }
+  }
+
+  public static int add(int a, int b) {
+    return a + b;
+  }
+
+  public static int sub(int a, int b) {
+    return a - b;
+  }
+
+  /// CHECK-START: int Main.$noinline$invokeExact(int, int) inliner (before)
+  /// CHECK:       InvokePolymorphic
+
+  /// CHECK-START: int Main.$noinline$invokeExact(int, int) inliner (after)
+  /// CHECK-DAG:   <<Handle:l\d+>> StaticFieldGet field_name:Main.HANDLE
+  /// CHECK-DAG:   <<Target:j\d+>> InstanceFieldGet [<<Handle>>] field_name:java.lang.invoke.MethodHandle.artFieldOrMethod
+  /// CHECK-DAG:   <<Guard:z\d+>>  NotEqual [<<Target>>,{{j\d+}}]
+  /// CHECK-DAG:                   If [<<Guard>>]
+  /// CHECK-DAG:   <<Slow:i\d+>>   InvokePolymorphic
+  /// CHECK-DAG:   <<Fast:i\d+>>   Add
+  /// CHECK-DAG:                   Phi [<<Fast>>,<<Slow>>]
+
+  /// CHECK-START: int Main.$noinline$invokeExact(int, int) inliner (after)
+  /// CHECK-NOT:   InvokeStaticOrDirect method_name:Main.add
+
+  public static int $noinline$invokeExact(int a, int b) throws Throwable {
+    return (int) HANDLE.invokeExact(a, b);
+  }
+
+  public static void testInlining() throws Throwable {
+    for (int i = 0; i < 1000; i++) {
+      expectEquals(3, $noinline$invokeExact(1, 2));
+    }
+    ensureJitCompiled(Main.class, "$noinline$invokeExact");
+    expectEquals(3, $noinline$invokeExact(1, 2));
+  }
+
+  public static void testGuardFallsBack() throws Throwable {
+    if (!hasJit()) {
+      return;
+    }
+    // Retarget the final field. The compiled code must notice through its guard and
+    // invoke the new handle instead of the inlined `add`.
+    MethodHandle sub = MethodHandles.lookup().findStatic(
+        Main.class, "sub", MethodType.methodType(int.class, int.class, int.class));
+    setStaticFinalField(Main.class.getDeclaredField("HANDLE"), sub);
+    expectEquals(-1, $noinline$invokeExact(1, 2));
+    if (!hasJitCompiledEntrypoint(Main.class, "$noinline$invokeExact")) {
+      throw new Error("Expected the compiled code to handle the new target");
+    }
+  }
+
+  private static void setStaticFinalField(Field field, Object value) throws Throwable {
+    Field unsafeField = Unsafe.class.getDeclaredField("theUnsafe");
+    unsafeField.setAccessible(true);
+    Unsafe unsafe = (Unsafe) unsafeField.get(null);
+    // Static fields live in the class object; their offset is not exposed by sun.misc.Unsafe.
+    Method getOffset = Field.class.getDeclaredMethod("getOffset");
+    unsafe.putObject(field.getDeclaringClass(), (int) getOffset.invoke(field), value);
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  public static void main(String[] args) throws Throwable {
+    System.loadLibrary(args[0]);
+    testInlining();
+    testGuardFallsBack();
+  }
+
+  private static native boolean hasJit();
+  private static native boolean hasJitCompiledEntrypoint(Class<?> cls, String methodName);
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Field;
+
+public class Main {
+  // Must match -Xthrowable-stack-trace-depth in run.py.
+  private static final int MAX_DEPTH = 8;
+
+  private static Throwable $noinline$recurse(int depth) {
+    if (depth == 0) {
+      return new Throwable();
+    }
+    return $noinline$recurse(depth - 1);
+  }
+
+  public static void testDepth() {
+    StackTraceElement[] trace = $noinline$recurse(2 * MAX_DEPTH).getStackTrace();
+    // The limit does not apply to debuggable runtimes, see Thread::CreateThrowableStackTrace.
+    if (isDebuggable()) {
+      expectTrue(trace.length > 2 * MAX_DEPTH);
+      return;
+    }
+    expectEquals(MAX_DEPTH, trace.length);
+    for (StackTraceElement element : trace) {
+      expectEquals("$noinline$recurse", element.getMethodName());
+    }
+
+    // Shorter stacks are not affected.
+    trace = new Throwable().getStackTrace();
+    expectEquals(2, trace.length);
+    expectEquals("testDepth", trace[0].getMethodName());
+    expectEquals("main", trace[1].getMethodName());
+  }
+
+  public static void testReuse() throws Exception {
+    Field backtrace = Throwable.class.getDeclaredField("backtrace");
+    backtrace.setAccessible(true);
+
+    Throwable[] throwables = new Throwable[3];
+    for (int i = 0; i < 2; ++i) {
+      throwables[i] = new Throwable();
+    }
+    // Throwables created from identical stacks share their internal trace.
+    expectSame(backtrace.get(throwables[0]), backtrace.get(throwables[1]));
+
+    // A Throwable from a different dex pc gets its own trace.
+    Throwable other = new Throwable();
+    expectNotSame(backtrace.get(throwables[0]), backtrace.get(other));
+    expectEquals(throwables[0].getStackTrace().length, other.getStackTrace().length);
+    expectNotEquals(throwables[0].getStackTrace()[0].getLineNumber(),
+                    other.getStackTrace()[0].getLineNumber());
+
+    // The reusable trace is a weak reference. The GC updates it while the trace is alive,
+    // possibly moving it...
+    for (int i = 0; i < 2; ++i) {
+      if (i == 1) {
+        Runtime.getRuntime().gc();
+      }
+      throwables[i] = new Throwable();
+    }
+    expectSame(backtrace.get(throwables[0]), backtrace.get(throwables[1]));
+    StackTraceElement[] trace = throwables[1].getStackTrace();
+    expectEquals("testReuse", trace[0].getMethodName());
+
+    // ... and clears it once it is unreachable, after which new traces are created as usual.
+    throwables[0] = null;
+    throwables[1] = null;
+    other = null;
+    Runtime.getRuntime().gc();
+    for (int i = 0; i < 2; ++i) {
+      throwables[i] = new Throwable();
+    }
+    expectSame(backtrace.get(throwables[0]), backtrace.get(throwables[1]));
+    expectEquals("testReuse", throwables[1].getStackTrace()[0].getMethodName());
+  }
+
+  private static void expectTrue(boolean value) {
+    if (!value) {
+      throw new Error("Expected true");
+    }
+  }
+
+  private static void expectEquals(Object expected, Object result) {
+    if (!expected.equals(result)) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectNotEquals(Object unexpected, Object result) {
+    if (unexpected.equals(result)) {
+      throw new Error("Did not expect: " + result);
+    }
+  }
+
+  private static void expectSame(Object expected, Object result) {
+    if (expected != result) {
+      throw new Error("Expected the same object: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectNotSame(Object unexpected, Object result) {
+    if (unexpected == result) {
+      throw new Error("Did not expect the same object: " + result);
+    }
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    testDepth();
+    testReuse();
+  }
+
+  private static native boolean isDebuggable();
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.io.File;
+import java.io.FileDescriptor;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.lang.reflect.Method;
+
+public class Main {
+    private static final String TEMP_FILE_NAME_PREFIX = "test";
+    private static final String TEMP_FILE_NAME_SUFFIX = ".trace";
+    private static final int WALL_CLOCK_FLAG = 0x010;
+    // Trace::TraceFlag::kTraceCompactFormat, the flag selected by -Xmethod-trace-compact.
+    private static final int COMPACT_FORMAT_FLAG = 0x1000;
+    private static final String THREAD_NAME = "TestThread2268";
+
+    public static void main(String[] args) throws Exception {
+        System.loadLibrary(args[0]);
+        String name = System.getProperty("java.vm.name");
+        if (!"Dalvik".equals(name)) {
+            System.out.println("This test is not supported on " + name);
+            return;
+        }
+
+        ensureJitCompiled(Main.class, "$noinline$doSomeWorkJIT");
+
+        System.out.println("***** compact streaming test - dual clock *******");
+        testCompactTracing(/* flags= */ 0,
+                BaseTraceParser.STREAMING_DUAL_CLOCK_VERSION,
+                BaseTraceParser.COMPACT_DUAL_CLOCK_VERSION);
+
+        System.out.println("***** compact streaming test - wall clock *******");
+        testCompactTracing(/* flags= */ WALL_CLOCK_FLAG,
+                BaseTraceParser.STREAMING_WALL_CLOCK_VERSION,
+                BaseTraceParser.COMPACT_WALL_CLOCK_VERSION);
+    }
+
+    // Trace the same code in the regular and the compact streaming formats, on a new thread
+    // and on the main thread, and check that both traces have the same events.
+    public static void testCompactTracing(int flags, int version, int compactVersion)
+            throws Exception {
+        if (VMDebug.getMethodTracingMode() != 0) {
+            VMDebug.$noinline$stopMethodTracing();
+        }
+
+        String events = traceOnNewThread(flags, version);
+        String compactEvents = traceOnNewThread(flags | COMPACT_FORMAT_FLAG, compactVersion);
+        checkSameEvents(THREAD_NAME, events, compactEvents);
+
+        events = traceWork(flags, version, "main");
+        compactEvents = traceWork(flags | COMPACT_FORMAT_FLAG, compactVersion, "main");
+        checkSameEvents("main", events, compactEvents);
+    }
+
+    private static String traceOnNewThread(int flags, int version) throws Exception {
+        String[] events = new String[1];
+        Thread t = new Thread(() -> {
+            try {
+                events[0] = traceWork(flags, version, THREAD_NAME);
+            } catch (Exception e) {
+                System.out.println("Exception in thread " + e);
+                e.printStackTrace();
+            }
+        }, THREAD_NAME);
+        t.start();
+        t.join();
+        return events[0];
+    }
+
+    // Returns the events traced on the current thread, named `threadName`.
+    private static String traceWork(int flags, int version, String threadName) throws Exception {
+        File file = createTempFile();
+        try {
+            FileOutputStream out_file = new FileOutputStream(file);
+            VMDebug.startMethodTracing(
+                    file.getPath(), out_file.getFD(), 0, flags, false, 0, /* streaming= */ true);
+            Main m = new Main();
+            m.$noinline$doSomeWork();
+            // Call JITed code multiple times to flush out any issues with timestamps.
+            for (int i = 0; i < 20; i++) {
+                m.$noinline$doSomeWorkJIT();
+            }
+            m.doSomeWorkThrow();
+            VMDebug.$noinline$stopMethodTracing();
+            out_file.close();
+            return new StreamTraceParser().CheckTraceFileFormat(file, version, threadName);
+        } finally {
+            file.delete();
+        }
+    }
+
+    private static void checkSameEvents(String threadName, String events, String compactEvents) {
+        if (events == null || compactEvents == null) {
+            return;
+        }
+        if (!compactEvents.equals(events)) {
+            System.out.println(threadName + ": compact trace differs from the regular trace");
+            System.out.println("Regular trace:");
+            System.out.println(events);
+            System.out.println("Compact trace:");
+            System.out.println(compactEvents);
+            return;
+        }
+        // Also check that the traces are not both empty or both truncated.
+        String leafCall = ">> " + threadName + " Main callLeafFunction ";
+        int numLeafCalls = 0;
+        for (int index = compactEvents.indexOf(leafCall);
+                index != -1;
+                index = compactEvents.indexOf(leafCall, index + 1)) {
+            numLeafCalls++;
+        }
+        System.out.println(threadName + ": compact trace matches the regular trace, "
+                + numLeafCalls + " calls to callLeafFunction");
+    }
+
+    private static File createTempFile() throws Exception {
+        try {
+            return File.createTempFile(TEMP_FILE_NAME_PREFIX, TEMP_FILE_NAME_SUFFIX);
+        } catch (IOException e) {
+            System.setProperty("java.io.tmpdir", "/data/local/tmp");
+            try {
+                return File.createTempFile(TEMP_FILE_NAME_PREFIX, TEMP_FILE_NAME_SUFFIX);
+            } catch (IOException e2) {
+                System.setProperty("java.io.tmpdir", "/sdcard");
+                return File.createTempFile(TEMP_FILE_NAME_PREFIX, TEMP_FILE_NAME_SUFFIX);
+            }
+        }
+    }
+
+    public void callOuterFunction() {
+        callLeafFunction();
+    }
+
+    public void callLeafFunction() {}
+
+    public void $noinline$doSomeWork() {
+        callOuterFunction();
+        callLeafFunction();
+    }
+
+    public void $noinline$doSomeWorkJIT() {
+        callOuterFunction();
+        callLeafFunction();
+    }
+
+    public void callThrowFunction() throws Exception {
+        throw new Exception("test");
+    }
+
+    public void doSomeWorkThrow() {
+        try {
+            callThrowFunction();
+        } catch (Exception e) {
+        }
+    }
+
+    private static class VMDebug {
+        private static final Method startMethodTracingMethod;
+        private static final Method stopMethodTracingMethod;
+        private static final Method getMethodTracingModeMethod;
+        static {
+            try {
+                Class<?> c = Class.forName("dalvik.system.VMDebug");
+                startMethodTracingMethod = c.getDeclaredMethod("startMethodTracing", String.class,
+                        FileDescriptor.class, Integer.TYPE, Integer.TYPE, Boolean.TYPE,
+                        Integer.TYPE, Boolean.TYPE);
+                stopMethodTracingMethod = c.getDeclaredMethod("stopMethodTracing");
+                getMethodTracingModeMethod = c.getDeclaredMethod("getMethodTracingMode");
+            } catch (Exception e) {
+                throw new RuntimeException(e);
+            }
+        }
+
+        public static void startMethodTracing(String filename, FileDescriptor fd, int bufferSize,
+                int flags, boolean samplingEnabled, int intervalUs, boolean streaming)
+                throws Exception {
+            startMethodTracingMethod.invoke(
+                    null, filename, fd, bufferSize, flags, samplingEnabled, intervalUs, streaming);
+        }
+        public static void $noinline$stopMethodTracing() throws Exception {
+            stopMethodTracingMethod.invoke(null);
+        }
+        public static int getMethodTracingMode() throws Exception {
+            return (int) getMethodTracingModeMethod.invoke(null);
+        }
+    }
+
+    private static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.io.File;
+import java.io.IOException;
+
+// Parses regular and compact streaming traces. The events of compact traces are expanded the
+// same way tools/stream-trace-converter.py does, so both formats give the same events.
+public class StreamTraceParser extends BaseTraceParser {
+
+    // Returns the events of the thread named `threadName`, up to the end of method tracing.
+    public String CheckTraceFileFormat(File file,
+        int expectedVersion, String threadName) throws Exception {
+        InitializeParser(file);
+        seenStopTracingMethod = false;
+
+        validateTraceHeader(expectedVersion);
+        boolean compact = (expectedVersion & 0xF0) == 0xE0;
+        boolean hasEntries = true;
+        while (hasEntries) {
+            int threadId = GetThreadID();
+            if (threadId != 0) {
+                if (compact) {
+                    throw new Exception("Unexpected regular event in a compact trace");
+                }
+                String eventString = ProcessEventEntry(threadId);
+                RecordEvent(threadId, eventString, threadName);
+            } else {
+                int headerType = GetEntryHeader();
+                switch (headerType) {
+                    case 1:
+                        ProcessMethodInfoEntry();
+                        break;
+                    case 2:
+                        ProcessThreadInfoEntry();
+                        break;
+                    case 3:
+                        hasEntries = false;
+                        break;
+                    case 4:
+                        if (!compact) {
+                            throw new Exception("Unexpected compact events in a regular trace");
+                        }
+                        ProcessCompactEventsEntry(threadName);
+                        break;
+                    default:
+                        System.out.println("Unexpected header in the trace " + headerType);
+                }
+            }
+        }
+        closeFile();
+
+        String events = threadEventsMap.get(threadName);
+        return (events != null) ? events : "";
+    }
+
+    public void ProcessCompactEventsEntry(String threadName) throws Exception {
+        // Read 2-byte thread id
+        int threadId = readNumber(2);
+        // Read 4-byte number of events
+        int numEvents = readNumber(4);
+        // Timestamps are encoded as deltas from the previous event of the entry.
+        int timestamp1 = 0;
+        int timestamp2 = 0;
+        for (int i = 0; i < numEvents; i++) {
+            int methodAndEvent = readUnsignedLeb128();
+            timestamp1 += readSignedLeb128();
+            if (traceFormatVersion != 2) {
+                timestamp2 += readSignedLeb128();
+            }
+            String eventString = ProcessEvent(threadId, methodAndEvent, timestamp1, timestamp2);
+            RecordEvent(threadId, eventString, threadName);
+        }
+    }
+
+    private void RecordEvent(int threadId, String eventString, String threadName)
+            throws Exception {
+        if (!ShouldCheckThread(threadId, threadName)) {
+            return;
+        }
+        // Ignore events after method tracing was stopped. The code that is executed
+        // later could be non-deterministic.
+        if (!seenStopTracingMethod) {
+            UpdateThreadEvents(threadId, eventString);
+        }
+        if (eventString.contains("Main$VMDebug $noinline$stopMethodTracing")) {
+            seenStopTracingMethod = true;
+        }
+    }
+
+    private boolean seenStopTracingMethod = false;
+}
@@ -288,6 +288,33 @@ public class Main {
     }
   }
 
+  /// CHECK-START: void Main.earlyExit(int[], int[]) BCE (before)
+  /// CHECK-DAG: BoundsCheck loop:<<Loop:B\d+>>
+  /// CHECK-DAG: BoundsCheck loop:<<Loop>>
+  //
+  /// CHECK-START: void Main.earlyExit(int[], int[]) BCE (after)
+  /// CHECK-DAG: <<Phi1:i\d+>> Phi                             loop:<<Loop1:B\d+>>
+  /// CHECK-DAG:               ArrayGet [{{l\d+}},<<Phi1>>]    loop:<<Loop1>>
+  /// CHECK-DAG: <<Phi2:i\d+>> Phi                             loop:<<Loop2:B\d+>>
+  /// CHECK-DAG: <<Bnd:i\d+>>  BoundsCheck [<<Phi2>>,{{i\d+}}] loop:<<Loop2>>
+  /// CHECK-DAG:               ArrayGet [{{l\d+}},<<Bnd>>]     loop:<<Loop2>>
+  //
+  /// CHECK-START: void Main.earlyExit(int[], int[]) BCE (after)
+  /// CHECK-NOT: Deoptimize
+  public static void earlyExit(int[] a, int[] b) {
+    if (b.length == 0) {
+      return;
+    }
+    // Dynamic bce on b versions the loop rather than deoptimizing,
+    // since the loop may exit before reaching the end of b.
+    for (int i = 0; i < a.length; i++) {
+      if (b[i] == 0) {
+        break;
+      }
+      a[i] = b[i];
+    }
+  }
+
   //
   // Verifier.
   //
@@ -401,6 +428,22 @@ public class Main {
       expectEquals(888, a[i]);
     }
 
+    earlyExit(a, b);
+    for (int i = 0; i < a.length; i++) {
+      expectEquals(i + 1, a[i]);
+    }
+    int b2[] = { 100, 0 };
+    earlyExit(a, b2);
+    expectEquals(100, a[0]);
+    for (int i = 1; i < a.length; i++) {
+      expectEquals(i + 1, a[i]);
+    }
+    try {
+      earlyExit(a, b1);
+      throw new Error("Should throw AIOOBE");
+    } catch (ArrayIndexOutOfBoundsException e) {
+    }
+
     System.out.println("passed");
   }
 
@@ -244,6 +244,39 @@ public class SimdInt {
       a[i] >>>= $opt$inline$IntConstantMinus254();  // 2, since & 31
   }
 
+  //
+  // If-converted operations.
+  //
+
+  /// CHECK-START: void SimdInt.select(int) loop_optimization (before)
+  /// CHECK-DAG: ArrayGet loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: Select   loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: ArraySet loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START-{X86_64,ARM64}: void SimdInt.select(int) loop_optimization (after)
+  /// CHECK-IF:     hasIsaFeature("sve")
+  //
+  ///     CHECK-DAG: <<LoopP:j\d+>> VecPredWhile                                           loop:<<Loop:B\d+>> outer_loop:none
+  ///     CHECK-DAG: <<Get:d\d+>>   VecLoad                                                loop:<<Loop>>      outer_loop:none
+  ///     CHECK-DAG: <<Cond:d\d+>>  VecCondition [{{d\d+}},<<Get>>,<<LoopP>>] condition:GT   loop:<<Loop>>      outer_loop:none
+  ///     CHECK-DAG: <<Sel:d\d+>>   VecSelect [<<Cond>>,{{d\d+}},{{d\d+}},<<LoopP>>]         loop:<<Loop>>      outer_loop:none
+  ///     CHECK-DAG:                 VecStore [{{l\d+}},{{i\d+}},<<Sel>>,<<LoopP>>]          loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-ELSE:
+  //
+  ///     CHECK-DAG: <<Get:d\d+>>  VecLoad                                         loop:<<Loop:B\d+>> outer_loop:none
+  ///     CHECK-DAG: <<Cond:d\d+>> VecCondition [{{d\d+}},<<Get>>] condition:GT     loop:<<Loop>>      outer_loop:none
+  ///     CHECK-DAG: <<Sel:d\d+>>  VecSelect [<<Cond>>,{{d\d+}},{{d\d+}}]           loop:<<Loop>>      outer_loop:none
+  ///     CHECK-DAG:                VecStore [{{l\d+}},{{i\d+}},<<Sel>>]            loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-FI:
+  static void select(int x) {
+    for (int i = 0; i < 128; i++) {
+      int v = a[i];
+      a[i] = v < x ? -v : v + 1;
+    }
+  }
+
   //
   // Loop bounds.
   //
@@ -324,6 +357,14 @@ public class SimdInt {
     for (int i = 0; i < 128; i++) {
       expectEquals(0xf8000000, a[i], "not");
     }
+    // If-converted operations.
+    for (int i = 0; i < 128; i++) {
+      a[i] = i - 64;
+    }
+    select(0);
+    for (int i = 0; i < 128; i++) {
+      expectEquals(i < 64 ? 64 - i : i - 63, a[i], "select");
+    }
     // Done.
     System.out.println("SimdInt passed");
   }
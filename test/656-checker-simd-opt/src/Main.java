@@ -156,6 +156,26 @@ public class Main {
     }
   }
 
+  /// CHECK-START-{X86_64,ARM64}: void Main.$noinline$stencilTwoSources(int[], int[], int[], int) loop_optimization (after)
+  /// CHECK-DAG: <<C0:i\d+>>    IntConstant 0
+  /// CHECK-DAG: <<Arr0:l\d+>>  ParameterValue
+  /// CHECK-DAG: <<Arr1:l\d+>>  ParameterValue
+  /// CHECK-DAG: <<Arr2:l\d+>>  ParameterValue
+  /// CHECK-DAG: <<Ch1:z\d+>>   NotEqual [<<Arr0>>,<<Arr1>>]         loop:none
+  /// CHECK-DAG: <<Sel1:i\d+>>  Select [<<C0>>,{{i\d+}},<<Ch1>>]     loop:none
+  /// CHECK-DAG: <<Ch2:z\d+>>   NotEqual [<<Arr0>>,<<Arr2>>]         loop:none
+  /// CHECK-DAG: <<Sel2:i\d+>>  Select [<<C0>>,<<Sel1>>,<<Ch2>>]     loop:none
+  /// CHECK-DAG:                 VecStore                             loop:<<LoopV:B\d+>> outer_loop:none
+  /// CHECK-DAG:                 ArraySet                             loop:<<LoopS:B\d+>> outer_loop:none
+  //
+  // Checks that a disambiguation runtime test is generated for each pair of array references.
+  //
+  private static void $noinline$stencilTwoSources(int[] a, int[] b, int[] c, int n) {
+    for (int i = 1; i < n - 1; i++) {
+      a[i] = b[i + 1] + c[i - 1];
+    }
+  }
+
   /// CHECK-START: void Main.stencilAddInt(int[], int[], int) loop_optimization (before)
   /// CHECK-DAG: <<CP1:i\d+>>   IntConstant 1                        loop:none
   /// CHECK-DAG: <<CM1:i\d+>>   IntConstant -1                       loop:none
@@ -470,6 +490,31 @@ public class Main {
     }
   }
 
+  static void testStencilTwoSources() {
+    int[] a = new int[100];
+    int[] b = new int[100];
+    int[] c = new int[100];
+    initArrayStencil(b);
+    initArrayStencil(c);
+    $noinline$stencilTwoSources(a, b, c, 100);
+    for (int i = 1; i < 99; i++) {
+      expectEquals(i + 1 + i - 1, a[i]);
+    }
+    // Aliased arrays must run the sequential fallback loop.
+    initArrayStencil(a);
+    $noinline$stencilTwoSources(a, a, c, 100);
+    for (int i = 1; i < 99; i++) {
+      expectEquals(i + 1 + i - 1, a[i]);
+    }
+    initArrayStencil(a);
+    $noinline$stencilTwoSources(a, b, a, 100);
+    int expected = 0;
+    for (int i = 1; i < 99; i++) {
+      expected = i + 1 + expected;
+      expectEquals(expected, a[i]);
+    }
+  }
+
   static void testTypes() {
     int[] a = new int[100];
     int[] b = new int[100];
@@ -491,6 +536,7 @@ public class Main {
     testStencilConstSize();
     testStencil2();
     testStencil3();
+    testStencilTwoSources();
     testTypes();
     System.out.println("passed");
   }
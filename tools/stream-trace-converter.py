@@ -16,7 +16,8 @@
 
 """Script that parses a trace filed produced in streaming mode. The file is broken up into
    a header and body part, which, when concatenated, make up a non-streaming trace file that
-   can be used with traceview."""
+   can be used with traceview. Traces in the compact streaming format (-Xmethod-trace-compact)
+   are expanded to regular records."""
 
 import sys
 
@@ -60,6 +61,34 @@ def WriteIntLE(f, val):
   asbytearray = bytearray(bytes)
   f.write(asbytearray)
 
+def ReadUnsignedLeb128(f):
+  result = 0
+  shift = 0
+  while True:
+    byte = f.read(1)
+    if not byte:
+      raise BufferUnderrun()
+    value = ord(byte)
+    result |= (value & 0x7f) << shift
+    shift += 7
+    if (value & 0x80) == 0:
+      return result
+
+def ReadSignedLeb128(f):
+  result = 0
+  shift = 0
+  while True:
+    byte = f.read(1)
+    if not byte:
+      raise BufferUnderrun()
+    value = ord(byte)
+    result |= (value & 0x7f) << shift
+    shift += 7
+    if (value & 0x80) == 0:
+      if (value & 0x40) != 0:
+        result -= (1 << shift)
+      return result
+
 def Copy(input, output, length):
   buf = input.read(length)
   if len(buf) != length:
@@ -83,12 +112,16 @@ class Rewriter:
     WriteIntLE(body, magic)
 
     version = ReadShortLE(input)
-    if (version & 0xf0) != 0xf0:
+    if (version & 0xf0) == 0xf0:
+      self._compact = False
+    elif (version & 0xf0) == 0xe0:
+      self._compact = True
+    else:
       raise MyException("Does not seem to be a streaming trace: %d." % version)
-    version = version ^ 0xf0
+    version = version & 0x0f
 
-    if version != 3:
-      raise MyException("Only support version 3")
+    if version != 3 and not (self._compact and version == 2):
+      raise MyException("Only support version 3, or version 2 in the compact format")
 
     WriteShortLE(body, version)
 
@@ -130,7 +163,20 @@ class Rewriter:
     self._summary = str
     print 'Summary: \"%s\"' % str
 
-  def ProcessSpecial(self, input):
+  def ProcessCompactEvents(self, input, body):
+    threadId = ReadShortLE(input)
+    numEvents = ReadIntLE(input)
+    # Each time is delta encoded from the previous event of the block.
+    times = [0] * ((self._mRecordSize - 6) / 4)
+    for i in range(numEvents):
+      methodValue = ReadUnsignedLeb128(input)
+      WriteShortLE(body, threadId)
+      WriteIntLE(body, methodValue)
+      for t in range(len(times)):
+        times[t] = (times[t] + ReadSignedLeb128(input)) & 0xFFFFFFFF
+        WriteIntLE(body, times[t])
+
+  def ProcessSpecial(self, input, body):
     code = ord(input.read(1))
     if code == 1:
       self.ProcessMethod(input)
@@ -138,6 +184,8 @@ class Rewriter:
       self.ProcessThread(input)
     elif code == 3:
       self.ProcessTraceSummary(input)
+    elif code == 4 and self._compact:
+      self.ProcessCompactEvents(input, body)
     else:
       raise MyException("Unknown special!")
 
@@ -146,7 +194,7 @@ class Rewriter:
       while True:
         threadId = ReadShortLE(input)
         if threadId == 0:
-          self.ProcessSpecial(input)
+          self.ProcessSpecial(input, body)
         else:
           # Regular package, just copy
           WriteShortLE(body, threadId)